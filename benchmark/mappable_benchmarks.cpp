@@ -0,0 +1,298 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+#include "mappable/mappable_fwd.hpp"
+
+// Counts the bytes allocated by each benchmark
+static std::atomic<std::size_t> bytes_allocated {0};
+
+// The replacements are kept out of line. When GCC 12 inlines the sized operator delete into a
+// std::allocator deallocation, it sees memory from operator new released with std::free and reports
+// -Wmismatched-new-delete, even though the replacements are consistent. Keeping them out of line hides
+// the pairing without disabling the warning for the rest of the benchmarks.
+#if defined(__GNUC__)
+    #define MAPPABLE_BENCHMARK_NOINLINE __attribute__((noinline))
+#else
+    #define MAPPABLE_BENCHMARK_NOINLINE
+#endif
+
+MAPPABLE_BENCHMARK_NOINLINE void* operator new(const std::size_t size)
+{
+    bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+    if (auto result = std::malloc(size == 0 ? 1 : size)) return result;
+    throw std::bad_alloc {};
+}
+
+MAPPABLE_BENCHMARK_NOINLINE void operator delete(void* p) noexcept { std::free(p); }
+MAPPABLE_BENCHMARK_NOINLINE void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace mappable { namespace benchmarks {
+
+using Position = ContigRegion::Position;
+
+/*
+ Benchmarks are parameterised by (set size, read lengths[, query size]). The reads are spread over a contig
+ long enough for an average depth of about 30 with ReadLengths::fixed.
+ */
+enum ReadLengths : std::int64_t { fixed, variable, long_outliers };
+
+static constexpr std::size_t num_queries {1024};
+
+Position contig_size(const std::size_t num_reads)
+{
+    return static_cast<Position>(5 * num_reads + 1000);
+}
+
+template <typename Region> Region make_region(Position begin, Position end);
+template <> ContigRegion make_region<ContigRegion>(Position begin, Position end) { return ContigRegion {begin, end}; }
+template <> GenomicRegion make_region<GenomicRegion>(Position begin, Position end) { return GenomicRegion {"chr1", begin, end}; }
+
+template <typename Region>
+std::vector<Region> make_reads(const std::size_t num_reads, const ReadLengths lengths, const unsigned seed = 42)
+{
+    std::mt19937 gen {seed};
+    const auto last_position = contig_size(num_reads);
+    std::uniform_int_distribution<Position> begin_dist {0, last_position};
+    std::uniform_int_distribution<Position> variable_dist {50, 500}, long_dist {10'000, 100'000};
+    std::bernoulli_distribution is_long_dist {0.01};
+    std::vector<Region> result {};
+    result.reserve(num_reads);
+    std::generate_n(std::back_inserter(result), num_reads, [&] () {
+        Position length {150};
+        if (lengths == variable || (lengths == long_outliers && is_long_dist(gen))) {
+            length = lengths == variable ? variable_dist(gen) : long_dist(gen);
+        }
+        const auto begin = begin_dist(gen);
+        return make_region<Region>(begin, std::min(begin + length, last_position));
+    });
+    return result;
+}
+
+template <typename Region>
+std::vector<Region> make_queries(const std::size_t num_reads, const Position query_size)
+{
+    std::mt19937 gen {7};
+    // queries longer than the contig are clamped to it, otherwise the begin distribution would wrap around
+    const auto size = std::min(query_size, contig_size(num_reads));
+    std::uniform_int_distribution<Position> begin_dist {0, contig_size(num_reads) - size};
+    std::vector<Region> result {};
+    result.reserve(num_queries);
+    std::generate_n(std::back_inserter(result), num_queries, [&] () {
+        const auto begin = begin_dist(gen);
+        return make_region<Region>(begin, begin + size);
+    });
+    return result;
+}
+
+struct AllocationCounter
+{
+    benchmark::State& state;
+    std::size_t start, paused = 0;
+    explicit AllocationCounter(benchmark::State& s) : state {s}, start {bytes_allocated.load()} {}
+    void pause() { state.PauseTiming(); paused = bytes_allocated.load(); }
+    void resume() { start += bytes_allocated.load() - paused; state.ResumeTiming(); }
+    ~AllocationCounter()
+    {
+        state.counters["bytes_allocated"] = benchmark::Counter(static_cast<double>(bytes_allocated.load() - start),
+                                                               benchmark::Counter::kAvgIterations);
+    }
+};
+
+template <typename Set>
+void construction(benchmark::State& state)
+{
+    using Region = typename Set::value_type;
+    const auto reads = make_reads<Region>(state.range(0), static_cast<ReadLengths>(state.range(1)));
+    AllocationCounter allocations {state};
+    for (auto _ : state) {
+        Set set {std::cbegin(reads), std::cend(reads)};
+        benchmark::DoNotOptimize(set.size());
+    }
+    state.SetItemsProcessed(state.iterations() * reads.size());
+}
+
+template <typename Set>
+void insert(benchmark::State& state)
+{
+    using Region = typename Set::value_type;
+    const auto reads = make_reads<Region>(state.range(0), static_cast<ReadLengths>(state.range(1)));
+    const auto new_reads = make_reads<Region>(num_queries, static_cast<ReadLengths>(state.range(1)), 1);
+    Set set {std::cbegin(reads), std::cend(reads)};
+    AllocationCounter allocations {state};
+    std::size_t i {0};
+    for (auto _ : state) {
+        if (i == new_reads.size()) {
+            allocations.pause();
+            set = Set {std::cbegin(reads), std::cend(reads)};
+            i = 0;
+            allocations.resume();
+        }
+        benchmark::DoNotOptimize(set.insert(new_reads[i++]));
+    }
+}
+
+template <typename Set>
+void erase(benchmark::State& state)
+{
+    using Region = typename Set::value_type;
+    const auto reads = make_reads<Region>(state.range(0), static_cast<ReadLengths>(state.range(1)));
+    auto erased = reads;
+    std::shuffle(std::begin(erased), std::end(erased), std::mt19937 {1});
+    erased.resize(std::min(erased.size(), num_queries));
+    Set set {std::cbegin(reads), std::cend(reads)};
+    AllocationCounter allocations {state};
+    std::size_t i {0};
+    for (auto _ : state) {
+        if (i == erased.size()) {
+            allocations.pause();
+            set = Set {std::cbegin(reads), std::cend(reads)};
+            i = 0;
+            allocations.resume();
+        }
+        benchmark::DoNotOptimize(set.erase(erased[i++]));
+    }
+}
+
+template <typename Set, typename Query>
+void run_queries(benchmark::State& state, Query query)
+{
+    using Region = typename Set::value_type;
+    const auto reads = make_reads<Region>(state.range(0), static_cast<ReadLengths>(state.range(1)));
+    const Set set {std::cbegin(reads), std::cend(reads)};
+    const auto queries = make_queries<Region>(reads.size(), static_cast<Position>(state.range(2)));
+    AllocationCounter allocations {state};
+    std::size_t i {0};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(query(set, queries[i++ % queries.size()]));
+    }
+}
+
+template <typename Range>
+std::size_t iterate(const Range& range)
+{
+    std::size_t result {0};
+    for (const auto& region : range) result += region_size(region);
+    return result;
+}
+
+template <typename Set>
+void overlap_range(benchmark::State& state)
+{
+    run_queries<Set>(state, [] (const Set& set, const auto& query) { return iterate(set.overlap_range(query)); });
+}
+
+template <typename Set>
+void contained_range(benchmark::State& state)
+{
+    run_queries<Set>(state, [] (const Set& set, const auto& query) { return iterate(set.contained_range(query)); });
+}
+
+template <typename Set>
+void count_overlapped(benchmark::State& state)
+{
+    run_queries<Set>(state, [] (const Set& set, const auto& query) { return set.count_overlapped(query); });
+}
+
+template <typename Set>
+void count_contained(benchmark::State& state)
+{
+    run_queries<Set>(state, [] (const Set& set, const auto& query) { return set.count_contained(query); });
+}
+
+template <typename Set>
+void count_shared(benchmark::State& state)
+{
+    run_queries<Set>(state, [] (const Set& set, const auto& query) {
+        const auto other = shift(query, region_size(query) / 2 + 1);
+        if (set.bidirectionally_sorted()) return mappable::count_shared(set, query, other, BidirectionallySortedTag {});
+        return mappable::count_shared(set, query, other, ForwardSortedTag {});
+    });
+}
+
+template <typename Set>
+void coverage(benchmark::State& state)
+{
+    using Region = typename Set::value_type;
+    const auto reads = make_reads<Region>(state.range(0), static_cast<ReadLengths>(state.range(1)));
+    const Set set {std::cbegin(reads), std::cend(reads)};
+    AllocationCounter allocations {state};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(calculate_coverage_runs(set));
+    }
+    state.SetItemsProcessed(state.iterations() * reads.size());
+}
+
+template <typename Set>
+void segmentation(benchmark::State& state)
+{
+    using Region = typename Set::value_type;
+    const auto reads = make_reads<Region>(state.range(0), static_cast<ReadLengths>(state.range(1)));
+    const Set set {std::cbegin(reads), std::cend(reads)};
+    AllocationCounter allocations {state};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(segment_overlapped_copy(set));
+    }
+    state.SetItemsProcessed(state.iterations() * reads.size());
+}
+
+template <typename Set>
+void segmentation_view(benchmark::State& state)
+{
+    using Region = typename Set::value_type;
+    const auto reads = make_reads<Region>(state.range(0), static_cast<ReadLengths>(state.range(1)));
+    const Set set {std::cbegin(reads), std::cend(reads)};
+    AllocationCounter allocations {state};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(segment_overlapped(set));
+    }
+    state.SetItemsProcessed(state.iterations() * reads.size());
+}
+
+const std::vector<std::int64_t> set_sizes {1 << 10, 1 << 14, 1 << 18};
+const std::vector<std::int64_t> read_lengths {fixed, variable, long_outliers};
+const std::vector<std::int64_t> query_sizes {1, 150, 10'000};
+
+void set_arguments(benchmark::internal::Benchmark* b)
+{
+    b->ArgNames({"n", "lengths"})->ArgsProduct({set_sizes, read_lengths});
+}
+
+void query_arguments(benchmark::internal::Benchmark* b)
+{
+    b->ArgNames({"n", "lengths", "query"})->ArgsProduct({set_sizes, read_lengths, query_sizes});
+}
+
+#define MAPPABLE_BENCHMARK(function, arguments) \
+    BENCHMARK_TEMPLATE(function, MappableFlatSet<ContigRegion>)->Apply(arguments); \
+    BENCHMARK_TEMPLATE(function, MappableFlatMultiSet<ContigRegion>)->Apply(arguments); \
+    BENCHMARK_TEMPLATE(function, MappableFlatSet<GenomicRegion>)->Apply(arguments); \
+    BENCHMARK_TEMPLATE(function, MappableFlatMultiSet<GenomicRegion>)->Apply(arguments)
+
+MAPPABLE_BENCHMARK(construction, set_arguments);
+MAPPABLE_BENCHMARK(insert, set_arguments);
+MAPPABLE_BENCHMARK(erase, set_arguments);
+MAPPABLE_BENCHMARK(overlap_range, query_arguments);
+MAPPABLE_BENCHMARK(contained_range, query_arguments);
+MAPPABLE_BENCHMARK(count_overlapped, query_arguments);
+MAPPABLE_BENCHMARK(count_contained, query_arguments);
+MAPPABLE_BENCHMARK(count_shared, query_arguments);
+MAPPABLE_BENCHMARK(coverage, set_arguments);
+MAPPABLE_BENCHMARK(segmentation, set_arguments);
+MAPPABLE_BENCHMARK(segmentation_view, set_arguments);
+
+} // namespace benchmarks
+} // namespace mappable
+
+BENCHMARK_MAIN();
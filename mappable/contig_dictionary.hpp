@@ -0,0 +1,142 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef contig_dictionary_hpp
+#define contig_dictionary_hpp
+
+#include <string>
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+#include <boost/optional.hpp>
+
+namespace mappable {
+
+/*
+ ContigDictionary interns contig names, assigning each distinct name a dense 32-bit id in order of first use.
+ Names are never removed, and references returned by name remain valid for the lifetime of the dictionary.
+ All methods are thread safe. Lookups by id (name and size) are lock free, as names are stored in chunks
+ that never move and are published by an atomic count, so they can be used in hot loops.
+
+ The empty name always has id 0 so that default constructed regions have a valid contig.
+
+ When MAPPABLE_INTERNED_CONTIGS is defined, GenomicRegion stores the id of its contig in the global
+ dictionary rather than the contig name itself.
+ */
+class ContigDictionary
+{
+public:
+    using ContigName = std::string;
+    using ContigId   = std::uint32_t;
+    using size_type  = std::size_t;
+
+    ContigDictionary();
+
+    ContigDictionary(const ContigDictionary&)            = delete;
+    ContigDictionary& operator=(const ContigDictionary&) = delete;
+    ContigDictionary(ContigDictionary&&)                 = delete;
+    ContigDictionary& operator=(ContigDictionary&&)      = delete;
+
+    ~ContigDictionary() = default;
+
+    static ContigDictionary& global();
+
+    ContigId intern(const ContigName& name);
+    boost::optional<ContigId> find(const ContigName& name) const;
+    const ContigName& name(ContigId id) const;
+    size_type size() const noexcept;
+
+private:
+    // Chunk i holds first_chunk_size * 2^i names, so 32 chunks cover every 32-bit id
+    static constexpr size_type first_chunk_size = 64;
+    static constexpr std::size_t max_chunks = 32;
+
+    mutable std::mutex mutex_;
+    std::array<std::unique_ptr<ContigName[]>, max_chunks> chunks_;
+    std::atomic<size_type> size_;
+    std::unordered_map<ContigName, ContigId> ids_;
+
+    static std::size_t chunk_index(size_type id) noexcept;
+    static size_type chunk_begin(std::size_t chunk) noexcept;
+};
+
+inline ContigDictionary::ContigDictionary()
+: mutex_ {}
+, chunks_ {}
+, size_ {0}
+, ids_ {}
+{
+    intern(ContigName {});
+}
+
+inline ContigDictionary& ContigDictionary::global()
+{
+    static ContigDictionary result {};
+    return result;
+}
+
+inline ContigDictionary::ContigId ContigDictionary::intern(const ContigName& name)
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    const auto it = ids_.find(name);
+    if (it != std::cend(ids_)) return it->second;
+    const auto id = size_.load(std::memory_order_relaxed);
+    if (id > std::numeric_limits<ContigId>::max()) {
+        throw std::length_error {"ContigDictionary: too many contigs"};
+    }
+    const auto chunk = chunk_index(id);
+    if (!chunks_[chunk]) {
+        chunks_[chunk].reset(new ContigName[chunk_begin(chunk + 1) - chunk_begin(chunk)]);
+    }
+    chunks_[chunk][id - chunk_begin(chunk)] = name;
+    const auto result = static_cast<ContigId>(id);
+    ids_.emplace(name, result);
+    size_.store(id + 1, std::memory_order_release); // publishes the name to name()
+    return result;
+}
+
+inline boost::optional<ContigDictionary::ContigId> ContigDictionary::find(const ContigName& name) const
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    const auto it = ids_.find(name);
+    if (it == std::cend(ids_)) return boost::none;
+    return it->second;
+}
+
+/**
+ Returns the name of id. This never locks, and only throws std::out_of_range if id has not been issued.
+ */
+inline const ContigDictionary::ContigName& ContigDictionary::name(const ContigId id) const
+{
+    if (id >= size_.load(std::memory_order_acquire)) throw std::out_of_range {"ContigDictionary"};
+    const auto chunk = chunk_index(id);
+    return chunks_[chunk][id - chunk_begin(chunk)];
+}
+
+inline ContigDictionary::size_type ContigDictionary::size() const noexcept
+{
+    return size_.load(std::memory_order_acquire);
+}
+
+inline std::size_t ContigDictionary::chunk_index(const size_type id) noexcept
+{
+    std::size_t result {0};
+    for (auto n = id / first_chunk_size + 1; n > 1; n /= 2) ++result;
+    return result;
+}
+
+inline ContigDictionary::size_type ContigDictionary::chunk_begin(const std::size_t chunk) noexcept
+{
+    return first_chunk_size * ((size_type {1} << chunk) - 1);
+}
+
+} // namespace mappable
+
+#endif
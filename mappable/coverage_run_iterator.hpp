@@ -0,0 +1,185 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef coverage_run_iterator_hpp
+#define coverage_run_iterator_hpp
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/range/iterator_range_core.hpp>
+
+#include "mappable.hpp"
+#include "mappable_algorithms.hpp"
+
+namespace mappable {
+
+/*
+ CoverageRunIterator is a single pass iterator that computes the run-length encoded coverage of a sorted stream
+ of MappableType elements, i.e. the same runs as calculate_coverage_runs, but consuming the stream as it goes.
+ Each element is read exactly once, so any input iterator can be used, and only the ends of the elements
+ covering the current position are kept (in a min-heap), so memory is O(max depth) rather than O(n).
+
+ Runs start at the begin of the first element on each contig and end at the last end on that contig; uncovered
+ gaps between elements on the same contig are reported as runs with zero coverage. The elements must be
+ ForwardSorted, and GenomicRegion elements on the same contig must be adjacent.
+ */
+template <typename InputIt>
+class CoverageRunIterator
+    : public boost::iterator_facade<
+        CoverageRunIterator<InputIt>,
+        const std::pair<RegionType<typename std::iterator_traits<InputIt>::value_type>, unsigned>,
+        boost::single_pass_traversal_tag
+    >
+{
+public:
+    using RegionTp = RegionType<typename std::iterator_traits<InputIt>::value_type>;
+    using Position = typename RegionTp::Position;
+    using Run      = std::pair<RegionTp, unsigned>;
+
+    CoverageRunIterator() = default; // the end iterator
+
+    CoverageRunIterator(InputIt first, InputIt last);
+
+    CoverageRunIterator(const CoverageRunIterator&)            = default;
+    CoverageRunIterator& operator=(const CoverageRunIterator&) = default;
+    CoverageRunIterator(CoverageRunIterator&&)                 = default;
+    CoverageRunIterator& operator=(CoverageRunIterator&&)      = default;
+
+    ~CoverageRunIterator() = default;
+
+private:
+    friend class boost::iterator_core_access;
+
+    using EndHeap = std::priority_queue<Position, std::vector<Position>, std::greater<Position>>;
+
+    InputIt first_, last_;
+    RegionTp pending_, contig_;
+    bool has_pending_ = false, has_contig_ = false, done_ = true;
+    Position position_ = 0;
+    EndHeap active_ends_;
+    Run run_;
+
+    const Run& dereference() const noexcept;
+    void increment();
+    bool equal(const CoverageRunIterator& other) const noexcept;
+
+    void fetch();
+    bool pending_on_contig() const;
+    bool is_contig_end() const;
+    void absorb();
+    bool start_run();
+};
+
+template <typename InputIt>
+CoverageRunIterator<InputIt>::CoverageRunIterator(InputIt first, InputIt last)
+: first_ {first}
+, last_ {last}
+, done_ {false}
+{
+    fetch();
+    increment();
+}
+
+template <typename InputIt>
+const typename CoverageRunIterator<InputIt>::Run&
+CoverageRunIterator<InputIt>::dereference() const noexcept
+{
+    return run_;
+}
+
+template <typename InputIt>
+void CoverageRunIterator<InputIt>::increment()
+{
+    if (!start_run()) {
+        done_ = true;
+        return;
+    }
+    const auto run_begin = position_;
+    const auto depth = static_cast<unsigned>(active_ends_.size());
+    do {
+        if (active_ends_.empty()) {
+            position_ = mapped_begin(pending_);
+        } else if (pending_on_contig()) {
+            position_ = std::min(active_ends_.top(), static_cast<Position>(mapped_begin(pending_)));
+        } else {
+            position_ = active_ends_.top();
+        }
+        absorb();
+    } while (active_ends_.size() == depth && !is_contig_end());
+    run_ = Run {detail::make_sub_region(contig_, run_begin, position_), depth};
+}
+
+template <typename InputIt>
+bool CoverageRunIterator<InputIt>::equal(const CoverageRunIterator& other) const noexcept
+{
+    return (done_ && other.done_) || this == &other;
+}
+
+template <typename InputIt>
+void CoverageRunIterator<InputIt>::fetch()
+{
+    has_pending_ = first_ != last_;
+    if (has_pending_) {
+        pending_ = mapped_region(*first_);
+        ++first_;
+    }
+}
+
+template <typename InputIt>
+bool CoverageRunIterator<InputIt>::pending_on_contig() const
+{
+    return has_pending_ && has_contig_ && detail::is_same_contig_or_contig_region(contig_, pending_);
+}
+
+template <typename InputIt>
+bool CoverageRunIterator<InputIt>::is_contig_end() const
+{
+    return active_ends_.empty() && !pending_on_contig();
+}
+
+template <typename InputIt>
+void CoverageRunIterator<InputIt>::absorb()
+{
+    while (!active_ends_.empty() && active_ends_.top() <= position_) {
+        active_ends_.pop();
+    }
+    while (pending_on_contig() && mapped_begin(pending_) <= position_) {
+        // Empty elements do not contribute any coverage
+        if (mapped_end(pending_) > position_) active_ends_.push(mapped_end(pending_));
+        fetch();
+    }
+}
+
+template <typename InputIt>
+bool CoverageRunIterator<InputIt>::start_run()
+{
+    while (is_contig_end()) {
+        if (!has_pending_) return false;
+        contig_ = pending_;
+        has_contig_ = true;
+        position_ = mapped_begin(pending_);
+        absorb();
+    }
+    return true;
+}
+
+template <typename InputIt>
+auto make_coverage_run_range(InputIt first, InputIt last)
+{
+    return boost::make_iterator_range(CoverageRunIterator<InputIt> {first, last}, CoverageRunIterator<InputIt> {});
+}
+
+template <typename Range>
+auto make_coverage_run_range(const Range& mappables)
+{
+    return make_coverage_run_range(std::cbegin(mappables), std::cend(mappables));
+}
+
+} // namespace mappable
+
+#endif
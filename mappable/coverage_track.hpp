@@ -0,0 +1,306 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef coverage_track_hpp
+#define coverage_track_hpp
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+#include <stdexcept>
+
+#include "contig_region.hpp"
+#include "genomic_region.hpp"
+#include "mappable.hpp"
+#include "mappable_algorithms.hpp"
+
+namespace mappable {
+
+/*
+ CoverageTrack is a run-length encoded coverage profile over a region: the region is partitioned into maximal
+ runs of constant depth, so memory is proportional to the number of depth changes rather than the number of
+ positions.
+
+ Depth and region queries are O(log n) in the number of runs (plus the number of runs reported), tracks from
+ different samples can be added together, and runs can be thresholded into region lists without expanding the
+ track to positions. Positions outside the track region have zero depth.
+ */
+template <typename RegionTp>
+class CoverageTrack
+{
+public:
+    using RegionType = RegionTp;
+    using Position   = typename RegionTp::Position;
+    using Depth      = unsigned;
+    using size_type  = std::size_t;
+    using Run        = std::pair<RegionTp, Depth>;
+
+    CoverageTrack() = default;
+
+    explicit CoverageTrack(RegionTp region);
+
+    template <typename ForwardIt>
+    CoverageTrack(ForwardIt first, ForwardIt last);
+
+    template <typename ForwardIt>
+    CoverageTrack(ForwardIt first, ForwardIt last, RegionTp region);
+
+    CoverageTrack(const CoverageTrack&)            = default;
+    CoverageTrack& operator=(const CoverageTrack&) = default;
+    CoverageTrack(CoverageTrack&&)                 = default;
+    CoverageTrack& operator=(CoverageTrack&&)      = default;
+
+    ~CoverageTrack() = default;
+
+    const RegionTp& region() const noexcept;
+    size_type num_runs() const noexcept;
+    bool empty() const noexcept;
+    Run run(size_type n) const;
+    std::vector<Run> runs() const;
+    std::vector<Run> runs(const RegionTp& region) const;
+
+    Depth depth(Position position) const;
+    Depth min_depth(const RegionTp& region) const;
+    Depth max_depth(const RegionTp& region) const;
+    double mean_depth(const RegionTp& region) const;
+
+    template <typename UnaryPredicate>
+    std::vector<RegionTp> select_regions(UnaryPredicate pred) const;
+    std::vector<RegionTp> threshold(Depth min_depth) const;
+
+    CoverageTrack& operator+=(const CoverageTrack& other);
+
+private:
+    using IndexRange = std::pair<size_type, size_type>;
+
+    RegionTp region_;
+    std::vector<Position> breakpoints_; // run i is [breakpoints_[i], breakpoints_[i + 1])
+    std::vector<Depth> depths_;
+
+    bool is_on_contig(const RegionTp& region) const;
+    IndexRange run_bounds(const RegionTp& region) const;
+    Position clipped_run_size(size_type n, const RegionTp& region) const;
+};
+
+template <typename RegionTp>
+CoverageTrack<RegionTp>::CoverageTrack(RegionTp region)
+: region_ {std::move(region)}
+, breakpoints_ {}
+, depths_ {}
+{
+    if (!is_empty(region_)) {
+        breakpoints_ = {region_.begin(), region_.end()};
+        depths_ = {0};
+    }
+}
+
+template <typename RegionTp>
+template <typename ForwardIt>
+CoverageTrack<RegionTp>::CoverageTrack(ForwardIt first, ForwardIt last)
+: CoverageTrack {first, last, encompassing_region(first, last)}
+{}
+
+template <typename RegionTp>
+template <typename ForwardIt>
+CoverageTrack<RegionTp>::CoverageTrack(ForwardIt first, ForwardIt last, RegionTp region)
+: region_ {std::move(region)}
+, breakpoints_ {}
+, depths_ {}
+{
+    detail::CallRecorder uninstrumented {};
+    detail::sweep_coverage(first, last, region_.begin(), region_.end(), breakpoints_, depths_, uninstrumented);
+    breakpoints_.shrink_to_fit();
+    depths_.shrink_to_fit();
+}
+
+template <typename RegionTp>
+const RegionTp& CoverageTrack<RegionTp>::region() const noexcept
+{
+    return region_;
+}
+
+template <typename RegionTp>
+typename CoverageTrack<RegionTp>::size_type CoverageTrack<RegionTp>::num_runs() const noexcept
+{
+    return depths_.size();
+}
+
+template <typename RegionTp>
+bool CoverageTrack<RegionTp>::empty() const noexcept
+{
+    return depths_.empty();
+}
+
+template <typename RegionTp>
+typename CoverageTrack<RegionTp>::Run CoverageTrack<RegionTp>::run(const size_type n) const
+{
+    if (n >= num_runs()) throw std::out_of_range {"CoverageTrack"};
+    return Run {detail::make_sub_region(region_, breakpoints_[n], breakpoints_[n + 1]), depths_[n]};
+}
+
+template <typename RegionTp>
+std::vector<typename CoverageTrack<RegionTp>::Run> CoverageTrack<RegionTp>::runs() const
+{
+    return runs(region_);
+}
+
+template <typename RegionTp>
+std::vector<typename CoverageTrack<RegionTp>::Run> CoverageTrack<RegionTp>::runs(const RegionTp& region) const
+{
+    std::vector<Run> result {};
+    const auto bounds = run_bounds(region);
+    result.reserve(bounds.second - bounds.first);
+    for (auto n = bounds.first; n < bounds.second; ++n) {
+        const auto begin = std::max(breakpoints_[n], static_cast<Position>(region.begin()));
+        const auto end   = std::min(breakpoints_[n + 1], static_cast<Position>(region.end()));
+        result.emplace_back(detail::make_sub_region(region_, begin, end), depths_[n]);
+    }
+    return result;
+}
+
+template <typename RegionTp>
+typename CoverageTrack<RegionTp>::Depth CoverageTrack<RegionTp>::depth(const Position position) const
+{
+    if (empty() || position < breakpoints_.front() || position >= breakpoints_.back()) return 0;
+    const auto it = std::upper_bound(std::cbegin(breakpoints_), std::cend(breakpoints_), position);
+    return depths_[std::distance(std::cbegin(breakpoints_), it) - 1];
+}
+
+template <typename RegionTp>
+typename CoverageTrack<RegionTp>::Depth CoverageTrack<RegionTp>::min_depth(const RegionTp& region) const
+{
+    if (is_empty(region) || !is_on_contig(region)) return 0;
+    // Any part of region outside the track has zero depth
+    if (!contains(region_, region)) return 0;
+    const auto bounds = run_bounds(region);
+    return *std::min_element(std::next(std::cbegin(depths_), bounds.first),
+                             std::next(std::cbegin(depths_), bounds.second));
+}
+
+template <typename RegionTp>
+typename CoverageTrack<RegionTp>::Depth CoverageTrack<RegionTp>::max_depth(const RegionTp& region) const
+{
+    const auto bounds = run_bounds(region);
+    if (bounds.first == bounds.second) return 0;
+    return *std::max_element(std::next(std::cbegin(depths_), bounds.first),
+                             std::next(std::cbegin(depths_), bounds.second));
+}
+
+template <typename RegionTp>
+double CoverageTrack<RegionTp>::mean_depth(const RegionTp& region) const
+{
+    if (is_empty(region)) return 0;
+    const auto bounds = run_bounds(region);
+    double total {0};
+    for (auto n = bounds.first; n < bounds.second; ++n) {
+        total += static_cast<double>(depths_[n]) * clipped_run_size(n, region);
+    }
+    return total / region_size(region);
+}
+
+template <typename RegionTp>
+template <typename UnaryPredicate>
+std::vector<RegionTp> CoverageTrack<RegionTp>::select_regions(UnaryPredicate pred) const
+{
+    std::vector<RegionTp> result {};
+    for (size_type n {0}; n < num_runs();) {
+        if (pred(depths_[n])) {
+            auto last = n + 1;
+            while (last < num_runs() && pred(depths_[last])) ++last;
+            result.push_back(detail::make_sub_region(region_, breakpoints_[n], breakpoints_[last]));
+            n = last;
+        } else {
+            ++n;
+        }
+    }
+    return result;
+}
+
+template <typename RegionTp>
+std::vector<RegionTp> CoverageTrack<RegionTp>::threshold(const Depth min_depth) const
+{
+    return select_regions([min_depth] (const Depth depth) { return depth >= min_depth; });
+}
+
+template <typename RegionTp>
+CoverageTrack<RegionTp>& CoverageTrack<RegionTp>::operator+=(const CoverageTrack& other)
+{
+    if (other.empty()) return *this;
+    if (empty()) return *this = other;
+    // Throws BadRegionCompare if the tracks are on different contigs
+    auto region = encompassing_region(region_, other.region_);
+    std::vector<Position> positions(breakpoints_.size() + other.breakpoints_.size());
+    positions.erase(std::unique(std::begin(positions),
+                                std::merge(std::cbegin(breakpoints_), std::cend(breakpoints_),
+                                           std::cbegin(other.breakpoints_), std::cend(other.breakpoints_),
+                                           std::begin(positions))),
+                    std::end(positions));
+    std::vector<Position> breakpoints {};
+    std::vector<Depth> depths {};
+    breakpoints.reserve(positions.size());
+    depths.reserve(positions.size());
+    size_type i {0}, j {0};
+    for (size_type k {0}; k + 1 < positions.size(); ++k) {
+        const auto position = positions[k];
+        while (i < num_runs() && breakpoints_[i + 1] <= position) ++i;
+        while (j < other.num_runs() && other.breakpoints_[j + 1] <= position) ++j;
+        Depth depth {0};
+        if (i < num_runs() && breakpoints_[i] <= position) depth += depths_[i];
+        if (j < other.num_runs() && other.breakpoints_[j] <= position) depth += other.depths_[j];
+        if (depths.empty() || depths.back() != depth) {
+            breakpoints.push_back(position);
+            depths.push_back(depth);
+        }
+    }
+    breakpoints.push_back(positions.back());
+    region_      = std::move(region);
+    breakpoints_ = std::move(breakpoints);
+    depths_      = std::move(depths);
+    return *this;
+}
+
+// private methods
+
+template <typename RegionTp>
+bool CoverageTrack<RegionTp>::is_on_contig(const RegionTp& region) const
+{
+    return detail::is_same_contig_or_contig_region(region_, region);
+}
+
+template <typename RegionTp>
+typename CoverageTrack<RegionTp>::IndexRange CoverageTrack<RegionTp>::run_bounds(const RegionTp& region) const
+{
+    if (empty() || is_empty(region) || !is_on_contig(region)) return {0, 0};
+    const auto first = std::upper_bound(std::cbegin(breakpoints_), std::cend(breakpoints_),
+                                        static_cast<Position>(region.begin()));
+    const auto last  = std::lower_bound(first, std::cend(breakpoints_), static_cast<Position>(region.end()));
+    // first is the end of the first run overlapping region, and last is the end of the last run
+    const auto begin_index = static_cast<size_type>(std::distance(std::cbegin(breakpoints_), first));
+    const auto end_index   = std::min(static_cast<size_type>(std::distance(std::cbegin(breakpoints_), last)),
+                                      num_runs());
+    if (begin_index == 0) return {0, end_index};
+    return {begin_index - 1, end_index};
+}
+
+template <typename RegionTp>
+typename CoverageTrack<RegionTp>::Position
+CoverageTrack<RegionTp>::clipped_run_size(const size_type n, const RegionTp& region) const
+{
+    return std::min(breakpoints_[n + 1], static_cast<Position>(region.end()))
+           - std::max(breakpoints_[n], static_cast<Position>(region.begin()));
+}
+
+// non-member methods
+
+template <typename RegionTp>
+CoverageTrack<RegionTp> operator+(CoverageTrack<RegionTp> lhs, const CoverageTrack<RegionTp>& rhs)
+{
+    lhs += rhs;
+    return lhs;
+}
+
+} // namespace mappable
+
+#endif
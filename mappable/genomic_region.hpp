@@ -9,12 +9,15 @@
 #include <stdexcept>
 #include <ostream>
 #include <cassert>
+#include <type_traits>
+#include <utility>
 
 #include <boost/optional.hpp>
 #include <boost/functional/hash.hpp>
 
 #include "comparable.hpp"
 #include "contig_region.hpp"
+#include "contig_dictionary.hpp"
 
 namespace mappable {
 
@@ -25,23 +28,39 @@ namespace mappable {
  
     All comparison operations (<, ==, is_before, etc) throw exceptions if the arguements
     are not from the same contig.
+ 
+    By default the contig name is stored in each region. If MAPPABLE_INTERNED_CONTIGS is defined
+    the region instead stores a 32-bit id from ContigDictionary::global(), so regions are trivially
+    copyable and contig comparisons are integer comparisons. In either mode the contig is identified
+    by contig_key(), which should be used in place of contig_name() when constructing new regions
+    on the same contig.
 */
 class GenomicRegion : public Comparable<GenomicRegion>
 {
 public:
     using ContigName = std::string;
+#ifdef MAPPABLE_INTERNED_CONTIGS
+    using ContigKey  = ContigDictionary::ContigId;
+    static constexpr bool has_interned_contigs = true;
+#else
+    using ContigKey  = ContigName;
+    static constexpr bool has_interned_contigs = false;
+#endif
     using Position   = ContigRegion::Position;
     using Size       = ContigRegion::Size;
     using Distance   = ContigRegion::Distance;
     
     GenomicRegion() = default;  // for use with containers
     
-    template <typename T>
+    template <typename T, typename = std::enable_if_t<!std::is_same<std::decay_t<T>, ContigKey>::value>>
     explicit GenomicRegion(T&& contig_name, Position begin, Position end);
     
-    template <typename T, typename R>
+    template <typename T, typename R, typename = std::enable_if_t<!std::is_same<std::decay_t<T>, ContigKey>::value>>
     explicit GenomicRegion(T&& contig_name, R&& contig_region);
     
+    explicit GenomicRegion(ContigKey contig_key, Position begin, Position end);
+    explicit GenomicRegion(ContigKey contig_key, ContigRegion contig_region);
+    
     GenomicRegion(const GenomicRegion&)            = default;
     GenomicRegion& operator=(const GenomicRegion&) = default;
     GenomicRegion(GenomicRegion&&)                 = default;
@@ -49,15 +68,20 @@ public:
     
     ~GenomicRegion() = default;
     
-    const ContigName& contig_name() const noexcept;
+    // Interned contig names are looked up in ContigDictionary::global(), which throws for unknown keys
+    const ContigName& contig_name() const noexcept(!has_interned_contigs);
+    const ContigKey& contig_key() const noexcept;
     const ContigRegion& contig_region() const noexcept;
     
     Position begin() const noexcept;
     Position end() const noexcept;
 
 private:
-    ContigName contig_name_;
+    ContigKey contig_key_ {};
     ContigRegion contig_region_;
+    
+    template <typename T>
+    static ContigKey make_contig_key(T&& contig_name);
 };
 
 class BadRegionCompare : public std::logic_error
@@ -87,21 +111,59 @@ private:
 
 // public member methods
 
-template <typename T>
+template <typename T, typename>
 GenomicRegion::GenomicRegion(T&& contig_name, const Position begin, const Position end)
-: contig_name_ {std::forward<T>(contig_name)}
+: contig_key_ {make_contig_key(std::forward<T>(contig_name))}
 , contig_region_ {begin, end}
 {}
 
-template <typename T, typename R>
+template <typename T, typename R, typename>
 GenomicRegion::GenomicRegion(T&& contig_name, R&& contig_region)
-: contig_name_ {std::forward<T>(contig_name)}
+: contig_key_ {make_contig_key(std::forward<T>(contig_name))}
 , contig_region_ {std::forward<R>(contig_region)}
 {}
 
-inline const GenomicRegion::ContigName& GenomicRegion::contig_name() const noexcept
+inline GenomicRegion::GenomicRegion(ContigKey contig_key, const Position begin, const Position end)
+: contig_key_ {std::move(contig_key)}
+, contig_region_ {begin, end}
+{}
+
+inline GenomicRegion::GenomicRegion(ContigKey contig_key, ContigRegion contig_region)
+: contig_key_ {std::move(contig_key)}
+, contig_region_ {std::move(contig_region)}
+{}
+
+#ifdef MAPPABLE_INTERNED_CONTIGS
+
+inline const GenomicRegion::ContigName& GenomicRegion::contig_name() const noexcept(!has_interned_contigs)
+{
+    return ContigDictionary::global().name(contig_key_);
+}
+
+template <typename T>
+GenomicRegion::ContigKey GenomicRegion::make_contig_key(T&& contig_name)
+{
+    return ContigDictionary::global().intern(ContigName {std::forward<T>(contig_name)});
+}
+
+#else
+
+inline const GenomicRegion::ContigName& GenomicRegion::contig_name() const noexcept(!has_interned_contigs)
+{
+    return contig_key_;
+}
+
+template <typename T>
+GenomicRegion::ContigKey GenomicRegion::make_contig_key(T&& contig_name)
+{
+    return ContigKey {std::forward<T>(contig_name)};
+}
+
+#endif
+
+inline const GenomicRegion::ContigKey& GenomicRegion::contig_key() const noexcept
 {
-    return contig_name_;
+    return contig_key_;
 }
 
 inline const ContigRegion& GenomicRegion::contig_region() const noexcept
@@ -121,7 +183,7 @@ inline GenomicRegion::Position GenomicRegion::end() const noexcept
 
 // non-member methods
 
-inline const GenomicRegion::ContigName& contig_name(const GenomicRegion& region) noexcept
+inline const GenomicRegion::ContigName& contig_name(const GenomicRegion& region) noexcept(!GenomicRegion::has_interned_contigs)
 {
     return region.contig_name();
 }
@@ -159,7 +221,7 @@ inline bool is_position(const GenomicRegion& region) noexcept
 
 inline bool is_same_contig(const GenomicRegion& lhs, const GenomicRegion& rhs) noexcept
 {
-    return lhs.contig_name() == rhs.contig_name();
+    return lhs.contig_key() == rhs.contig_key();
 }
 
 inline bool begins_equal(const GenomicRegion& lhs, const GenomicRegion& rhs)
@@ -243,39 +305,39 @@ inline GenomicRegion::Distance outer_distance(const GenomicRegion& lhs, const Ge
 
 inline GenomicRegion shift(const GenomicRegion& region, GenomicRegion::Distance n)
 {
-    return GenomicRegion {region.contig_name(), shift(region.contig_region(), n)};
+    return GenomicRegion {region.contig_key(), shift(region.contig_region(), n)};
 }
 
 inline GenomicRegion next_position(const GenomicRegion& region)
 {
-    return GenomicRegion {region.contig_name(), next_position(region.contig_region())};
+    return GenomicRegion {region.contig_key(), next_position(region.contig_region())};
 }
 
 inline GenomicRegion expand_lhs(const GenomicRegion& region, const GenomicRegion::Distance n)
 {
-    return GenomicRegion {region.contig_name(), expand_lhs(region.contig_region(), n)};
+    return GenomicRegion {region.contig_key(), expand_lhs(region.contig_region(), n)};
 }
 
 inline GenomicRegion expand_rhs(const GenomicRegion& region, const GenomicRegion::Distance n)
 {
-    return GenomicRegion {region.contig_name(), expand_rhs(region.contig_region(), n)};
+    return GenomicRegion {region.contig_key(), expand_rhs(region.contig_region(), n)};
 }
 
 inline GenomicRegion expand(const GenomicRegion& region, const GenomicRegion::Distance n)
 {
-    return GenomicRegion {region.contig_name(), expand(region.contig_region(), n)};
+    return GenomicRegion {region.contig_key(), expand(region.contig_region(), n)};
 }
 
 inline GenomicRegion expand(const GenomicRegion& region, const GenomicRegion::Distance lhs,
                             const GenomicRegion::Distance rhs)
 {
-    return GenomicRegion {region.contig_name(), expand(region.contig_region(), lhs, rhs)};
+    return GenomicRegion {region.contig_key(), expand(region.contig_region(), lhs, rhs)};
 }
 
 inline GenomicRegion encompassing_region(const GenomicRegion& lhs, const GenomicRegion& rhs)
 {
     if (!is_same_contig(lhs, rhs)) throw BadRegionCompare {to_string(lhs), to_string(rhs)};
-    return GenomicRegion {lhs.contig_name(), encompassing_region(lhs.contig_region(), rhs.contig_region())};
+    return GenomicRegion {lhs.contig_key(), encompassing_region(lhs.contig_region(), rhs.contig_region())};
 }
 
 inline boost::optional<GenomicRegion> intervening_region(const GenomicRegion& lhs, const GenomicRegion& rhs)
@@ -283,7 +345,7 @@ inline boost::optional<GenomicRegion> intervening_region(const GenomicRegion& lh
     if (!is_same_contig(lhs, rhs)) return boost::none;
     const auto contig_region = intervening_region(lhs.contig_region(),  rhs.contig_region());
     if (contig_region) {
-        return GenomicRegion {lhs.contig_name(), *contig_region};
+        return GenomicRegion {lhs.contig_key(), *contig_region};
     }
     return boost::none;
 }
@@ -299,7 +361,7 @@ inline boost::optional<GenomicRegion> overlapped_region(const GenomicRegion& lhs
     if (!overlaps(lhs, rhs)) {
         return boost::none;
     }
-    return GenomicRegion {lhs.contig_name(), *overlapped_region(lhs.contig_region(), rhs.contig_region())};
+    return GenomicRegion {lhs.contig_key(), *overlapped_region(lhs.contig_region(), rhs.contig_region())};
 }
 
 inline GenomicRegion::Size left_overhang_size(const GenomicRegion& lhs, const GenomicRegion& rhs) noexcept
@@ -315,39 +377,39 @@ inline GenomicRegion::Size right_overhang_size(const GenomicRegion& lhs, const G
 inline GenomicRegion left_overhang_region(const GenomicRegion& lhs, const GenomicRegion& rhs)
 {
     if (!is_same_contig(lhs, rhs)) throw BadRegionCompare {to_string(lhs), to_string(rhs)};
-    return GenomicRegion {lhs.contig_name(), left_overhang_region(lhs.contig_region(), rhs.contig_region())};
+    return GenomicRegion {lhs.contig_key(), left_overhang_region(lhs.contig_region(), rhs.contig_region())};
 }
 
 inline GenomicRegion right_overhang_region(const GenomicRegion& lhs, const GenomicRegion& rhs)
 {
     if (!is_same_contig(lhs, rhs)) throw BadRegionCompare {to_string(lhs), to_string(rhs)};
-    return GenomicRegion {lhs.contig_name(), right_overhang_region(lhs.contig_region(), rhs.contig_region())};
+    return GenomicRegion {lhs.contig_key(), right_overhang_region(lhs.contig_region(), rhs.contig_region())};
 }
 
 inline GenomicRegion closed_region(const GenomicRegion& lhs, const GenomicRegion& rhs)
 {
     if (!is_same_contig(lhs, rhs)) throw BadRegionCompare {to_string(lhs), to_string(rhs)};
-    return GenomicRegion {lhs.contig_name(), closed_region(lhs.contig_region(), rhs.contig_region())};
+    return GenomicRegion {lhs.contig_key(), closed_region(lhs.contig_region(), rhs.contig_region())};
 }
 
 inline GenomicRegion head_region(const GenomicRegion& region, const GenomicRegion::Size n = 0)
 {
-    return GenomicRegion {region.contig_name(), head_region(region.contig_region(), n)};
+    return GenomicRegion {region.contig_key(), head_region(region.contig_region(), n)};
 }
 
 inline GenomicRegion head_position(const GenomicRegion& region)
 {
-    return GenomicRegion {region.contig_name(), head_position(region.contig_region())};
+    return GenomicRegion {region.contig_key(), head_position(region.contig_region())};
 }
 
 inline GenomicRegion tail_region(const GenomicRegion& region, const GenomicRegion::Size n = 0)
 {
-    return GenomicRegion {region.contig_name(), tail_region(region.contig_region(), n)};
+    return GenomicRegion {region.contig_key(), tail_region(region.contig_region(), n)};
 }
 
 inline GenomicRegion tail_position(const GenomicRegion& region)
 {
-    return GenomicRegion {region.contig_name(), tail_position(region.contig_region())};
+    return GenomicRegion {region.contig_key(), tail_position(region.contig_region())};
 }
 
 inline GenomicRegion::Distance begin_distance(const GenomicRegion& first, const GenomicRegion& second)
@@ -374,7 +436,7 @@ struct GenomicRegionHash
     {
         using boost::hash_combine;
         std::size_t result {};
-        hash_combine(result, std::hash<GenomicRegion::ContigName>()(region.contig_name()));
+        hash_combine(result, std::hash<GenomicRegion::ContigKey>()(region.contig_key()));
         hash_combine(result, std::hash<ContigRegion>()(region.contig_region()));
         return result;
     }
@@ -0,0 +1,355 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef implicit_interval_tree_hpp
+#define implicit_interval_tree_hpp
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cstddef>
+
+#include "mappable.hpp"
+#include "materialised_range.hpp"
+
+namespace mappable {
+
+/*
+ ImplicitIntervalTree augments a sorted random access range of MappableType elements with
+ the maximum end position of every subtree of an implicit binary search tree laid over the
+ range (the node at index i has level equal to the number of trailing one bits of i, and
+ the root is at index 2^K - 1). The range itself is not reordered; only one position per
+ element is stored.
+
+ This makes overlap queries O(log n + k), where k is the number of overlapped elements,
+ regardless of the size distribution of the elements. The tree must be rebuilt whenever the
+ underlying range is modified, and every query must be passed the same range the tree was
+ built from.
+ */
+template <typename Position>
+class ImplicitIntervalTree
+{
+public:
+    using size_type = std::size_t;
+
+    ImplicitIntervalTree() = default;
+
+    template <typename RandomIt>
+    ImplicitIntervalTree(RandomIt first, RandomIt last);
+
+    ImplicitIntervalTree(const ImplicitIntervalTree&)            = default;
+    ImplicitIntervalTree& operator=(const ImplicitIntervalTree&) = default;
+    ImplicitIntervalTree(ImplicitIntervalTree&&)                 = default;
+    ImplicitIntervalTree& operator=(ImplicitIntervalTree&&)      = default;
+
+    ~ImplicitIntervalTree() = default;
+
+    template <typename RandomIt>
+    void rebuild(RandomIt first, RandomIt last);
+
+    void clear() noexcept;
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+
+    template <typename RandomIt, typename MappableTp>
+    RandomIt find_first_overlapped(RandomIt first, RandomIt last, const MappableTp& mappable) const;
+
+    template <typename RandomIt, typename MappableTp>
+    bool has_overlapped(RandomIt first, RandomIt last, const MappableTp& mappable) const;
+
+    template <typename RandomIt, typename MappableTp>
+    size_type count_overlapped(RandomIt first, RandomIt last, const MappableTp& mappable) const;
+
+    template <typename RandomIt, typename MappableTp, typename UnaryFunction>
+    UnaryFunction for_each_overlapped(RandomIt first, RandomIt last, const MappableTp& mappable,
+                                      UnaryFunction f) const;
+
+    template <typename RandomIt, typename MappableTp>
+    MaterialisedRange<RandomIt> materialise_overlapped(RandomIt first, RandomIt last, const MappableTp& mappable) const;
+
+    template <typename RandomIt, typename MappableTp>
+    OverlapRange<RandomIt> overlap_range(RandomIt first, RandomIt last, const MappableTp& mappable) const;
+
+    template <typename RandomIt, typename MappableTp>
+    IndexedOverlapRange<RandomIt> indexed_overlap_range(RandomIt first, RandomIt last,
+                                                        const MappableTp& mappable) const;
+
+private:
+    std::vector<Position> max_ends_;
+    int root_level_ = 0;
+
+    // Visits the overlapped elements in order until the visitor returns false
+    template <typename RandomIt, typename MappableTp, typename Visitor>
+    void visit_overlapped(RandomIt first, const MappableTp& mappable, Visitor&& visitor) const;
+
+    // The IndexedOverlapIterator::IndexSearch of the tree with the given max ends
+    template <typename RandomIt, typename Region>
+    static RandomIt search_overlapped(const void* index, std::size_t index_size, RandomIt first, RandomIt it,
+                                      bool forward, const Region& region);
+
+    // The first overlapped element of the subtree at or after from, or n if there is none
+    template <typename RandomIt, typename MappableTp>
+    static size_type next_overlapped(const Position* max_ends, size_type n, RandomIt first,
+                                     size_type index, int level, size_type from, const MappableTp& mappable);
+
+    // The last overlapped element of the subtree before to, or n if there is none
+    template <typename RandomIt, typename MappableTp>
+    static size_type prev_overlapped(const Position* max_ends, size_type n, RandomIt first,
+                                     size_type index, int level, size_type to, const MappableTp& mappable);
+};
+
+template <typename Position>
+template <typename RandomIt>
+ImplicitIntervalTree<Position>::ImplicitIntervalTree(RandomIt first, RandomIt last)
+{
+    rebuild(first, last);
+}
+
+template <typename Position>
+template <typename RandomIt>
+void ImplicitIntervalTree<Position>::rebuild(RandomIt first, RandomIt last)
+{
+    const auto n = static_cast<size_type>(std::distance(first, last));
+    max_ends_.resize(n);
+    root_level_ = 0;
+    if (n == 0) return;
+    // Leaves are the even indices. last_i tracks the rightmost node so that
+    // out of range right children can be assigned its maximum end, last_end.
+    size_type last_i {0};
+    Position last_end {0};
+    for (size_type i {0}; i < n; i += 2) {
+        last_i = i;
+        last_end = max_ends_[i] = mapped_end(first[i]);
+    }
+    int k {1};
+    for (; (size_type {1} << k) <= n; ++k) {
+        const size_type x {size_type {1} << (k - 1)}, i0 {(x << 1) - 1}, step {x << 2};
+        for (auto i = i0; i < n; i += step) {
+            const auto left_end  = max_ends_[i - x];
+            const auto right_end = i + x < n ? max_ends_[i + x] : last_end;
+            max_ends_[i] = std::max({static_cast<Position>(mapped_end(first[i])), left_end, right_end});
+        }
+        last_i = ((last_i >> k) & 1) ? last_i - x : last_i + x;
+        if (last_i < n && max_ends_[last_i] > last_end) last_end = max_ends_[last_i];
+    }
+    root_level_ = k - 1;
+}
+
+template <typename Position>
+void ImplicitIntervalTree<Position>::clear() noexcept
+{
+    max_ends_.clear();
+    root_level_ = 0;
+}
+
+template <typename Position>
+typename ImplicitIntervalTree<Position>::size_type
+ImplicitIntervalTree<Position>::size() const noexcept
+{
+    return max_ends_.size();
+}
+
+template <typename Position>
+bool ImplicitIntervalTree<Position>::empty() const noexcept
+{
+    return max_ends_.empty();
+}
+
+template <typename Position>
+template <typename RandomIt, typename MappableTp, typename Visitor>
+void ImplicitIntervalTree<Position>::visit_overlapped(RandomIt first, const MappableTp& mappable,
+                                                      Visitor&& visitor) const
+{
+    struct Node
+    {
+        size_type index;
+        int level;
+        bool left_visited;
+    };
+
+    const auto n = size();
+    if (n == 0) return;
+    const auto query_begin = mapped_begin(mappable);
+    const auto query_end   = mapped_end(mappable);
+    // The pruning tests are inclusive as empty regions overlap regions they touch;
+    // the exact test is left to overlaps.
+    Node stack[8 * sizeof(size_type)];
+    int top {0};
+    stack[top++] = Node {(size_type {1} << root_level_) - 1, root_level_, false};
+    while (top > 0) {
+        const auto node = stack[--top];
+        if (node.level <= 3) {
+            // Small subtree, just scan it
+            const auto i0 = (node.index >> node.level) << node.level;
+            const auto i1 = std::min(i0 + (size_type {1} << (node.level + 1)) - 1, n);
+            for (auto i = i0; i < i1 && mapped_begin(first[i]) <= query_end; ++i) {
+                if (overlaps(first[i], mappable) && !visitor(std::next(first, i))) return;
+            }
+        } else if (!node.left_visited) {
+            const auto left = node.index - (size_type {1} << (node.level - 1));
+            stack[top++] = Node {node.index, node.level, true};
+            if (left >= n || max_ends_[left] >= query_begin) {
+                stack[top++] = Node {left, node.level - 1, false};
+            }
+        } else if (node.index < n && mapped_begin(first[node.index]) <= query_end) {
+            if (overlaps(first[node.index], mappable) && !visitor(std::next(first, node.index))) return;
+            stack[top++] = Node {node.index + (size_type {1} << (node.level - 1)), node.level - 1, false};
+        }
+    }
+}
+
+template <typename Position>
+template <typename RandomIt, typename MappableTp>
+RandomIt
+ImplicitIntervalTree<Position>::find_first_overlapped(RandomIt first, RandomIt last,
+                                                      const MappableTp& mappable) const
+{
+    auto result = last;
+    visit_overlapped(first, mappable, [&result] (RandomIt it) { result = it; return false; });
+    return result;
+}
+
+template <typename Position>
+template <typename RandomIt, typename MappableTp>
+bool ImplicitIntervalTree<Position>::has_overlapped(RandomIt first, RandomIt last,
+                                                    const MappableTp& mappable) const
+{
+    return find_first_overlapped(first, last, mappable) != last;
+}
+
+template <typename Position>
+template <typename RandomIt, typename MappableTp>
+typename ImplicitIntervalTree<Position>::size_type
+ImplicitIntervalTree<Position>::count_overlapped(RandomIt first, RandomIt,
+                                                 const MappableTp& mappable) const
+{
+    size_type result {0};
+    visit_overlapped(first, mappable, [&result] (RandomIt) { ++result; return true; });
+    return result;
+}
+
+template <typename Position>
+template <typename RandomIt, typename MappableTp, typename UnaryFunction>
+UnaryFunction
+ImplicitIntervalTree<Position>::for_each_overlapped(RandomIt first, RandomIt,
+                                                    const MappableTp& mappable, UnaryFunction f) const
+{
+    visit_overlapped(first, mappable, [&f] (RandomIt it) { f(*it); return true; });
+    return f;
+}
+
+// Only the overlapped elements are visited, so this is O(log n + k) even if the overlapped elements are far apart
+template <typename Position>
+template <typename RandomIt, typename MappableTp>
+MaterialisedRange<RandomIt>
+ImplicitIntervalTree<Position>::materialise_overlapped(RandomIt first, RandomIt last,
+                                                       const MappableTp& mappable) const
+{
+    using Difference = typename MaterialisedRange<RandomIt>::difference_type;
+    detail::CallRecorder recorder {Algorithm::materialise};
+    std::vector<Difference> offsets {};
+    auto offset_inserter = detail::recording_back_inserter(offsets, recorder);
+    visit_overlapped(first, mappable, [first, &offset_inserter, &recorder] (RandomIt it) {
+        recorder.scanned();
+        *offset_inserter++ = std::distance(first, it);
+        return true;
+    });
+    if (offsets.empty()) return MaterialisedRange<RandomIt> {last, last};
+    const auto result_first = std::next(first, offsets.front());
+    const auto result_last  = std::next(first, offsets.back() + 1);
+    const auto base_offset  = offsets.front();
+    for (auto& offset : offsets) offset -= base_offset;
+    return MaterialisedRange<RandomIt> {result_first, result_last, std::move(offsets)};
+}
+
+template <typename Position>
+template <typename RandomIt, typename Region>
+RandomIt
+ImplicitIntervalTree<Position>::search_overlapped(const void* index, const std::size_t index_size,
+                                                  const RandomIt first, const RandomIt it,
+                                                  const bool forward, const Region& region)
+{
+    const auto max_ends = static_cast<const Position*>(index);
+    const auto n = static_cast<size_type>(index_size);
+    const auto i = static_cast<size_type>(std::distance(first, it));
+    int level {0};
+    while ((size_type {2} << level) <= n) ++level;
+    const auto root = (size_type {1} << level) - 1;
+    const auto result = forward ? next_overlapped(max_ends, n, first, root, level, i, region)
+                                : prev_overlapped(max_ends, n, first, root, level, i, region);
+    return std::next(first, result);
+}
+
+// The subtree of the node at index with the given level spans [index + 1 - 2^level, index + 2^level)
+template <typename Position>
+template <typename RandomIt, typename MappableTp>
+typename ImplicitIntervalTree<Position>::size_type
+ImplicitIntervalTree<Position>::next_overlapped(const Position* max_ends, const size_type n, const RandomIt first,
+                                                const size_type index, const int level, const size_type from,
+                                                const MappableTp& mappable)
+{
+    const auto width = size_type {1} << level;
+    const auto i0 = index + 1 - width;
+    if (index + width <= from || i0 >= n) return n;
+    if (index < n && max_ends[index] < mapped_begin(mappable)) return n;
+    if (mapped_begin(first[std::max(i0, from)]) > mapped_end(mappable)) return n;
+    if (level == 0) return overlaps(first[index], mappable) ? index : n;
+    const auto half = width >> 1;
+    const auto left = next_overlapped(max_ends, n, first, index - half, level - 1, from, mappable);
+    if (left < n || index >= n) return left;
+    if (index >= from && overlaps(first[index], mappable)) return index;
+    return next_overlapped(max_ends, n, first, index + half, level - 1, from, mappable);
+}
+
+template <typename Position>
+template <typename RandomIt, typename MappableTp>
+typename ImplicitIntervalTree<Position>::size_type
+ImplicitIntervalTree<Position>::prev_overlapped(const Position* max_ends, const size_type n, const RandomIt first,
+                                                const size_type index, const int level, const size_type to,
+                                                const MappableTp& mappable)
+{
+    const auto width = size_type {1} << level;
+    const auto i0 = index + 1 - width;
+    if (i0 >= std::min(to, n)) return n;
+    if (index < n && max_ends[index] < mapped_begin(mappable)) return n;
+    if (mapped_begin(first[i0]) > mapped_end(mappable)) return n;
+    if (level == 0) return overlaps(first[index], mappable) ? index : n;
+    const auto half = width >> 1;
+    if (index < n) {
+        const auto right = prev_overlapped(max_ends, n, first, index + half, level - 1, to, mappable);
+        if (right < n) return right;
+        if (index < to && overlaps(first[index], mappable)) return index;
+    }
+    return prev_overlapped(max_ends, n, first, index - half, level - 1, to, mappable);
+}
+
+// The bounds of the range are the first and last overlapped elements, so finding the range is O(log n), but
+// iterating it tests every element between them
+template <typename Position>
+template <typename RandomIt, typename MappableTp>
+OverlapRange<RandomIt>
+ImplicitIntervalTree<Position>::overlap_range(RandomIt first, RandomIt last, const MappableTp& mappable) const
+{
+    const auto& region = mapped_region(mappable);
+    const auto result_first = search_overlapped(max_ends_.data(), size(), first, first, true, region);
+    if (result_first == last) return make_overlap_range(last, last, mappable);
+    const auto result_last = std::next(search_overlapped(max_ends_.data(), size(), first, last, false, region));
+    return make_overlap_range(result_first, result_last, mappable);
+}
+
+// Iterating the range searches the tree for the next overlapped element whenever it passes one that is not
+// overlapped, so finding and iterating the range is O(log n) per run of overlapped elements
+template <typename Position>
+template <typename RandomIt, typename MappableTp>
+IndexedOverlapRange<RandomIt>
+ImplicitIntervalTree<Position>::indexed_overlap_range(RandomIt first, RandomIt last,
+                                                      const MappableTp& mappable) const
+{
+    using Region = RegionType<typename std::iterator_traits<RandomIt>::value_type>;
+    return make_indexed_overlap_range(first, last, mappable, max_ends_.data(), size(),
+                                      &ImplicitIntervalTree::template search_overlapped<RandomIt, Region>);
+}
+
+} // namespace mappable
+
+#endif
@@ -0,0 +1,467 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef instrumentation_hpp
+#define instrumentation_hpp
+
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include "type_tricks.hpp"
+
+/**
+ Opt-in instrumentation of the algorithms and containers that are most sensitive to the shape of a query.
+
+ If MAPPABLE_INSTRUMENTATION is defined (configure with -DMAPPABLE_INSTRUMENTATION=ON), each instrumented
+ call adds to global per-Algorithm counters, which can be read at any time with algorithm_stats. Otherwise
+ the hooks are empty and the counters are always zero.
+
+ The counters are:
+    - calls: the number of calls.
+    - allocations and bytes_allocated: the allocations made by the call, for temporaries and results. These are
+      counted by an allocator adaptor, or for result containers by each change of capacity while they are
+      filled (a vector only allocates when its capacity changes). Results without a capacity, such as sets,
+      and allocations made by the elements themselves, such as GenomicRegion contig names, are not counted.
+    - elements_scanned: the elements tested by linear scans in the call. Elements tested later, when a
+      returned OverlapRange or ContainedRange is iterated, are not counted.
+    - comparisons: the calls of the comparators and predicates of the call, including binary searches.
+
+ Algorithms that call other instrumented algorithms are counted for each algorithm.
+ */
+
+namespace mappable {
+
+enum class Algorithm
+{
+    overlap_range,
+    count_overlapped,
+    copy_overlapped,
+    contained_range,
+    count_contained,
+    copy_contained,
+    extract_regions,
+    decompose,
+    segment,
+    calculate_positional_coverage,
+    calculate_coverage_runs,
+    select_regions,
+    materialise,
+    erase_overlapped,
+    erase_contained,
+    copy_nonoverlapped,
+    extract_covered_regions,
+    extract_intervening_regions
+};
+
+static constexpr std::size_t num_instrumented_algorithms {
+    static_cast<std::size_t>(Algorithm::extract_intervening_regions) + 1
+};
+
+struct AlgorithmStats
+{
+    std::uint64_t calls = 0, allocations = 0, bytes_allocated = 0, elements_scanned = 0, comparisons = 0;
+};
+
+namespace detail {
+
+#ifdef MAPPABLE_INSTRUMENTATION
+
+struct AtomicAlgorithmStats
+{
+    std::atomic<std::uint64_t> calls {0}, allocations {0}, bytes_allocated {0}, elements_scanned {0}, comparisons {0};
+};
+
+inline std::array<AtomicAlgorithmStats, num_instrumented_algorithms>& algorithm_stats_registry() noexcept
+{
+    static std::array<AtomicAlgorithmStats, num_instrumented_algorithms> result {};
+    return result;
+}
+
+inline AtomicAlgorithmStats& registered_stats(const Algorithm algorithm) noexcept
+{
+    return algorithm_stats_registry()[static_cast<std::size_t>(algorithm)];
+}
+
+/*
+ CallRecorder counts the work of one call of an instrumented algorithm, and adds it to the counters of the
+ algorithm when it is destroyed. The counts come from the wrappers below: comparators and predicates wrapped by
+ counting_compare and scanning_predicate, allocators made by recording_alloc, and result containers grown through
+ recording_back_inserter or checked with record_reallocation.
+
+ A default constructed CallRecorder counts but records nothing, for uninstrumented callers of helpers that take a
+ CallRecorder.
+ */
+class CallRecorder
+{
+public:
+    CallRecorder() = default;
+    explicit CallRecorder(const Algorithm algorithm) noexcept : stats_ {&registered_stats(algorithm)} {}
+    
+    CallRecorder(const CallRecorder&)            = delete;
+    CallRecorder& operator=(const CallRecorder&) = delete;
+    
+    ~CallRecorder()
+    {
+        if (stats_ == nullptr) return;
+        stats_->calls.fetch_add(1, std::memory_order_relaxed);
+        if (allocations_ > 0) {
+            stats_->allocations.fetch_add(allocations_, std::memory_order_relaxed);
+            stats_->bytes_allocated.fetch_add(bytes_allocated_, std::memory_order_relaxed);
+        }
+        if (elements_scanned_ > 0) stats_->elements_scanned.fetch_add(elements_scanned_, std::memory_order_relaxed);
+        if (comparisons_ > 0) stats_->comparisons.fetch_add(comparisons_, std::memory_order_relaxed);
+    }
+    
+    void scanned(const std::uint64_t n = 1) noexcept { elements_scanned_ += n; }
+    void compared(const std::uint64_t n = 1) noexcept { comparisons_ += n; }
+    void allocated(const std::uint64_t bytes) noexcept { ++allocations_; bytes_allocated_ += bytes; }
+    
+private:
+    AtomicAlgorithmStats* stats_ = nullptr;
+    std::uint64_t allocations_ = 0, bytes_allocated_ = 0, elements_scanned_ = 0, comparisons_ = 0;
+};
+
+template <typename Compare>
+class CountingCompare
+{
+public:
+    CountingCompare(Compare compare, CallRecorder& recorder) : compare_ {std::move(compare)}, recorder_ {&recorder} {}
+    
+    template <typename T, typename U>
+    bool operator()(const T& lhs, const U& rhs) const
+    {
+        recorder_->compared();
+        return compare_(lhs, rhs);
+    }
+    
+private:
+    Compare compare_;
+    CallRecorder* recorder_;
+};
+
+template <typename Predicate>
+class ScanningPredicate
+{
+public:
+    ScanningPredicate(Predicate pred, CallRecorder& recorder) : pred_ {std::move(pred)}, recorder_ {&recorder} {}
+    
+    template <typename T>
+    bool operator()(const T& value) const
+    {
+        recorder_->scanned();
+        recorder_->compared();
+        return pred_(value);
+    }
+    
+private:
+    Predicate pred_;
+    CallRecorder* recorder_;
+};
+
+// Wraps compare so that each call is counted as a comparison
+template <typename Compare>
+CountingCompare<Compare> counting_compare(Compare compare, CallRecorder& recorder)
+{
+    return CountingCompare<Compare> {std::move(compare), recorder};
+}
+
+// Wraps pred so that each call is counted as a scanned element and a comparison
+template <typename Predicate>
+ScanningPredicate<Predicate> scanning_predicate(Predicate pred, CallRecorder& recorder)
+{
+    return ScanningPredicate<Predicate> {std::move(pred), recorder};
+}
+
+// An allocator adaptor that records each allocation made with it
+template <typename Allocator>
+class CountingAllocator
+{
+    using Traits = std::allocator_traits<Allocator>;
+    
+public:
+    using value_type = typename Traits::value_type;
+    using pointer    = typename Traits::pointer;
+    using size_type  = typename Traits::size_type;
+    
+    template <typename U>
+    struct rebind { using other = CountingAllocator<RebindAlloc<Allocator, U>>; };
+    
+    CountingAllocator(const Allocator& alloc, CallRecorder& recorder) noexcept
+    : alloc_ (alloc), recorder_ {&recorder} {}
+    template <typename OtherAllocator>
+    CountingAllocator(const CountingAllocator<OtherAllocator>& other) noexcept
+    : alloc_ (other.base()), recorder_ {other.recorder()} {}
+    
+    pointer allocate(const size_type n)
+    {
+        const auto result = Traits::allocate(alloc_, n);
+        recorder_->allocated(n * sizeof(value_type));
+        return result;
+    }
+    
+    void deallocate(const pointer p, const size_type n) noexcept { Traits::deallocate(alloc_, p, n); }
+    
+    const Allocator& base() const noexcept { return alloc_; }
+    CallRecorder* recorder() const noexcept { return recorder_; }
+    
+private:
+    Allocator alloc_;
+    CallRecorder* recorder_;
+};
+
+template <typename Allocator1, typename Allocator2>
+bool operator==(const CountingAllocator<Allocator1>& lhs, const CountingAllocator<Allocator2>& rhs) noexcept
+{
+    return lhs.base() == rhs.base();
+}
+
+template <typename Allocator1, typename Allocator2>
+bool operator!=(const CountingAllocator<Allocator1>& lhs, const CountingAllocator<Allocator2>& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+// The allocator for temporary containers of T made from alloc, which records its allocations
+template <typename Allocator, typename T>
+using RecordingAlloc = CountingAllocator<RebindAlloc<Allocator, T>>;
+
+template <typename T, typename Allocator>
+RecordingAlloc<Allocator, T> recording_alloc(const Allocator& alloc, CallRecorder& recorder)
+{
+    return RecordingAlloc<Allocator, T> {rebind_alloc<T>(alloc), recorder};
+}
+
+template <typename C, typename = void>
+struct HasCapacity : std::false_type {};
+
+template <typename C>
+struct HasCapacity<C, decltype(std::declval<const C&>().capacity(), void())> : std::true_type {};
+
+template <typename Container>
+void record_reallocation(CallRecorder& recorder, const Container& container, const std::size_t prev_capacity,
+                         std::true_type) noexcept
+{
+    if (container.capacity() != prev_capacity && container.capacity() > 0) {
+        recorder.allocated(container.capacity() * sizeof(typename Container::value_type));
+    }
+}
+
+template <typename Container>
+void record_reallocation(CallRecorder&, const Container&, std::size_t, std::false_type) noexcept {}
+
+// Records an allocation of the new capacity of container if it differs from prev_capacity, as a vector only
+// allocates when its capacity changes
+template <typename Container>
+void record_reallocation(CallRecorder& recorder, const Container& container, const std::size_t prev_capacity) noexcept
+{
+    record_reallocation(recorder, container, prev_capacity, HasCapacity<Container> {});
+}
+
+// Records the allocation of a container that was empty before the call
+template <typename Container>
+void record_allocation(CallRecorder& recorder, const Container& container) noexcept
+{
+    record_reallocation(recorder, container, 0);
+}
+
+// A back insert iterator that records each reallocation of the container it appends to
+template <typename Container>
+class RecordingBackInsertIterator
+{
+public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type        = void;
+    using difference_type   = void;
+    using pointer           = void;
+    using reference         = void;
+    using container_type    = Container;
+    
+    RecordingBackInsertIterator(Container& container, CallRecorder& recorder) noexcept
+    : container_ {&container}, recorder_ {&recorder} {}
+    
+    RecordingBackInsertIterator& operator=(const typename Container::value_type& value)
+    {
+        const auto prev_capacity = container_->capacity();
+        container_->push_back(value);
+        record_reallocation(*recorder_, *container_, prev_capacity);
+        return *this;
+    }
+    
+    RecordingBackInsertIterator& operator=(typename Container::value_type&& value)
+    {
+        const auto prev_capacity = container_->capacity();
+        container_->push_back(std::move(value));
+        record_reallocation(*recorder_, *container_, prev_capacity);
+        return *this;
+    }
+    
+    RecordingBackInsertIterator& operator*() noexcept { return *this; }
+    RecordingBackInsertIterator& operator++() noexcept { return *this; }
+    RecordingBackInsertIterator& operator++(int) noexcept { return *this; }
+    
+private:
+    Container* container_;
+    CallRecorder* recorder_;
+};
+
+template <typename Container>
+RecordingBackInsertIterator<Container> recording_back_inserter(Container& container, CallRecorder& recorder) noexcept
+{
+    return RecordingBackInsertIterator<Container> {container, recorder};
+}
+
+#else
+
+// Without MAPPABLE_INSTRUMENTATION the recorder is empty and the wrappers return what they are given
+
+class CallRecorder
+{
+public:
+    CallRecorder() = default;
+    explicit CallRecorder(Algorithm) noexcept {}
+    
+    CallRecorder(const CallRecorder&)            = delete;
+    CallRecorder& operator=(const CallRecorder&) = delete;
+    
+    void scanned(std::uint64_t = 1) noexcept {}
+    void compared(std::uint64_t = 1) noexcept {}
+    void allocated(std::uint64_t) noexcept {}
+};
+
+template <typename Compare>
+Compare counting_compare(Compare compare, CallRecorder&) noexcept
+{
+    return compare;
+}
+
+template <typename Predicate>
+Predicate scanning_predicate(Predicate pred, CallRecorder&) noexcept
+{
+    return pred;
+}
+
+template <typename Allocator, typename T>
+using RecordingAlloc = RebindAlloc<Allocator, T>;
+
+template <typename T, typename Allocator>
+RecordingAlloc<Allocator, T> recording_alloc(const Allocator& alloc, CallRecorder&)
+{
+    return rebind_alloc<T>(alloc);
+}
+
+template <typename Container>
+void record_reallocation(CallRecorder&, const Container&, std::size_t) noexcept {}
+
+template <typename Container>
+void record_allocation(CallRecorder&, const Container&) noexcept {}
+
+template <typename Container>
+std::back_insert_iterator<Container> recording_back_inserter(Container& container, CallRecorder&) noexcept
+{
+    return std::back_inserter(container);
+}
+
+#endif // MAPPABLE_INSTRUMENTATION
+
+} // namespace detail
+
+constexpr bool is_instrumentation_enabled() noexcept
+{
+#ifdef MAPPABLE_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ Returns the counters of algorithm accumulated by all threads since the last reset_algorithm_stats.
+ */
+#ifdef MAPPABLE_INSTRUMENTATION
+inline AlgorithmStats algorithm_stats(const Algorithm algorithm) noexcept
+{
+    AlgorithmStats result {};
+    const auto& stats = detail::registered_stats(algorithm);
+    result.calls            = stats.calls.load(std::memory_order_relaxed);
+    result.allocations      = stats.allocations.load(std::memory_order_relaxed);
+    result.bytes_allocated  = stats.bytes_allocated.load(std::memory_order_relaxed);
+    result.elements_scanned = stats.elements_scanned.load(std::memory_order_relaxed);
+    result.comparisons      = stats.comparisons.load(std::memory_order_relaxed);
+    return result;
+}
+#else
+inline AlgorithmStats algorithm_stats(const Algorithm) noexcept
+{
+    return AlgorithmStats {};
+}
+#endif
+
+inline void reset_algorithm_stats() noexcept
+{
+#ifdef MAPPABLE_INSTRUMENTATION
+    for (auto& stats : detail::algorithm_stats_registry()) {
+        stats.calls            = 0;
+        stats.allocations      = 0;
+        stats.bytes_allocated  = 0;
+        stats.elements_scanned = 0;
+        stats.comparisons      = 0;
+    }
+#endif
+}
+
+inline const char* to_string(const Algorithm algorithm) noexcept
+{
+    switch (algorithm) {
+        case Algorithm::overlap_range: return "overlap_range";
+        case Algorithm::count_overlapped: return "count_overlapped";
+        case Algorithm::copy_overlapped: return "copy_overlapped";
+        case Algorithm::contained_range: return "contained_range";
+        case Algorithm::count_contained: return "count_contained";
+        case Algorithm::copy_contained: return "copy_contained";
+        case Algorithm::extract_regions: return "extract_regions";
+        case Algorithm::decompose: return "decompose";
+        case Algorithm::segment: return "segment";
+        case Algorithm::calculate_positional_coverage: return "calculate_positional_coverage";
+        case Algorithm::calculate_coverage_runs: return "calculate_coverage_runs";
+        case Algorithm::select_regions: return "select_regions";
+        case Algorithm::materialise: return "materialise";
+        case Algorithm::erase_overlapped: return "erase_overlapped";
+        case Algorithm::erase_contained: return "erase_contained";
+        case Algorithm::copy_nonoverlapped: return "copy_nonoverlapped";
+        case Algorithm::extract_covered_regions: return "extract_covered_regions";
+        case Algorithm::extract_intervening_regions: return "extract_intervening_regions";
+    }
+    return "unknown";
+}
+
+inline std::ostream& operator<<(std::ostream& os, const AlgorithmStats& stats)
+{
+    os << "calls=" << stats.calls << " allocations=" << stats.allocations
+       << " bytes_allocated=" << stats.bytes_allocated << " elements_scanned=" << stats.elements_scanned
+       << " comparisons=" << stats.comparisons;
+    return os;
+}
+
+/**
+ Writes the counters of every algorithm that has been called to os, one algorithm per line.
+ */
+inline std::ostream& print_algorithm_stats(std::ostream& os)
+{
+    for (std::size_t i {0}; i < num_instrumented_algorithms; ++i) {
+        const auto algorithm = static_cast<Algorithm>(i);
+        const auto stats = algorithm_stats(algorithm);
+        if (stats.calls > 0) os << to_string(algorithm) << ' ' << stats << '\n';
+    }
+    return os;
+}
+
+} // namespace mappable
+
+#endif
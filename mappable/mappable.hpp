@@ -153,7 +153,8 @@ auto is_position(const Mappable<T>& mappable) noexcept
 }
 
 template <typename T>
-decltype(auto) contig_name(const Mappable<T>& mappable) noexcept
+decltype(auto) contig_name(const Mappable<T>& mappable)
+    noexcept(noexcept(contig_name(static_cast<const T&>(mappable).mapped_region())))
 {
     return contig_name(static_cast<const T&>(mappable).mapped_region());
 }
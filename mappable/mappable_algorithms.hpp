@@ -11,6 +11,9 @@
 #include <stdexcept>
 #include <type_traits>
 #include <limits>
+#include <vector>
+#include <utility>
+#include <memory>
 
 #include <boost/iterator/filter_iterator.hpp>
 #include <boost/range/iterator_range_core.hpp>
@@ -19,7 +22,9 @@
 #include "genomic_region.hpp"
 #include "mappable.hpp"
 #include "mappable_range.hpp"
+#include "segmentation.hpp"
 #include "type_tricks.hpp"
+#include "instrumentation.hpp"
 
 /**
  Mappable algorithms are STL like algorithms that work on ranges of Mappable objects.
@@ -29,6 +34,12 @@
  
  Some of the algorithms have lower time complexities when the input range also meets the
  requirement of BidirectionallySorted.
+ 
+ Algorithms that return containers (extract_*_regions, decompose, segment_*_copy,
+ calculate_positional_coverage, calculate_coverage_runs, select_regions and join_if) have
+ allocator-extended overloads that take std::allocator_arg and an allocator as their leading
+ arguments. The allocator is rebound for every container the algorithm allocates, including
+ temporaries, so a stateful arena allocator can back all the allocations of a computation.
  */
 
 namespace mappable {
@@ -368,6 +379,23 @@ auto extract_bidirectionally_sorted_ranges(const Range& mappables)
 
 // find_first_after
 
+namespace detail {
+
+template <typename ForwardIt, typename MappableTp>
+ForwardIt find_first_after(ForwardIt first, ForwardIt last, const MappableTp& mappable, CallRecorder& recorder)
+{
+    if (mapped_end(mappable) == std::numeric_limits<typename RegionType<MappableTp>::Size>::max()) {
+        return last;
+    }
+    auto itr = std::lower_bound(first, last, next_mapped_position(mappable),
+                                counting_compare(std::less<> {}, recorder));
+    return std::find_if_not(itr, last, scanning_predicate([&mappable] (const auto& m) {
+        return overlaps(m, mappable);
+    }, recorder));
+}
+
+} // namespace detail
+
 /**
  Returns the first element in the range [first, last) that is_after mappable.
  
@@ -379,11 +407,8 @@ ForwardIt find_first_after(ForwardIt first, ForwardIt last, const MappableTp& ma
     using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
                   "Mappable required");
-    if (mapped_end(mappable) == std::numeric_limits<typename RegionType<MappableTp>::Size>::max()) {
-        return last;
-    }
-    auto itr = std::lower_bound(first, last, next_mapped_position(mappable));
-    return std::find_if_not(itr, last, [&mappable] (const auto& m) { return overlaps(m, mappable); });
+    detail::CallRecorder recorder {};
+    return detail::find_first_after(first, last, mappable, recorder);
 }
 
 template <typename Range, typename MappableTp>
@@ -424,7 +449,8 @@ OverlapRange<BidirIt> overlap_range(BidirIt first, BidirIt last, const MappableT
     using MappableTp2 = typename std::iterator_traits<BidirIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
                   "Mappable required");
-    const auto it = find_first_after(first, last, mappable);
+    detail::CallRecorder recorder {Algorithm::overlap_range};
+    const auto it = detail::find_first_after(first, last, mappable, recorder);
     // We must do a linear search for the first overlapped as the end positions may not be sorted.
     // Consider find the overlap range of M:
     //
@@ -433,7 +459,9 @@ OverlapRange<BidirIt> overlap_range(BidirIt first, BidirIt last, const MappableT
     //             [--M--)
     //
     // Here std::lower_bound (comparing mapped_begin) will return B and miss A.
-    const auto it2 = std::find_if(first, it, [&mappable] (const auto& m) { return overlaps(m, mappable); });
+    const auto it2 = std::find_if(first, it, detail::scanning_predicate([&mappable] (const auto& m) {
+        return overlaps(m, mappable);
+    }, recorder));
     return make_overlap_range(it2, it, mappable);
 }
 
@@ -444,21 +472,19 @@ OverlapRange<BidirIt> overlap_range(BidirIt first, BidirIt last, const MappableT
     using MappableTp2 = typename std::iterator_traits<BidirIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
                   "Mappable required");
+    detail::CallRecorder recorder {Algorithm::overlap_range};
     auto overlapped = std::equal_range(first, last, mappable,
-                                       [] (const auto& lhs, const auto& rhs) {
+                                       detail::counting_compare([] (const auto& lhs, const auto& rhs) {
                                            return is_before(lhs, rhs);
-                                       });
+                                       }, recorder));
     // We need to try and push these boundaries out as the range does not fully capture
     // insertions
+    const auto is_overlapped = detail::scanning_predicate([&mappable] (const auto& m) {
+        return overlaps(m, mappable);
+    }, recorder);
     overlapped.first = std::find_if_not(std::make_reverse_iterator(overlapped.first),
-                                        std::make_reverse_iterator(first),
-                                        [&mappable] (const auto& m) {
-                                            return overlaps(m, mappable);
-                                        }).base();
-    overlapped.second = std::find_if_not(overlapped.second, last,
-                                         [&mappable] (const auto& m) {
-                                             return overlaps(m, mappable);
-                                         });
+                                        std::make_reverse_iterator(first), is_overlapped).base();
+    overlapped.second = std::find_if_not(overlapped.second, last, is_overlapped);
     return make_overlap_range(overlapped.first, overlapped.second, mappable);
 }
 
@@ -477,18 +503,76 @@ overlap_range(ForwardIt first, ForwardIt last, const MappableTp& mappable,
     using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
                   "Mappable required");
-    const auto it1 = find_first_after(first, last, mappable);
+    detail::CallRecorder recorder {Algorithm::overlap_range};
+    const auto it1 = detail::find_first_after(first, last, mappable, recorder);
     const auto leftmost = shift(mapped_region(mappable), -std::min(mapped_begin(mappable), max_mappable_size));
     auto it2 = std::lower_bound(first, it1, leftmost,
-                                [] (const auto& lhs, const auto& rhs) {
+                                detail::counting_compare([] (const auto& lhs, const auto& rhs) {
                                     return begins_before(lhs, rhs);
-                                });
-    it2 = std::find_if(it2, it1, [&mappable] (const auto& m) { return overlaps(m, mappable); });
+                                }, recorder));
+    it2 = std::find_if(it2, it1, detail::scanning_predicate([&mappable] (const auto& m) {
+        return overlaps(m, mappable);
+    }, recorder));
     return make_overlap_range(it2, it1, mappable);
 }
 
 namespace detail {
 
+inline void check_same_contig(const ContigRegion&, const ContigRegion&) noexcept {}
+
+inline void check_same_contig(const GenomicRegion& lhs, const GenomicRegion& rhs)
+{
+    if (!is_same_contig(lhs, rhs)) throw BadRegionCompare {to_string(lhs), to_string(rhs)};
+}
+
+// When every element has the same size the begins and ends are both sorted, so the exact bounds of the
+// overlapped elements can be found with two binary searches and no boundary scans. The range must lie on a
+// single contig, as for the other searches. The searches only compare positions, so each compared element's
+// contig is checked, and a range spanning contigs throws BadRegionCompare like the comparisons elsewhere.
+template <typename ForwardIt, typename MappableTp>
+std::pair<ForwardIt, ForwardIt>
+fixed_size_overlap_bounds(ForwardIt first, ForwardIt last, const MappableTp& mappable, CallRecorder& recorder)
+{
+    if (first == last) return {last, last};
+    // Empty regions overlap regions they are adjacent to
+    const bool inclusive {is_empty_region(*first) || is_empty_region(mappable)};
+    const auto it1 = std::lower_bound(first, last, mappable,
+                                      counting_compare([inclusive] (const auto& lhs, const auto& rhs) {
+                                          check_same_contig(mapped_region(lhs), mapped_region(rhs));
+                                          return inclusive ? mapped_end(lhs) < mapped_begin(rhs)
+                                                           : mapped_end(lhs) <= mapped_begin(rhs);
+                                      }, recorder));
+    const auto it2 = std::lower_bound(it1, last, mappable,
+                                      counting_compare([inclusive] (const auto& lhs, const auto& rhs) {
+                                          check_same_contig(mapped_region(lhs), mapped_region(rhs));
+                                          return inclusive ? mapped_begin(lhs) <= mapped_end(rhs)
+                                                           : mapped_begin(lhs) < mapped_end(rhs);
+                                      }, recorder));
+    return {it1, it2};
+}
+
+} // namespace detail
+
+/**
+ Returns an OverlapRange of the range [first, last) whose base iterators bound exactly the overlapped
+ elements, so size(range, FixedSizeTag {}) is constant time for random access iterators.
+ 
+ Requires the range [first, last) is FixedSize and lies on a single contig, otherwise BadRegionCompare is thrown.
+ */
+template <typename ForwardIt, typename MappableTp>
+OverlapRange<ForwardIt>
+overlap_range(ForwardIt first, ForwardIt last, const MappableTp& mappable, FixedSizeTag)
+{
+    using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
+                  "Mappable required");
+    detail::CallRecorder recorder {Algorithm::overlap_range};
+    const auto overlapped = detail::fixed_size_overlap_bounds(first, last, mappable, recorder);
+    return make_overlap_range(overlapped.first, overlapped.second, mappable);
+}
+
+namespace detail {
+
 template <typename C, typename T, typename = void>
 struct HasMemberOverlapRange : std::false_type {};
 
@@ -562,41 +646,136 @@ overlap_range(Range& mappables, const MappableTp& mappable,
                          BidirectionallySortedTag {});
 }
 
+template <typename Range, typename MappableTp>
+OverlapRange<typename Range::const_iterator>
+overlap_range(const Range& mappables, const MappableTp& mappable, FixedSizeTag)
+{
+    return overlap_range(std::cbegin(mappables), std::cend(mappables), mappable, FixedSizeTag {});
+}
+
 // copy_overlapped
 
+namespace detail {
+
+// The number of elements in range, testing each element after the first once
+template <typename Predicate, typename Iterator>
+std::size_t count_filtered(const boost::iterator_range<boost::filter_iterator<Predicate, Iterator>>& range,
+                           CallRecorder& recorder)
+{
+    if (range.empty()) return 0;
+    return 1 + std::count_if(std::next(range.begin().base()), range.end().base(),
+                             scanning_predicate(range.begin().predicate(), recorder));
+}
+
+// range with the predicate tests made while iterating it counted as scanned elements
+template <typename Predicate, typename Iterator>
+auto scanned_range(const boost::iterator_range<boost::filter_iterator<Predicate, Iterator>>& range,
+                   CallRecorder& recorder)
+{
+    const auto pred = scanning_predicate(range.begin().predicate(), recorder);
+    const auto last = range.end().base();
+    return boost::make_iterator_range(boost::make_filter_iterator(pred, range.begin().base(), last),
+                                      boost::make_filter_iterator(pred, last, last));
+}
+
+template <typename Range, typename FilteredRange>
+Range copy_filtered(const FilteredRange& filtered, CallRecorder& recorder)
+{
+    const auto scanned = scanned_range(filtered, recorder);
+    Range result {std::cbegin(scanned), std::cend(scanned)};
+    record_allocation(recorder, result);
+    return result;
+}
+
+} // namespace detail
+
 template <typename Range, typename MappableTp>
 Range copy_overlapped(const Range& mappables, const MappableTp& mappable)
 {
-    const auto overlapped = overlap_range(mappables, mappable);
-    return Range {std::cbegin(overlapped), std::cend(overlapped)};
+    detail::CallRecorder recorder {Algorithm::copy_overlapped};
+    return detail::copy_filtered<Range>(overlap_range(mappables, mappable), recorder);
 }
 
 template <typename Range, typename MappableTp>
 Range copy_overlapped(const Range& mappables, const MappableTp& mappable,
                       BidirectionallySortedTag)
 {
-    const auto overlapped = overlap_range(mappables, mappable, BidirectionallySortedTag {});
-    return Range {std::cbegin(overlapped), std::cend(overlapped)};
+    detail::CallRecorder recorder {Algorithm::copy_overlapped};
+    return detail::copy_filtered<Range>(overlap_range(mappables, mappable, BidirectionallySortedTag {}), recorder);
 }
 
 template <typename Range, typename MappableTp>
 Range copy_overlapped(const Range& mappables, const MappableTp& mappable,
                       const typename RegionType<MappableTp>::Position max_mappable_size)
 {
-    const auto overlapped = overlap_range(mappables, mappable, max_mappable_size);
-    return Range {std::cbegin(overlapped), std::cend(overlapped)};
+    detail::CallRecorder recorder {Algorithm::copy_overlapped};
+    return detail::copy_filtered<Range>(overlap_range(mappables, mappable, max_mappable_size), recorder);
+}
+
+/**
+ Copies the elements in the range [first, last) that overlap with mappable to result.
+
+ Requires the range [first, last) is ForwardSorted.
+ */
+template <typename BidirIt, typename MappableTp, typename OutputIt>
+OutputIt copy_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable, OutputIt result)
+{
+    detail::CallRecorder recorder {Algorithm::copy_overlapped};
+    const auto overlapped = detail::scanned_range(overlap_range(first, last, mappable), recorder);
+    return std::copy(std::cbegin(overlapped), std::cend(overlapped), result);
+}
+
+/**
+ Replaces the contents of result with the elements of mappables that overlap with mappable.
+
+ The capacity of result is retained so repeated calls with the same buffer do not allocate once it is
+ large enough.
+ */
+template <typename Range, typename MappableTp, typename Allocator>
+void copy_overlapped(const Range& mappables, const MappableTp& mappable,
+                     std::vector<typename Range::value_type, Allocator>& result)
+{
+    detail::CallRecorder recorder {Algorithm::copy_overlapped};
+    const auto prev_capacity = result.capacity();
+    result.clear();
+    const auto overlapped = detail::scanned_range(overlap_range(mappables, mappable), recorder);
+    result.insert(std::cend(result), std::cbegin(overlapped), std::cend(overlapped));
+    detail::record_reallocation(recorder, result, prev_capacity);
 }
 
 // copy_nonoverlapped
 
+namespace detail {
+
+template <typename BidirIt, typename MappableTp, typename OutputIt>
+OutputIt copy_nonoverlapped(BidirIt first, BidirIt last, const MappableTp& mappable, OutputIt result,
+                            CallRecorder& recorder)
+{
+    const auto overlapped = bases(overlap_range(first, last, mappable));
+    result = std::copy(first, std::begin(overlapped), result);
+    result = std::remove_copy_if(std::begin(overlapped), std::end(overlapped), result,
+                                 scanning_predicate([&mappable] (const auto& m) {
+                                     return overlaps(m, mappable);
+                                 }, recorder));
+    return std::copy(std::end(overlapped), last, result);
+}
+
+} // namespace detail
+
 template <typename Container, typename MappableTp>
 Container copy_nonoverlapped(const Container& mappables, const MappableTp& mappable)
 {
     using std::cbegin; using std::cend;
+    detail::CallRecorder recorder {Algorithm::copy_nonoverlapped};
     const auto num_overlapped = count_overlapped(mappables, mappable);
-    if (num_overlapped == 0) return mappables;
+    if (num_overlapped == 0) {
+        Container result {mappables};
+        detail::record_allocation(recorder, result);
+        return result;
+    }
     Container result {};
     result.reserve(mappables.size() - num_overlapped);
+    detail::record_allocation(recorder, result);
     auto overlapped = overlap_range(mappables, mappable);
     auto base_begin = cbegin(overlapped).base();
     auto base_end   = cend(overlapped).base();
@@ -613,6 +792,33 @@ Container copy_nonoverlapped(const Container& mappables, const MappableTp& mappa
     return result;
 }
 
+/**
+ Copies the elements in the range [first, last) that do not overlap with mappable to result.
+
+ Requires the range [first, last) is ForwardSorted.
+ */
+template <typename BidirIt, typename MappableTp, typename OutputIt>
+OutputIt copy_nonoverlapped(BidirIt first, BidirIt last, const MappableTp& mappable, OutputIt result)
+{
+    detail::CallRecorder recorder {Algorithm::copy_nonoverlapped};
+    return detail::copy_nonoverlapped(first, last, mappable, result, recorder);
+}
+
+/**
+ Replaces the contents of result with the elements of mappables that do not overlap with mappable.
+
+ The capacity of result is retained.
+ */
+template <typename Range, typename MappableTp, typename Allocator>
+void copy_nonoverlapped(const Range& mappables, const MappableTp& mappable,
+                        std::vector<typename Range::value_type, Allocator>& result)
+{
+    detail::CallRecorder recorder {Algorithm::copy_nonoverlapped};
+    result.clear();
+    detail::copy_nonoverlapped(std::cbegin(mappables), std::cend(mappables), mappable,
+                               detail::recording_back_inserter(result, recorder), recorder);
+}
+
 // has_overlapped
 
 /**
@@ -650,6 +856,17 @@ bool has_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable,
                               [] (const auto& lhs, const auto& rhs) { return is_before(lhs, rhs); });
 }
 
+template <typename ForwardIt, typename MappableTp>
+bool has_overlapped(ForwardIt first, ForwardIt last, const MappableTp& mappable, FixedSizeTag)
+{
+    using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
+                  "Mappable required");
+    detail::CallRecorder recorder {};
+    const auto overlapped = detail::fixed_size_overlap_bounds(first, last, mappable, recorder);
+    return overlapped.first != overlapped.second;
+}
+
 template <typename BidirIt, typename MappableTp>
 bool has_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable,
                     const typename RegionType<MappableTp>::Position max_mappable_size)
@@ -744,8 +961,8 @@ std::size_t count_overlapped(ForwardIt first, ForwardIt last, const MappableTp&
     using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
                   "Mappable required");
-    const auto overlapped = overlap_range(first, last, mappable);
-    return size(overlapped, ForwardSortedTag {});
+    detail::CallRecorder recorder {Algorithm::count_overlapped};
+    return detail::count_filtered(overlap_range(first, last, mappable), recorder);
 }
 
 template <typename ForwardIt, typename MappableTp>
@@ -755,10 +972,28 @@ std::size_t count_overlapped(ForwardIt first, ForwardIt last, const MappableTp&
     using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
                   "Mappable required");
+    detail::CallRecorder recorder {Algorithm::count_overlapped};
     const auto overlapped = overlap_range(first, last, mappable, BidirectionallySortedTag {});
     return size(overlapped, BidirectionallySortedTag {});
 }
 
+/**
+ Returns the number of mappable elements in the range [first, last) that overlap with mappable.
+ 
+ Requires the range [first, last) is FixedSize and lies on a single contig, otherwise BadRegionCompare is thrown.
+ */
+template <typename ForwardIt, typename MappableTp>
+std::size_t count_overlapped(ForwardIt first, ForwardIt last, const MappableTp& mappable,
+                             FixedSizeTag)
+{
+    using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
+                  "Mappable required");
+    detail::CallRecorder recorder {Algorithm::count_overlapped};
+    const auto overlapped = detail::fixed_size_overlap_bounds(first, last, mappable, recorder);
+    return static_cast<std::size_t>(std::distance(overlapped.first, overlapped.second));
+}
+
 /**
  Returns the number of mappable elements in the range [first, last) that overlap with mappable.
  
@@ -771,8 +1006,8 @@ std::size_t count_overlapped(ForwardIt first, ForwardIt last, const MappableTp&
     using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
                   "Mappable required");
-    const auto overlapped = overlap_range(first, last, mappable, max_mappable_size);
-    return std::distance(std::cbegin(overlapped), std::cend(overlapped));
+    detail::CallRecorder recorder {Algorithm::count_overlapped};
+    return detail::count_filtered(overlap_range(first, last, mappable, max_mappable_size), recorder);
 }
 
 template <typename ForwardIt, typename MappableTp>
@@ -837,159 +1072,577 @@ auto count_overlapped(const Range& mappables, const MappableTp& mappable,
                                   detail::HasMemberCountOverlapped<Range, MappableTp> {});
 }
 
-// max/min_overlapped
-
-// Returns an iterator to element in range with the max/min overlap_size with the given Mappable
+// overlap_ranges
 
 namespace detail {
 
-template <typename MappableTp1>
-struct OverlapSizeLess
-{
-    template <typename MappableTp2>
-    bool operator()(const MappableTp2& lhs, const MappableTp2& rhs) const
-    {
-        return overlap_size(mappable, lhs) < overlap_size(mappable, rhs);
+// Exponential search from first followed by a binary search, so the cost is logarithmic in
+// the distance from first to the result rather than in the size of [first, last).
+template <typename ForwardIt, typename T, typename Compare>
+ForwardIt gallop_lower_bound(ForwardIt first, const ForwardIt last, const T& value, Compare cmp)
+{
+    auto remaining = std::distance(first, last);
+    decltype(remaining) step {1};
+    while (step < remaining) {
+        const auto probe = std::next(first, step - 1);
+        if (!cmp(*probe, value)) {
+            return std::lower_bound(first, std::next(probe), value, cmp);
+        }
+        first = std::next(probe);
+        remaining -= step;
+        step *= 2;
     }
-    OverlapSizeLess(const MappableTp1& mappable) : mappable {mappable} {}
-    const MappableTp1& mappable;
-};
-
-template <typename BidirIt, typename MappableTp>
-auto max_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable)
-{
-    return std::max_element(first, last, OverlapSizeLess<MappableTp> {mappable});
+    return std::lower_bound(first, last, value, cmp);
 }
 
-template <typename BidirIt, typename MappableTp>
-auto min_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable)
+template <typename ForwardIt, typename MappableTp>
+ForwardIt gallop_find_first_after(ForwardIt first, ForwardIt last, const MappableTp& mappable)
 {
-    return std::min_element(first, last, OverlapSizeLess<MappableTp> {mappable});
+    if (mapped_end(mappable) == std::numeric_limits<typename RegionType<MappableTp>::Size>::max()) {
+        return last;
+    }
+    const auto it = gallop_lower_bound(first, last, next_mapped_position(mappable),
+                                       [] (const auto& lhs, const auto& rhs) { return lhs < rhs; });
+    return std::find_if_not(it, last, [&mappable] (const auto& m) { return overlaps(m, mappable); });
 }
 
-} // namespace detail
+// Each sweep_overlap_range overload returns the OverlapRange of mappable in [first, last), searching
+// from hint, and then advances hint so it remains valid for any later mappable in sorted order. Only the
+// BidirectionallySorted overload searches back from hint, so the others never need first.
 
 template <typename BidirIt, typename MappableTp>
-auto max_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable, ForwardSortedTag)
+OverlapRange<BidirIt>
+sweep_overlap_range(BidirIt, BidirIt& hint, BidirIt last, const MappableTp& mappable,
+                    ForwardSortedTag)
 {
-    const auto overlapped = overlap_range(first, last, mappable, ForwardSortedTag {});
-    return detail::max_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable).base();
+    // Elements ending before mappable begins cannot overlap any later mappable either
+    hint = std::find_if(hint, last, [&mappable] (const auto& m) { return mapped_end(m) >= mapped_begin(mappable); });
+    const auto it1 = gallop_find_first_after(hint, last, mappable);
+    const auto it2 = std::find_if(hint, it1, [&mappable] (const auto& m) { return overlaps(m, mappable); });
+    return make_overlap_range(it2, it1, mappable);
 }
 
 template <typename BidirIt, typename MappableTp>
-auto max_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable, BidirectionallySortedTag)
+OverlapRange<BidirIt>
+sweep_overlap_range(BidirIt first, BidirIt& hint, BidirIt last, const MappableTp& mappable,
+                    BidirectionallySortedTag)
 {
-    const auto overlapped = bases(overlap_range(first, last, mappable, BidirectionallySortedTag {}));
-    return detail::max_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable);
+    hint = gallop_lower_bound(hint, last, mappable,
+                              [] (const auto& lhs, const auto& rhs) { return is_before(lhs, rhs); });
+    auto it1 = gallop_lower_bound(hint, last, mappable,
+                                  [] (const auto& lhs, const auto& rhs) { return !is_before(rhs, lhs); });
+    // Push the boundaries out to capture insertions, as in overlap_range
+    const auto it2 = std::find_if_not(std::make_reverse_iterator(hint), std::make_reverse_iterator(first),
+                                      [&mappable] (const auto& m) { return overlaps(m, mappable); }).base();
+    it1 = std::find_if_not(it1, last, [&mappable] (const auto& m) { return overlaps(m, mappable); });
+    return make_overlap_range(it2, it1, mappable);
 }
 
 template <typename BidirIt, typename MappableTp>
-auto max_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable,
+OverlapRange<BidirIt>
+sweep_overlap_range(BidirIt, BidirIt& hint, BidirIt last, const MappableTp& mappable,
                     const typename RegionType<MappableTp>::Position max_mappable_size)
 {
-    const auto overlapped = overlap_range(first, last, mappable, max_mappable_size);
-    return detail::max_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable).base();
+    const auto leftmost = shift(mapped_region(mappable), -std::min(mapped_begin(mappable), max_mappable_size));
+    hint = gallop_lower_bound(hint, last, leftmost,
+                              [] (const auto& lhs, const auto& rhs) { return begins_before(lhs, rhs); });
+    const auto it1 = gallop_find_first_after(hint, last, mappable);
+    const auto it2 = std::find_if(hint, it1, [&mappable] (const auto& m) { return overlaps(m, mappable); });
+    return make_overlap_range(it2, it1, mappable);
 }
 
-template <typename BidirIt, typename MappableTp>
-auto max_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable)
+template <typename BidirIt, typename InputIt, typename OrderInfo, typename UnaryFunction>
+void for_each_overlap_range(BidirIt first, BidirIt last, InputIt first_query, InputIt last_query,
+                            OrderInfo order, UnaryFunction f)
 {
-    return max_overlapped(first, last, mappable, ForwardSortedTag {});
+    using MappableTp = typename std::iterator_traits<BidirIt>::value_type;
+    using QueryTp = typename std::iterator_traits<InputIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<QueryTp>,
+                  "Mappable required");
+    auto hint = first;
+    std::for_each(first_query, last_query, [&] (const auto& query) {
+        f(sweep_overlap_range(first, hint, last, query, order));
+    });
 }
 
-template <typename Range, typename MappableTp>
-auto max_overlapped(const Range& range, const MappableTp& mappable)
+} // namespace detail
+
+/**
+ Returns the OverlapRange of [first, last) for each mappable in [first_query, last_query), in query order.
+ 
+ Requires [first, last) is ForwardSorted and [first_query, last_query) is sorted. Each search starts
+ where the previous one finished (using a galloping search), so the whole batch is answered in a single
+ sweep of [first, last) rather than with a binary search of the full range per query.
+ */
+template <typename BidirIt, typename InputIt>
+std::vector<OverlapRange<BidirIt>>
+overlap_ranges(BidirIt first, BidirIt last, InputIt first_query, InputIt last_query, ForwardSortedTag)
 {
-    const auto overlapped = overlap_range(range, mappable);
-    return detail::max_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable).base();
+    std::vector<OverlapRange<BidirIt>> result {};
+    detail::for_each_overlap_range(first, last, first_query, last_query, ForwardSortedTag {},
+                                   [&result] (auto&& overlapped) { result.push_back(std::move(overlapped)); });
+    return result;
 }
 
-template <typename BidirIt, typename MappableTp>
-auto min_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable, ForwardSortedTag)
+template <typename BidirIt, typename InputIt>
+std::vector<OverlapRange<BidirIt>>
+overlap_ranges(BidirIt first, BidirIt last, InputIt first_query, InputIt last_query, BidirectionallySortedTag)
 {
-    const auto overlapped = overlap_range(first, last, mappable, ForwardSortedTag {});
-    return detail::min_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable).base();
+    std::vector<OverlapRange<BidirIt>> result {};
+    detail::for_each_overlap_range(first, last, first_query, last_query, BidirectionallySortedTag {},
+                                   [&result] (auto&& overlapped) { result.push_back(std::move(overlapped)); });
+    return result;
 }
 
-template <typename BidirIt, typename MappableTp>
-auto min_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable, BidirectionallySortedTag)
-{
-    const auto overlapped = bases(overlap_range(first, last, mappable, BidirectionallySortedTag {}));
-    return detail::min_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable);
+// Faster version if the max mappable size in [first, last) is known
+template <typename BidirIt, typename InputIt>
+std::vector<OverlapRange<BidirIt>>
+overlap_ranges(BidirIt first, BidirIt last, InputIt first_query, InputIt last_query,
+               const typename RegionType<typename std::iterator_traits<InputIt>::value_type>::Position max_mappable_size)
+{
+    std::vector<OverlapRange<BidirIt>> result {};
+    detail::for_each_overlap_range(first, last, first_query, last_query, max_mappable_size,
+                                   [&result] (auto&& overlapped) { result.push_back(std::move(overlapped)); });
+    return result;
 }
 
-template <typename BidirIt, typename MappableTp>
-auto min_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable,
-                    const typename RegionType<MappableTp>::Position max_mappable_size)
+template <typename BidirIt, typename InputIt>
+auto overlap_ranges(BidirIt first, BidirIt last, InputIt first_query, InputIt last_query)
 {
-    const auto overlapped = overlap_range(first, last, mappable, max_mappable_size);
-    return detail::min_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable).base();
+    return overlap_ranges(first, last, first_query, last_query, ForwardSortedTag {});
 }
 
-template <typename BidirIt, typename MappableTp>
-auto min_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable)
+/**
+ Returns the number of elements in [first, last) overlapping each mappable in [first_query, last_query).
+ 
+ Requires [first, last) is ForwardSorted and [first_query, last_query) is sorted.
+ */
+template <typename BidirIt, typename InputIt>
+std::vector<std::size_t>
+count_overlapped_each(BidirIt first, BidirIt last, InputIt first_query, InputIt last_query, ForwardSortedTag)
+{
+    std::vector<std::size_t> result {};
+    detail::for_each_overlap_range(first, last, first_query, last_query, ForwardSortedTag {},
+                                   [&result] (const auto& overlapped) {
+                                       result.push_back(size(overlapped, ForwardSortedTag {}));
+                                   });
+    return result;
+}
+
+template <typename BidirIt, typename InputIt>
+std::vector<std::size_t>
+count_overlapped_each(BidirIt first, BidirIt last, InputIt first_query, InputIt last_query,
+                      BidirectionallySortedTag)
 {
-    return min_overlapped(first, last, mappable, ForwardSortedTag {});
+    std::vector<std::size_t> result {};
+    detail::for_each_overlap_range(first, last, first_query, last_query, BidirectionallySortedTag {},
+                                   [&result] (const auto& overlapped) {
+                                       result.push_back(size(overlapped, BidirectionallySortedTag {}));
+                                   });
+    return result;
 }
 
-template <typename Range, typename MappableTp>
-auto min_overlapped(const Range& range, const MappableTp& mappable)
+template <typename BidirIt, typename InputIt>
+std::vector<std::size_t>
+count_overlapped_each(BidirIt first, BidirIt last, InputIt first_query, InputIt last_query,
+                      const typename RegionType<typename std::iterator_traits<InputIt>::value_type>::Position max_mappable_size)
 {
-    const auto overlapped = overlap_range(range, mappable);
-    return detail::min_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable).base();
+    std::vector<std::size_t> result {};
+    detail::for_each_overlap_range(first, last, first_query, last_query, max_mappable_size,
+                                   [&result] (const auto& overlapped) {
+                                       result.push_back(size(overlapped, ForwardSortedTag {}));
+                                   });
+    return result;
 }
 
-// has_exact_overlap
+template <typename BidirIt, typename InputIt>
+auto count_overlapped_each(BidirIt first, BidirIt last, InputIt first_query, InputIt last_query)
+{
+    return count_overlapped_each(first, last, first_query, last_query, ForwardSortedTag {});
+}
 
 /**
- Returns true if the range [first, last) has an element with the region of mappable
+ Returns true for each mappable in [first_query, last_query) that overlaps any element in [first, last).
  
- Requires the range [first, last) is ForwardSorted.
+ Requires [first, last) is ForwardSorted and [first_query, last_query) is sorted.
  */
-template <typename ForwardIt, typename MappableTp>
-bool has_exact_overlap(ForwardIt first, ForwardIt last, const MappableTp& mappable,
-                       ForwardSortedTag)
+template <typename BidirIt, typename InputIt, typename OrderTag>
+std::vector<bool>
+has_overlapped_each(BidirIt first, BidirIt last, InputIt first_query, InputIt last_query, OrderTag order)
 {
-    using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
-    static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
-                  "Mappable required");
-    const auto overlapped = overlap_range(first, last, mappable);
-    return std::find_if(std::cbegin(overlapped), std::cend(overlapped),
-                        [&mappable] (const auto& e) {
-                            return is_same_region(mappable, e);
-                        }) != std::cend(overlapped);
+    std::vector<bool> result {};
+    detail::for_each_overlap_range(first, last, first_query, last_query, order,
+                                   [&result] (const auto& overlapped) { result.push_back(!overlapped.empty()); });
+    return result;
 }
 
-template <typename ForwardIt, typename MappableTp>
-bool has_exact_overlap(ForwardIt first, ForwardIt last, const MappableTp& mappable,
-                       BidirectionallySortedTag)
+template <typename BidirIt, typename InputIt>
+auto has_overlapped_each(BidirIt first, BidirIt last, InputIt first_query, InputIt last_query)
 {
-    using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
-    static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
-                  "Mappable required");
-    return std::binary_search(first, last, mappable);
+    return has_overlapped_each(first, last, first_query, last_query, ForwardSortedTag {});
 }
 
-template <typename ForwardIt, typename MappableTp>
-bool has_exact_overlap(ForwardIt first, ForwardIt last, const MappableTp& mappable)
+namespace detail {
+
+template <typename C, typename = void>
+struct HasMemberBidirectionallySorted : std::false_type {};
+
+template <typename C>
+struct HasMemberBidirectionallySorted<C, std::enable_if_t<
+std::is_same<decltype(std::declval<C>().bidirectionally_sorted()), bool>::value>>
+: std::true_type {};
+
+template <typename Container, typename InputIt>
+auto overlap_ranges(const Container& mappables, InputIt first_query, InputIt last_query, std::true_type)
 {
-    return has_exact_overlap(first, last, mappable, ForwardSortedTag {});
+    if (mappables.bidirectionally_sorted()) {
+        return mappable::overlap_ranges(std::cbegin(mappables), std::cend(mappables), first_query, last_query,
+                                        BidirectionallySortedTag {});
+    }
+    return mappable::overlap_ranges(std::cbegin(mappables), std::cend(mappables), first_query, last_query,
+                                    mappables.max_element_size());
 }
 
-template <typename Range, typename MappableTp>
-bool has_exact_overlap(const Range& mappables, const MappableTp& mappable,
-                       ForwardSortedTag)
+template <typename Range, typename InputIt>
+auto overlap_ranges(const Range& mappables, InputIt first_query, InputIt last_query, std::false_type)
 {
-    return has_exact_overlap(std::cbegin(mappables), std::cend(mappables), mappable,
-                             ForwardSortedTag {});
+    return mappable::overlap_ranges(std::cbegin(mappables), std::cend(mappables), first_query, last_query);
 }
 
-template <typename Range, typename MappableTp>
-bool has_exact_overlap(const Range& mappables, const MappableTp& mappable,
-                       BidirectionallySortedTag)
+template <typename Container, typename InputIt>
+auto count_overlapped_each(const Container& mappables, InputIt first_query, InputIt last_query, std::true_type)
 {
-    return has_exact_overlap(std::cbegin(mappables), std::cend(mappables), mappable,
-                             BidirectionallySortedTag {});
+    if (mappables.bidirectionally_sorted()) {
+        return mappable::count_overlapped_each(std::cbegin(mappables), std::cend(mappables),
+                                               first_query, last_query, BidirectionallySortedTag {});
+    }
+    return mappable::count_overlapped_each(std::cbegin(mappables), std::cend(mappables),
+                                           first_query, last_query, mappables.max_element_size());
+}
+
+template <typename Range, typename InputIt>
+auto count_overlapped_each(const Range& mappables, InputIt first_query, InputIt last_query, std::false_type)
+{
+    return mappable::count_overlapped_each(std::cbegin(mappables), std::cend(mappables), first_query, last_query);
+}
+
+template <typename Container, typename InputIt>
+auto has_overlapped_each(const Container& mappables, InputIt first_query, InputIt last_query, std::true_type)
+{
+    if (mappables.bidirectionally_sorted()) {
+        return mappable::has_overlapped_each(std::cbegin(mappables), std::cend(mappables),
+                                             first_query, last_query, BidirectionallySortedTag {});
+    }
+    return mappable::has_overlapped_each(std::cbegin(mappables), std::cend(mappables),
+                                         first_query, last_query, mappables.max_element_size());
+}
+
+template <typename Range, typename InputIt>
+auto has_overlapped_each(const Range& mappables, InputIt first_query, InputIt last_query, std::false_type)
+{
+    return mappable::has_overlapped_each(std::cbegin(mappables), std::cend(mappables), first_query, last_query);
+}
+
+} // namespace detail
+
+template <typename Range, typename InputIt>
+auto overlap_ranges(const Range& mappables, InputIt first_query, InputIt last_query)
+{
+    return detail::overlap_ranges(mappables, first_query, last_query,
+                                  detail::HasMemberBidirectionallySorted<Range> {});
+}
+
+template <typename Range, typename QueryRange>
+auto overlap_ranges(const Range& mappables, const QueryRange& queries)
+{
+    return overlap_ranges(mappables, std::cbegin(queries), std::cend(queries));
+}
+
+template <typename Range, typename InputIt>
+auto count_overlapped_each(const Range& mappables, InputIt first_query, InputIt last_query)
+{
+    return detail::count_overlapped_each(mappables, first_query, last_query,
+                                         detail::HasMemberBidirectionallySorted<Range> {});
+}
+
+template <typename Range, typename QueryRange>
+auto count_overlapped_each(const Range& mappables, const QueryRange& queries)
+{
+    return count_overlapped_each(mappables, std::cbegin(queries), std::cend(queries));
+}
+
+template <typename Range, typename InputIt>
+auto has_overlapped_each(const Range& mappables, InputIt first_query, InputIt last_query)
+{
+    return detail::has_overlapped_each(mappables, first_query, last_query,
+                                       detail::HasMemberBidirectionallySorted<Range> {});
+}
+
+template <typename Range, typename QueryRange>
+auto has_overlapped_each(const Range& mappables, const QueryRange& queries)
+{
+    return has_overlapped_each(mappables, std::cbegin(queries), std::cend(queries));
+}
+
+// overlap_join
+
+namespace detail {
+
+// Orders a heap of active elements so the element with the smallest end, and of those a non-empty element,
+// is at the top
+struct EndsAfter
+{
+    template <typename Iterator>
+    bool operator()(const Iterator& lhs, const Iterator& rhs) const
+    {
+        if (mapped_end(*lhs) != mapped_end(*rhs)) return mapped_end(*lhs) > mapped_end(*rhs);
+        return is_empty_region(*lhs) && !is_empty_region(*rhs);
+    }
+};
+
+template <typename ForwardIt>
+void pop_active(std::vector<ForwardIt>& active)
+{
+    std::pop_heap(std::begin(active), std::end(active), EndsAfter {});
+    active.pop_back();
+}
+
+template <typename ForwardIt>
+void push_active(std::vector<ForwardIt>& active, const ForwardIt it)
+{
+    active.push_back(it);
+    std::push_heap(std::begin(active), std::end(active), EndsAfter {});
+}
+
+// Removes the elements of active that end before position, which cannot overlap anything beginning after it
+template <typename ForwardIt, typename Position>
+void evict_ended(std::vector<ForwardIt>& active, const Position position)
+{
+    while (!active.empty() && mapped_end(*active.front()) < position) pop_active(active);
+}
+
+// Removes the elements of active that cannot overlap mappable or anything after it, and calls f on the rest
+// that overlap mappable. A non-empty element ending where mappable begins can only overlap later empty elements
+// beginning there, which cannot follow mappable in sorted order unless mappable is empty.
+template <typename ForwardIt, typename MappableTp, typename UnaryFunction>
+void sweep_active(std::vector<ForwardIt>& active, const MappableTp& mappable, UnaryFunction f)
+{
+    const auto begin = mapped_begin(mappable);
+    evict_ended(active, begin);
+    if (!is_empty_region(mappable)) {
+        while (!active.empty() && mapped_end(*active.front()) == begin && !is_empty_region(*active.front())) {
+            pop_active(active);
+        }
+    }
+    for (const auto& it : active) {
+        if (overlaps(*it, mappable)) f(it);
+    }
+}
+
+} // namespace detail
+
+/**
+ Calls f(a, b) for every pair of elements a in [first1, last1) and b in [first2, last2) such that
+ a overlaps b. Pairs are reported in the order the later of the two elements appears in the merged
+ ranges.
+ 
+ Requires both ranges are ForwardSorted. A single merge-like sweep is made over both ranges, keeping
+ the elements of each range that may still overlap an element of the other in a heap ordered by end.
+ Elements are evicted as soon as the sweep passes their end, so the kept elements are only those
+ covering the sweep position, and a long element does not keep the elements after it alive. Each kept
+ element compared with an element of the other range is an overlapping pair, so the time complexity is
+ O((n + m) log d + k), where d is the greatest number of elements covering a position and k is the
+ number of overlapping pairs. This holds regardless of element sizes, so the sweep does not need
+ max_mappable_size or BidirectionallySorted information.
+ */
+template <typename ForwardIt1, typename ForwardIt2, typename BinaryFunction>
+BinaryFunction overlap_join(ForwardIt1 first1, ForwardIt1 last1, ForwardIt2 first2, ForwardIt2 last2,
+                            BinaryFunction f)
+{
+    using MappableTp1 = typename std::iterator_traits<ForwardIt1>::value_type;
+    using MappableTp2 = typename std::iterator_traits<ForwardIt2>::value_type;
+    static_assert(is_region_or_mappable<MappableTp1> && is_region_or_mappable<MappableTp2>,
+                  "Mappable required");
+    std::vector<ForwardIt1> active1 {};
+    std::vector<ForwardIt2> active2 {};
+    while (first1 != last1 || first2 != last2) {
+        if ((first1 == last1 && active1.empty()) || (first2 == last2 && active2.empty())) break;
+        // Elements of the other range yet to be swept begin at or after the current element
+        if (first2 == last2 || (first1 != last1 && !begins_before(*first2, *first1))) {
+            detail::sweep_active(active2, *first1, [&f, first1] (ForwardIt2 it) { f(*first1, *it); });
+            detail::evict_ended(active1, mapped_begin(*first1));
+            if (first2 != last2) detail::push_active(active1, first1);
+            ++first1;
+        } else {
+            detail::sweep_active(active1, *first2, [&f, first2] (ForwardIt1 it) { f(*it, *first2); });
+            detail::evict_ended(active2, mapped_begin(*first2));
+            if (first1 != last1) detail::push_active(active2, first2);
+            ++first2;
+        }
+    }
+    return f;
+}
+
+template <typename Range1, typename Range2, typename BinaryFunction>
+BinaryFunction overlap_join(const Range1& mappables1, const Range2& mappables2, BinaryFunction f)
+{
+    return overlap_join(std::cbegin(mappables1), std::cend(mappables1),
+                        std::cbegin(mappables2), std::cend(mappables2), std::move(f));
+}
+
+// max/min_overlapped
+
+// Returns an iterator to element in range with the max/min overlap_size with the given Mappable
+
+namespace detail {
+
+template <typename MappableTp1>
+struct OverlapSizeLess
+{
+    template <typename MappableTp2>
+    bool operator()(const MappableTp2& lhs, const MappableTp2& rhs) const
+    {
+        return overlap_size(mappable, lhs) < overlap_size(mappable, rhs);
+    }
+    OverlapSizeLess(const MappableTp1& mappable) : mappable {mappable} {}
+    const MappableTp1& mappable;
+};
+
+template <typename BidirIt, typename MappableTp>
+auto max_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable)
+{
+    return std::max_element(first, last, OverlapSizeLess<MappableTp> {mappable});
+}
+
+template <typename BidirIt, typename MappableTp>
+auto min_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable)
+{
+    return std::min_element(first, last, OverlapSizeLess<MappableTp> {mappable});
+}
+
+} // namespace detail
+
+template <typename BidirIt, typename MappableTp>
+auto max_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable, ForwardSortedTag)
+{
+    const auto overlapped = overlap_range(first, last, mappable, ForwardSortedTag {});
+    return detail::max_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable).base();
+}
+
+template <typename BidirIt, typename MappableTp>
+auto max_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable, BidirectionallySortedTag)
+{
+    const auto overlapped = bases(overlap_range(first, last, mappable, BidirectionallySortedTag {}));
+    return detail::max_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable);
+}
+
+template <typename BidirIt, typename MappableTp>
+auto max_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable,
+                    const typename RegionType<MappableTp>::Position max_mappable_size)
+{
+    const auto overlapped = overlap_range(first, last, mappable, max_mappable_size);
+    return detail::max_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable).base();
+}
+
+template <typename BidirIt, typename MappableTp>
+auto max_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable)
+{
+    return max_overlapped(first, last, mappable, ForwardSortedTag {});
+}
+
+template <typename Range, typename MappableTp>
+auto max_overlapped(const Range& range, const MappableTp& mappable)
+{
+    const auto overlapped = overlap_range(range, mappable);
+    return detail::max_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable).base();
+}
+
+template <typename BidirIt, typename MappableTp>
+auto min_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable, ForwardSortedTag)
+{
+    const auto overlapped = overlap_range(first, last, mappable, ForwardSortedTag {});
+    return detail::min_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable).base();
+}
+
+template <typename BidirIt, typename MappableTp>
+auto min_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable, BidirectionallySortedTag)
+{
+    const auto overlapped = bases(overlap_range(first, last, mappable, BidirectionallySortedTag {}));
+    return detail::min_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable);
+}
+
+template <typename BidirIt, typename MappableTp>
+auto min_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable,
+                    const typename RegionType<MappableTp>::Position max_mappable_size)
+{
+    const auto overlapped = overlap_range(first, last, mappable, max_mappable_size);
+    return detail::min_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable).base();
+}
+
+template <typename BidirIt, typename MappableTp>
+auto min_overlapped(BidirIt first, BidirIt last, const MappableTp& mappable)
+{
+    return min_overlapped(first, last, mappable, ForwardSortedTag {});
+}
+
+template <typename Range, typename MappableTp>
+auto min_overlapped(const Range& range, const MappableTp& mappable)
+{
+    const auto overlapped = overlap_range(range, mappable);
+    return detail::min_overlapped(std::cbegin(overlapped), std::cend(overlapped), mappable).base();
+}
+
+// has_exact_overlap
+
+/**
+ Returns true if the range [first, last) has an element with the region of mappable
+ 
+ Requires the range [first, last) is ForwardSorted.
+ */
+template <typename ForwardIt, typename MappableTp>
+bool has_exact_overlap(ForwardIt first, ForwardIt last, const MappableTp& mappable,
+                       ForwardSortedTag)
+{
+    using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
+                  "Mappable required");
+    const auto overlapped = overlap_range(first, last, mappable);
+    return std::find_if(std::cbegin(overlapped), std::cend(overlapped),
+                        [&mappable] (const auto& e) {
+                            return is_same_region(mappable, e);
+                        }) != std::cend(overlapped);
+}
+
+template <typename ForwardIt, typename MappableTp>
+bool has_exact_overlap(ForwardIt first, ForwardIt last, const MappableTp& mappable,
+                       BidirectionallySortedTag)
+{
+    using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
+                  "Mappable required");
+    return std::binary_search(first, last, mappable);
+}
+
+template <typename ForwardIt, typename MappableTp>
+bool has_exact_overlap(ForwardIt first, ForwardIt last, const MappableTp& mappable)
+{
+    return has_exact_overlap(first, last, mappable, ForwardSortedTag {});
+}
+
+template <typename Range, typename MappableTp>
+bool has_exact_overlap(const Range& mappables, const MappableTp& mappable,
+                       ForwardSortedTag)
+{
+    return has_exact_overlap(std::cbegin(mappables), std::cend(mappables), mappable,
+                             ForwardSortedTag {});
+}
+
+template <typename Range, typename MappableTp>
+bool has_exact_overlap(const Range& mappables, const MappableTp& mappable,
+                       BidirectionallySortedTag)
+{
+    return has_exact_overlap(std::cbegin(mappables), std::cend(mappables), mappable,
+                             BidirectionallySortedTag {});
 }
 
 template <typename Range, typename MappableTp>
@@ -1012,19 +1665,61 @@ contained_range(BidirIt first, BidirIt last, const MappableTp& mappable)
     using MappableTp2 = typename std::iterator_traits<BidirIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
                   "Mappable required");
+    detail::CallRecorder recorder {Algorithm::contained_range};
     const auto it = std::lower_bound(first, last, mappable,
-                               [] (const auto& lhs, const auto& rhs) {
+                               detail::counting_compare([] (const auto& lhs, const auto& rhs) {
                                    return begins_before(lhs, rhs);
-                               });
-    const auto it2 = find_first_after(it, last, mappable);
+                               }, recorder));
+    const auto it2 = detail::find_first_after(it, last, mappable, recorder);
     if (it == it2) return make_contained_range(it, it2, mappable);
     auto rit = std::find_if(std::make_reverse_iterator(it2), std::make_reverse_iterator(std::next(it)),
-                            [&mappable] (const auto& m) { return contains(mappable, m); });
+                            detail::scanning_predicate([&mappable] (const auto& m) {
+                                return contains(mappable, m);
+                            }, recorder));
     return make_contained_range(it, rit.base(), mappable);
 }
 
 namespace detail {
 
+// As fixed_size_overlap_bounds, the range must lie on a single contig and each compared element is checked
+template <typename ForwardIt, typename MappableTp>
+std::pair<ForwardIt, ForwardIt>
+fixed_size_contained_bounds(ForwardIt first, ForwardIt last, const MappableTp& mappable, CallRecorder& recorder)
+{
+    const auto it1 = std::lower_bound(first, last, mappable,
+                                      counting_compare([] (const auto& lhs, const auto& rhs) {
+                                          return begins_before(lhs, rhs);
+                                      }, recorder));
+    const auto it2 = std::lower_bound(it1, last, mappable,
+                                      counting_compare([] (const auto& lhs, const auto& rhs) {
+                                          check_same_contig(mapped_region(lhs), mapped_region(rhs));
+                                          return mapped_end(lhs) <= mapped_end(rhs);
+                                      }, recorder));
+    return {it1, it2};
+}
+
+} // namespace detail
+
+/**
+ Returns a ContainedRange of the range [first, last) whose base iterators bound exactly the contained
+ elements.
+ 
+ Requires the range [first, last) is FixedSize and lies on a single contig, otherwise BadRegionCompare is thrown.
+ */
+template <typename ForwardIt, typename MappableTp>
+ContainedRange<ForwardIt>
+contained_range(ForwardIt first, ForwardIt last, const MappableTp& mappable, FixedSizeTag)
+{
+    using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
+                  "Mappable required");
+    detail::CallRecorder recorder {Algorithm::contained_range};
+    const auto contained = detail::fixed_size_contained_bounds(first, last, mappable, recorder);
+    return make_contained_range(contained.first, contained.second, mappable);
+}
+
+namespace detail {
+
 template <typename C, typename T, typename = void>
 struct HasMemberContainedRange : std::false_type {};
 
@@ -1075,6 +1770,17 @@ bool has_contained(ForwardIt first, ForwardIt last, const MappableTp& mappable)
     return (it != last) && mapped_end(*it) <= mapped_end(mappable);
 }
 
+template <typename ForwardIt, typename MappableTp>
+bool has_contained(ForwardIt first, ForwardIt last, const MappableTp& mappable, FixedSizeTag)
+{
+    using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
+                  "Mappable required");
+    detail::CallRecorder recorder {};
+    const auto contained = detail::fixed_size_contained_bounds(first, last, mappable, recorder);
+    return contained.first != contained.second;
+}
+
 namespace detail {
 
 template <typename C, typename T, typename = void>
@@ -1119,8 +1825,19 @@ std::size_t count_contained(BidirIt first, BidirIt last, const MappableTp& mappa
     using MappableTp2 = typename std::iterator_traits<BidirIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
                   "Mappable required");
-    const auto contained = contained_range(first, last, mappable);
-    return std::distance(contained.begin(), contained.end());
+    detail::CallRecorder recorder {Algorithm::count_contained};
+    return detail::count_filtered(contained_range(first, last, mappable), recorder);
+}
+
+template <typename ForwardIt, typename MappableTp>
+std::size_t count_contained(ForwardIt first, ForwardIt last, const MappableTp& mappable, FixedSizeTag)
+{
+    using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
+                  "Mappable required");
+    detail::CallRecorder recorder {Algorithm::count_contained};
+    const auto contained = detail::fixed_size_contained_bounds(first, last, mappable, recorder);
+    return static_cast<std::size_t>(std::distance(contained.first, contained.second));
 }
 
 namespace detail {
@@ -1159,11 +1876,41 @@ auto count_contained(const Range& mappables, const MappableTp& mappable)
 template <typename Range, typename MappableType>
 Range copy_contained(const Range& mappables, const MappableType& mappable)
 {
-    const auto contained = contained_range(mappables, mappable);
-    return Range {std::begin(contained), std::end(contained)};
+    detail::CallRecorder recorder {Algorithm::copy_contained};
+    return detail::copy_filtered<Range>(contained_range(mappables, mappable), recorder);
 }
 
-// copy_contained
+/**
+ Copies the elements in the range [first, last) that are contained by mappable to result.
+
+ Requires the range [first, last) is ForwardSorted.
+ */
+template <typename BidirIt, typename MappableTp, typename OutputIt>
+OutputIt copy_contained(BidirIt first, BidirIt last, const MappableTp& mappable, OutputIt result)
+{
+    detail::CallRecorder recorder {Algorithm::copy_contained};
+    const auto contained = detail::scanned_range(contained_range(first, last, mappable), recorder);
+    return std::copy(std::begin(contained), std::end(contained), result);
+}
+
+/**
+ Replaces the contents of result with the elements of mappables that are contained by mappable.
+
+ The capacity of result is retained.
+ */
+template <typename Range, typename MappableTp, typename Allocator>
+void copy_contained(const Range& mappables, const MappableTp& mappable,
+                    std::vector<typename Range::value_type, Allocator>& result)
+{
+    detail::CallRecorder recorder {Algorithm::copy_contained};
+    const auto prev_capacity = result.capacity();
+    result.clear();
+    const auto contained = detail::scanned_range(contained_range(mappables, mappable), recorder);
+    result.insert(std::cend(result), std::begin(contained), std::end(contained));
+    detail::record_reallocation(recorder, result, prev_capacity);
+}
+
+// copy_noncontained
 
 template <typename Container, typename MappableType>
 Container copy_noncontained(const Container& mappables, const MappableType& mappable)
@@ -1189,6 +1936,27 @@ Container copy_noncontained(const Container& mappables, const MappableType& mapp
     return result;
 }
 
+namespace detail {
+
+// Merges the sorted ranges into a vector, through a buffer rather than with std::inplace_merge so the
+// temporary allocations can be recorded
+template <typename Range, typename T>
+std::vector<T> merge_copy(const std::vector<Range>& ranges, CallRecorder& recorder)
+{
+    std::vector<T> result {}, buffer {};
+    const auto less = counting_compare(std::less<> {}, recorder);
+    for (const auto& range : ranges) {
+        const auto scanned = scanned_range(range, recorder);
+        buffer.clear();
+        std::merge(std::cbegin(result), std::cend(result), std::cbegin(scanned), std::cend(scanned),
+                   recording_back_inserter(buffer, recorder), less);
+        result.swap(buffer);
+    }
+    return result;
+}
+
+} // namespace detail
+
 // count_spanning
 
 template <typename Range, typename MappableTp>
@@ -1349,27 +2117,34 @@ auto adjacent_overlap_find(const Range& mappables)
 
 namespace detail {
 
-template <typename InputIt>
-auto extract_regions(InputIt first, InputIt last, std::input_iterator_tag)
+template <typename InputIt, typename Allocator>
+auto extract_regions(InputIt first, InputIt last, const Allocator& alloc, std::input_iterator_tag)
 {
     using MappableTp = typename std::iterator_traits<InputIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
-    std::vector<RegionType<MappableTp>> result {};
-    std::transform(first, last, std::back_inserter(result),
-                   [] (const auto& mappable) { return mapped_region(mappable); });
+    using Region = RegionType<MappableTp>;
+    CallRecorder recorder {Algorithm::extract_regions};
+    std::vector<Region, RebindAlloc<Allocator, Region>> result {rebind_alloc<Region>(alloc)};
+    std::transform(first, last, recording_back_inserter(result, recorder),
+                   [&recorder] (const auto& mappable) { recorder.scanned(); return mapped_region(mappable); });
+    const auto prev_capacity = result.capacity();
     result.shrink_to_fit();
+    record_reallocation(recorder, result, prev_capacity);
     return result;
 }
 
-template <typename ForwardIt>
-auto extract_regions(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+template <typename ForwardIt, typename Allocator>
+auto extract_regions(ForwardIt first, ForwardIt last, const Allocator& alloc, std::forward_iterator_tag)
 {
     using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
-    std::vector<RegionType<MappableTp>> result {};
+    using Region = RegionType<MappableTp>;
+    CallRecorder recorder {Algorithm::extract_regions};
+    std::vector<Region, RebindAlloc<Allocator, Region>> result {rebind_alloc<Region>(alloc)};
     result.reserve(std::distance(first, last));
+    record_allocation(recorder, result);
     std::transform(first, last, std::back_inserter(result),
-                   [] (const auto& mappable) { return mapped_region(mappable); });
+                   [&recorder] (const auto& mappable) { recorder.scanned(); return mapped_region(mappable); });
     return result;
 }
 
@@ -1378,11 +2153,12 @@ auto extract_regions(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
 /**
  Returns a vector of mapped_regions in the range [first, last).
  */
-template <typename InputIt>
+template <typename InputIt, typename = enable_if_iterator<InputIt>>
 auto extract_regions(InputIt first, InputIt last)
 {
     using Category = typename std::iterator_traits<InputIt>::iterator_category;
-    return detail::extract_regions(first, last, Category {});
+    using MappableTp = typename std::iterator_traits<InputIt>::value_type;
+    return detail::extract_regions(first, last, std::allocator<RegionType<MappableTp>> {}, Category {});
 }
 
 template <typename Range>
@@ -1391,14 +2167,58 @@ auto extract_regions(const Range& mappables)
     return extract_regions(std::cbegin(mappables), std::cend(mappables));
 }
 
+template <typename InputIt, typename Allocator>
+auto extract_regions(std::allocator_arg_t, const Allocator& alloc, InputIt first, InputIt last)
+{
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    return detail::extract_regions(first, last, alloc, Category {});
+}
+
+template <typename Range, typename Allocator>
+auto extract_regions(std::allocator_arg_t, const Allocator& alloc, const Range& mappables)
+{
+    return extract_regions(std::allocator_arg, alloc, std::cbegin(mappables), std::cend(mappables));
+}
+
+/**
+ Writes the mapped_regions in the range [first, last) to result.
+ */
+template <typename InputIt, typename OutputIt>
+OutputIt extract_regions(InputIt first, InputIt last, OutputIt result)
+{
+    using MappableTp = typename std::iterator_traits<InputIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
+    detail::CallRecorder recorder {Algorithm::extract_regions};
+    return std::transform(first, last, result, [&recorder] (const auto& mappable) {
+        recorder.scanned();
+        return mapped_region(mappable);
+    });
+}
+
+/**
+ Replaces the contents of result with the mapped_regions of mappables, retaining the capacity of result.
+ */
+template <typename Range, typename Allocator>
+void extract_regions(const Range& mappables,
+                     std::vector<RegionType<typename Range::value_type>, Allocator>& result)
+{
+    detail::CallRecorder recorder {Algorithm::extract_regions};
+    const auto prev_capacity = result.capacity();
+    result.clear();
+    result.reserve(mappables.size());
+    detail::record_reallocation(recorder, result, prev_capacity);
+    std::transform(std::cbegin(mappables), std::cend(mappables), std::back_inserter(result),
+                   [&recorder] (const auto& mappable) { recorder.scanned(); return mapped_region(mappable); });
+}
+
 // decompose
 
 namespace detail {
 
-template <typename MappableTp>
-auto decompose(const MappableTp& mappable, ContigRegion)
+template <typename MappableTp, typename Allocator>
+auto decompose(const MappableTp& mappable, ContigRegion, const Allocator& alloc)
 {
-    std::vector<ContigRegion> result {};
+    std::vector<ContigRegion, RebindAlloc<Allocator, ContigRegion>> result {rebind_alloc<ContigRegion>(alloc)};
     const auto num_elements = size(mappable);
     if (num_elements == 0) return result;
     result.reserve(num_elements);
@@ -1411,10 +2231,10 @@ auto decompose(const MappableTp& mappable, ContigRegion)
     return result;
 }
 
-template <typename MappableTp>
-auto decompose(const MappableTp& mappable, GenomicRegion)
+template <typename MappableTp, typename Allocator>
+auto decompose(const MappableTp& mappable, GenomicRegion, const Allocator& alloc)
 {
-    std::vector<GenomicRegion> result {};
+    std::vector<GenomicRegion, RebindAlloc<Allocator, GenomicRegion>> result {rebind_alloc<GenomicRegion>(alloc)};
     const auto num_elements = region_size(mappable);
     if (num_elements == 0) return result;
     result.reserve(num_elements);
@@ -1434,26 +2254,38 @@ auto decompose(const MappableTp& mappable, GenomicRegion)
  Returns a vector of RegionType<MappableTp>'s, each of size 1, that cover the region defined
  by mappable.
  */
+template <typename MappableTp, typename Allocator>
+auto decompose(std::allocator_arg_t, const Allocator& alloc, const MappableTp& mappable)
+{
+    static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
+    detail::CallRecorder recorder {Algorithm::decompose};
+    auto result = detail::decompose(mappable, RegionType<MappableTp> {}, alloc);
+    detail::record_allocation(recorder, result);
+    return result;
+}
+
 template <typename MappableTp>
 auto decompose(const MappableTp& mappable)
 {
-    static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
-    return detail::decompose(mappable, RegionType<MappableTp> {});
+    return decompose(std::allocator_arg, std::allocator<RegionType<MappableTp>> {}, mappable);
 }
 
 /**
  Returns the maximal vector of RegionType<MappableTp>'s, each of size n, that do not
  span past mapped_end(mappable).
  */
-template <typename MappableTp>
-auto decompose(const MappableTp& mappable, const GenomicRegion::Position n)
+template <typename MappableTp, typename Allocator>
+auto decompose(std::allocator_arg_t, const Allocator& alloc, const MappableTp& mappable,
+               const GenomicRegion::Position n)
 {
     static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
-    std::vector<GenomicRegion> result {};
+    detail::CallRecorder recorder {Algorithm::decompose};
+    std::vector<GenomicRegion, RebindAlloc<Allocator, GenomicRegion>> result {rebind_alloc<GenomicRegion>(alloc)};
     if (n == 0) return result;
     const auto num_elements = region_size(mappable) / n;
     if (num_elements == 0) return result;
     result.reserve(num_elements);
+    detail::record_allocation(recorder, result);
     const auto& contig = contig_name(mappable);
     auto curr = mapped_begin(mappable);
     std::generate_n(std::back_inserter(result), num_elements, [&contig, &curr, n] () {
@@ -1464,6 +2296,12 @@ auto decompose(const MappableTp& mappable, const GenomicRegion::Position n)
     return result;
 }
 
+template <typename MappableTp>
+auto decompose(const MappableTp& mappable, const GenomicRegion::Position n)
+{
+    return decompose(std::allocator_arg, std::allocator<GenomicRegion> {}, mappable, n);
+}
+
 // encompassing_region
 
 /**
@@ -1492,20 +2330,20 @@ auto encompassing_region(const Range& mappables)
 
 namespace detail {
 
-template <typename ForwardIt, typename Compare>
-auto extract_overlapping_regions(ForwardIt first, const ForwardIt last, Compare cmp)
+template <typename ForwardIt, typename OutputIt, typename Compare>
+OutputIt write_overlapping_regions(ForwardIt first, const ForwardIt last, OutputIt result, Compare cmp)
 {
     using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
-    std::vector<RegionType<MappableTp>> result {};
     if (first == last) return result;
-    result.reserve(std::distance(first, last));
     auto first_overlapped = first;
     auto rightmost        = first;
+    auto last_written     = last;
     for (; first != last; ++first) {
         if (cmp(*first, *rightmost)) {
-            if (result.empty() || !ends_equal(result.back(), *rightmost)) {
-                result.push_back(closed_region(*first_overlapped, *rightmost));
+            if (last_written == last || !ends_equal(*last_written, *rightmost)) {
+                *result++ = closed_region(*first_overlapped, *rightmost);
+                last_written = rightmost;
             }
             rightmost        = first;
             first_overlapped = first;
@@ -1513,11 +2351,44 @@ auto extract_overlapping_regions(ForwardIt first, const ForwardIt last, Compare
             rightmost = first;
         }
     }
-    result.push_back(closed_region(*first_overlapped, *rightmost));
+    *result++ = closed_region(*first_overlapped, *rightmost);
+    return result;
+}
+
+// Wraps a comparator that write_overlapping_regions calls once for each element
+template <typename Compare>
+auto scanning_compare(Compare cmp, CallRecorder& recorder)
+{
+    return [cmp, &recorder] (const auto& lhs, const auto& rhs) {
+        recorder.scanned();
+        recorder.compared();
+        return cmp(lhs, rhs);
+    };
+}
+
+template <typename ForwardIt, typename Compare, typename Allocator>
+auto extract_overlapping_regions(ForwardIt first, const ForwardIt last, Compare cmp, const Allocator& alloc,
+                                 CallRecorder& recorder)
+{
+    using Region = RegionType<typename std::iterator_traits<ForwardIt>::value_type>;
+    std::vector<Region, RebindAlloc<Allocator, Region>> result {rebind_alloc<Region>(alloc)};
+    if (first == last) return result;
+    result.reserve(std::distance(first, last));
+    record_allocation(recorder, result);
+    write_overlapping_regions(first, last, std::back_inserter(result), scanning_compare(cmp, recorder));
+    const auto prev_capacity = result.capacity();
     result.shrink_to_fit();
+    record_reallocation(recorder, result, prev_capacity);
     return result;
 }
 
+template <typename ForwardIt, typename Compare, typename Allocator>
+auto extract_overlapping_regions(ForwardIt first, const ForwardIt last, Compare cmp, const Allocator& alloc)
+{
+    CallRecorder uninstrumented {};
+    return extract_overlapping_regions(first, last, cmp, alloc, uninstrumented);
+}
+
 template <typename ForwardIt, typename Compare>
 auto count_overlapping_regions(ForwardIt first, const ForwardIt last, Compare cmp)
 {
@@ -1557,10 +2428,13 @@ const auto is_new_mutually_exclusive_region = [] (const auto& a, const auto& b)
  
  Requires [first_mappable, last_mappable) is sorted w.r.t GenomicRegion::operator<
  */
-template <typename ForwardIt>
+template <typename ForwardIt, typename = enable_if_iterator<ForwardIt>>
 auto extract_covered_regions(ForwardIt first, ForwardIt last)
 {
-    return detail::extract_overlapping_regions(first, last, detail::is_new_covered_region);
+    using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
+    detail::CallRecorder recorder {Algorithm::extract_covered_regions};
+    return detail::extract_overlapping_regions(first, last, detail::is_new_covered_region,
+                                               std::allocator<RegionType<MappableTp>> {}, recorder);
 }
 
 template <typename Range>
@@ -1569,6 +2443,41 @@ auto extract_covered_regions(const Range& mappables)
     return extract_covered_regions(std::cbegin(mappables), std::cend(mappables));
 }
 
+template <typename ForwardIt, typename Allocator>
+auto extract_covered_regions(std::allocator_arg_t, const Allocator& alloc, ForwardIt first, ForwardIt last)
+{
+    detail::CallRecorder recorder {Algorithm::extract_covered_regions};
+    return detail::extract_overlapping_regions(first, last, detail::is_new_covered_region, alloc, recorder);
+}
+
+template <typename Range, typename Allocator>
+auto extract_covered_regions(std::allocator_arg_t, const Allocator& alloc, const Range& mappables)
+{
+    return extract_covered_regions(std::allocator_arg, alloc, std::cbegin(mappables), std::cend(mappables));
+}
+
+template <typename ForwardIt, typename OutputIt>
+OutputIt extract_covered_regions(ForwardIt first, ForwardIt last, OutputIt result)
+{
+    detail::CallRecorder recorder {Algorithm::extract_covered_regions};
+    return detail::write_overlapping_regions(first, last, result,
+                                             detail::scanning_compare(detail::is_new_covered_region, recorder));
+}
+
+/**
+ Replaces the contents of result with the covered regions of mappables, retaining the capacity of result.
+ */
+template <typename Range, typename Allocator>
+void extract_covered_regions(const Range& mappables,
+                             std::vector<RegionType<typename Range::value_type>, Allocator>& result)
+{
+    detail::CallRecorder recorder {Algorithm::extract_covered_regions};
+    result.clear();
+    detail::write_overlapping_regions(std::cbegin(mappables), std::cend(mappables),
+                                      detail::recording_back_inserter(result, recorder),
+                                      detail::scanning_compare(detail::is_new_covered_region, recorder));
+}
+
 template <typename ForwardIt>
 auto count_covered_regions(ForwardIt first, ForwardIt last)
 {
@@ -1593,7 +2502,9 @@ auto count_covered_regions(const Range& mappables)
 template <typename ForwardIt>
 auto extract_mutually_exclusive_regions(ForwardIt first, const ForwardIt last)
 {
-    return detail::extract_overlapping_regions(first, last, detail::is_new_mutually_exclusive_region);
+    using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
+    return detail::extract_overlapping_regions(first, last, detail::is_new_mutually_exclusive_region,
+                                               std::allocator<RegionType<MappableTp>> {});
 }
 
 template <typename Range>
@@ -1602,6 +2513,18 @@ auto extract_mutually_exclusive_regions(const Range& mappables)
     return extract_mutually_exclusive_regions(std::cbegin(mappables), std::cend(mappables));
 }
 
+template <typename ForwardIt, typename Allocator>
+auto extract_mutually_exclusive_regions(std::allocator_arg_t, const Allocator& alloc, ForwardIt first, ForwardIt last)
+{
+    return detail::extract_overlapping_regions(first, last, detail::is_new_mutually_exclusive_region, alloc);
+}
+
+template <typename Range, typename Allocator>
+auto extract_mutually_exclusive_regions(std::allocator_arg_t, const Allocator& alloc, const Range& mappables)
+{
+    return extract_mutually_exclusive_regions(std::allocator_arg, alloc, std::cbegin(mappables), std::cend(mappables));
+}
+
 template <typename ForwardIt>
 auto count_mutually_exclusive_regions(ForwardIt first, const ForwardIt last)
 {
@@ -1616,26 +2539,69 @@ auto count_mutually_exclusive_regions(const Range& mappables)
 
 // extract_intervening_regions
 
+namespace detail {
+
+template <typename ForwardIt, typename OutputIt>
+OutputIt write_intervening_regions(ForwardIt first, ForwardIt last, OutputIt result, CallRecorder& recorder)
+{
+    if (first == last) return result;
+    return std::transform(first, std::prev(last), std::next(first), result,
+                          [&recorder] (const auto& mappable, const auto& next_mappable) {
+                              recorder.scanned();
+                              return *intervening_region(mappable, next_mappable);
+                          });
+}
+
+template <typename ForwardIt, typename MappableTp, typename OutputIt>
+OutputIt write_intervening_regions(ForwardIt first, ForwardIt last, const MappableTp& mappable, OutputIt result,
+                                   CallRecorder& recorder)
+{
+    if (first == last) return result;
+    if (begins_before(mappable, *first)) {
+        *result++ = left_overhang_region(mappable, *first);
+    }
+    result = write_intervening_regions(first, last, result, recorder);
+    if (ends_before(*std::prev(last), mappable)) {
+        *result++ = right_overhang_region(mappable, *std::prev(last));
+    }
+    return result;
+}
+
+} // namespace detail
+
 /**
  Returns all intervening regions between non-overlapping mappables in the range [first, last).
  
  Requires the range [first, last) is ForwardSorted.
  */
-template <typename ForwardIt>
-auto extract_intervening_regions(ForwardIt first, ForwardIt last)
+template <typename ForwardIt, typename Allocator>
+auto extract_intervening_regions(std::allocator_arg_t, const Allocator& alloc, ForwardIt first, ForwardIt last)
 {
     using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
-    std::vector<RegionType<MappableTp>> result {};
+    using Region = RegionType<MappableTp>;
+    detail::CallRecorder recorder {Algorithm::extract_intervening_regions};
+    std::vector<Region, RebindAlloc<Allocator, Region>> result {rebind_alloc<Region>(alloc)};
     if (first == last) return result;
     result.reserve(std::distance(first, last) - 1);
-    std::transform(first, std::prev(last), std::next(first), std::back_inserter(result),
-                   [] (const auto& mappable, const auto& next_mappable) {
-                       return *intervening_region(mappable, next_mappable);
-                   });
+    detail::record_allocation(recorder, result);
+    detail::write_intervening_regions(first, last, std::back_inserter(result), recorder);
     return result;
 }
 
+template <typename Range, typename Allocator>
+auto extract_intervening_regions(std::allocator_arg_t, const Allocator& alloc, const Range& mappables)
+{
+    return extract_intervening_regions(std::allocator_arg, alloc, std::cbegin(mappables), std::cend(mappables));
+}
+
+template <typename ForwardIt, typename = enable_if_iterator<ForwardIt>>
+auto extract_intervening_regions(ForwardIt first, ForwardIt last)
+{
+    using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
+    return extract_intervening_regions(std::allocator_arg, std::allocator<RegionType<MappableTp>> {}, first, last);
+}
+
 template <typename Range>
 auto extract_intervening_regions(const Range& mappables)
 {
@@ -1649,67 +2615,237 @@ auto extract_intervening_regions(const Range& mappables)
  
  Requires the range [first, last) is ForwardSorted.
  */
-template <typename ForwardIt, typename MappableTp>
-auto extract_intervening_regions(ForwardIt first, ForwardIt last, const MappableTp& mappable)
+template <typename ForwardIt, typename MappableTp, typename Allocator,
+          typename = EnableIfRegionOrMappable<MappableTp>>
+auto extract_intervening_regions(std::allocator_arg_t, const Allocator& alloc, ForwardIt first, ForwardIt last,
+                                 const MappableTp& mappable)
 {
     using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
                   "Mappable required");
-    std::vector<RegionType<MappableTp>> result {};
+    using Region = RegionType<MappableTp>;
+    detail::CallRecorder recorder {Algorithm::extract_intervening_regions};
+    std::vector<Region, RebindAlloc<Allocator, Region>> result {rebind_alloc<Region>(alloc)};
     if (first == last) return result;
     result.reserve(std::distance(first, last) + 1);
-    if (begins_before(mappable, *first)) {
-        result.push_back(left_overhang_region(mappable, *first));
-    }
-    std::transform(first, std::prev(last), std::next(first), std::back_inserter(result),
-                   [] (const auto& mappable, const auto& next_mappable) {
-                       return *intervening_region(mappable, next_mappable);
-                   });
-    if (ends_before(*std::prev(last), mappable)) {
-        result.push_back(right_overhang_region(mappable, *std::prev(last)));
-    }
+    detail::record_allocation(recorder, result);
+    detail::write_intervening_regions(first, last, mappable, std::back_inserter(result), recorder);
     return result;
 }
 
-template <typename Range, typename MappableTp>
+template <typename Range, typename MappableTp, typename Allocator,
+          typename = EnableIfRegionOrMappable<MappableTp>>
+auto extract_intervening_regions(std::allocator_arg_t, const Allocator& alloc, const Range& mappables,
+                                 const MappableTp& mappable)
+{
+    return extract_intervening_regions(std::allocator_arg, alloc, std::cbegin(mappables), std::cend(mappables),
+                                       mappable);
+}
+
+template <typename ForwardIt, typename MappableTp,
+          typename = EnableIfRegionOrMappable<MappableTp>>
+auto extract_intervening_regions(ForwardIt first, ForwardIt last, const MappableTp& mappable)
+{
+    return extract_intervening_regions(std::allocator_arg, std::allocator<RegionType<MappableTp>> {},
+                                       first, last, mappable);
+}
+
+template <typename Range, typename MappableTp,
+          typename = EnableIfRegionOrMappable<MappableTp>>
 auto extract_intervening_regions(const Range& mappables, const MappableTp& mappable)
 {
     return extract_intervening_regions(std::cbegin(mappables), std::cend(mappables), mappable);
 }
 
+/**
+ Writes all intervening regions between non-overlapping mappables in the range [first, last) to result.
+ 
+ Requires the range [first, last) is ForwardSorted.
+ */
+template <typename ForwardIt, typename OutputIt,
+          typename = std::enable_if_t<!is_region_or_mappable<OutputIt>>>
+OutputIt extract_intervening_regions(ForwardIt first, ForwardIt last, OutputIt result)
+{
+    using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
+    detail::CallRecorder recorder {Algorithm::extract_intervening_regions};
+    return detail::write_intervening_regions(first, last, result, recorder);
+}
+
+/**
+ Writes all intervening regions between non-overlapping mappables in the range [first, last), and
+ also any flanking regions of mappable, to result.
+ 
+ Requires the range [first, last) is ForwardSorted.
+ */
+template <typename ForwardIt, typename MappableTp, typename OutputIt>
+OutputIt extract_intervening_regions(ForwardIt first, ForwardIt last, const MappableTp& mappable, OutputIt result)
+{
+    using MappableTp2 = typename std::iterator_traits<ForwardIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp> && is_region_or_mappable<MappableTp2>,
+                  "Mappable required");
+    detail::CallRecorder recorder {Algorithm::extract_intervening_regions};
+    return detail::write_intervening_regions(first, last, mappable, result, recorder);
+}
+
+/**
+ Replaces the contents of result with the intervening regions of mappables, retaining the capacity of result.
+ */
+template <typename Range, typename Allocator>
+void extract_intervening_regions(const Range& mappables,
+                                 std::vector<RegionType<typename Range::value_type>, Allocator>& result)
+{
+    detail::CallRecorder recorder {Algorithm::extract_intervening_regions};
+    result.clear();
+    detail::write_intervening_regions(std::cbegin(mappables), std::cend(mappables),
+                                      detail::recording_back_inserter(result, recorder), recorder);
+}
+
+template <typename Range, typename MappableTp, typename Allocator>
+void extract_intervening_regions(const Range& mappables, const MappableTp& mappable,
+                                 std::vector<RegionType<MappableTp>, Allocator>& result)
+{
+    detail::CallRecorder recorder {Algorithm::extract_intervening_regions};
+    result.clear();
+    detail::write_intervening_regions(std::cbegin(mappables), std::cend(mappables), mappable,
+                                      detail::recording_back_inserter(result, recorder), recorder);
+}
+
 // segment_*
 
+/*
+ The segment_* algorithms partition a sorted range into consecutive segments of elements that either overlap
+ (segment_overlapped), or have equal begins, ends or regions. The segment_*_copy algorithms copy each segment
+ into its own vector, while segment_overlapped, segment_by_begin, segment_by_end and segment_by_region return a
+ Segmentation of boundary offsets into the input range, with no elements copied.
+ */
+
+namespace detail {
+
+template <typename MappableTp, typename Allocator>
+using SegmentVector = std::vector<std::vector<MappableTp, RebindAlloc<Allocator, MappableTp>>,
+                                  RebindAlloc<Allocator, std::vector<MappableTp, RebindAlloc<Allocator, MappableTp>>>>;
+
+template <typename MappableTp, typename Allocator>
+SegmentVector<MappableTp, Allocator> make_segment_vector(const Allocator& alloc)
+{
+    return SegmentVector<MappableTp, Allocator> {rebind_alloc<typename SegmentVector<MappableTp, Allocator>::value_type>(alloc)};
+}
+
+// Each *_segment_end returns the end of the segment that starts at first, which must not equal last
+
 template <typename ForwardIt>
-auto segment_overlapped_copy(ForwardIt first, ForwardIt last)
+ForwardIt overlapped_segment_end(ForwardIt first, const ForwardIt last, CallRecorder& recorder)
+{
+    auto rightmost = first;
+    const auto in_segment = scanning_predicate([&rightmost] (const auto& mappable) {
+        return overlaps(mappable, *rightmost) || ends_equal(mappable, *rightmost);
+    }, recorder);
+    const auto extends_segment = counting_compare([] (const auto& lhs, const auto& rhs) {
+        return ends_before(lhs, rhs);
+    }, recorder);
+    while (first != last && in_segment(*first)) {
+        if (extends_segment(*rightmost, *first)) {
+            rightmost = first;
+        }
+        ++first;
+    }
+    return first;
+}
+
+template <typename ForwardIt>
+ForwardIt begin_segment_end(const ForwardIt first, const ForwardIt last, CallRecorder& recorder)
+{
+    return std::find_if_not(std::next(first), last, scanning_predicate([first] (const auto& mappable) {
+        return begins_equal(*first, mappable);
+    }, recorder));
+}
+
+template <typename ForwardIt>
+ForwardIt end_segment_end(const ForwardIt first, const ForwardIt last, CallRecorder& recorder)
+{
+    return std::find_if_not(std::next(first), last, scanning_predicate([first] (const auto& mappable) {
+        return ends_equal(*first, mappable);
+    }, recorder));
+}
+
+template <typename ForwardIt>
+ForwardIt region_segment_end(const ForwardIt first, const ForwardIt last, CallRecorder& recorder)
+{
+    const auto& curr_region = mapped_region(*first);
+    return std::find_if_not(std::next(first), last, scanning_predicate([&curr_region] (const auto& mappable) {
+        return curr_region == mapped_region(mappable);
+    }, recorder));
+}
+
+template <typename ForwardIt, typename SegmentEnd, typename Allocator>
+auto segment_copy(ForwardIt first, const ForwardIt last, SegmentEnd segment_end, const Allocator& alloc)
 {
     using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
     static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
-    std::vector<std::vector<MappableTp>> result {};
+    CallRecorder recorder {Algorithm::segment};
+    auto result = make_segment_vector<MappableTp>(alloc);
     if (first == last) return result;
     result.reserve(std::distance(first, last));
-    auto it        = first;
-    auto rightmost = first;
+    record_allocation(recorder, result);
     while (first != last) {
-        while (it != last && (overlaps(*it, *rightmost) || ends_equal(*it, *rightmost))) {
-            if (ends_before(*rightmost, *it)) {
-                rightmost = it;
-            }
-            ++it;
-        }
-        result.emplace_back(first, it);
-        first     = it;
-        rightmost = it;
+        const auto it = segment_end(first, last, recorder);
+        result.emplace_back(first, it, rebind_alloc<MappableTp>(alloc));
+        record_allocation(recorder, result.back());
+        first = it;
     }
+    const auto prev_capacity = result.capacity();
     result.shrink_to_fit();
+    record_reallocation(recorder, result, prev_capacity);
     return result;
 }
 
+template <typename ForwardIt, typename SegmentEnd>
+Segmentation<ForwardIt> segment(const ForwardIt first, const ForwardIt last, SegmentEnd segment_end)
+{
+    using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
+    static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
+    using Difference = typename Segmentation<ForwardIt>::difference_type;
+    CallRecorder recorder {Algorithm::segment};
+    std::vector<Difference> boundaries {};
+    if (first == last) return Segmentation<ForwardIt> {first, std::move(boundaries)};
+    auto boundary_inserter = recording_back_inserter(boundaries, recorder);
+    *boundary_inserter++ = 0;
+    for (auto segment_begin = first; segment_begin != last;) {
+        const auto it = segment_end(segment_begin, last, recorder);
+        *boundary_inserter++ = boundaries.back() + std::distance(segment_begin, it);
+        segment_begin = it;
+    }
+    return Segmentation<ForwardIt> {first, std::move(boundaries)};
+}
+
+} // namespace detail
+
+template <typename ForwardIt, typename Allocator>
+auto segment_overlapped_copy(std::allocator_arg_t, const Allocator& alloc, ForwardIt first, ForwardIt last)
+{
+    return detail::segment_copy(first, last, detail::overlapped_segment_end<ForwardIt>, alloc);
+}
+
+template <typename ForwardIt>
+auto segment_overlapped_copy(ForwardIt first, ForwardIt last)
+{
+    using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
+    return segment_overlapped_copy(std::allocator_arg, std::allocator<MappableTp> {}, first, last);
+}
+
 template <typename Range>
 auto segment_overlapped_copy(const Range& mappables)
 {
     return segment_overlapped_copy(std::cbegin(mappables), std::cend(mappables));
 }
 
+template <typename Range, typename Allocator>
+auto segment_overlapped_copy(std::allocator_arg_t, const Allocator& alloc, const Range& mappables)
+{
+    return segment_overlapped_copy(std::allocator_arg, alloc, std::cbegin(mappables), std::cend(mappables));
+}
+
 template <typename Range>
 auto segment_by_overlapped_move(Range& mappables)
 {
@@ -1717,24 +2853,29 @@ auto segment_by_overlapped_move(Range& mappables)
                                    std::make_move_iterator(std::end(mappables)));
 }
 
+template <typename ForwardIt>
+Segmentation<ForwardIt> segment_overlapped(ForwardIt first, ForwardIt last)
+{
+    return detail::segment(first, last, detail::overlapped_segment_end<ForwardIt>);
+}
+
+template <typename Range>
+auto segment_overlapped(const Range& mappables)
+{
+    return segment_overlapped(std::cbegin(mappables), std::cend(mappables));
+}
+
+template <typename ForwardIt, typename Allocator>
+auto segment_by_begin_copy(std::allocator_arg_t, const Allocator& alloc, ForwardIt first, ForwardIt last)
+{
+    return detail::segment_copy(first, last, detail::begin_segment_end<ForwardIt>, alloc);
+}
+
 template <typename ForwardIt>
 auto segment_by_begin_copy(ForwardIt first, ForwardIt last)
 {
     using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
-    static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
-    std::vector<std::vector<MappableTp>> result {};
-    if (first == last) return result;
-    result.reserve(std::distance(first, last));
-    while (first != last) {
-        auto it = std::find_if_not(std::next(first), last, [first]
-                                   (const auto& mappable) {
-                                       return begins_equal(*first, mappable);
-                                   });
-        result.emplace_back(first, it);
-        first = it;
-    }
-    result.shrink_to_fit();
-    return result;
+    return segment_by_begin_copy(std::allocator_arg, std::allocator<MappableTp> {}, first, last);
 }
 
 template <typename Range>
@@ -1743,6 +2884,12 @@ auto segment_by_begin_copy(const Range& mappables)
     return segment_by_begin_copy(std::cbegin(mappables), std::cend(mappables));
 }
 
+template <typename Range, typename Allocator>
+auto segment_by_begin_copy(std::allocator_arg_t, const Allocator& alloc, const Range& mappables)
+{
+    return segment_by_begin_copy(std::allocator_arg, alloc, std::cbegin(mappables), std::cend(mappables));
+}
+
 template <typename Range>
 auto segment_by_begin_move(Range& mappables)
 {
@@ -1750,24 +2897,29 @@ auto segment_by_begin_move(Range& mappables)
                                  std::make_move_iterator(std::end(mappables)));
 }
 
+template <typename ForwardIt>
+Segmentation<ForwardIt> segment_by_begin(ForwardIt first, ForwardIt last)
+{
+    return detail::segment(first, last, detail::begin_segment_end<ForwardIt>);
+}
+
+template <typename Range>
+auto segment_by_begin(const Range& mappables)
+{
+    return segment_by_begin(std::cbegin(mappables), std::cend(mappables));
+}
+
+template <typename ForwardIt, typename Allocator>
+auto segment_by_end_copy(std::allocator_arg_t, const Allocator& alloc, ForwardIt first, ForwardIt last)
+{
+    return detail::segment_copy(first, last, detail::end_segment_end<ForwardIt>, alloc);
+}
+
 template <typename ForwardIt>
 auto segment_by_end_copy(ForwardIt first, ForwardIt last)
 {
     using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
-    static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
-    std::vector<std::vector<MappableTp>> result {};
-    if (first == last) return result;
-    result.reserve(std::distance(first, last));
-    while (first != last) {
-        auto it = std::find_if_not(std::next(first), last, [first]
-                                   (const auto& mappable) {
-                                       return ends_equal(*first, mappable);
-                                   });
-        result.emplace_back(first, it);
-        first = it;
-    }
-    result.shrink_to_fit();
-    return result;
+    return segment_by_end_copy(std::allocator_arg, std::allocator<MappableTp> {}, first, last);
 }
 
 template <typename Range>
@@ -1776,6 +2928,12 @@ auto segment_by_end_copy(const Range& mappables)
     return segment_by_end_copy(std::cbegin(mappables), std::cend(mappables));
 }
 
+template <typename Range, typename Allocator>
+auto segment_by_end_copy(std::allocator_arg_t, const Allocator& alloc, const Range& mappables)
+{
+    return segment_by_end_copy(std::allocator_arg, alloc, std::cbegin(mappables), std::cend(mappables));
+}
+
 template <typename Range>
 auto segment_by_end_move(Range& mappables)
 {
@@ -1783,31 +2941,53 @@ auto segment_by_end_move(Range& mappables)
                                std::make_move_iterator(std::end(mappables)));
 }
 
+template <typename ForwardIt>
+Segmentation<ForwardIt> segment_by_end(ForwardIt first, ForwardIt last)
+{
+    return detail::segment(first, last, detail::end_segment_end<ForwardIt>);
+}
+
+template <typename Range>
+auto segment_by_end(const Range& mappables)
+{
+    return segment_by_end(std::cbegin(mappables), std::cend(mappables));
+}
+
+template <typename ForwardIt, typename Allocator>
+auto segment_by_region_copy(std::allocator_arg_t, const Allocator& alloc, ForwardIt first, ForwardIt last)
+{
+    return detail::segment_copy(first, last, detail::region_segment_end<ForwardIt>, alloc);
+}
+
 template <typename ForwardIt>
 auto segment_by_region_copy(ForwardIt first, ForwardIt last)
 {
     using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
-    static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
-    std::vector<std::vector<MappableTp>> result {};
-    if (first == last) return result;
-    result.reserve(std::distance(first, last));
-    while (first != last) {
-        const auto& curr_region = mapped_region(*first);
-        auto it = std::find_if_not(std::next(first), last, [&curr_region]
-                                   (const auto& mappable) {
-                                       return curr_region == mapped_region(mappable);
-                                   });
-        result.emplace_back(first, it);
-        first = it;
-    }
-    result.shrink_to_fit();
-    return result;
+    return segment_by_region_copy(std::allocator_arg, std::allocator<MappableTp> {}, first, last);
 }
 
 template <typename Range>
 auto segment_by_region_copy(const Range& mappables)
 {
-    return segment_equal(std::cbegin(mappables), std::cend(mappables));
+    return segment_by_region_copy(std::cbegin(mappables), std::cend(mappables));
+}
+
+template <typename Range, typename Allocator>
+auto segment_by_region_copy(std::allocator_arg_t, const Allocator& alloc, const Range& mappables)
+{
+    return segment_by_region_copy(std::allocator_arg, alloc, std::cbegin(mappables), std::cend(mappables));
+}
+
+template <typename ForwardIt>
+Segmentation<ForwardIt> segment_by_region(ForwardIt first, ForwardIt last)
+{
+    return detail::segment(first, last, detail::region_segment_end<ForwardIt>);
+}
+
+template <typename Range>
+auto segment_by_region(const Range& mappables)
+{
+    return segment_by_region(std::cbegin(mappables), std::cend(mappables));
 }
 
 template <typename MappableTp>
@@ -1822,33 +3002,63 @@ auto all_segment_regions(const std::vector<std::vector<MappableTp>>& segments)
     return result;
 }
 
+template <typename Iterator>
+auto all_segment_regions(const Segmentation<Iterator>& segments)
+{
+    using MappableTp = typename std::iterator_traits<Iterator>::value_type;
+    static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
+    std::vector<RegionType<MappableTp>> result {};
+    result.reserve(segments.size());
+    for (const auto& segment : segments) {
+        result.push_back(encompassing_region(std::cbegin(segment), std::cend(segment)));
+    }
+    return result;
+}
+
 // calculate_positional_coverage
 
 /**
  Returns the number of elements that overlap each position within region.
+ 
+ Coverage is accumulated in a difference array (+1 at each element begin and -1 at each element end)
+ which is prefix summed once, so this is O(n + region_size(region)) rather than O(n * element size).
  */
-template <typename ForwardIt, typename RegionTp,
+template <typename ForwardIt, typename RegionTp, typename Allocator,
           typename = EnableIfRegionOrMappable<typename std::iterator_traits<ForwardIt>::value_type>>
-auto calculate_positional_coverage(ForwardIt first, ForwardIt last, const RegionTp& region)
+auto calculate_positional_coverage(std::allocator_arg_t, const Allocator& alloc,
+                                   ForwardIt first, ForwardIt last, const RegionTp& region)
 {
     using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
     static_assert(std::is_same<RegionType<MappableTp>, RegionType<RegionTp>>::value,
                   "RegionType mismatch");
-    using std::next; using std::min;
     const auto num_positions = region_size(region);
-    std::vector<unsigned> result(num_positions, 0);
-    const auto result_begin_itr = std::begin(result);
+    // + 1 for elements ending at the region end
+    detail::CallRecorder recorder {Algorithm::calculate_positional_coverage};
+    std::vector<unsigned, RebindAlloc<Allocator, unsigned>> result(num_positions + 1, 0, rebind_alloc<unsigned>(alloc));
+    detail::record_allocation(recorder, result);
     const auto first_position = mapped_begin(region);
-    std::for_each(first, last, [=] (const auto& mappable) {
-        const auto it1 = next(result_begin_itr,
-                              (mapped_begin(mappable) <= first_position)
-                              ? 0 : mapped_begin(mappable) - first_position);
-        const auto it2 = next(result_begin_itr, min(mapped_end(mappable) - first_position, num_positions));
-        std::transform(it1, it2, it1, [] (const auto count) { return count + 1; });
+    const auto last_position  = mapped_end(region);
+    std::for_each(first, last, [&] (const auto& mappable) {
+        recorder.scanned();
+        const auto begin = std::max(mapped_begin(mappable), first_position);
+        const auto end   = std::min(mapped_end(mappable), last_position);
+        if (begin < end) {
+            ++result[begin - first_position];
+            --result[end - first_position]; // unsigned wrap around is undone by the prefix sum
+        }
     });
+    std::partial_sum(std::cbegin(result), std::cend(result), std::begin(result));
+    result.pop_back();
     return result;
 }
 
+template <typename ForwardIt, typename RegionTp,
+          typename = EnableIfRegionOrMappable<typename std::iterator_traits<ForwardIt>::value_type>>
+auto calculate_positional_coverage(ForwardIt first, ForwardIt last, const RegionTp& region)
+{
+    return calculate_positional_coverage(std::allocator_arg, std::allocator<unsigned> {}, first, last, region);
+}
+
 template <typename ForwardIt,
           typename = EnableIfRegionOrMappable<typename std::iterator_traits<ForwardIt>::value_type>>
 auto calculate_positional_coverage(ForwardIt first, ForwardIt last)
@@ -1856,8 +3066,31 @@ auto calculate_positional_coverage(ForwardIt first, ForwardIt last)
     return calculate_positional_coverage(first, last, encompassing_region(first, last));
 }
 
+template <typename ForwardIt, typename Allocator,
+          typename = EnableIfRegionOrMappable<typename std::iterator_traits<ForwardIt>::value_type>>
+auto calculate_positional_coverage(std::allocator_arg_t, const Allocator& alloc, ForwardIt first, ForwardIt last)
+{
+    return calculate_positional_coverage(std::allocator_arg, alloc, first, last, encompassing_region(first, last));
+}
+
+template <typename Range, typename Allocator,
+          typename = EnableIfRegionOrMappable<typename Range::value_type>>
+auto calculate_positional_coverage(std::allocator_arg_t, const Allocator& alloc, const Range& mappables)
+{
+    return calculate_positional_coverage(std::allocator_arg, alloc, std::cbegin(mappables), std::cend(mappables));
+}
+
+template <typename Range, typename RegionTp, typename Allocator,
+          typename = EnableIfRegionOrMappable<typename Range::value_type>>
+auto calculate_positional_coverage(std::allocator_arg_t, const Allocator& alloc,
+                                   const Range& mappables, const RegionTp& region)
+{
+    const auto overlapped = overlap_range(mappables, region);
+    return calculate_positional_coverage(std::allocator_arg, alloc, std::cbegin(overlapped), std::cend(overlapped), region);
+}
+
 template <typename Range,
-          typename = EnableIfMappable<typename Range::value_type>>
+          typename = EnableIfRegionOrMappable<typename Range::value_type>>
 auto calculate_positional_coverage(const Range& mappables)
 {
     return calculate_positional_coverage(std::cbegin(mappables), std::cend(mappables));
@@ -1871,6 +3104,167 @@ auto calculate_positional_coverage(const Range& mappables, const RegionTp& regio
     return calculate_positional_coverage(std::cbegin(overlapped), std::cend(overlapped), region);
 }
 
+// calculate_coverage_runs
+
+namespace detail {
+
+inline ContigRegion make_sub_region(const ContigRegion&, ContigRegion::Position begin, ContigRegion::Position end)
+{
+    return ContigRegion {begin, end};
+}
+
+inline GenomicRegion make_sub_region(const GenomicRegion& base, GenomicRegion::Position begin, GenomicRegion::Position end)
+{
+    return GenomicRegion {base.contig_key(), begin, end};
+}
+
+inline bool is_same_contig_or_contig_region(const ContigRegion&, const ContigRegion&) noexcept
+{
+    return true;
+}
+
+inline bool is_same_contig_or_contig_region(const GenomicRegion& lhs, const GenomicRegion& rhs) noexcept
+{
+    return is_same_contig(lhs, rhs);
+}
+
+} // namespace detail
+
+namespace detail {
+
+/*
+ Sweeps the clamped begins and ends of the elements in [first, last) over [first_position, last_position),
+ writing the maximal runs of constant coverage as breakpoints (run i is [breakpoints[i], breakpoints[i + 1]))
+ and depths. Nothing is written if the interval is empty.
+ */
+template <typename ForwardIt, typename Position, typename PositionAllocator, typename DepthAllocator>
+void sweep_coverage(ForwardIt first, ForwardIt last, const Position first_position, const Position last_position,
+                    std::vector<Position, PositionAllocator>& breakpoints,
+                    std::vector<unsigned, DepthAllocator>& depths, CallRecorder& recorder)
+{
+    const auto position_alloc = recording_alloc<Position>(breakpoints.get_allocator(), recorder);
+    std::vector<Position, RecordingAlloc<PositionAllocator, Position>> begins {position_alloc}, ends {position_alloc};
+    std::for_each(first, last, [&] (const auto& mappable) {
+        recorder.scanned();
+        const auto begin = std::max(static_cast<Position>(mapped_begin(mappable)), first_position);
+        const auto end   = std::min(static_cast<Position>(mapped_end(mappable)), last_position);
+        if (begin < end) {
+            begins.push_back(begin);
+            ends.push_back(end);
+        }
+    });
+    const auto less = counting_compare(std::less<> {}, recorder);
+    if (!std::is_sorted(std::cbegin(begins), std::cend(begins), less)) {
+        std::sort(std::begin(begins), std::end(begins), less);
+    }
+    std::sort(std::begin(ends), std::end(ends), less);
+    auto breakpoint_inserter = recording_back_inserter(breakpoints, recorder);
+    auto depth_inserter      = recording_back_inserter(depths, recorder);
+    auto begin_itr = std::cbegin(begins);
+    auto end_itr   = std::cbegin(ends);
+    unsigned depth {0};
+    for (auto run_begin = first_position; run_begin < last_position;) {
+        for (; begin_itr != std::cend(begins) && *begin_itr == run_begin; ++begin_itr) ++depth;
+        for (; end_itr != std::cend(ends) && *end_itr == run_begin; ++end_itr) --depth;
+        auto run_end = last_position;
+        if (begin_itr != std::cend(begins)) run_end = std::min(run_end, *begin_itr);
+        if (end_itr != std::cend(ends)) run_end = std::min(run_end, *end_itr);
+        if (depths.empty() || depths.back() != depth) {
+            *breakpoint_inserter++ = run_begin;
+            *depth_inserter++ = depth;
+        }
+        run_begin = run_end;
+    }
+    if (!depths.empty()) *breakpoint_inserter++ = last_position;
+}
+
+} // namespace detail
+
+/**
+ Returns the run-length encoded positional coverage within region, i.e. the maximal sub-regions of region
+ with constant coverage, paired with their coverage. The runs are sorted and partition region; uncovered
+ positions are reported as runs with zero coverage.
+ 
+ This is O(n log n) in the number of elements and independent of region_size(region).
+ */
+template <typename ForwardIt, typename RegionTp, typename Allocator,
+          typename = EnableIfRegionOrMappable<typename std::iterator_traits<ForwardIt>::value_type>>
+auto calculate_coverage_runs(std::allocator_arg_t, const Allocator& alloc,
+                             ForwardIt first, ForwardIt last, const RegionTp& region)
+{
+    using MappableTp = typename std::iterator_traits<ForwardIt>::value_type;
+    static_assert(std::is_same<RegionType<MappableTp>, RegionType<RegionTp>>::value,
+                  "RegionType mismatch");
+    using Position = typename RegionType<RegionTp>::Position;
+    using Run = std::pair<RegionType<RegionTp>, unsigned>;
+    detail::CallRecorder recorder {Algorithm::calculate_coverage_runs};
+    std::vector<Position, RebindAlloc<Allocator, Position>> breakpoints {rebind_alloc<Position>(alloc)};
+    std::vector<unsigned, RebindAlloc<Allocator, unsigned>> depths {rebind_alloc<unsigned>(alloc)};
+    detail::sweep_coverage(first, last, static_cast<Position>(mapped_begin(region)),
+                           static_cast<Position>(mapped_end(region)), breakpoints, depths, recorder);
+    std::vector<Run, RebindAlloc<Allocator, Run>> result {rebind_alloc<Run>(alloc)};
+    result.reserve(depths.size());
+    detail::record_allocation(recorder, result);
+    const auto& base = mapped_region(region);
+    for (std::size_t i {0}; i < depths.size(); ++i) {
+        result.emplace_back(detail::make_sub_region(base, breakpoints[i], breakpoints[i + 1]), depths[i]);
+    }
+    return result;
+}
+
+template <typename ForwardIt, typename RegionTp,
+          typename = EnableIfRegionOrMappable<typename std::iterator_traits<ForwardIt>::value_type>>
+auto calculate_coverage_runs(ForwardIt first, ForwardIt last, const RegionTp& region)
+{
+    using Run = std::pair<RegionType<RegionTp>, unsigned>;
+    return calculate_coverage_runs(std::allocator_arg, std::allocator<Run> {}, first, last, region);
+}
+
+template <typename ForwardIt,
+          typename = EnableIfRegionOrMappable<typename std::iterator_traits<ForwardIt>::value_type>>
+auto calculate_coverage_runs(ForwardIt first, ForwardIt last)
+{
+    return calculate_coverage_runs(first, last, encompassing_region(first, last));
+}
+
+template <typename Range,
+          typename = EnableIfRegionOrMappable<typename Range::value_type>>
+auto calculate_coverage_runs(const Range& mappables)
+{
+    return calculate_coverage_runs(std::cbegin(mappables), std::cend(mappables));
+}
+
+template <typename Range, typename RegionTp,
+          typename = EnableIfRegionOrMappable<typename Range::value_type>>
+auto calculate_coverage_runs(const Range& mappables, const RegionTp& region)
+{
+    const auto overlapped = overlap_range(mappables, region);
+    return calculate_coverage_runs(std::cbegin(overlapped), std::cend(overlapped), region);
+}
+
+template <typename ForwardIt, typename Allocator,
+          typename = EnableIfRegionOrMappable<typename std::iterator_traits<ForwardIt>::value_type>>
+auto calculate_coverage_runs(std::allocator_arg_t, const Allocator& alloc, ForwardIt first, ForwardIt last)
+{
+    return calculate_coverage_runs(std::allocator_arg, alloc, first, last, encompassing_region(first, last));
+}
+
+template <typename Range, typename Allocator,
+          typename = EnableIfRegionOrMappable<typename Range::value_type>>
+auto calculate_coverage_runs(std::allocator_arg_t, const Allocator& alloc, const Range& mappables)
+{
+    return calculate_coverage_runs(std::allocator_arg, alloc, std::cbegin(mappables), std::cend(mappables));
+}
+
+template <typename Range, typename RegionTp, typename Allocator,
+          typename = EnableIfRegionOrMappable<typename Range::value_type>>
+auto calculate_coverage_runs(std::allocator_arg_t, const Allocator& alloc,
+                             const Range& mappables, const RegionTp& region)
+{
+    const auto overlapped = overlap_range(mappables, region);
+    return calculate_coverage_runs(std::allocator_arg, alloc, std::cbegin(overlapped), std::cend(overlapped), region);
+}
+
 template <typename ForwardIt, typename RegionTp,
           typename = EnableIfRegionOrMappable<typename std::iterator_traits<ForwardIt>::value_type>>
 auto calculate_positional_seeds(ForwardIt first, ForwardIt last, const RegionTp& region)
@@ -1938,8 +3332,10 @@ template <typename Range, typename RegionTp,
 unsigned min_coverage(const Range& mappables, const RegionTp& region)
 {
     if (mappables.empty() || is_empty(region)) return 0;
-    const auto positional_coverage = calculate_positional_coverage(mappables, region);
-    return *std::min_element(std::cbegin(positional_coverage), std::cend(positional_coverage));
+    const auto runs = calculate_coverage_runs(mappables, region);
+    if (runs.empty()) return 0;
+    return std::min_element(std::cbegin(runs), std::cend(runs),
+                            [] (const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; })->second;
 }
 
 template <typename Range,
@@ -1948,8 +3344,10 @@ template <typename Range,
 unsigned min_coverage(const Range& mappables)
 {
     if (mappables.empty()) return 0;
-    const auto positional_coverage = calculate_positional_coverage(mappables);
-    return *std::min_element(std::cbegin(positional_coverage), std::cend(positional_coverage));
+    const auto runs = calculate_coverage_runs(mappables);
+    if (runs.empty()) return 0;
+    return std::min_element(std::cbegin(runs), std::cend(runs),
+                            [] (const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; })->second;
 }
 
 template <typename Range, typename RegionTp,
@@ -1958,8 +3356,10 @@ template <typename Range, typename RegionTp,
 unsigned max_coverage(const Range& mappables, const RegionTp& region)
 {
     if (mappables.empty() || is_empty(region)) return 0;
-    const auto positional_coverage = calculate_positional_coverage(mappables, region);
-    return *std::max_element(std::cbegin(positional_coverage), std::cend(positional_coverage));
+    const auto runs = calculate_coverage_runs(mappables, region);
+    if (runs.empty()) return 0;
+    return std::max_element(std::cbegin(runs), std::cend(runs),
+                            [] (const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; })->second;
 }
 
 template <typename Range,
@@ -1968,35 +3368,70 @@ template <typename Range,
 unsigned max_coverage(const Range& mappables)
 {
     if (mappables.empty()) return 0;
-    const auto positional_coverage = calculate_positional_coverage(mappables);
-    return *std::max_element(std::cbegin(positional_coverage), std::cend(positional_coverage));
+    const auto runs = calculate_coverage_runs(mappables);
+    if (runs.empty()) return 0;
+    return std::max_element(std::cbegin(runs), std::cend(runs),
+                            [] (const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; })->second;
 }
 
 // join_if
 
-template <typename ForwardIt, typename BinaryPredicate>
-auto join_if(ForwardIt first, const ForwardIt last, BinaryPredicate pred)
+/**
+ Writes the regions formed by joining adjacent elements of [first, last) that satisfy pred to result.
+ */
+template <typename ForwardIt, typename BinaryPredicate, typename OutputIt>
+OutputIt join_if(ForwardIt first, const ForwardIt last, BinaryPredicate pred, OutputIt result)
 {
-    std::vector<GenomicRegion> result {};
     if (first == last) return result;
-    result.reserve(std::distance(first, last));
     auto prev = first++, leftmost = prev;
     for (; first != last; ++first, ++prev) {
         if (!pred(*prev, *first)) {
-            result.push_back(closed_region(*leftmost, *prev));
+            *result++ = closed_region(*leftmost, *prev);
             leftmost = first;
         }
     }
-    result.push_back(closed_region(*leftmost, *prev));
+    *result++ = closed_region(*leftmost, *prev);
+    return result;
+}
+
+template <typename ForwardIt, typename BinaryPredicate, typename Allocator>
+auto join_if(std::allocator_arg_t, const Allocator& alloc, ForwardIt first, const ForwardIt last, BinaryPredicate pred)
+{
+    std::vector<GenomicRegion, RebindAlloc<Allocator, GenomicRegion>> result {rebind_alloc<GenomicRegion>(alloc)};
+    if (first == last) return result;
+    result.reserve(std::distance(first, last));
+    join_if(first, last, pred, std::back_inserter(result));
     return result;
 }
 
+template <typename ForwardIt, typename BinaryPredicate>
+auto join_if(ForwardIt first, const ForwardIt last, BinaryPredicate pred)
+{
+    return join_if(std::allocator_arg, std::allocator<GenomicRegion> {}, first, last, pred);
+}
+
 template <typename Range, typename BinaryPredicate>
 auto join_if(const Range& regions, BinaryPredicate pred)
 {
     return join_if(std::cbegin(regions), std::cend(regions), pred);
 }
 
+template <typename Range, typename BinaryPredicate, typename Allocator>
+auto join_if(std::allocator_arg_t, const Allocator& alloc, const Range& regions, BinaryPredicate pred)
+{
+    return join_if(std::allocator_arg, alloc, std::cbegin(regions), std::cend(regions), pred);
+}
+
+/**
+ Replaces the contents of result with the joined regions, retaining the capacity of result.
+ */
+template <typename Range, typename BinaryPredicate, typename Allocator>
+void join_if(const Range& regions, BinaryPredicate pred, std::vector<GenomicRegion, Allocator>& result)
+{
+    result.clear();
+    join_if(std::cbegin(regions), std::cend(regions), pred, std::back_inserter(result));
+}
+
 template <typename ForwardIt>
 auto join(ForwardIt first, const ForwardIt last, const GenomicRegion::Distance n)
 {
@@ -2011,41 +3446,68 @@ auto join(const Range& regions, const GenomicRegion::Distance n)
 
 namespace detail {
 
-inline void append(const ContigRegion& base, ContigRegion::Position begin, ContigRegion::Position end,
-                   std::vector<ContigRegion>& result)
+template <typename Allocator>
+void append(const ContigRegion&, ContigRegion::Position begin, ContigRegion::Position end,
+            std::vector<ContigRegion, Allocator>& result)
 {
     result.emplace_back(begin, end);
 }
 
-inline void append(const GenomicRegion& base, GenomicRegion::Position begin, GenomicRegion::Position end,
-                   std::vector<GenomicRegion>& result)
+template <typename Allocator>
+void append(const GenomicRegion& base, GenomicRegion::Position begin, GenomicRegion::Position end,
+            std::vector<GenomicRegion, Allocator>& result)
 {
-    result.emplace_back(base.contig_name(), begin, end);
+    result.emplace_back(base.contig_key(), begin, end);
 }
 
-} // namespace detail
-
-// select_regions: returns minimal subset of regions defined by each element in a range.
-
-template <typename Region, typename ForwardIt,
-          typename = std::enable_if_t<std::is_same<typename std::iterator_traits<ForwardIt>::value_type, bool>::value>>
-std::vector<Region> select_regions(const Region& region, const ForwardIt first, const ForwardIt last)
+template <typename Region, typename ForwardIt, typename UnaryPredicate, typename Allocator>
+auto select_regions(const Region& region, const ForwardIt first, const ForwardIt last, UnaryPredicate pred,
+                    const Allocator& alloc)
 {
     static_assert(is_region<Region>, "must be ContigRegion or GenomicRegion");
     assert(static_cast<typename Region::Size>(std::distance(first, last)) == size(region));
-    std::vector<Region> result {};
+    CallRecorder recorder {Algorithm::select_regions};
+    std::vector<Region, RebindAlloc<Allocator, Region>> result {rebind_alloc<Region>(alloc)};
     result.reserve(std::distance(first, last) / 2); // max possible
-    auto itr = std::find(first, last, true);
+    record_allocation(recorder, result);
+    const auto is_selected = scanning_predicate(std::move(pred), recorder);
+    auto itr = std::find_if(first, last, is_selected);
     for (; itr != last;) {
-        const auto itr2 = std::find(itr, last, false);
+        const auto itr2 = std::find_if_not(itr, last, is_selected);
         const auto begin = region.begin() + std::distance(first, itr);
         const auto end   = begin + std::distance(itr, itr2);
-        detail::append(region, begin, end, result);
-        itr = std::find(itr2, last, true);
+        append(region, begin, end, result);
+        itr = std::find_if(itr2, last, is_selected);
     }
     return result;
 }
 
+} // namespace detail
+
+// select_regions: returns minimal subset of regions defined by each element in a range.
+
+template <typename Region, typename ForwardIt, typename Allocator,
+          typename = std::enable_if_t<std::is_same<typename std::iterator_traits<ForwardIt>::value_type, bool>::value>>
+auto select_regions(std::allocator_arg_t, const Allocator& alloc,
+                    const Region& region, const ForwardIt first, const ForwardIt last)
+{
+    return detail::select_regions(region, first, last, [] (const bool selected) { return selected; }, alloc);
+}
+
+template <typename Region, typename ForwardIt,
+          typename = std::enable_if_t<std::is_same<typename std::iterator_traits<ForwardIt>::value_type, bool>::value>>
+std::vector<Region> select_regions(const Region& region, const ForwardIt first, const ForwardIt last)
+{
+    return select_regions(std::allocator_arg, std::allocator<Region> {}, region, first, last);
+}
+
+template <typename Region, typename Range, typename Allocator,
+          typename = std::enable_if_t<std::is_same<typename Range::value_type, bool>::value>>
+auto select_regions(std::allocator_arg_t, const Allocator& alloc, const Region& region, const Range& selections)
+{
+    return select_regions(std::allocator_arg, alloc, region, std::cbegin(selections), std::cend(selections));
+}
+
 template <typename Region, typename Range,
           typename = std::enable_if_t<std::is_same<typename Range::value_type, bool>::value>>
 auto select_regions(const Region& region, const Range& selections)
@@ -2053,22 +3515,25 @@ auto select_regions(const Region& region, const Range& selections)
     return select_regions(region, std::cbegin(selections), std::cend(selections));
 }
 
-template <typename Region, typename ForwardIt, typename UnaryPredicate>
+template <typename Region, typename ForwardIt, typename UnaryPredicate, typename Allocator>
+auto select_regions(std::allocator_arg_t, const Allocator& alloc,
+                    const Region& region, const ForwardIt first, const ForwardIt last, UnaryPredicate pred)
+{
+    return detail::select_regions(region, first, last, std::move(pred), alloc);
+}
+
+template <typename Region, typename ForwardIt, typename UnaryPredicate,
+          typename = std::enable_if_t<is_region<Region>>>
 std::vector<Region> select_regions(const Region& region, const ForwardIt first, const ForwardIt last, UnaryPredicate pred)
 {
-    static_assert(is_region<Region>, "must be ContigRegion or GenomicRegion");
-    assert(std::distance(first, last) == size(region));
-    std::vector<Region> result {};
-    result.reserve(std::distance(first, last) / 2); // max possible
-    auto itr = std::find_if(first, last, pred);
-    for (; itr != last;) {
-        const auto itr2 = std::find_if_not(itr, last, pred);
-        const auto begin = region.begin() + std::distance(first, itr);
-        const auto end   = begin + std::distance(itr, itr2);
-        detail::append(region, begin, end, result);
-        itr = std::find_if(itr2, last, pred);
-    }
-    return result;
+    return select_regions(std::allocator_arg, std::allocator<Region> {}, region, first, last, std::move(pred));
+}
+
+template <typename Region, typename Range, typename UnaryPredicate, typename Allocator>
+auto select_regions(std::allocator_arg_t, const Allocator& alloc,
+                    const Region& region, const Range& values, UnaryPredicate pred)
+{
+    return select_regions(std::allocator_arg, alloc, region, std::cbegin(values), std::cend(values), std::move(pred));
 }
 
 template <typename Region, typename Range, typename UnaryPredicate>
@@ -0,0 +1,485 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef mappable_bucketed_multi_set_hpp
+#define mappable_bucketed_multi_set_hpp
+
+#include <memory>
+#include <algorithm>
+#include <iterator>
+#include <initializer_list>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include "mappable.hpp"
+#include "mappable_range.hpp"
+#include "mappable_algorithms.hpp"
+#include "mappable_flat_multi_set.hpp"
+#include "type_tricks.hpp"
+
+namespace mappable {
+
+/*
+ MappableBucketedMultiSet partitions MappableType elements by region size into power-of-two size classes,
+ each stored in its own MappableFlatMultiSet. Bucket 0 holds empty elements and bucket k > 0 holds
+ elements with size in [2^(k - 1), 2^k).
+
+ Each bucket bounds its overlap searches by its own largest element, so a few very large elements only
+ slow down queries on their own bucket rather than on every element. Queries are answered by combining
+ the results from each bucket; overlap_ranges and contained_ranges return one range per non-empty bucket,
+ while the copy_* methods merge these into a single sorted vector. Iteration visits each bucket in turn, so
+ elements are sorted within a bucket but not across buckets. Every bucket uses a copy of the set's allocator.
+ */
+template <typename MappableType, typename Allocator = std::allocator<MappableType>>
+class MappableBucketedMultiSet
+{
+public:
+    using bucket_type     = MappableFlatMultiSet<MappableType, Allocator>;
+    using allocator_type  = Allocator;
+    using value_type      = MappableType;
+    using size_type       = std::size_t;
+    using const_reference = const MappableType&;
+    using bucket_const_iterator = typename bucket_type::const_iterator;
+
+    class const_iterator;
+    using iterator = const_iterator;
+
+    MappableBucketedMultiSet();
+    explicit MappableBucketedMultiSet(const allocator_type& alloc);
+
+    template <typename InputIterator>
+    MappableBucketedMultiSet(InputIterator first, InputIterator last);
+    template <typename InputIterator>
+    MappableBucketedMultiSet(InputIterator first, InputIterator last, const allocator_type& alloc);
+
+    MappableBucketedMultiSet(std::initializer_list<MappableType> mappables);
+
+    MappableBucketedMultiSet(const MappableBucketedMultiSet&)            = default;
+    MappableBucketedMultiSet& operator=(const MappableBucketedMultiSet&) = default;
+    MappableBucketedMultiSet(MappableBucketedMultiSet&&)                 = default;
+    MappableBucketedMultiSet& operator=(MappableBucketedMultiSet&&)      = default;
+
+    ~MappableBucketedMultiSet() = default;
+
+    const_iterator begin() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cend() const noexcept;
+
+    template <typename ...Args>
+    void emplace(Args&&...);
+    void insert(const MappableType&);
+    void insert(MappableType&&);
+    template <typename InputIterator>
+    void insert(InputIterator, InputIterator);
+    size_type erase(const MappableType&);
+
+    void clear();
+
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+
+    allocator_type get_allocator() const noexcept;
+
+    size_type bucket_count() const noexcept;
+    const bucket_type& bucket(size_type n) const;
+    static size_type bucket_index(typename RegionType<MappableType>::Size region_size) noexcept;
+
+    template <typename MappableType_>
+    bool has_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    size_type count_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    std::vector<OverlapRange<bucket_const_iterator>> overlap_ranges(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    std::vector<MappableType> copy_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    void erase_overlapped(const MappableType_& mappable);
+
+    template <typename MappableType_>
+    bool has_contained(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    size_type count_contained(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    std::vector<ContainedRange<bucket_const_iterator>> contained_ranges(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    std::vector<MappableType> copy_contained(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    void erase_contained(const MappableType_& mappable);
+
+private:
+    using BucketVector = std::vector<bucket_type, RebindAlloc<Allocator, bucket_type>>;
+
+    BucketVector buckets_;
+    size_type size_;
+
+    bucket_type& get_bucket(const MappableType& mappable);
+    template <typename MappableType_>
+    size_type num_contained_buckets(const MappableType_& mappable) const noexcept;
+};
+
+/*
+ Visits the elements of each non-empty bucket in turn, from bucket 0 upwards.
+ */
+template <typename MappableType, typename Allocator>
+class MappableBucketedMultiSet<MappableType, Allocator>::const_iterator
+    : public boost::iterator_facade<const_iterator, const MappableType, boost::forward_traversal_tag>
+{
+public:
+    const_iterator() = default;
+
+private:
+    friend class boost::iterator_core_access;
+    friend class MappableBucketedMultiSet;
+
+    using BucketIterator = typename BucketVector::const_iterator;
+
+    BucketIterator bucket_, last_bucket_;
+    bucket_const_iterator element_;
+
+    const_iterator(BucketIterator bucket, BucketIterator last_bucket) noexcept
+    : bucket_ {bucket}
+    , last_bucket_ {last_bucket}
+    , element_ {}
+    {
+        skip_empty_buckets();
+    }
+
+    void skip_empty_buckets() noexcept
+    {
+        bucket_ = std::find_if(bucket_, last_bucket_, [] (const auto& bucket) { return !bucket.empty(); });
+        if (bucket_ != last_bucket_) element_ = std::cbegin(*bucket_);
+    }
+
+    const MappableType& dereference() const noexcept
+    {
+        return *element_;
+    }
+
+    void increment() noexcept
+    {
+        if (++element_ == std::cend(*bucket_)) {
+            ++bucket_;
+            skip_empty_buckets();
+        }
+    }
+
+    bool equal(const const_iterator& other) const noexcept
+    {
+        return bucket_ == other.bucket_ && (bucket_ == last_bucket_ || element_ == other.element_);
+    }
+};
+
+template <typename MappableType, typename Allocator>
+MappableBucketedMultiSet<MappableType, Allocator>::MappableBucketedMultiSet()
+: MappableBucketedMultiSet {allocator_type {}}
+{}
+
+template <typename MappableType, typename Allocator>
+MappableBucketedMultiSet<MappableType, Allocator>::MappableBucketedMultiSet(const allocator_type& alloc)
+: buckets_ {rebind_alloc<bucket_type>(alloc)}
+, size_ {0}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableBucketedMultiSet<MappableType, Allocator>::MappableBucketedMultiSet(InputIterator first, InputIterator last)
+: MappableBucketedMultiSet {first, last, allocator_type {}}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableBucketedMultiSet<MappableType, Allocator>::MappableBucketedMultiSet(InputIterator first, InputIterator last,
+                                                                            const allocator_type& alloc)
+: MappableBucketedMultiSet {alloc}
+{
+    insert(first, last);
+}
+
+template <typename MappableType, typename Allocator>
+MappableBucketedMultiSet<MappableType, Allocator>::MappableBucketedMultiSet(std::initializer_list<MappableType> mappables)
+: MappableBucketedMultiSet {std::begin(mappables), std::end(mappables)}
+{}
+
+template <typename MappableType, typename Allocator>
+typename MappableBucketedMultiSet<MappableType, Allocator>::const_iterator
+MappableBucketedMultiSet<MappableType, Allocator>::begin() const noexcept
+{
+    return const_iterator {std::cbegin(buckets_), std::cend(buckets_)};
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableBucketedMultiSet<MappableType, Allocator>::const_iterator
+MappableBucketedMultiSet<MappableType, Allocator>::cbegin() const noexcept
+{
+    return begin();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableBucketedMultiSet<MappableType, Allocator>::const_iterator
+MappableBucketedMultiSet<MappableType, Allocator>::end() const noexcept
+{
+    return const_iterator {std::cend(buckets_), std::cend(buckets_)};
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableBucketedMultiSet<MappableType, Allocator>::const_iterator
+MappableBucketedMultiSet<MappableType, Allocator>::cend() const noexcept
+{
+    return end();
+}
+
+template <typename MappableType, typename Allocator>
+template <typename ...Args>
+void MappableBucketedMultiSet<MappableType, Allocator>::emplace(Args&&... args)
+{
+    insert(MappableType {std::forward<Args>(args)...});
+}
+
+template <typename MappableType, typename Allocator>
+void MappableBucketedMultiSet<MappableType, Allocator>::insert(const MappableType& mappable)
+{
+    get_bucket(mappable).insert(mappable);
+    ++size_;
+}
+
+template <typename MappableType, typename Allocator>
+void MappableBucketedMultiSet<MappableType, Allocator>::insert(MappableType&& mappable)
+{
+    get_bucket(mappable).insert(std::move(mappable));
+    ++size_;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+void MappableBucketedMultiSet<MappableType, Allocator>::insert(InputIterator first, InputIterator last)
+{
+    // Bulk insert each bucket so the buckets only sort once
+    std::vector<std::vector<MappableType>> partitions(buckets_.size());
+    std::for_each(first, last, [&partitions] (const auto& mappable) {
+        const auto n = bucket_index(region_size(mappable));
+        if (n >= partitions.size()) partitions.resize(n + 1);
+        partitions[n].push_back(mappable);
+    });
+    if (partitions.size() > buckets_.size()) buckets_.resize(partitions.size(), bucket_type {get_allocator()});
+    for (size_type n {0}; n < partitions.size(); ++n) {
+        if (!partitions[n].empty()) {
+            buckets_[n].insert(std::cbegin(partitions[n]), std::cend(partitions[n]));
+            size_ += partitions[n].size();
+        }
+    }
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableBucketedMultiSet<MappableType, Allocator>::size_type
+MappableBucketedMultiSet<MappableType, Allocator>::erase(const MappableType& mappable)
+{
+    const auto n = bucket_index(region_size(mappable));
+    if (n >= buckets_.size()) return 0;
+    const auto result = buckets_[n].erase(mappable);
+    size_ -= result;
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+void MappableBucketedMultiSet<MappableType, Allocator>::clear()
+{
+    buckets_.clear();
+    size_ = 0;
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableBucketedMultiSet<MappableType, Allocator>::size_type
+MappableBucketedMultiSet<MappableType, Allocator>::size() const noexcept
+{
+    return size_;
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableBucketedMultiSet<MappableType, Allocator>::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableBucketedMultiSet<MappableType, Allocator>::allocator_type
+MappableBucketedMultiSet<MappableType, Allocator>::get_allocator() const noexcept
+{
+    return allocator_type {buckets_.get_allocator()};
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableBucketedMultiSet<MappableType, Allocator>::size_type
+MappableBucketedMultiSet<MappableType, Allocator>::bucket_count() const noexcept
+{
+    return buckets_.size();
+}
+
+template <typename MappableType, typename Allocator>
+const typename MappableBucketedMultiSet<MappableType, Allocator>::bucket_type&
+MappableBucketedMultiSet<MappableType, Allocator>::bucket(const size_type n) const
+{
+    if (n < buckets_.size()) {
+        return buckets_[n];
+    } else {
+        throw std::out_of_range {"MappableBucketedMultiSet"};
+    }
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableBucketedMultiSet<MappableType, Allocator>::size_type
+MappableBucketedMultiSet<MappableType, Allocator>::bucket_index(typename RegionType<MappableType>::Size region_size) noexcept
+{
+    size_type result {0};
+    for (; region_size > 0; region_size >>= 1) ++result;
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+bool MappableBucketedMultiSet<MappableType, Allocator>::has_overlapped(const MappableType_& mappable) const
+{
+    return std::any_of(std::cbegin(buckets_), std::cend(buckets_),
+                       [&mappable] (const auto& bucket) {
+                           return !bucket.empty() && bucket.has_overlapped(mappable);
+                       });
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableBucketedMultiSet<MappableType, Allocator>::size_type
+MappableBucketedMultiSet<MappableType, Allocator>::count_overlapped(const MappableType_& mappable) const
+{
+    size_type result {0};
+    for (const auto& bucket : buckets_) {
+        if (!bucket.empty()) result += bucket.count_overlapped(mappable);
+    }
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+std::vector<OverlapRange<typename MappableBucketedMultiSet<MappableType, Allocator>::bucket_const_iterator>>
+MappableBucketedMultiSet<MappableType, Allocator>::overlap_ranges(const MappableType_& mappable) const
+{
+    std::vector<OverlapRange<bucket_const_iterator>> result {};
+    result.reserve(buckets_.size());
+    for (const auto& bucket : buckets_) {
+        if (!bucket.empty()) {
+            auto overlapped = bucket.overlap_range(mappable);
+            if (!overlapped.empty()) result.push_back(std::move(overlapped));
+        }
+    }
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+std::vector<MappableType>
+MappableBucketedMultiSet<MappableType, Allocator>::copy_overlapped(const MappableType_& mappable) const
+{
+    detail::CallRecorder recorder {Algorithm::copy_overlapped};
+    const auto ranges = overlap_ranges(mappable);
+    detail::record_allocation(recorder, ranges);
+    return detail::merge_copy<OverlapRange<bucket_const_iterator>, MappableType>(ranges, recorder);
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+void MappableBucketedMultiSet<MappableType, Allocator>::erase_overlapped(const MappableType_& mappable)
+{
+    for (auto& bucket : buckets_) {
+        if (!bucket.empty()) {
+            const auto bucket_size = bucket.size();
+            bucket.erase_overlapped(mappable);
+            size_ -= bucket_size - bucket.size();
+        }
+    }
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableBucketedMultiSet<MappableType, Allocator>::size_type
+MappableBucketedMultiSet<MappableType, Allocator>::num_contained_buckets(const MappableType_& mappable) const noexcept
+{
+    // Elements larger than mappable cannot be contained by it
+    return std::min(bucket_index(region_size(mappable)) + 1, buckets_.size());
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+bool MappableBucketedMultiSet<MappableType, Allocator>::has_contained(const MappableType_& mappable) const
+{
+    return std::any_of(std::cbegin(buckets_), std::next(std::cbegin(buckets_), num_contained_buckets(mappable)),
+                       [&mappable] (const auto& bucket) {
+                           return !bucket.empty() && !bucket.contained_range(mappable).empty();
+                       });
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableBucketedMultiSet<MappableType, Allocator>::size_type
+MappableBucketedMultiSet<MappableType, Allocator>::count_contained(const MappableType_& mappable) const
+{
+    size_type result {0};
+    for (size_type n {0}; n < num_contained_buckets(mappable); ++n) {
+        if (!buckets_[n].empty()) result += buckets_[n].count_contained(mappable);
+    }
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+std::vector<ContainedRange<typename MappableBucketedMultiSet<MappableType, Allocator>::bucket_const_iterator>>
+MappableBucketedMultiSet<MappableType, Allocator>::contained_ranges(const MappableType_& mappable) const
+{
+    std::vector<ContainedRange<bucket_const_iterator>> result {};
+    result.reserve(num_contained_buckets(mappable));
+    for (size_type n {0}; n < num_contained_buckets(mappable); ++n) {
+        if (!buckets_[n].empty()) {
+            auto contained = buckets_[n].contained_range(mappable);
+            if (!contained.empty()) result.push_back(std::move(contained));
+        }
+    }
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+std::vector<MappableType>
+MappableBucketedMultiSet<MappableType, Allocator>::copy_contained(const MappableType_& mappable) const
+{
+    detail::CallRecorder recorder {Algorithm::copy_contained};
+    const auto ranges = contained_ranges(mappable);
+    detail::record_allocation(recorder, ranges);
+    return detail::merge_copy<ContainedRange<bucket_const_iterator>, MappableType>(ranges, recorder);
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+void MappableBucketedMultiSet<MappableType, Allocator>::erase_contained(const MappableType_& mappable)
+{
+    for (size_type n {0}; n < num_contained_buckets(mappable); ++n) {
+        if (!buckets_[n].empty()) {
+            const auto bucket_size = buckets_[n].size();
+            buckets_[n].erase_contained(mappable);
+            size_ -= bucket_size - buckets_[n].size();
+        }
+    }
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableBucketedMultiSet<MappableType, Allocator>::bucket_type&
+MappableBucketedMultiSet<MappableType, Allocator>::get_bucket(const MappableType& mappable)
+{
+    const auto n = bucket_index(region_size(mappable));
+    if (n >= buckets_.size()) buckets_.resize(n + 1, bucket_type {get_allocator()});
+    return buckets_[n];
+}
+
+} // namespace mappable
+
+#endif
@@ -0,0 +1,787 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef mappable_column_set_hpp
+#define mappable_column_set_hpp
+
+#include <memory>
+#include <algorithm>
+#include <iterator>
+#include <initializer_list>
+#include <vector>
+#include <numeric>
+#include <utility>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+#include "comparable.hpp"
+#include "contig_region.hpp"
+#include "genomic_region.hpp"
+#include "mappable.hpp"
+#include "mappable_range.hpp"
+#include "mappable_algorithms.hpp"
+#include "packed_scan.hpp"
+
+namespace mappable {
+
+/*
+ MappableColumnSet is a sorted set of MappableType elements stored as a structure of arrays: the elements
+ themselves are kept in one contiguous vector, and the begin and end positions of the elements are kept in
+ two parallel packed columns of 32-bit positions. All binary searches and predicate scans (has_overlapped,
+ count_overlapped, has_contained, count_contained, count_spanning) only read the position columns, so queries
+ touch 8 bytes per element rather than the full element, which matters when MappableType is large or when
+ GenomicRegion contig names must otherwise be compared. The counting scans are vectorised where possible
+ (see packed_scan.hpp).
+
+ overlap_range and contained_range still return ranges over the elements, but the range bounds are computed
+ from the columns so the returned ranges only contain elements satisfying the predicate at either end.
+
+ Positions that do not fit in 32 bits cause std::out_of_range to be thrown on insertion. As with the other
+ sorted containers all GenomicRegion elements must be on the same contig; queries on other contigs find nothing.
+ Elements are immutable once inserted as the columns would otherwise become stale.
+ */
+template <typename MappableType, typename Allocator = std::allocator<MappableType>>
+class MappableColumnSet : public Comparable<MappableColumnSet<MappableType, Allocator>>
+{
+protected:
+    using base_t = std::vector<MappableType, Allocator>;
+
+public:
+    using allocator_type  = typename base_t::allocator_type;
+    using value_type      = typename base_t::value_type;
+    using reference       = typename base_t::const_reference;
+    using const_reference = typename base_t::const_reference;
+    using difference_type = typename base_t::difference_type;
+    using size_type       = typename base_t::size_type;
+
+    using iterator               = typename base_t::const_iterator;
+    using const_iterator         = typename base_t::const_iterator;
+    using reverse_iterator       = typename base_t::const_reverse_iterator;
+    using const_reverse_iterator = typename base_t::const_reverse_iterator;
+
+    using PackedPosition = std::uint32_t;
+    using column_type    = std::vector<PackedPosition>;
+
+    MappableColumnSet();
+
+    template <typename InputIterator>
+    MappableColumnSet(InputIterator first, InputIterator last);
+
+    MappableColumnSet(std::initializer_list<MappableType> mappables);
+
+    MappableColumnSet(const MappableColumnSet&)            = default;
+    MappableColumnSet& operator=(const MappableColumnSet&) = default;
+    MappableColumnSet(MappableColumnSet&&)                 = default;
+    MappableColumnSet& operator=(MappableColumnSet&&)      = default;
+
+    ~MappableColumnSet() = default;
+
+    const_iterator begin() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cend() const noexcept;
+    const_reverse_iterator rbegin() const noexcept;
+    const_reverse_iterator crbegin() const noexcept;
+    const_reverse_iterator rend() const noexcept;
+    const_reverse_iterator crend() const noexcept;
+
+    const_reference at(size_type pos) const;
+    const_reference operator[](size_type pos) const;
+    const_reference front() const;
+    const_reference back() const;
+
+    const column_type& begin_column() const noexcept;
+    const column_type& end_column() const noexcept;
+
+    template <typename ...Args>
+    std::pair<const_iterator, bool> emplace(Args&&...);
+    std::pair<const_iterator, bool> insert(const MappableType&);
+    std::pair<const_iterator, bool> insert(MappableType&&);
+    template <typename InputIterator>
+    void insert(InputIterator, InputIterator);
+    const_iterator erase(const_iterator);
+    size_type erase(const MappableType&);
+    const_iterator erase(const_iterator, const_iterator);
+
+    void clear() noexcept;
+
+    size_type size() const noexcept;
+    size_type capacity() const noexcept;
+    bool empty() const noexcept;
+    void reserve(size_type n);
+    void shrink_to_fit();
+
+    const_iterator find(const MappableType&) const;
+    size_type count(const MappableType&) const;
+
+    const MappableType& leftmost() const;
+    const MappableType& rightmost() const;
+
+    bool bidirectionally_sorted() const noexcept;
+    typename RegionType<MappableType>::Position max_element_size() const noexcept;
+
+    template <typename MappableType_>
+    bool has_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    size_type count_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    OverlapRange<const_iterator> overlap_range(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    void erase_overlapped(const MappableType_& mappable);
+
+    template <typename MappableType_>
+    bool has_contained(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    size_type count_contained(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    ContainedRange<const_iterator> contained_range(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    void erase_contained(const MappableType_& mappable);
+
+    template <typename MappableType_>
+    size_type count_spanning(const MappableType_& mappable) const;
+
+    template <typename M, typename A>
+    friend bool operator==(const MappableColumnSet<M, A>& lhs, const MappableColumnSet<M, A>& rhs);
+    template <typename M, typename A>
+    friend bool operator<(const MappableColumnSet<M, A>& lhs, const MappableColumnSet<M, A>& rhs);
+    template <typename M, typename A>
+    friend void swap(MappableColumnSet<M, A>& lhs, MappableColumnSet<M, A>& rhs) noexcept;
+
+private:
+    using Position = typename RegionType<MappableType>::Position;
+    using IndexRange = std::pair<size_type, size_type>;
+
+    base_t elements_;
+    column_type begins_, ends_;
+    bool is_bidirectionally_sorted_;
+    Position max_element_size_;
+
+    static PackedPosition pack(Position position);
+    static bool is_packable(Position position) noexcept;
+    static bool overlaps(Position begin, Position end, Position query_begin, Position query_end) noexcept;
+    static bool contains(Position begin, Position end, Position query_begin, Position query_end) noexcept;
+
+    void rebuild_columns();
+    void update_sort_info() noexcept;
+    const_iterator insert_at(size_type index, MappableType mappable);
+    template <typename MappableType_>
+    bool is_on_contig(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    IndexRange overlap_bounds(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    IndexRange contained_bounds(const MappableType_& mappable) const;
+};
+
+template <typename MappableType, typename Allocator>
+MappableColumnSet<MappableType, Allocator>::MappableColumnSet()
+: elements_ {}
+, begins_ {}
+, ends_ {}
+, is_bidirectionally_sorted_ {true}
+, max_element_size_ {0}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableColumnSet<MappableType, Allocator>::MappableColumnSet(InputIterator first, InputIterator last)
+: elements_ {first, last}
+, begins_ {}
+, ends_ {}
+, is_bidirectionally_sorted_ {true}
+, max_element_size_ {0}
+{
+    std::sort(std::begin(elements_), std::end(elements_));
+    elements_.erase(std::unique(std::begin(elements_), std::end(elements_)), std::end(elements_));
+    rebuild_columns();
+}
+
+template <typename MappableType, typename Allocator>
+MappableColumnSet<MappableType, Allocator>::MappableColumnSet(std::initializer_list<MappableType> mappables)
+: MappableColumnSet {std::begin(mappables), std::end(mappables)}
+{}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_iterator
+MappableColumnSet<MappableType, Allocator>::begin() const noexcept
+{
+    return elements_.begin();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_iterator
+MappableColumnSet<MappableType, Allocator>::cbegin() const noexcept
+{
+    return elements_.cbegin();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_iterator
+MappableColumnSet<MappableType, Allocator>::end() const noexcept
+{
+    return elements_.end();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_iterator
+MappableColumnSet<MappableType, Allocator>::cend() const noexcept
+{
+    return elements_.cend();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_reverse_iterator
+MappableColumnSet<MappableType, Allocator>::rbegin() const noexcept
+{
+    return elements_.rbegin();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_reverse_iterator
+MappableColumnSet<MappableType, Allocator>::crbegin() const noexcept
+{
+    return elements_.crbegin();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_reverse_iterator
+MappableColumnSet<MappableType, Allocator>::rend() const noexcept
+{
+    return elements_.rend();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_reverse_iterator
+MappableColumnSet<MappableType, Allocator>::crend() const noexcept
+{
+    return elements_.crend();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_reference
+MappableColumnSet<MappableType, Allocator>::at(size_type pos) const
+{
+    if (pos < size()) {
+        return elements_[pos];
+    } else {
+        throw std::out_of_range {"MappableColumnSet"};
+    }
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_reference
+MappableColumnSet<MappableType, Allocator>::operator[](size_type pos) const
+{
+    return elements_[pos];
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_reference
+MappableColumnSet<MappableType, Allocator>::front() const
+{
+    return elements_.front();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_reference
+MappableColumnSet<MappableType, Allocator>::back() const
+{
+    return elements_.back();
+}
+
+template <typename MappableType, typename Allocator>
+const typename MappableColumnSet<MappableType, Allocator>::column_type&
+MappableColumnSet<MappableType, Allocator>::begin_column() const noexcept
+{
+    return begins_;
+}
+
+template <typename MappableType, typename Allocator>
+const typename MappableColumnSet<MappableType, Allocator>::column_type&
+MappableColumnSet<MappableType, Allocator>::end_column() const noexcept
+{
+    return ends_;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename ...Args>
+std::pair<typename MappableColumnSet<MappableType, Allocator>::const_iterator, bool>
+MappableColumnSet<MappableType, Allocator>::emplace(Args&&... args)
+{
+    return insert(MappableType {std::forward<Args>(args)...});
+}
+
+template <typename MappableType, typename Allocator>
+std::pair<typename MappableColumnSet<MappableType, Allocator>::const_iterator, bool>
+MappableColumnSet<MappableType, Allocator>::insert(const MappableType& mappable)
+{
+    return insert(MappableType {mappable});
+}
+
+template <typename MappableType, typename Allocator>
+std::pair<typename MappableColumnSet<MappableType, Allocator>::const_iterator, bool>
+MappableColumnSet<MappableType, Allocator>::insert(MappableType&& mappable)
+{
+    const auto it = std::lower_bound(std::cbegin(elements_), std::cend(elements_), mappable);
+    if (it != std::cend(elements_) && *it == mappable) {
+        return std::make_pair(it, false);
+    }
+    return std::make_pair(insert_at(std::distance(std::cbegin(elements_), it), std::move(mappable)), true);
+}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+void MappableColumnSet<MappableType, Allocator>::insert(InputIterator first, InputIterator last)
+{
+    // Everything is built in temporaries and swapped in at the end, so the set is unchanged if this throws
+    base_t incoming {first, last, elements_.get_allocator()};
+    for (const auto& mappable : incoming) {
+        pack(mapped_begin(mappable));
+        pack(mapped_end(mappable));
+    }
+    std::sort(std::begin(incoming), std::end(incoming));
+    base_t elements {elements_.get_allocator()};
+    elements.reserve(elements_.size() + incoming.size());
+    std::merge(std::make_move_iterator(std::begin(incoming)), std::make_move_iterator(std::end(incoming)),
+               std::cbegin(elements_), std::cend(elements_), std::back_inserter(elements));
+    elements.erase(std::unique(std::begin(elements), std::end(elements)), std::end(elements));
+    column_type begins(elements.size()), ends(elements.size());
+    for (size_type i {0}; i < elements.size(); ++i) {
+        begins[i] = static_cast<PackedPosition>(mapped_begin(elements[i]));
+        ends[i]   = static_cast<PackedPosition>(mapped_end(elements[i]));
+    }
+    using std::swap;
+    swap(elements_, elements);
+    swap(begins_, begins);
+    swap(ends_, ends);
+    update_sort_info();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_iterator
+MappableColumnSet<MappableType, Allocator>::erase(const_iterator pos)
+{
+    return erase(pos, std::next(pos));
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::size_type
+MappableColumnSet<MappableType, Allocator>::erase(const MappableType& mappable)
+{
+    const auto it = find(mappable);
+    if (it == std::cend(elements_)) return 0;
+    erase(it);
+    return 1;
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_iterator
+MappableColumnSet<MappableType, Allocator>::erase(const_iterator first, const_iterator last)
+{
+    if (first == last) return last;
+    const auto i = std::distance(std::cbegin(elements_), first);
+    const auto j = std::distance(std::cbegin(elements_), last);
+    const auto result = elements_.erase(first, last);
+    begins_.erase(std::next(std::cbegin(begins_), i), std::next(std::cbegin(begins_), j));
+    ends_.erase(std::next(std::cbegin(ends_), i), std::next(std::cbegin(ends_), j));
+    update_sort_info();
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+void MappableColumnSet<MappableType, Allocator>::clear() noexcept
+{
+    elements_.clear();
+    begins_.clear();
+    ends_.clear();
+    is_bidirectionally_sorted_ = true;
+    max_element_size_ = 0;
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::size_type
+MappableColumnSet<MappableType, Allocator>::size() const noexcept
+{
+    return elements_.size();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::size_type
+MappableColumnSet<MappableType, Allocator>::capacity() const noexcept
+{
+    return elements_.capacity();
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableColumnSet<MappableType, Allocator>::empty() const noexcept
+{
+    return elements_.empty();
+}
+
+template <typename MappableType, typename Allocator>
+void MappableColumnSet<MappableType, Allocator>::reserve(const size_type n)
+{
+    elements_.reserve(n);
+    begins_.reserve(n);
+    ends_.reserve(n);
+}
+
+template <typename MappableType, typename Allocator>
+void MappableColumnSet<MappableType, Allocator>::shrink_to_fit()
+{
+    elements_.shrink_to_fit();
+    begins_.shrink_to_fit();
+    ends_.shrink_to_fit();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_iterator
+MappableColumnSet<MappableType, Allocator>::find(const MappableType& mappable) const
+{
+    const auto it = std::lower_bound(std::cbegin(elements_), std::cend(elements_), mappable);
+    return it != std::cend(elements_) && *it == mappable ? it : std::cend(elements_);
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::size_type
+MappableColumnSet<MappableType, Allocator>::count(const MappableType& mappable) const
+{
+    return find(mappable) != std::cend(elements_) ? 1 : 0;
+}
+
+template <typename MappableType, typename Allocator>
+const MappableType& MappableColumnSet<MappableType, Allocator>::leftmost() const
+{
+    return elements_.front();
+}
+
+template <typename MappableType, typename Allocator>
+const MappableType& MappableColumnSet<MappableType, Allocator>::rightmost() const
+{
+    const auto it = std::max_element(std::cbegin(ends_), std::cend(ends_));
+    return elements_[std::distance(std::cbegin(ends_), it)];
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableColumnSet<MappableType, Allocator>::bidirectionally_sorted() const noexcept
+{
+    return is_bidirectionally_sorted_;
+}
+
+template <typename MappableType, typename Allocator>
+typename RegionType<MappableType>::Position
+MappableColumnSet<MappableType, Allocator>::max_element_size() const noexcept
+{
+    return max_element_size_;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+bool MappableColumnSet<MappableType, Allocator>::has_overlapped(const MappableType_& mappable) const
+{
+    const auto bounds = overlap_bounds(mappable);
+    return bounds.first != bounds.second;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableColumnSet<MappableType, Allocator>::size_type
+MappableColumnSet<MappableType, Allocator>::count_overlapped(const MappableType_& mappable) const
+{
+    const auto bounds = overlap_bounds(mappable);
+    if (is_bidirectionally_sorted_) return bounds.second - bounds.first;
+    const auto query_begin = mapped_begin(mappable);
+    const auto query_end   = mapped_end(mappable);
+    if (is_packable(query_end)) {
+        return count_overlapped_packed(begins_.data() + bounds.first, ends_.data() + bounds.first,
+                                       bounds.second - bounds.first,
+                                       static_cast<PackedPosition>(query_begin),
+                                       static_cast<PackedPosition>(query_end));
+    }
+    size_type result {0};
+    for (auto i = bounds.first; i < bounds.second; ++i) {
+        result += overlaps(begins_[i], ends_[i], query_begin, query_end);
+    }
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+OverlapRange<typename MappableColumnSet<MappableType, Allocator>::const_iterator>
+MappableColumnSet<MappableType, Allocator>::overlap_range(const MappableType_& mappable) const
+{
+    const auto bounds = overlap_bounds(mappable);
+    return make_overlap_range(std::next(std::cbegin(elements_), bounds.first),
+                              std::next(std::cbegin(elements_), bounds.second),
+                              mappable);
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+void MappableColumnSet<MappableType, Allocator>::erase_overlapped(const MappableType_& mappable)
+{
+    const auto bounds = overlap_bounds(mappable);
+    if (is_bidirectionally_sorted_) {
+        erase(std::next(std::cbegin(elements_), bounds.first), std::next(std::cbegin(elements_), bounds.second));
+        return;
+    }
+    const auto query_begin = mapped_begin(mappable);
+    const auto query_end   = mapped_end(mappable);
+    auto element_out = std::next(std::begin(elements_), bounds.first);
+    auto index_out = bounds.first;
+    for (auto i = bounds.first; i < bounds.second; ++i) {
+        if (!overlaps(begins_[i], ends_[i], query_begin, query_end)) {
+            *element_out++ = std::move(elements_[i]);
+            begins_[index_out] = begins_[i];
+            ends_[index_out]   = ends_[i];
+            ++index_out;
+        }
+    }
+    erase(element_out, std::next(std::cbegin(elements_), bounds.second));
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+bool MappableColumnSet<MappableType, Allocator>::has_contained(const MappableType_& mappable) const
+{
+    const auto bounds = contained_bounds(mappable);
+    return bounds.first != bounds.second;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableColumnSet<MappableType, Allocator>::size_type
+MappableColumnSet<MappableType, Allocator>::count_contained(const MappableType_& mappable) const
+{
+    const auto bounds = contained_bounds(mappable);
+    if (is_bidirectionally_sorted_) return bounds.second - bounds.first;
+    const auto query_begin = mapped_begin(mappable);
+    const auto query_end   = mapped_end(mappable);
+    if (is_packable(query_end)) {
+        return count_contained_packed(begins_.data() + bounds.first, ends_.data() + bounds.first,
+                                      bounds.second - bounds.first,
+                                      static_cast<PackedPosition>(query_begin),
+                                      static_cast<PackedPosition>(query_end));
+    }
+    size_type result {0};
+    for (auto i = bounds.first; i < bounds.second; ++i) {
+        result += contains(begins_[i], ends_[i], query_begin, query_end);
+    }
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+ContainedRange<typename MappableColumnSet<MappableType, Allocator>::const_iterator>
+MappableColumnSet<MappableType, Allocator>::contained_range(const MappableType_& mappable) const
+{
+    const auto bounds = contained_bounds(mappable);
+    return make_contained_range(std::next(std::cbegin(elements_), bounds.first),
+                                std::next(std::cbegin(elements_), bounds.second),
+                                mappable);
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+void MappableColumnSet<MappableType, Allocator>::erase_contained(const MappableType_& mappable)
+{
+    const auto bounds = contained_bounds(mappable);
+    if (is_bidirectionally_sorted_) {
+        erase(std::next(std::cbegin(elements_), bounds.first), std::next(std::cbegin(elements_), bounds.second));
+        return;
+    }
+    const auto query_begin = mapped_begin(mappable);
+    const auto query_end   = mapped_end(mappable);
+    auto element_out = std::next(std::begin(elements_), bounds.first);
+    auto index_out = bounds.first;
+    for (auto i = bounds.first; i < bounds.second; ++i) {
+        if (!contains(begins_[i], ends_[i], query_begin, query_end)) {
+            *element_out++ = std::move(elements_[i]);
+            begins_[index_out] = begins_[i];
+            ends_[index_out]   = ends_[i];
+            ++index_out;
+        }
+    }
+    erase(element_out, std::next(std::cbegin(elements_), bounds.second));
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableColumnSet<MappableType, Allocator>::size_type
+MappableColumnSet<MappableType, Allocator>::count_spanning(const MappableType_& mappable) const
+{
+    // Counts the elements that contain the query. An element that contains the query also overlaps it, so
+    // only the elements within the overlap bounds need to be tested
+    const auto bounds = overlap_bounds(mappable);
+    const auto query_begin = mapped_begin(mappable);
+    const auto query_end   = mapped_end(mappable);
+    if (!is_packable(query_end)) return 0;
+    return count_spanning_packed(begins_.data() + bounds.first, ends_.data() + bounds.first,
+                                 bounds.second - bounds.first,
+                                 static_cast<PackedPosition>(query_begin),
+                                 static_cast<PackedPosition>(query_end));
+}
+
+// private methods
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::PackedPosition
+MappableColumnSet<MappableType, Allocator>::pack(const Position position)
+{
+    if (!is_packable(position)) {
+        throw std::out_of_range {"MappableColumnSet: position does not fit in packed column"};
+    }
+    return static_cast<PackedPosition>(position);
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableColumnSet<MappableType, Allocator>::is_packable(const Position position) noexcept
+{
+    return position <= std::numeric_limits<PackedPosition>::max();
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableColumnSet<MappableType, Allocator>::overlaps(const Position begin, const Position end,
+                                                           const Position query_begin,
+                                                           const Position query_end) noexcept
+{
+    // Same as overlaps for ContigRegion: empty regions overlap regions they touch
+    const auto overlap_begin = std::max(begin, query_begin);
+    const auto overlap_end   = std::min(end, query_end);
+    return overlap_begin < overlap_end
+           || (overlap_begin == overlap_end && (begin == end || query_begin == query_end));
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableColumnSet<MappableType, Allocator>::contains(const Position begin, const Position end,
+                                                           const Position query_begin,
+                                                           const Position query_end) noexcept
+{
+    return query_begin <= begin && end <= query_end;
+}
+
+template <typename MappableType, typename Allocator>
+void MappableColumnSet<MappableType, Allocator>::rebuild_columns()
+{
+    begins_.resize(elements_.size());
+    ends_.resize(elements_.size());
+    for (size_type i {0}; i < elements_.size(); ++i) {
+        begins_[i] = pack(mapped_begin(elements_[i]));
+        ends_[i]   = pack(mapped_end(elements_[i]));
+    }
+    update_sort_info();
+}
+
+template <typename MappableType, typename Allocator>
+void MappableColumnSet<MappableType, Allocator>::update_sort_info() noexcept
+{
+    // Begins are always sorted, so the elements are bidirectionally sorted iff the ends are
+    is_bidirectionally_sorted_ = std::is_sorted(std::cbegin(ends_), std::cend(ends_));
+    max_element_size_ = 0;
+    for (size_type i {0}; i < ends_.size(); ++i) {
+        max_element_size_ = std::max(max_element_size_, static_cast<Position>(ends_[i] - begins_[i]));
+    }
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableColumnSet<MappableType, Allocator>::const_iterator
+MappableColumnSet<MappableType, Allocator>::insert_at(const size_type index, MappableType mappable)
+{
+    const auto begin = pack(mapped_begin(mappable));
+    const auto end   = pack(mapped_end(mappable));
+    // Grow the columns first so that once elements_ has changed inserting into them cannot throw, and a
+    // throw leaves the columns the same length as elements_
+    if (begins_.size() == begins_.capacity()) begins_.reserve(std::max(2 * begins_.size(), size_type {1}));
+    if (ends_.size() == ends_.capacity()) ends_.reserve(std::max(2 * ends_.size(), size_type {1}));
+    const auto result = elements_.insert(std::next(std::cbegin(elements_), index), std::move(mappable));
+    begins_.insert(std::next(std::cbegin(begins_), index), begin);
+    ends_.insert(std::next(std::cbegin(ends_), index), end);
+    if (is_bidirectionally_sorted_) {
+        is_bidirectionally_sorted_ = (index == 0 || ends_[index - 1] <= end)
+                                     && (index + 1 == ends_.size() || end <= ends_[index + 1]);
+    }
+    max_element_size_ = std::max(max_element_size_, static_cast<Position>(end - begin));
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+bool MappableColumnSet<MappableType, Allocator>::is_on_contig(const MappableType_& mappable) const
+{
+    return elements_.empty()
+           || detail::is_same_contig_or_contig_region(mapped_region(elements_.front()), mapped_region(mappable));
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableColumnSet<MappableType, Allocator>::IndexRange
+MappableColumnSet<MappableType, Allocator>::overlap_bounds(const MappableType_& mappable) const
+{
+    if (!is_on_contig(mappable)) return {0, 0};
+    const Position query_begin = mapped_begin(mappable);
+    const Position query_end   = mapped_end(mappable);
+    const auto first_begin = std::cbegin(begins_);
+    auto last = std::distance(first_begin, std::upper_bound(first_begin, std::cend(begins_), query_end));
+    difference_type first;
+    if (is_bidirectionally_sorted_) {
+        const auto first_end = std::cbegin(ends_);
+        first = std::distance(first_end, std::lower_bound(first_end, std::next(first_end, last), query_begin));
+    } else {
+        const auto min_begin = query_begin - std::min(query_begin, max_element_size_);
+        first = std::distance(first_begin, std::lower_bound(first_begin, std::next(first_begin, last), min_begin));
+    }
+    // Trim the bounds so both ends of the range are overlapped
+    while (first < last && !overlaps(begins_[first], ends_[first], query_begin, query_end)) ++first;
+    while (last > first && !overlaps(begins_[last - 1], ends_[last - 1], query_begin, query_end)) --last;
+    return {static_cast<size_type>(first), static_cast<size_type>(last)};
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableColumnSet<MappableType, Allocator>::IndexRange
+MappableColumnSet<MappableType, Allocator>::contained_bounds(const MappableType_& mappable) const
+{
+    if (!is_on_contig(mappable)) return {0, 0};
+    const Position query_begin = mapped_begin(mappable);
+    const Position query_end   = mapped_end(mappable);
+    const auto first_begin = std::cbegin(begins_);
+    auto first = std::distance(first_begin, std::lower_bound(first_begin, std::cend(begins_), query_begin));
+    auto last  = std::distance(first_begin, std::upper_bound(std::next(first_begin, first), std::cend(begins_), query_end));
+    while (first < last && !contains(begins_[first], ends_[first], query_begin, query_end)) ++first;
+    while (last > first && !contains(begins_[last - 1], ends_[last - 1], query_begin, query_end)) --last;
+    return {static_cast<size_type>(first), static_cast<size_type>(last)};
+}
+
+// non-member methods
+
+template <typename MappableType, typename Allocator>
+bool operator==(const MappableColumnSet<MappableType, Allocator>& lhs,
+                const MappableColumnSet<MappableType, Allocator>& rhs)
+{
+    return lhs.elements_ == rhs.elements_;
+}
+
+template <typename MappableType, typename Allocator>
+bool operator<(const MappableColumnSet<MappableType, Allocator>& lhs,
+               const MappableColumnSet<MappableType, Allocator>& rhs)
+{
+    return lhs.elements_ < rhs.elements_;
+}
+
+template <typename MappableType, typename Allocator>
+void swap(MappableColumnSet<MappableType, Allocator>& lhs,
+          MappableColumnSet<MappableType, Allocator>& rhs) noexcept
+{
+    using std::swap;
+    swap(lhs.elements_, rhs.elements_);
+    swap(lhs.begins_, rhs.begins_);
+    swap(lhs.ends_, rhs.ends_);
+    swap(lhs.is_bidirectionally_sorted_, rhs.is_bidirectionally_sorted_);
+    swap(lhs.max_element_size_, rhs.max_element_size_);
+}
+
+} // namespace mappable
+
+#endif
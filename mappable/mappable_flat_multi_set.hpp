@@ -19,12 +19,19 @@
 #include "mappable.hpp"
 #include "mappable_range.hpp"
 #include "mappable_algorithms.hpp"
+#include "materialised_range.hpp"
+#include "parallel_sort.hpp"
+#include "sorted_element_stats.hpp"
+#include "instrumentation.hpp"
 
 namespace mappable {
 
 /*
  MappableFlatMultiSet is a container designed to allow fast retrieval of MappableType elements with minimal
  memory overhead.
+
+ The range constructors take an optional thread count for the initial sort (0 means all hardware threads)
+ and an optional allocator.
  */
 template <typename MappableType, typename Allocator = std::allocator<MappableType>>
 class MappableFlatMultiSet : public Comparable<MappableFlatMultiSet<MappableType, Allocator>>
@@ -46,9 +53,16 @@ public:
     using const_reverse_iterator = typename base_t::const_reverse_iterator;
     
     MappableFlatMultiSet();
+    explicit MappableFlatMultiSet(const allocator_type& alloc);
     
     template <typename InputIterator>
     MappableFlatMultiSet(InputIterator first, InputIterator second);
+    template <typename InputIterator>
+    MappableFlatMultiSet(InputIterator first, InputIterator second, unsigned num_threads);
+    template <typename InputIterator>
+    MappableFlatMultiSet(InputIterator first, InputIterator second, const allocator_type& alloc);
+    template <typename InputIterator>
+    MappableFlatMultiSet(InputIterator first, InputIterator second, unsigned num_threads, const allocator_type& alloc);
     
     MappableFlatMultiSet(std::initializer_list<MappableType> mappables);
     
@@ -93,6 +107,7 @@ public:
     iterator erase(const_iterator);
     size_type erase(const MappableType&);
     iterator erase(const_iterator, const_iterator);
+    iterator erase(const MaterialisedRange<const_iterator>&);
     template <typename InputIt>
     size_type erase_all(InputIt first, InputIt last);
     
@@ -105,11 +120,15 @@ public:
     void reserve(size_type n);
     void shrink_to_fit();
     
-    allocator_type get_allocator() noexcept;
+    allocator_type get_allocator() const noexcept;
     
     const MappableType& leftmost() const;
     const MappableType& rightmost() const;
     
+    bool bidirectionally_sorted() const noexcept;
+    bool fixed_size() const noexcept;
+    typename RegionType<MappableType>::Position max_element_size() const noexcept;
+    
     template <typename MappableType_>
     bool has_overlapped(const MappableType_& mappable) const;
     template <typename MappableType_>
@@ -179,30 +198,60 @@ public:
     
 private:
     base_t elements_;
-    bool is_bidirectionally_sorted_;
-    typename RegionType<MappableType>::Position max_element_size_;
+    detail::SortedElementStats<typename RegionType<MappableType>::Position> stats_;
 };
 
 template <typename MappableType, typename Allocator>
 MappableFlatMultiSet<MappableType, Allocator>::MappableFlatMultiSet()
 : elements_ {}
-, is_bidirectionally_sorted_ {true}
-, max_element_size_ {}
+, stats_ {}
+{}
+
+template <typename MappableType, typename Allocator>
+MappableFlatMultiSet<MappableType, Allocator>::MappableFlatMultiSet(const allocator_type& alloc)
+: elements_ {alloc}
+, stats_ {}
 {}
 
 template <typename MappableType, typename Allocator>
 template <typename InputIterator>
 MappableFlatMultiSet<MappableType, Allocator>::MappableFlatMultiSet(InputIterator first, InputIterator second)
-: elements_ {first, second}
-, is_bidirectionally_sorted_ {is_bidirectionally_sorted(elements_)}
-, max_element_size_ {(elements_.empty()) ? 0 : region_size(*largest_mappable(elements_))}
+: MappableFlatMultiSet {first, second, 1}
 {}
 
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableFlatMultiSet<MappableType, Allocator>::MappableFlatMultiSet(InputIterator first, InputIterator second,
+                                                                    const unsigned num_threads)
+: MappableFlatMultiSet {first, second, num_threads, allocator_type {}}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableFlatMultiSet<MappableType, Allocator>::MappableFlatMultiSet(InputIterator first, InputIterator second,
+                                                                    const allocator_type& alloc)
+: MappableFlatMultiSet {first, second, 1, alloc}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableFlatMultiSet<MappableType, Allocator>::MappableFlatMultiSet(InputIterator first, InputIterator second,
+                                                                    const unsigned num_threads,
+                                                                    const allocator_type& alloc)
+: elements_ {alloc}
+, stats_ {}
+{
+    // Sort the container's own sequence, so only one copy of the elements is ever alive
+    typename base_t::sequence_type sequence {first, second, alloc};
+    if (sequence.empty()) return;
+    detail::parallel_sort(std::begin(sequence), std::end(sequence), num_threads);
+    stats_ = detail::summarise_sorted(std::cbegin(sequence), std::cend(sequence), num_threads);
+    elements_.adopt_sequence(boost::container::ordered_range, std::move(sequence));
+}
+
 template <typename MappableType, typename Allocator>
 MappableFlatMultiSet<MappableType, Allocator>::MappableFlatMultiSet(std::initializer_list<MappableType> mappables)
-: elements_ {mappables}
-, is_bidirectionally_sorted_ {is_bidirectionally_sorted(elements_)}
-, max_element_size_ {(elements_.empty()) ? 0 : region_size(*largest_mappable(elements_))}
+: MappableFlatMultiSet {std::begin(mappables), std::end(mappables), 1}
 {}
 
 template <typename MappableType, typename Allocator>
@@ -359,11 +408,7 @@ typename MappableFlatMultiSet<MappableType, Allocator>::iterator
 MappableFlatMultiSet<MappableType, Allocator>::emplace(Args... args)
 {
     const auto it = elements_.emplace(std::forward<Args>(args)...);
-    if (is_bidirectionally_sorted_) {
-        const auto overlapped = overlap_range(*it);
-        is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
-    }
-    max_element_size_ = std::max(max_element_size_, region_size(*it));
+    stats_.insert(std::cbegin(elements_), std::cend(elements_), const_iterator {it});
     return it;
 }
 
@@ -372,11 +417,7 @@ typename MappableFlatMultiSet<MappableType, Allocator>::iterator
 MappableFlatMultiSet<MappableType, Allocator>::insert(const MappableType& m)
 {
     const auto it = elements_.insert(m);
-    if (is_bidirectionally_sorted_) {
-        const auto overlapped = overlap_range(*it);
-        is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
-    }
-    max_element_size_ = std::max(max_element_size_, region_size(*it));
+    stats_.insert(std::cbegin(elements_), std::cend(elements_), const_iterator {it});
     return it;
 }
 
@@ -385,11 +426,7 @@ typename MappableFlatMultiSet<MappableType, Allocator>::iterator
 MappableFlatMultiSet<MappableType, Allocator>::insert(MappableType&& m)
 {
     const auto it = elements_.insert(std::move(m));
-    if (is_bidirectionally_sorted_) {
-        const auto overlapped = overlap_range(*it);
-        is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
-    }
-    max_element_size_ = std::max(max_element_size_, region_size(*it));
+    stats_.insert(std::cbegin(elements_), std::cend(elements_), const_iterator {it});
     return it;
 }
 
@@ -398,11 +435,7 @@ typename MappableFlatMultiSet<MappableType, Allocator>::iterator
 MappableFlatMultiSet<MappableType, Allocator>::insert(const_iterator hint, const MappableType& m)
 {
     const auto it2 = elements_.insert(hint, m);
-    if (is_bidirectionally_sorted_) {
-        const auto overlapped = overlap_range(*it2);
-        is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
-    }
-    max_element_size_ = std::max(max_element_size_, region_size(m));
+    stats_.insert(std::cbegin(elements_), std::cend(elements_), const_iterator {it2});
     return it2;
 }
 
@@ -411,11 +444,7 @@ typename MappableFlatMultiSet<MappableType, Allocator>::iterator
 MappableFlatMultiSet<MappableType, Allocator>::insert(const_iterator hint, MappableType&& m)
 {
     const auto it2 = elements_.insert(hint, std::move(m));
-    if (is_bidirectionally_sorted_) {
-        const auto overlapped = overlap_range(*it2);
-        is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
-    }
-    max_element_size_ = std::max(max_element_size_, region_size(m));
+    stats_.insert(std::cbegin(elements_), std::cend(elements_), const_iterator {it2});
     return it2;
 }
 
@@ -424,27 +453,23 @@ template <typename InputIterator>
 void
 MappableFlatMultiSet<MappableType, Allocator>::insert(InputIterator first, InputIterator last)
 {
-    if (first != last) {
-        max_element_size_ = std::max(max_element_size_, region_size(*largest_mappable(first, last)));
-        elements_.insert(first, last);
-        if (is_bidirectionally_sorted_) {
-            is_bidirectionally_sorted_ = is_bidirectionally_sorted(elements_);
-        }
-    }
+    if (first == last) return;
+    typename base_t::sequence_type values {first, last, elements_.get_allocator()};
+    std::sort(std::begin(values), std::end(values));
+    const auto blocks = stats_.insertion_blocks(std::cbegin(elements_), std::cend(elements_),
+                                                std::cbegin(values), std::cend(values));
+    stats_.split(std::cbegin(elements_), std::cend(elements_), blocks);
+    elements_.insert(boost::container::ordered_range,
+                     std::make_move_iterator(std::begin(values)), std::make_move_iterator(std::end(values)));
+    stats_.insert_blocks(std::cbegin(elements_), std::cend(elements_), blocks);
 }
 
 template <typename MappableType, typename Allocator>
 typename MappableFlatMultiSet<MappableType, Allocator>::iterator
 MappableFlatMultiSet<MappableType, Allocator>::insert(std::initializer_list<MappableType> il)
 {
-    if (!il.empty()) {
-        max_element_size_ = std::max(max_element_size_, region_size(*largest_element(il)));
-    }
-    const auto result = elements_.insert(std::move(il));
-    if (is_bidirectionally_sorted_ && !il.empty() ) {
-        is_bidirectionally_sorted_ = is_bidirectionally_sorted(elements_);
-    }
-    return result;
+    insert(std::begin(il), std::end(il));
+    return std::begin(elements_);
 }
 
 template <typename MappableType, typename Allocator>
@@ -452,37 +477,21 @@ typename MappableFlatMultiSet<MappableType, Allocator>::iterator
 MappableFlatMultiSet<MappableType, Allocator>::erase(const_iterator p)
 {
     if (p == cend()) return elements_.erase(p);
-    const auto erased_size = region_size(*p);
-    const auto result = elements_.erase(p);
-    if (elements_.empty()) {
-        max_element_size_ = 0;
-        is_bidirectionally_sorted_ = true;
-    } else {
-        if (max_element_size_ == erased_size) {
-            max_element_size_ = region_size(*largest_mappable(elements_));
-        }
-    }
-    return result;
+    stats_.erase(std::cbegin(elements_), std::cend(elements_), p, std::next(p));
+    return elements_.erase(p);
 }
 
 template <typename MappableType, typename Allocator>
 typename MappableFlatMultiSet<MappableType, Allocator>::size_type
 MappableFlatMultiSet<MappableType, Allocator>::erase(const MappableType& m)
 {
-    const auto m_size = region_size(m);
-    const auto result = elements_.erase(m);
+    const auto er = elements_.equal_range(m);
+    const auto result = static_cast<size_type>(std::distance(er.first, er.second));
     if (result > 0) {
-        if (elements_.empty()) {
-            max_element_size_ = 0;
-            is_bidirectionally_sorted_ = true;
-        } else {
-            if (max_element_size_ == m_size) {
-                max_element_size_ = region_size(*largest_mappable(elements_));
-            }
-        }
-        return result;
+        stats_.erase(std::cbegin(elements_), std::cend(elements_), const_iterator {er.first}, const_iterator {er.second});
+        elements_.erase(er.first, er.second);
     }
-    return 0;
+    return result;
 }
 
 template <typename MappableType, typename Allocator>
@@ -490,17 +499,34 @@ typename MappableFlatMultiSet<MappableType, Allocator>::iterator
 MappableFlatMultiSet<MappableType, Allocator>::erase(const_iterator first, const_iterator last)
 {
     if (first == last) return elements_.erase(first, last);
-    const auto max_erased_size = region_size(*largest_mappable(first, last));
-    const auto result = elements_.erase(first, last);
-    if (elements_.empty()) {
-        max_element_size_ = 0;
-        is_bidirectionally_sorted_ = true;
-    } else {
-        if (max_element_size_ == max_erased_size) {
-            max_element_size_ = region_size(*largest_mappable(elements_));
-        }
+    stats_.erase(std::cbegin(elements_), std::cend(elements_), first, last);
+    return elements_.erase(first, last);
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableFlatMultiSet<MappableType, Allocator>::iterator
+MappableFlatMultiSet<MappableType, Allocator>::erase(const MaterialisedRange<const_iterator>& range)
+{
+    if (range.is_contiguous()) return erase(range.base_begin(), range.base_end());
+    stats_.erase(std::cbegin(elements_), std::cend(elements_), range.base_begin(), range.base_end());
+    // The elements cannot be moved in place, so take the sequence, compact the unselected elements between the
+    // bounds of range to the front in a single pass, and adopt the (still ordered) result
+    const auto offset = std::distance(std::cbegin(elements_), range.base_begin());
+    const auto num_bases = base_size(range);
+    auto sequence = elements_.extract_sequence();
+    const auto first = std::next(std::begin(sequence), offset);
+    const auto last = std::next(first, num_bases);
+    auto kept_last = first;
+    const auto& offsets = range.offsets();
+    for (std::size_t i {1}; i < offsets.size(); ++i) {
+        kept_last = std::move(std::next(first, offsets[i - 1] + 1), std::next(first, offsets[i]), kept_last);
     }
-    return result;
+    const auto num_kept = std::distance(first, kept_last);
+    sequence.erase(kept_last, last);
+    elements_.adopt_sequence(boost::container::ordered_range, std::move(sequence));
+    const auto kept_first = std::next(std::cbegin(elements_), offset);
+    stats_.insert(std::cbegin(elements_), std::cend(elements_), kept_first, std::next(kept_first, num_kept));
+    return std::next(std::begin(elements_), offset + num_kept);
 }
 
 template <typename MappableType, typename Allocator>
@@ -511,31 +537,9 @@ MappableFlatMultiSet<MappableType, Allocator>::erase_all(InputIt first, InputIt
     using ItrValueType = typename std::iterator_traits<InputIt>::value_type;
     static_assert(std::is_same<ItrValueType, MappableType>::value, "Cannot erase different type");
     size_type result {0};
-    if (first == last) return result;
-    typename RegionType<MappableType>::Size max_erased_size {0};
-    std::for_each(first, last, [this, &result, &max_erased_size] (const auto& element) {
-        const auto er = elements_.equal_range(element);
-        if (er.first != er.second) {
-            if (region_size(element) > max_erased_size) {
-                max_erased_size = region_size(element);
-            }
-            result += std::distance(er.first, er.second);
-            elements_.erase(er.first, er.second);
-        }
+    std::for_each(first, last, [this, &result] (const auto& element) {
+        result += this->erase(element);
     });
-    if (result > 0) {
-        if (!elements_.empty()) {
-            if (!is_bidirectionally_sorted_) {
-                is_bidirectionally_sorted_ = is_bidirectionally_sorted(elements_);
-            }
-            if (max_element_size_ == max_erased_size) {
-                max_element_size_ = region_size(*largest_mappable(elements_));
-            }
-        } else {
-            max_element_size_ = 0;
-            is_bidirectionally_sorted_ = true;
-        }
-    }
     return result;
 }
 
@@ -543,8 +547,7 @@ template <typename MappableType, typename Allocator>
 void MappableFlatMultiSet<MappableType, Allocator>::clear()
 {
     elements_.clear();
-    is_bidirectionally_sorted_ = true;
-    max_element_size_ = 0;
+    stats_.clear();
 }
 
 template <typename MappableType, typename Allocator>
@@ -590,7 +593,7 @@ MappableFlatMultiSet<MappableType, Allocator>::shrink_to_fit()
 
 template <typename MappableType, typename Allocator>
 typename MappableFlatMultiSet<MappableType, Allocator>::allocator_type
-MappableFlatMultiSet<MappableType, Allocator>::get_allocator() noexcept
+MappableFlatMultiSet<MappableType, Allocator>::get_allocator() const noexcept
 {
     return elements_.get_allocator();
 }
@@ -606,26 +609,41 @@ const MappableType& MappableFlatMultiSet<MappableType, Allocator>::rightmost() c
 {
     using std::cbegin; using std::cend;
     const auto& last = *std::prev(elements_.cend());
-    if (is_bidirectionally_sorted_) {
+    if (stats_.is_bidirectionally_sorted()) {
         return last;
     } else {
         using mappable::overlap_range;
         const auto overlapped = overlap_range(cbegin(elements_), cend(elements_), last,
-                                              max_element_size_);
+                                              stats_.max_element_size());
         return *rightmost_mappable(cbegin(overlapped), cend(overlapped));
     }
 }
 
+template <typename MappableType, typename Allocator>
+bool MappableFlatMultiSet<MappableType, Allocator>::bidirectionally_sorted() const noexcept
+{
+    return stats_.is_bidirectionally_sorted();
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableFlatMultiSet<MappableType, Allocator>::fixed_size() const noexcept
+{
+    return stats_.is_fixed_size();
+}
+
+template <typename MappableType, typename Allocator>
+typename RegionType<MappableType>::Position
+MappableFlatMultiSet<MappableType, Allocator>::max_element_size() const noexcept
+{
+    return stats_.max_element_size();
+}
+
 template <typename MappableType, typename Allocator>
 template <typename MappableType_>
 bool
 MappableFlatMultiSet<MappableType, Allocator>::has_overlapped(const MappableType_& mappable) const
 {
-    using mappable::has_overlapped;
-    if (is_bidirectionally_sorted_) {
-        return has_overlapped(std::begin(elements_), std::end(elements_), mappable, BidirectionallySortedTag {});
-    }
-    return has_overlapped(std::begin(elements_), std::end(elements_), mappable);
+    return has_overlapped(std::cbegin(elements_), std::cend(elements_), mappable);
 }
 
 template <typename MappableType, typename Allocator>
@@ -635,10 +653,13 @@ MappableFlatMultiSet<MappableType, Allocator>::has_overlapped(const_iterator fir
                                                               const MappableType_& mappable) const
 {
     using mappable::has_overlapped;
-    if (is_bidirectionally_sorted_) {
+    if (stats_.is_fixed_size()) {
+        return has_overlapped(first, last, mappable, FixedSizeTag {});
+    }
+    if (stats_.is_bidirectionally_sorted()) {
         return has_overlapped(first, last, mappable, BidirectionallySortedTag {});
     }
-    return has_overlapped(first, last, mappable);
+    return has_overlapped(first, last, mappable, stats_.max_element_size());
 }
 
 template <typename MappableType, typename Allocator>
@@ -656,10 +677,13 @@ MappableFlatMultiSet<MappableType, Allocator>::count_overlapped(const_iterator f
                                                                 const MappableType_& mappable) const
 {
     using mappable::count_overlapped;
-    if (is_bidirectionally_sorted_) {
+    if (stats_.is_fixed_size()) {
+        return count_overlapped(first, last, mappable, FixedSizeTag {});
+    }
+    if (stats_.is_bidirectionally_sorted()) {
         return count_overlapped(first, last, mappable, BidirectionallySortedTag {});
     }
-    return count_overlapped(first, last, mappable, max_element_size_);
+    return count_overlapped(first, last, mappable, stats_.max_element_size());
 }
 
 template <typename MappableType, typename Allocator>
@@ -677,24 +701,24 @@ MappableFlatMultiSet<MappableType, Allocator>::overlap_range(const_iterator firs
                                                              const MappableType_& mappable) const
 {
     using mappable::overlap_range;
-    if (is_bidirectionally_sorted_) {
+    if (stats_.is_fixed_size()) {
+        return overlap_range(first, last, mappable, FixedSizeTag {});
+    }
+    if (stats_.is_bidirectionally_sorted()) {
         return overlap_range(first, last, mappable, BidirectionallySortedTag {});
     }
-    return overlap_range(first, last, mappable, max_element_size_);
+    return overlap_range(first, last, mappable, stats_.max_element_size());
 }
 
 template <typename MappableType, typename Allocator>
 template <typename MappableType_>
 void MappableFlatMultiSet<MappableType, Allocator>::erase_overlapped(const MappableType_& mappable)
 {
-    const auto overlapped = overlap_range(mappable);
-    using mappable::size;
-    if (is_bidirectionally_sorted_ || size(overlapped) == base_size(overlapped)) {
-        erase(std::cbegin(overlapped).base(), std::cend(overlapped).base());
-    } else {
-        const std::vector<MappableType> tmp {std::cbegin(overlapped), std::cend(overlapped)};
-        erase_all(std::cbegin(tmp), std::cend(tmp));
-    }
+    const auto erased = stats_.is_bidirectionally_sorted() ? materialise(overlap_range(mappable), BidirectionallySortedTag {})
+                                                           : materialise(overlap_range(mappable));
+    detail::CallRecorder recorder {Algorithm::erase_overlapped};
+    recorder.scanned(base_size(erased)); // erase compacts the elements between the bounds of erased
+    erase(erased);
 }
 
 template <typename MappableType, typename Allocator>
@@ -712,6 +736,9 @@ MappableFlatMultiSet<MappableType, Allocator>::has_contained(const_iterator firs
                                                              const MappableType_& mappable) const
 {
     using mappable::has_contained;
+    if (stats_.is_fixed_size()) {
+        return has_contained(first, last, mappable, FixedSizeTag {});
+    }
     return has_contained(first, last, mappable);
 }
 
@@ -730,6 +757,9 @@ MappableFlatMultiSet<MappableType, Allocator>::count_contained(const_iterator fi
                                                                const MappableType_& mappable) const
 {
     using mappable::count_contained;
+    if (stats_.is_fixed_size()) {
+        return count_contained(first, last, mappable, FixedSizeTag {});
+    }
     return count_contained(first, last, mappable);
 }
 
@@ -748,6 +778,9 @@ MappableFlatMultiSet<MappableType, Allocator>::contained_range(const_iterator fi
                                                                const MappableType_& mappable) const
 {
     using mappable::contained_range;
+    if (stats_.is_fixed_size()) {
+        return contained_range(first, last, mappable, FixedSizeTag {});
+    }
     return contained_range(first, last, mappable);
 }
 
@@ -755,14 +788,11 @@ template <typename MappableType, typename Allocator>
 template <typename MappableType_>
 void MappableFlatMultiSet<MappableType, Allocator>::erase_contained(const MappableType_& mappable)
 {
-    auto contained = contained_range(mappable);
-    using mappable::size;
-    if (is_bidirectionally_sorted_ || size(contained) == base_size(contained)) {
-        erase(std::cbegin(contained).base(), std::cend(contained).base());
-    } else {
-        const std::vector<MappableType> tmp {std::cbegin(contained), std::cend(contained)};
-        erase_all(std::cbegin(tmp), std::cend(tmp));
-    }
+    const auto erased = stats_.is_bidirectionally_sorted() ? materialise(contained_range(mappable), BidirectionallySortedTag {})
+                                                           : materialise(contained_range(mappable));
+    detail::CallRecorder recorder {Algorithm::erase_contained};
+    recorder.scanned(base_size(erased)); // erase compacts the elements between the bounds of erased
+    erase(erased);
 }
 
 template <typename MappableType, typename Allocator>
@@ -781,7 +811,7 @@ MappableFlatMultiSet<MappableType, Allocator>::has_shared(const_iterator first,
                                                           const MappableType1_& mappable1,
                                                           const MappableType2_& mappable2) const
 {
-    if (static_cast<decltype(max_element_size_)>(inner_distance(mappable1, mappable2)) > max_element_size_) return false;
+    if (static_cast<typename RegionType<MappableType>::Position>(inner_distance(mappable1, mappable2)) > stats_.max_element_size()) return false;
     const auto m = std::minmax(mapped_region(mappable1), mapped_region(mappable2));
     const auto overlapped_lhs = overlap_range(first, last, m.first);
     return std::any_of(std::cbegin(overlapped_lhs), std::cend(overlapped_lhs),
@@ -804,7 +834,7 @@ MappableFlatMultiSet<MappableType, Allocator>::count_shared(const_iterator first
                                                             const MappableType1_& mappable1,
                                                             const MappableType2_& mappable2) const
 {
-    if (static_cast<decltype(max_element_size_)>(inner_distance(mappable1, mappable2)) > max_element_size_) return 0;
+    if (static_cast<typename RegionType<MappableType>::Position>(inner_distance(mappable1, mappable2)) > stats_.max_element_size()) return 0;
     const auto m = std::minmax(mapped_region(mappable1), mapped_region(mappable2));
     const auto overlapped_lhs = overlap_range(first, last, m.first);
     return std::count_if(std::cbegin(overlapped_lhs), std::cend(overlapped_lhs),
@@ -827,7 +857,7 @@ MappableFlatMultiSet<MappableType, Allocator>::shared_range(const_iterator first
                                                             const MappableType1_& mappable1,
                                                             const MappableType2_& mappable2) const
 {
-    if (inner_distance(mappable1, mappable2) > max_element_size_) {
+    if (inner_distance(mappable1, mappable2) > stats_.max_element_size()) {
         return make_shared_range(last, last, mappable1, mappable2);
     }
     const auto m = std::minmax(mapped_region(mappable1), mapped_region(mappable2));
@@ -861,8 +891,7 @@ void swap(MappableFlatMultiSet<MappableType, Allocator>& lhs,
 {
     using std::swap;
     swap(lhs.elements_, rhs.elements_);
-    swap(lhs.is_bidirectionally_sorted_, rhs.is_bidirectionally_sorted_);
-    swap(lhs.max_element_size_, rhs.max_element_size_);
+    swap(lhs.stats_, rhs.stats_);
 }
 
 template <typename ForwardIterator, typename MappableType1, typename MappableType2, typename Allocator>
@@ -18,6 +18,11 @@
 #include "mappable.hpp"
 #include "mappable_range.hpp"
 #include "mappable_algorithms.hpp"
+#include "materialised_range.hpp"
+#include "implicit_interval_tree.hpp"
+#include "parallel_sort.hpp"
+#include "sorted_element_stats.hpp"
+#include "instrumentation.hpp"
 #include "type_tricks.hpp"
 
 namespace mappable {
@@ -25,6 +30,21 @@ namespace mappable {
 /*
  MappableFlatSet is a container designed to allow fast retrieval of MappableType elements with minimal
  memory overhead.
+ 
+ If all the elements have the same size (e.g. fixed length reads) then the set is FixedSize and overlap and
+ containment queries are answered with two binary searches, returning ranges whose bases are exact.
+ 
+ If the elements are not bidirectionally sorted then overlap queries are bounded by the size of the largest
+ element, which can be poor if a few elements are much larger than the rest. In this case an overlap index
+ (an ImplicitIntervalTree over the elements) can be built with build_overlap_index, which makes has_overlapped,
+ count_overlapped and materialise_overlapped logarithmic in the worst case (plus the number of overlapped
+ elements). overlap_range then has exact bounds, but iterating it still tests every element between them;
+ indexed_overlap_range returns a range that steps directly between the overlapped elements. The index costs one
+ position per element and is rebuilt by every modification, in O(n) like the element shifts the modification
+ already makes, so const queries never modify the set and may run concurrently.
+
+ The range constructors take an optional thread count for the initial sort (0 means all hardware threads)
+ and an optional allocator.
  */
 template <typename MappableType, typename Allocator = std::allocator<MappableType>>
 class MappableFlatSet : public Comparable<MappableFlatSet<MappableType, Allocator>>
@@ -46,9 +66,16 @@ public:
     using const_reverse_iterator = typename base_t::const_reverse_iterator;
     
     MappableFlatSet();
+    explicit MappableFlatSet(const allocator_type& alloc);
     
     template <typename InputIterator>
     MappableFlatSet(InputIterator first, InputIterator second);
+    template <typename InputIterator>
+    MappableFlatSet(InputIterator first, InputIterator second, unsigned num_threads);
+    template <typename InputIterator>
+    MappableFlatSet(InputIterator first, InputIterator second, const allocator_type& alloc);
+    template <typename InputIterator>
+    MappableFlatSet(InputIterator first, InputIterator second, unsigned num_threads, const allocator_type& alloc);
     
     MappableFlatSet(std::initializer_list<MappableType> mappables);
     
@@ -93,6 +120,7 @@ public:
     iterator erase(const_iterator);
     size_type erase(const MappableType&);
     iterator erase(const_iterator, const_iterator);
+    iterator erase(const MaterialisedRange<const_iterator>&);
     template <typename BidirIt>
     size_type erase_all(BidirIt first, BidirIt last);
     
@@ -104,6 +132,8 @@ public:
     bool empty() const noexcept;
     void shrink_to_fit();
     
+    allocator_type get_allocator() const noexcept;
+    
     iterator find(const MappableType&);
     const_iterator find(const MappableType&) const;
     size_type count(const MappableType&) const;
@@ -111,6 +141,10 @@ public:
     const MappableType& leftmost() const;
     const MappableType& rightmost() const;
     
+    bool bidirectionally_sorted() const noexcept;
+    bool fixed_size() const noexcept;
+    typename RegionType<MappableType>::Position max_element_size() const noexcept;
+    
     template <typename MappableType_>
     bool has_overlapped(const MappableType_& mappable) const;
     template <typename MappableType_>
@@ -128,6 +162,15 @@ public:
     OverlapRange<const_iterator> overlap_range(const_iterator first, const_iterator last,
                                                const MappableType_& mappable) const;
     
+    template <typename MappableType_>
+    IndexedOverlapRange<const_iterator> indexed_overlap_range(const MappableType_& mappable) const;
+    
+    template <typename MappableType_>
+    MaterialisedRange<const_iterator> materialise_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    MaterialisedRange<const_iterator> materialise_overlapped(const_iterator first, const_iterator last,
+                                                             const MappableType_& mappable) const;
+    
     template <typename MappableType_>
     void erase_overlapped(const MappableType_& mappable);
     
@@ -151,6 +194,10 @@ public:
     template <typename MappableType_>
     void erase_contained(const MappableType_& mappable);
     
+    void build_overlap_index();
+    void clear_overlap_index() noexcept;
+    bool has_overlap_index() const noexcept;
+    
     template <typename M, typename A>
     friend bool operator==(const MappableFlatSet<M, A>& lhs, const MappableFlatSet<M, A>& rhs);
     template <typename M, typename A>
@@ -159,45 +206,72 @@ public:
     friend void swap(MappableFlatSet<M, A>& lhs, MappableFlatSet<M, A>& rhs) noexcept;
     
 private:
+    using Position = typename RegionType<MappableType>::Position;
+    
     base_t elements_;
-    bool is_bidirectionally_sorted_;
-    typename RegionType<MappableType>::Position max_element_size_;
+    detail::SortedElementStats<Position> stats_;
+    bool has_overlap_index_;
+    ImplicitIntervalTree<Position> overlap_index_;
+    
+    void update_overlap_index();
+    bool use_overlap_index(const_iterator first, const_iterator last) const;
 };
 
 template <typename MappableType, typename Allocator>
 MappableFlatSet<MappableType, Allocator>::MappableFlatSet()
 : elements_ {}
-, is_bidirectionally_sorted_ {true}
-, max_element_size_ {0}
+, stats_ {}
+, has_overlap_index_ {false}
+, overlap_index_ {}
+{}
+
+template <typename MappableType, typename Allocator>
+MappableFlatSet<MappableType, Allocator>::MappableFlatSet(const allocator_type& alloc)
+: elements_ {alloc}
+, stats_ {}
+, has_overlap_index_ {false}
+, overlap_index_ {}
 {}
 
 template <typename MappableType, typename Allocator>
 template <typename InputIterator>
 MappableFlatSet<MappableType, Allocator>::MappableFlatSet(InputIterator first, InputIterator second)
-: elements_ {first, second}
-, is_bidirectionally_sorted_ {true}
-, max_element_size_ {0}
+: MappableFlatSet {first, second, 1}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableFlatSet<MappableType, Allocator>::MappableFlatSet(InputIterator first, InputIterator second,
+                                                          const unsigned num_threads)
+: MappableFlatSet {first, second, num_threads, allocator_type {}}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableFlatSet<MappableType, Allocator>::MappableFlatSet(InputIterator first, InputIterator second,
+                                                          const allocator_type& alloc)
+: MappableFlatSet {first, second, 1, alloc}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableFlatSet<MappableType, Allocator>::MappableFlatSet(InputIterator first, InputIterator second,
+                                                          const unsigned num_threads, const allocator_type& alloc)
+: elements_ {first, second, alloc}
+, stats_ {}
+, has_overlap_index_ {false}
+, overlap_index_ {}
 {
     if (elements_.empty()) return;
-    std::sort(std::begin(elements_), std::end(elements_));
+    detail::parallel_sort(std::begin(elements_), std::end(elements_), num_threads);
     elements_.erase(std::unique(std::begin(elements_), std::end(elements_)), std::end(elements_));
-    is_bidirectionally_sorted_ = is_bidirectionally_sorted(elements_);
-    max_element_size_ = region_size(*largest_mappable(elements_));
+    stats_ = detail::summarise_sorted(std::cbegin(elements_), std::cend(elements_), num_threads);
 }
 
 template <typename MappableType, typename Allocator>
 MappableFlatSet<MappableType, Allocator>::MappableFlatSet(std::initializer_list<MappableType> mappables)
-:
-elements_ {mappables},
-is_bidirectionally_sorted_ {true},
-max_element_size_ {0}
-{
-    if (elements_.empty()) return;
-    std::sort(std::begin(elements_), std::end(elements_));
-    elements_.erase(std::unique(std::begin(elements_), std::end(elements_)), std::end(elements_));
-    is_bidirectionally_sorted_ = is_bidirectionally_sorted(elements_);
-    max_element_size_ = region_size(*largest_mappable(elements_));
-}
+: MappableFlatSet {std::begin(mappables), std::end(mappables), 1}
+{}
 
 template <typename MappableType, typename Allocator>
 typename MappableFlatSet<MappableType, Allocator>::iterator
@@ -361,11 +435,8 @@ MappableFlatSet<MappableType, Allocator>::emplace(Args... args)
     }
     std::rotate(std::rbegin(elements_), std::next(std::rbegin(elements_)),
                 std::make_reverse_iterator(it));
-    if (is_bidirectionally_sorted_) {
-        const auto overlapped = overlap_range(*it);
-        is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
-    }
-    max_element_size_ = std::max(max_element_size_, region_size(*it));
+    stats_.insert(std::cbegin(elements_), std::cend(elements_), const_iterator {it});
+    update_overlap_index();
     return std::make_pair(it, true);
 }
 
@@ -379,11 +450,8 @@ MappableFlatSet<MappableType, Allocator>::insert(const MappableType& m)
     } else {
         return std::make_pair(it, false);
     }
-    if (is_bidirectionally_sorted_) {
-        const auto overlapped = overlap_range(*it);
-        is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
-    }
-    max_element_size_ = std::max(max_element_size_, region_size(*it));
+    stats_.insert(std::cbegin(elements_), std::cend(elements_), const_iterator {it});
+    update_overlap_index();
     return std::make_pair(it, true);
 }
 
@@ -397,11 +465,8 @@ MappableFlatSet<MappableType, Allocator>::insert(MappableType&& m)
     } else {
         return std::make_pair(it, false);
     }
-    if (is_bidirectionally_sorted_) {
-        const auto overlapped = overlap_range(*it);
-        is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
-    }
-    max_element_size_ = std::max(max_element_size_, region_size(*it));
+    stats_.insert(std::cbegin(elements_), std::cend(elements_), const_iterator {it});
+    update_overlap_index();
     return std::make_pair(it, true);
 }
 
@@ -444,17 +509,14 @@ MappableFlatSet<MappableType, Allocator>::insert(const_iterator hint, const Mapp
     } else {
         if (empty() || elements_.back() < m) {
             elements_.push_back(m);
-            result = std::begin(elements_);
+            result = std::prev(std::end(elements_));
         } else {
             return insert(m).first; // bad hint
         }
     }
-    // the element was inserted
-    if (is_bidirectionally_sorted_) {
-        const auto overlapped = overlap_range(m);
-        is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
-    }
-    max_element_size_ = std::max(max_element_size_, region_size(m));
+    // the element was inserted and result now points to it
+    stats_.insert(std::cbegin(elements_), std::cend(elements_), const_iterator {result});
+    update_overlap_index();
     return result;
 }
 
@@ -496,17 +558,14 @@ MappableFlatSet<MappableType, Allocator>::insert(const_iterator hint, MappableTy
     } else {
         if (empty() || elements_.back() < m) {
             elements_.push_back(std::move(m));
-            result = std::begin(elements_);
+            result = std::prev(std::end(elements_));
         } else {
             return insert(std::move(m)).first; // bad hint
         }
     }
     // the element was inserted and result now points to it
-    if (is_bidirectionally_sorted_) {
-        const auto overlapped = overlap_range(*result);
-        is_bidirectionally_sorted_ = is_bidirectionally_sorted(overlapped);
-    }
-    max_element_size_ = std::max(max_element_size_, region_size(*result));
+    stats_.insert(std::cbegin(elements_), std::cend(elements_), const_iterator {result});
+    update_overlap_index();
     return result;
 }
 
@@ -515,22 +574,25 @@ template <typename InputIterator>
 void MappableFlatSet<MappableType, Allocator>::insert(InputIterator first, InputIterator last)
 {
     if (first == last) return;
-    max_element_size_ = std::max(max_element_size_, region_size(*largest_mappable(first, last)));
-    for (auto it1 = first; it1 != last; ) {
-        const auto it2 = std::is_sorted_until(it1, last);
-        auto ub = std::upper_bound(std::begin(elements_), std::end(elements_), *std::prev(it2));
-        const auto d = std::distance(it1, it2);
-        const auto it3 = elements_.insert(ub, it1, it2);
-        // ub is now invalidated
-        const auto lb = std::lower_bound(std::begin(elements_), it3, *it3);
-        ub = std::next(it3, d);
-        std::inplace_merge(lb, it3, ub);
-        elements_.erase(std::unique(lb, ub), ub);
-        it1 = it2;
-    }
-    if (is_bidirectionally_sorted_) {
-        is_bidirectionally_sorted_ = is_bidirectionally_sorted(elements_);
-    }
+    // Only the elements not already present are inserted, as one sorted run merged into place
+    std::vector<MappableType, Allocator> values {first, last, elements_.get_allocator()};
+    std::sort(std::begin(values), std::end(values));
+    values.erase(std::unique(std::begin(values), std::end(values)), std::end(values));
+    values.erase(std::remove_if(std::begin(values), std::end(values), [this] (const auto& mappable) {
+                     return std::binary_search(std::cbegin(elements_), std::cend(elements_), mappable);
+                 }), std::end(values));
+    if (values.empty()) return;
+    const auto blocks = stats_.insertion_blocks(std::cbegin(elements_), std::cend(elements_),
+                                                std::cbegin(values), std::cend(values));
+    stats_.split(std::cbegin(elements_), std::cend(elements_), blocks);
+    const auto ub = std::upper_bound(std::begin(elements_), std::end(elements_), values.back());
+    const auto it = elements_.insert(ub, std::make_move_iterator(std::begin(values)),
+                                     std::make_move_iterator(std::end(values)));
+    // ub is now invalidated
+    const auto lb = std::lower_bound(std::begin(elements_), it, *it);
+    std::inplace_merge(lb, it, std::next(it, values.size()));
+    stats_.insert_blocks(std::cbegin(elements_), std::cend(elements_), blocks);
+    update_overlap_index();
 }
 
 template <typename MappableType, typename Allocator>
@@ -545,16 +607,9 @@ typename MappableFlatSet<MappableType, Allocator>::iterator
 MappableFlatSet<MappableType, Allocator>::erase(const_iterator p)
 {
     if (p == cend()) return elements_.erase(p);
-    const auto erased_size = region_size(*p);
+    stats_.erase(std::cbegin(elements_), std::cend(elements_), p, std::next(p));
     const auto result = elements_.erase(p);
-    if (elements_.empty()) {
-        max_element_size_ = 0;
-        is_bidirectionally_sorted_ = true;
-    } else {
-        if (max_element_size_ == erased_size) {
-            max_element_size_ = region_size(*largest_mappable(elements_));
-        }
-    }
+    update_overlap_index();
     return result;
 }
 
@@ -564,16 +619,9 @@ MappableFlatSet<MappableType, Allocator>::erase(const MappableType& m)
 {
     const auto it = std::lower_bound(std::cbegin(elements_), std::cend(elements_), m);
     if (it != std::cend(elements_) && *it == m) {
-        const auto m_size = region_size(m);
+        stats_.erase(std::cbegin(elements_), std::cend(elements_), it, std::next(it));
         elements_.erase(it);
-        if (elements_.empty()) {
-            max_element_size_ = 0;
-            is_bidirectionally_sorted_ = true;
-        } else {
-            if (max_element_size_ == m_size) {
-                max_element_size_ = region_size(*largest_mappable(elements_));
-            }
-        }
+        update_overlap_index();
         return 1;
     }
     return 0;
@@ -584,16 +632,32 @@ typename MappableFlatSet<MappableType, Allocator>::iterator
 MappableFlatSet<MappableType, Allocator>::erase(const_iterator first, const_iterator last)
 {
     if (first == last) return elements_.erase(first, last);
-    const auto max_erased_size = region_size(*largest_mappable(first, last));
+    stats_.erase(std::cbegin(elements_), std::cend(elements_), first, last);
     const auto result = elements_.erase(first, last);
-    if (elements_.empty()) {
-        max_element_size_ = 0;
-        is_bidirectionally_sorted_ = true;
-    } else {
-        if (max_element_size_ == max_erased_size) {
-            max_element_size_ = region_size(*largest_mappable(elements_));
-        }
+    update_overlap_index();
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableFlatSet<MappableType, Allocator>::iterator
+MappableFlatSet<MappableType, Allocator>::erase(const MaterialisedRange<const_iterator>& range)
+{
+    if (range.is_contiguous()) return erase(range.base_begin(), range.base_end());
+    stats_.erase(std::cbegin(elements_), std::cend(elements_), range.base_begin(), range.base_end());
+    // Compact the unselected elements between the bounds of range to the front, in a single pass
+    const auto offset = std::distance(std::cbegin(elements_), range.base_begin());
+    const auto first = std::next(std::begin(elements_), offset);
+    const auto last = std::next(first, base_size(range));
+    auto kept_last = first;
+    const auto& offsets = range.offsets();
+    for (std::size_t i {1}; i < offsets.size(); ++i) {
+        kept_last = std::move(std::next(first, offsets[i - 1] + 1), std::next(first, offsets[i]), kept_last);
     }
+    const auto num_kept = std::distance(first, kept_last);
+    const auto result = elements_.erase(kept_last, last);
+    const auto kept_first = std::next(std::cbegin(elements_), offset);
+    stats_.insert(std::cbegin(elements_), std::cend(elements_), kept_first, std::next(kept_first, num_kept));
+    update_overlap_index();
     return result;
 }
 
@@ -622,7 +686,6 @@ MappableFlatSet<MappableType, Allocator>::erase_all(BidirIt first, const BidirIt
     const auto region = encompassing_region(first, last);
     auto contained_elements = bases(contained_range(std::begin(elements_), std::end(elements_), region));
     if (contained_elements.empty()) return num_erased;
-    typename RegionType<MappableType>::Size max_erased_size {0};
     auto first_contained = std::begin(contained_elements);
     auto last_contained  = std::end(contained_elements);
     auto last_element = std::end(elements_);
@@ -631,11 +694,11 @@ MappableFlatSet<MappableType, Allocator>::erase_all(BidirIt first, const BidirIt
         const auto it = detail::binary_find(first_contained, last_contained, *first);
         if (it != last_contained) {
             const auto p = std::mismatch(std::next(it), last_contained, std::next(first), last);
+            stats_.erase(std::begin(elements_), last_element, it, p.first);
             const auto n = std::distance(p.first, last_contained);
             last_element = std::rotate(it, p.first, last_element);
             first_contained = it;
             last_contained  = std::next(it, n);
-            max_erased_size = std::max(max_erased_size, region_size(*largest_mappable(first, p.second)));
             num_erased += std::distance(first, p.second);
             first = p.second;
         } else {
@@ -645,17 +708,7 @@ MappableFlatSet<MappableType, Allocator>::erase_all(BidirIt first, const BidirIt
     
     if (num_erased > 0) {
         elements_.erase(last_element, std::end(elements_));
-        if (!elements_.empty()) {
-            if (!is_bidirectionally_sorted_) {
-                is_bidirectionally_sorted_ = is_bidirectionally_sorted(elements_);
-            }
-            if (max_element_size_ == max_erased_size) {
-                max_element_size_ = region_size(*largest_mappable(elements_));
-            }
-        } else {
-            max_element_size_ = 0;
-            is_bidirectionally_sorted_ = true;
-        }
+        update_overlap_index();
     }
     
     return num_erased;
@@ -665,8 +718,8 @@ template <typename MappableType, typename Allocator>
 void MappableFlatSet<MappableType, Allocator>::clear()
 {
     elements_.clear();
-    is_bidirectionally_sorted_ = true;
-    max_element_size_ = 0;
+    stats_.clear();
+    update_overlap_index();
 }
 
 template <typename MappableType, typename Allocator>
@@ -696,6 +749,13 @@ MappableFlatSet<MappableType, Allocator>::shrink_to_fit()
     elements_.shrink_to_fit();
 }
 
+template <typename MappableType, typename Allocator>
+typename MappableFlatSet<MappableType, Allocator>::allocator_type
+MappableFlatSet<MappableType, Allocator>::get_allocator() const noexcept
+{
+    return elements_.get_allocator();
+}
+
 template <typename MappableType, typename Allocator>
 typename MappableFlatSet<MappableType, Allocator>::iterator
 MappableFlatSet<MappableType, Allocator>::find(const MappableType& m)
@@ -731,26 +791,40 @@ template <typename MappableType, typename Allocator>
 const MappableType& MappableFlatSet<MappableType, Allocator>::rightmost() const
 {
     const auto& last = *std::prev(std::cend(elements_));
-    if (is_bidirectionally_sorted_) {
+    if (stats_.is_bidirectionally_sorted()) {
         return last;
     } else {
         using mappable::overlap_range;
         const auto overlapped = overlap_range(std::cbegin(elements_), std::cend(elements_), last,
-                                              max_element_size_);
+                                              stats_.max_element_size());
         return *rightmost_mappable(std::cbegin(overlapped), std::cend(overlapped));
     }
 }
 
+template <typename MappableType, typename Allocator>
+bool MappableFlatSet<MappableType, Allocator>::bidirectionally_sorted() const noexcept
+{
+    return stats_.is_bidirectionally_sorted();
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableFlatSet<MappableType, Allocator>::fixed_size() const noexcept
+{
+    return stats_.is_fixed_size();
+}
+
+template <typename MappableType, typename Allocator>
+typename RegionType<MappableType>::Position
+MappableFlatSet<MappableType, Allocator>::max_element_size() const noexcept
+{
+    return stats_.max_element_size();
+}
+
 template <typename MappableType, typename Allocator>
 template <typename MappableType_>
 bool
 MappableFlatSet<MappableType, Allocator>::has_overlapped(const MappableType_& mappable) const
 {
-    using mappable::has_overlapped;
-    if (is_bidirectionally_sorted_) {
-        return has_overlapped(std::cbegin(elements_), std::cend(elements_), mappable,
-                              BidirectionallySortedTag {});
-    }
     return has_overlapped(std::cbegin(elements_), std::cend(elements_), mappable);
 }
 
@@ -761,10 +835,16 @@ MappableFlatSet<MappableType, Allocator>::has_overlapped(const_iterator first, c
                                                          const MappableType_& mappable) const
 {
     using mappable::has_overlapped;
-    if (is_bidirectionally_sorted_) {
+    if (stats_.is_fixed_size()) {
+        return has_overlapped(first, last, mappable, FixedSizeTag {});
+    }
+    if (stats_.is_bidirectionally_sorted()) {
         return has_overlapped(first, last, mappable, BidirectionallySortedTag {});
     }
-    return has_overlapped(first, last, mappable, max_element_size_);
+    if (use_overlap_index(first, last)) {
+        return overlap_index_.has_overlapped(first, last, mappable);
+    }
+    return has_overlapped(first, last, mappable, stats_.max_element_size());
 }
 
 template <typename MappableType, typename Allocator>
@@ -782,12 +862,23 @@ MappableFlatSet<MappableType, Allocator>::count_overlapped(const_iterator first,
                                                            const MappableType_& mappable) const
 {
     using mappable::count_overlapped;
-    if (is_bidirectionally_sorted_) {
+    if (stats_.is_fixed_size()) {
+        return count_overlapped(first, last, mappable, FixedSizeTag {});
+    }
+    if (stats_.is_bidirectionally_sorted()) {
         return count_overlapped(first, last, mappable, BidirectionallySortedTag {});
     }
-    return count_overlapped(first, last, mappable, max_element_size_);
+    if (use_overlap_index(first, last)) {
+        return overlap_index_.count_overlapped(first, last, mappable);
+    }
+    return count_overlapped(first, last, mappable, stats_.max_element_size());
 }
 
+/**
+ Returns an OverlapRange of the elements that overlap mappable. With an overlap index the bounds are found in
+ O(log n), but iterating the range still tests every element between the bounds, so it is not O(log n + k) for
+ k overlapped elements; use indexed_overlap_range or materialise_overlapped for that.
+ */
 template <typename MappableType, typename Allocator>
 template <typename MappableType_>
 OverlapRange<typename MappableFlatSet<MappableType, Allocator>::const_iterator>
@@ -803,26 +894,62 @@ MappableFlatSet<MappableType, Allocator>::overlap_range(const_iterator first, co
                                                         const MappableType_& mappable) const
 {
     using mappable::overlap_range;
-    if (is_bidirectionally_sorted_) {
+    if (stats_.is_fixed_size()) {
+        return overlap_range(first, last, mappable, FixedSizeTag {});
+    }
+    if (stats_.is_bidirectionally_sorted()) {
         return overlap_range(first, last, mappable, BidirectionallySortedTag {});
     }
-    return overlap_range(first, last, mappable, max_element_size_);
+    if (use_overlap_index(first, last)) {
+        return overlap_index_.overlap_range(first, last, mappable);
+    }
+    return overlap_range(first, last, mappable, stats_.max_element_size());
 }
 
+/**
+ Returns a range of the elements that overlap mappable, which steps directly between the overlapped elements.
+ 
+ Requires has_overlap_index().
+ */
 template <typename MappableType, typename Allocator>
 template <typename MappableType_>
-void MappableFlatSet<MappableType, Allocator>::erase_overlapped(const MappableType_& mappable)
+IndexedOverlapRange<typename MappableFlatSet<MappableType, Allocator>::const_iterator>
+MappableFlatSet<MappableType, Allocator>::indexed_overlap_range(const MappableType_& mappable) const
 {
-    const auto overlapped = overlap_range(mappable);
-    using mappable::size;
-    if (is_bidirectionally_sorted_ || size(overlapped) == base_size(overlapped)) {
-        erase(std::cbegin(overlapped).base(), std::cend(overlapped).base());
-    } else {
-        // Must make copies as the iterator range passed to erase_all
-        // cannot overlap with elements_
-        const std::vector<MappableType> tmp {std::cbegin(overlapped), std::cend(overlapped)};
-        erase_all(std::cbegin(tmp), std::cend(tmp));
+    return overlap_index_.indexed_overlap_range(std::cbegin(elements_), std::cend(elements_), mappable);
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+MaterialisedRange<typename MappableFlatSet<MappableType, Allocator>::const_iterator>
+MappableFlatSet<MappableType, Allocator>::materialise_overlapped(const MappableType_& mappable) const
+{
+    return materialise_overlapped(std::cbegin(elements_), std::cend(elements_), mappable);
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+MaterialisedRange<typename MappableFlatSet<MappableType, Allocator>::const_iterator>
+MappableFlatSet<MappableType, Allocator>::materialise_overlapped(const_iterator first, const_iterator last,
+                                                                 const MappableType_& mappable) const
+{
+    if (stats_.is_bidirectionally_sorted()) {
+        return materialise(overlap_range(first, last, mappable), BidirectionallySortedTag {});
     }
+    if (use_overlap_index(first, last)) {
+        return overlap_index_.materialise_overlapped(first, last, mappable);
+    }
+    return materialise(overlap_range(first, last, mappable));
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+void MappableFlatSet<MappableType, Allocator>::erase_overlapped(const MappableType_& mappable)
+{
+    const auto erased = materialise_overlapped(mappable);
+    detail::CallRecorder recorder {Algorithm::erase_overlapped};
+    recorder.scanned(base_size(erased)); // erase compacts the elements between the bounds of erased
+    erase(erased);
 }
 
 template <typename MappableType, typename Allocator>
@@ -840,6 +967,9 @@ MappableFlatSet<MappableType, Allocator>::has_contained(const_iterator first, co
                                                         const MappableType_& mappable) const
 {
     using mappable::has_contained;
+    if (stats_.is_fixed_size()) {
+        return has_contained(first, last, mappable, FixedSizeTag {});
+    }
     return has_contained(first, last, mappable);
 }
 
@@ -858,6 +988,9 @@ MappableFlatSet<MappableType, Allocator>::count_contained(const_iterator first,
                                                           const MappableType_& mappable) const
 {
     using mappable::count_contained;
+    if (stats_.is_fixed_size()) {
+        return count_contained(first, last, mappable, FixedSizeTag {});
+    }
     return count_contained(first, last, mappable);
 }
 
@@ -876,6 +1009,9 @@ MappableFlatSet<MappableType, Allocator>::contained_range(const_iterator first,
                                                           const MappableType_& mappable) const
 {
     using mappable::contained_range;
+    if (stats_.is_fixed_size()) {
+        return contained_range(first, last, mappable, FixedSizeTag {});
+    }
     return contained_range(first, last, mappable);
 }
 
@@ -883,16 +1019,46 @@ template <typename MappableType, typename Allocator>
 template <typename MappableType_>
 void MappableFlatSet<MappableType, Allocator>::erase_contained(const MappableType_& mappable)
 {
-    const auto contained = contained_range(mappable);
-    using mappable::size;
-    if (is_bidirectionally_sorted_ || size(contained) == base_size(contained)) {
-        erase(std::cbegin(contained).base(), std::cend(contained).base());
-    } else {
-        // Must make copies as the iterator range passed to erase_all
-        // cannot overlap with elements_
-        const std::vector<MappableType> tmp {std::cbegin(contained), std::cend(contained)};
-        erase_all(std::cbegin(tmp), std::cend(tmp));
-    }
+    const auto erased = stats_.is_bidirectionally_sorted() ? materialise(contained_range(mappable), BidirectionallySortedTag {})
+                                                           : materialise(contained_range(mappable));
+    detail::CallRecorder recorder {Algorithm::erase_contained};
+    recorder.scanned(base_size(erased)); // erase compacts the elements between the bounds of erased
+    erase(erased);
+}
+
+template <typename MappableType, typename Allocator>
+void MappableFlatSet<MappableType, Allocator>::build_overlap_index()
+{
+    has_overlap_index_ = true;
+    overlap_index_.rebuild(std::cbegin(elements_), std::cend(elements_));
+}
+
+template <typename MappableType, typename Allocator>
+void MappableFlatSet<MappableType, Allocator>::clear_overlap_index() noexcept
+{
+    has_overlap_index_ = false;
+    overlap_index_.clear();
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableFlatSet<MappableType, Allocator>::has_overlap_index() const noexcept
+{
+    return has_overlap_index_;
+}
+
+template <typename MappableType, typename Allocator>
+void MappableFlatSet<MappableType, Allocator>::update_overlap_index()
+{
+    // Rebuilding in the modifiers rather than lazily in the queries keeps the const queries free of writes
+    if (has_overlap_index_) overlap_index_.rebuild(std::cbegin(elements_), std::cend(elements_));
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableFlatSet<MappableType, Allocator>::use_overlap_index(const_iterator first,
+                                                                 const_iterator last) const
+{
+    // The index only describes the whole set
+    return has_overlap_index_ && first == std::cbegin(elements_) && last == std::cend(elements_);
 }
 
 // non-member methods
@@ -917,8 +1083,9 @@ void swap(MappableFlatSet<MappableType, Allocator>& lhs,
 {
     using std::swap;
     swap(lhs.elements_, rhs.elements_);
-    swap(lhs.is_bidirectionally_sorted_, rhs.is_bidirectionally_sorted_);
-    swap(lhs.max_element_size_, rhs.max_element_size_);
+    swap(lhs.stats_, rhs.stats_);
+    swap(lhs.has_overlap_index_, rhs.has_overlap_index_);
+    swap(lhs.overlap_index_, rhs.overlap_index_);
 }
 
 } // namespace mappable
@@ -5,12 +5,26 @@
 #define mappable_fwd_hpp
 
 #include "contig_region.hpp"
+#include "contig_dictionary.hpp"
 #include "genomic_region.hpp"
 #include "mappable.hpp"
 #include "mappable_algorithms.hpp"
+#include "instrumentation.hpp"
+#include "materialised_range.hpp"
+#include "segmentation.hpp"
 #include "mappable_flat_set.hpp"
 #include "mappable_flat_multi_set.hpp"
+#include "mappable_bucketed_multi_set.hpp"
+#include "mappable_column_set.hpp"
+#include "mappable_genome_set.hpp"
+#include "mappable_log_structured_set.hpp"
+#include "mappable_snapshot.hpp"
+#include "overlap_cursor.hpp"
 #include "mappable_reference_wrapper.hpp"
 #include "mappable_map.hpp"
+#include "coverage_track.hpp"
+#include "coverage_run_iterator.hpp"
+#include "region_reader.hpp"
+#include "region_writer.hpp"
 
 #endif
@@ -0,0 +1,490 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef mappable_genome_set_hpp
+#define mappable_genome_set_hpp
+
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include <stdexcept>
+
+#include <boost/optional.hpp>
+
+#include "comparable.hpp"
+#include "genomic_region.hpp"
+#include "mappable.hpp"
+#include "mappable_range.hpp"
+#include "mappable_flat_set.hpp"
+#include "type_tricks.hpp"
+
+namespace mappable {
+
+/**
+ ContigMappable wraps a GenomicRegion mapped MappableType so that it is mapped to the ContigRegion of the
+ wrapped element. Comparisons only compare the contig region unless the contig regions are equal, so
+ containers of ContigMappable elements never compare contig names.
+ */
+template <typename MappableType>
+class ContigMappable : public Mappable<ContigMappable<MappableType>>, public Comparable<ContigMappable<MappableType>>
+{
+public:
+    static_assert(std::is_same<RegionType<MappableType>, GenomicRegion>::value, "GenomicRegion Mappable required");
+
+    using type = MappableType;
+
+    ContigMappable() = default;
+
+    ContigMappable(MappableType mappable)
+    : mappable_ {std::move(mappable)}
+    , region_ {}
+    {
+        const auto& region = mappable::mapped_region(mappable_);
+        region_ = region.contig_region();
+    }
+
+    ContigMappable(const ContigMappable&)            = default;
+    ContigMappable& operator=(const ContigMappable&) = default;
+    ContigMappable(ContigMappable&&)                 = default;
+    ContigMappable& operator=(ContigMappable&&)      = default;
+
+    ~ContigMappable() = default;
+
+    operator const MappableType&() const noexcept { return mappable_; }
+
+    const MappableType& get() const noexcept { return mappable_; }
+
+    const ContigRegion& mapped_region() const noexcept { return region_; }
+
+private:
+    MappableType mappable_;
+    ContigRegion region_;
+};
+
+template <typename MappableType>
+bool operator==(const ContigMappable<MappableType>& lhs, const ContigMappable<MappableType>& rhs)
+{
+    return lhs.mapped_region() == rhs.mapped_region() && lhs.get() == rhs.get();
+}
+
+template <typename MappableType>
+bool operator<(const ContigMappable<MappableType>& lhs, const ContigMappable<MappableType>& rhs)
+{
+    if (lhs.mapped_region() == rhs.mapped_region()) return lhs.get() < rhs.get();
+    return lhs.mapped_region() < rhs.mapped_region();
+}
+
+/*
+ MappableGenomeSet is a set of GenomicRegion mapped MappableType elements spanning many contigs. Elements are
+ partitioned by contig into a flat vector of MappableFlatSet containers of ContigMappable elements, in the
+ order the contigs were first inserted, so each query is routed to its contig once and then only compares
+ ContigRegions. If MAPPABLE_INTERNED_CONTIGS is defined the contig id indexes a table of vector positions;
+ otherwise the contig name is binary searched in a small vector sorted by name length first, so most of the
+ comparisons are size comparisons and no name is hashed.
+
+ The query methods have the same names and semantics as MappableFlatSet, but the returned ranges are over
+ ContigMappable elements, which implicitly convert to const MappableType&. There is no whole set iteration;
+ iterate contig(name) for each name in contigs() instead. Each contig set allocates from a rebound copy of the
+ set's allocator.
+ */
+template <typename MappableType, typename Allocator = std::allocator<MappableType>>
+class MappableGenomeSet
+{
+public:
+    using value_type        = MappableType;
+    using contig_value_type = ContigMappable<MappableType>;
+    using contig_set_type   = MappableFlatSet<contig_value_type, RebindAlloc<Allocator, contig_value_type>>;
+    using allocator_type    = Allocator;
+    using size_type         = std::size_t;
+    using const_iterator    = typename contig_set_type::const_iterator;
+    using ContigName        = GenomicRegion::ContigName;
+
+    MappableGenomeSet();
+    explicit MappableGenomeSet(const allocator_type& alloc);
+
+    template <typename InputIterator>
+    MappableGenomeSet(InputIterator first, InputIterator last);
+    template <typename InputIterator>
+    MappableGenomeSet(InputIterator first, InputIterator last, const allocator_type& alloc);
+
+    MappableGenomeSet(std::initializer_list<MappableType> mappables);
+
+    MappableGenomeSet(const MappableGenomeSet&)            = default;
+    MappableGenomeSet& operator=(const MappableGenomeSet&) = default;
+    MappableGenomeSet(MappableGenomeSet&&)                 = default;
+    MappableGenomeSet& operator=(MappableGenomeSet&&)      = default;
+
+    ~MappableGenomeSet() = default;
+
+    allocator_type get_allocator() const noexcept;
+
+    template <typename ...Args>
+    bool emplace(Args&&...);
+    bool insert(const MappableType&);
+    bool insert(MappableType&&);
+    template <typename InputIterator>
+    void insert(InputIterator, InputIterator);
+    size_type erase(const MappableType&);
+
+    void clear();
+
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+
+    size_type count(const MappableType&) const;
+
+    std::vector<ContigName> contigs() const;
+    const contig_set_type& contig(const ContigName& contig) const;
+
+    template <typename MappableType_>
+    bool has_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    size_type count_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    OverlapRange<const_iterator> overlap_range(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    void erase_overlapped(const MappableType_& mappable);
+
+    template <typename MappableType_>
+    bool has_contained(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    size_type count_contained(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    ContainedRange<const_iterator> contained_range(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    void erase_contained(const MappableType_& mappable);
+
+private:
+    using ContigKey = GenomicRegion::ContigKey;
+
+    using ContigSetVector = std::vector<contig_set_type, RebindAlloc<Allocator, contig_set_type>>;
+    using PartitionVector = std::vector<contig_value_type, RebindAlloc<Allocator, contig_value_type>>;
+
+    ContigSetVector contigs_;
+    std::vector<ContigKey> keys_;
+#ifdef MAPPABLE_INTERNED_CONTIGS
+    static constexpr size_type no_index {static_cast<size_type>(-1)};
+    std::vector<size_type> indices_;
+#else
+    using ContigIndex = std::pair<ContigKey, size_type>;
+    std::vector<ContigIndex> indices_;
+#endif
+    size_type size_;
+    contig_set_type empty_contig_;
+
+    static boost::optional<ContigKey> find_key(const ContigName& contig);
+#ifndef MAPPABLE_INTERNED_CONTIGS
+    typename std::vector<ContigIndex>::const_iterator find_index_position(const ContigKey& key) const;
+#endif
+    boost::optional<size_type> find_index(const ContigKey& key) const;
+    size_type get_index(const ContigKey& key);
+    template <typename MappableType_>
+    const contig_set_type* find_contig(const MappableType_& mappable) const;
+};
+
+#ifdef MAPPABLE_INTERNED_CONTIGS
+template <typename MappableType, typename Allocator>
+constexpr typename MappableGenomeSet<MappableType, Allocator>::size_type MappableGenomeSet<MappableType, Allocator>::no_index;
+#endif
+
+template <typename MappableType, typename Allocator>
+MappableGenomeSet<MappableType, Allocator>::MappableGenomeSet()
+: MappableGenomeSet {allocator_type {}}
+{}
+
+template <typename MappableType, typename Allocator>
+MappableGenomeSet<MappableType, Allocator>::MappableGenomeSet(const allocator_type& alloc)
+: contigs_ {rebind_alloc<contig_set_type>(alloc)}
+, keys_ {}
+, indices_ {}
+, size_ {0}
+, empty_contig_ {rebind_alloc<contig_value_type>(alloc)}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableGenomeSet<MappableType, Allocator>::MappableGenomeSet(InputIterator first, InputIterator last)
+: MappableGenomeSet {first, last, allocator_type {}}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableGenomeSet<MappableType, Allocator>::MappableGenomeSet(InputIterator first, InputIterator last,
+                                                              const allocator_type& alloc)
+: MappableGenomeSet {alloc}
+{
+    insert(first, last);
+}
+
+template <typename MappableType, typename Allocator>
+MappableGenomeSet<MappableType, Allocator>::MappableGenomeSet(std::initializer_list<MappableType> mappables)
+: MappableGenomeSet {std::begin(mappables), std::end(mappables)}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename ...Args>
+bool MappableGenomeSet<MappableType, Allocator>::emplace(Args&&... args)
+{
+    return insert(MappableType(std::forward<Args>(args)...));
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableGenomeSet<MappableType, Allocator>::insert(const MappableType& mappable)
+{
+    return insert(MappableType {mappable});
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableGenomeSet<MappableType, Allocator>::insert(MappableType&& mappable)
+{
+    const auto index = get_index(mapped_region(mappable).contig_key());
+    const auto result = contigs_[index].insert(contig_value_type {std::move(mappable)}).second;
+    if (result) ++size_;
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+void MappableGenomeSet<MappableType, Allocator>::insert(InputIterator first, InputIterator last)
+{
+    // Bulk insert each contig so the contig sets only sort once
+    const PartitionVector empty_partition {rebind_alloc<contig_value_type>(get_allocator())};
+    std::vector<PartitionVector> partitions(contigs_.size(), empty_partition);
+    std::for_each(first, last, [this, &partitions, &empty_partition] (const auto& mappable) {
+        const auto index = get_index(mapped_region(mappable).contig_key());
+        if (index >= partitions.size()) partitions.resize(index + 1, empty_partition);
+        partitions[index].emplace_back(mappable);
+    });
+    for (size_type index {0}; index < partitions.size(); ++index) {
+        if (!partitions[index].empty()) {
+            auto& contig = contigs_[index];
+            size_ -= contig.size();
+            contig.insert(std::cbegin(partitions[index]), std::cend(partitions[index]));
+            size_ += contig.size();
+        }
+    }
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableGenomeSet<MappableType, Allocator>::size_type
+MappableGenomeSet<MappableType, Allocator>::erase(const MappableType& mappable)
+{
+    const auto index = find_index(mapped_region(mappable).contig_key());
+    if (!index) return 0;
+    const auto result = contigs_[*index].erase(contig_value_type {mappable});
+    size_ -= result;
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableGenomeSet<MappableType, Allocator>::allocator_type
+MappableGenomeSet<MappableType, Allocator>::get_allocator() const noexcept
+{
+    return allocator_type {contigs_.get_allocator()};
+}
+
+template <typename MappableType, typename Allocator>
+void MappableGenomeSet<MappableType, Allocator>::clear()
+{
+    contigs_.clear();
+    keys_.clear();
+    indices_.clear();
+    size_ = 0;
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableGenomeSet<MappableType, Allocator>::size_type
+MappableGenomeSet<MappableType, Allocator>::size() const noexcept
+{
+    return size_;
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableGenomeSet<MappableType, Allocator>::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableGenomeSet<MappableType, Allocator>::size_type
+MappableGenomeSet<MappableType, Allocator>::count(const MappableType& mappable) const
+{
+    const auto contig = find_contig(mappable);
+    return contig ? contig->count(contig_value_type {mappable}) : 0;
+}
+
+template <typename MappableType, typename Allocator>
+std::vector<typename MappableGenomeSet<MappableType, Allocator>::ContigName>
+MappableGenomeSet<MappableType, Allocator>::contigs() const
+{
+    std::vector<ContigName> result {};
+    for (size_type index {0}; index < contigs_.size(); ++index) {
+        if (!contigs_[index].empty()) {
+            result.push_back(GenomicRegion {keys_[index], 0, 0}.contig_name());
+        }
+    }
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+const typename MappableGenomeSet<MappableType, Allocator>::contig_set_type&
+MappableGenomeSet<MappableType, Allocator>::contig(const ContigName& contig) const
+{
+    // Looking up the key rather than making a GenomicRegion never interns an unknown contig
+    const auto key = find_key(contig);
+    const auto index = key ? find_index(*key) : boost::none;
+    return index ? contigs_[*index] : empty_contig_;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+bool MappableGenomeSet<MappableType, Allocator>::has_overlapped(const MappableType_& mappable) const
+{
+    const auto contig = find_contig(mappable);
+    return contig && contig->has_overlapped(mapped_region(mappable).contig_region());
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableGenomeSet<MappableType, Allocator>::size_type
+MappableGenomeSet<MappableType, Allocator>::count_overlapped(const MappableType_& mappable) const
+{
+    const auto contig = find_contig(mappable);
+    return contig ? contig->count_overlapped(mapped_region(mappable).contig_region()) : 0;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+OverlapRange<typename MappableGenomeSet<MappableType, Allocator>::const_iterator>
+MappableGenomeSet<MappableType, Allocator>::overlap_range(const MappableType_& mappable) const
+{
+    const auto contig = find_contig(mappable);
+    return (contig ? *contig : empty_contig_).overlap_range(mapped_region(mappable).contig_region());
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+void MappableGenomeSet<MappableType, Allocator>::erase_overlapped(const MappableType_& mappable)
+{
+    const auto index = find_index(mapped_region(mappable).contig_key());
+    if (!index) return;
+    auto& contig = contigs_[*index];
+    size_ -= contig.size();
+    contig.erase_overlapped(mapped_region(mappable).contig_region());
+    size_ += contig.size();
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+bool MappableGenomeSet<MappableType, Allocator>::has_contained(const MappableType_& mappable) const
+{
+    const auto contig = find_contig(mappable);
+    return contig && contig->has_contained(mapped_region(mappable).contig_region());
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableGenomeSet<MappableType, Allocator>::size_type
+MappableGenomeSet<MappableType, Allocator>::count_contained(const MappableType_& mappable) const
+{
+    const auto contig = find_contig(mappable);
+    return contig ? contig->count_contained(mapped_region(mappable).contig_region()) : 0;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+ContainedRange<typename MappableGenomeSet<MappableType, Allocator>::const_iterator>
+MappableGenomeSet<MappableType, Allocator>::contained_range(const MappableType_& mappable) const
+{
+    const auto contig = find_contig(mappable);
+    return (contig ? *contig : empty_contig_).contained_range(mapped_region(mappable).contig_region());
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+void MappableGenomeSet<MappableType, Allocator>::erase_contained(const MappableType_& mappable)
+{
+    const auto index = find_index(mapped_region(mappable).contig_key());
+    if (!index) return;
+    auto& contig = contigs_[*index];
+    size_ -= contig.size();
+    contig.erase_contained(mapped_region(mappable).contig_region());
+    size_ += contig.size();
+}
+
+// private methods
+
+template <typename MappableType, typename Allocator>
+boost::optional<typename MappableGenomeSet<MappableType, Allocator>::ContigKey>
+MappableGenomeSet<MappableType, Allocator>::find_key(const ContigName& contig)
+{
+#ifdef MAPPABLE_INTERNED_CONTIGS
+    return ContigDictionary::global().find(contig);
+#else
+    return contig;
+#endif
+}
+
+template <typename MappableType, typename Allocator>
+boost::optional<typename MappableGenomeSet<MappableType, Allocator>::size_type>
+MappableGenomeSet<MappableType, Allocator>::find_index(const ContigKey& key) const
+{
+#ifdef MAPPABLE_INTERNED_CONTIGS
+    if (key < indices_.size() && indices_[key] != no_index) return indices_[key];
+#else
+    const auto it = find_index_position(key);
+    if (it != std::cend(indices_) && it->first == key) return it->second;
+#endif
+    return boost::none;
+}
+
+#ifndef MAPPABLE_INTERNED_CONTIGS
+template <typename MappableType, typename Allocator>
+typename std::vector<typename MappableGenomeSet<MappableType, Allocator>::ContigIndex>::const_iterator
+MappableGenomeSet<MappableType, Allocator>::find_index_position(const ContigKey& key) const
+{
+    // Contig names are compared by length first, which usually decides the comparison
+    return std::lower_bound(std::cbegin(indices_), std::cend(indices_), key,
+                            [] (const ContigIndex& index, const ContigKey& name) {
+                                if (index.first.size() != name.size()) return index.first.size() < name.size();
+                                return index.first < name;
+                            });
+}
+#endif
+
+template <typename MappableType, typename Allocator>
+typename MappableGenomeSet<MappableType, Allocator>::size_type
+MappableGenomeSet<MappableType, Allocator>::get_index(const ContigKey& key)
+{
+    const auto index = find_index(key);
+    if (index) return *index;
+    const auto result = contigs_.size();
+#ifdef MAPPABLE_INTERNED_CONTIGS
+    if (key >= indices_.size()) indices_.resize(key + 1, no_index);
+    indices_[key] = result;
+#else
+    indices_.emplace(find_index_position(key), key, result);
+#endif
+    contigs_.emplace_back(rebind_alloc<contig_value_type>(get_allocator()));
+    keys_.push_back(key);
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+const typename MappableGenomeSet<MappableType, Allocator>::contig_set_type*
+MappableGenomeSet<MappableType, Allocator>::find_contig(const MappableType_& mappable) const
+{
+    static_assert(std::is_same<RegionType<MappableType_>, GenomicRegion>::value, "GenomicRegion Mappable required");
+    const auto index = find_index(mapped_region(mappable).contig_key());
+    return index ? &contigs_[*index] : nullptr;
+}
+
+} // namespace mappable
+
+#endif
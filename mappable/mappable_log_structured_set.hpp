@@ -0,0 +1,478 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef mappable_log_structured_set_hpp
+#define mappable_log_structured_set_hpp
+
+#include <memory>
+#include <algorithm>
+#include <iterator>
+#include <initializer_list>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+#include "mappable.hpp"
+#include "mappable_range.hpp"
+#include "mappable_algorithms.hpp"
+#include "mappable_flat_set.hpp"
+#include "type_tricks.hpp"
+
+namespace mappable {
+
+/*
+ MappableLogStructuredSet is a set of MappableType elements for workloads that interleave many small
+ insertions with queries, where every insertion into a single MappableFlatSet would shift O(n) elements.
+
+ Elements are stored in a sequence of disjoint MappableFlatSet levels, where level k holds at most
+ buffer_capacity * 2^k elements. New elements always go into level 0, and when a level overflows it is merged
+ into the next one, so each element is merged O(log n) times and insertion is amortised O(log n) moves.
+ Queries are answered by combining the results from each level, of which there are O(log n); like
+ MappableBucketedMultiSet, overlap_ranges and contained_ranges return one range per non-empty level, while
+ the copy_* methods merge these into a single sorted vector. compact merges all levels into one and drops the
+ rest; the next insertion starts a new level 0 in front of it if it is larger than the buffer. Every level uses a
+ copy of the set's allocator.
+ */
+template <typename MappableType, typename Allocator = std::allocator<MappableType>>
+class MappableLogStructuredSet
+{
+public:
+    using level_type           = MappableFlatSet<MappableType, Allocator>;
+    using allocator_type       = Allocator;
+    using value_type           = MappableType;
+    using size_type            = std::size_t;
+    using const_reference      = const MappableType&;
+    using level_const_iterator = typename level_type::const_iterator;
+
+    static constexpr size_type default_buffer_capacity {256};
+
+    MappableLogStructuredSet();
+    explicit MappableLogStructuredSet(const allocator_type& alloc);
+    explicit MappableLogStructuredSet(size_type buffer_capacity);
+    MappableLogStructuredSet(size_type buffer_capacity, const allocator_type& alloc);
+
+    template <typename InputIterator>
+    MappableLogStructuredSet(InputIterator first, InputIterator last);
+    template <typename InputIterator>
+    MappableLogStructuredSet(InputIterator first, InputIterator last, const allocator_type& alloc);
+
+    MappableLogStructuredSet(std::initializer_list<MappableType> mappables);
+
+    MappableLogStructuredSet(const MappableLogStructuredSet&)            = default;
+    MappableLogStructuredSet& operator=(const MappableLogStructuredSet&) = default;
+    MappableLogStructuredSet(MappableLogStructuredSet&&)                 = default;
+    MappableLogStructuredSet& operator=(MappableLogStructuredSet&&)      = default;
+
+    ~MappableLogStructuredSet() = default;
+
+    template <typename ...Args>
+    bool emplace(Args&&...);
+    bool insert(const MappableType&);
+    bool insert(MappableType&&);
+    template <typename InputIterator>
+    void insert(InputIterator, InputIterator);
+    size_type erase(const MappableType&);
+
+    void clear();
+    void compact();
+
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+    size_type buffer_capacity() const noexcept;
+
+    allocator_type get_allocator() const noexcept;
+
+    size_type count(const MappableType&) const;
+
+    size_type level_count() const noexcept;
+    const level_type& level(size_type n) const;
+
+    template <typename MappableType_>
+    bool has_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    size_type count_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    std::vector<OverlapRange<level_const_iterator>> overlap_ranges(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    std::vector<MappableType> copy_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    void erase_overlapped(const MappableType_& mappable);
+
+    template <typename MappableType_>
+    bool has_contained(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    size_type count_contained(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    std::vector<ContainedRange<level_const_iterator>> contained_ranges(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    std::vector<MappableType> copy_contained(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    void erase_contained(const MappableType_& mappable);
+
+private:
+    using LevelVector = std::vector<level_type, RebindAlloc<Allocator, level_type>>;
+
+    LevelVector levels_;
+    size_type buffer_capacity_;
+    size_type size_;
+
+    size_type level_capacity(size_type n) const noexcept;
+    level_type& buffer();
+    bool is_in_deeper_level(const MappableType& mappable) const;
+    void cascade();
+};
+
+template <typename MappableType, typename Allocator>
+constexpr typename MappableLogStructuredSet<MappableType, Allocator>::size_type
+MappableLogStructuredSet<MappableType, Allocator>::default_buffer_capacity;
+
+template <typename MappableType, typename Allocator>
+MappableLogStructuredSet<MappableType, Allocator>::MappableLogStructuredSet()
+: MappableLogStructuredSet {default_buffer_capacity}
+{}
+
+template <typename MappableType, typename Allocator>
+MappableLogStructuredSet<MappableType, Allocator>::MappableLogStructuredSet(const allocator_type& alloc)
+: MappableLogStructuredSet {default_buffer_capacity, alloc}
+{}
+
+template <typename MappableType, typename Allocator>
+MappableLogStructuredSet<MappableType, Allocator>::MappableLogStructuredSet(const size_type buffer_capacity)
+: MappableLogStructuredSet {buffer_capacity, allocator_type {}}
+{}
+
+template <typename MappableType, typename Allocator>
+MappableLogStructuredSet<MappableType, Allocator>::MappableLogStructuredSet(const size_type buffer_capacity,
+                                                                            const allocator_type& alloc)
+: levels_ {rebind_alloc<level_type>(alloc)}
+, buffer_capacity_ {std::max(buffer_capacity, size_type {1})}
+, size_ {0}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableLogStructuredSet<MappableType, Allocator>::MappableLogStructuredSet(InputIterator first, InputIterator last)
+: MappableLogStructuredSet {first, last, allocator_type {}}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+MappableLogStructuredSet<MappableType, Allocator>::MappableLogStructuredSet(InputIterator first, InputIterator last,
+                                                                            const allocator_type& alloc)
+: MappableLogStructuredSet {default_buffer_capacity, alloc}
+{
+    insert(first, last);
+}
+
+template <typename MappableType, typename Allocator>
+MappableLogStructuredSet<MappableType, Allocator>::MappableLogStructuredSet(std::initializer_list<MappableType> mappables)
+: MappableLogStructuredSet {std::begin(mappables), std::end(mappables)}
+{}
+
+template <typename MappableType, typename Allocator>
+template <typename ...Args>
+bool MappableLogStructuredSet<MappableType, Allocator>::emplace(Args&&... args)
+{
+    return insert(MappableType(std::forward<Args>(args)...));
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableLogStructuredSet<MappableType, Allocator>::insert(const MappableType& mappable)
+{
+    return insert(MappableType {mappable});
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableLogStructuredSet<MappableType, Allocator>::insert(MappableType&& mappable)
+{
+    auto& buffer = this->buffer();
+    if (is_in_deeper_level(mappable) || !buffer.insert(std::move(mappable)).second) return false;
+    ++size_;
+    cascade();
+    return true;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename InputIterator>
+void MappableLogStructuredSet<MappableType, Allocator>::insert(InputIterator first, InputIterator last)
+{
+    if (first == last) return;
+    auto& buffer = this->buffer();
+    std::vector<MappableType, Allocator> batch {first, last, get_allocator()};
+    // The batch is sorted and merged once; cascade then pushes it down to a level big enough to hold it
+    std::sort(std::begin(batch), std::end(batch));
+    batch.erase(std::unique(std::begin(batch), std::end(batch)), std::end(batch));
+    batch.erase(std::remove_if(std::begin(batch), std::end(batch),
+                               [this] (const MappableType& mappable) { return is_in_deeper_level(mappable); }),
+                std::end(batch));
+    const auto buffer_size = buffer.size();
+    buffer.insert(std::cbegin(batch), std::cend(batch));
+    size_ += buffer.size() - buffer_size;
+    cascade();
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableLogStructuredSet<MappableType, Allocator>::size_type
+MappableLogStructuredSet<MappableType, Allocator>::erase(const MappableType& mappable)
+{
+    for (auto& level : levels_) {
+        if (level.erase(mappable) > 0) {
+            --size_;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+template <typename MappableType, typename Allocator>
+void MappableLogStructuredSet<MappableType, Allocator>::clear()
+{
+    levels_.clear();
+    size_ = 0;
+}
+
+template <typename MappableType, typename Allocator>
+void MappableLogStructuredSet<MappableType, Allocator>::compact()
+{
+    if (levels_.empty()) return;
+    // Erasures can leave a higher level larger than the last, so merge into the largest level
+    const auto largest = std::max_element(std::begin(levels_), std::end(levels_),
+                                          [] (const auto& lhs, const auto& rhs) { return lhs.size() < rhs.size(); });
+    level_type merged {std::move(*largest)};
+    for (auto level = std::cbegin(levels_); level != std::cend(levels_); ++level) {
+        if (level != largest && !level->empty()) merged.insert(std::cbegin(*level), std::cend(*level));
+    }
+    levels_.clear();
+    if (!merged.empty()) levels_.push_back(std::move(merged));
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableLogStructuredSet<MappableType, Allocator>::size_type
+MappableLogStructuredSet<MappableType, Allocator>::size() const noexcept
+{
+    return size_;
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableLogStructuredSet<MappableType, Allocator>::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableLogStructuredSet<MappableType, Allocator>::size_type
+MappableLogStructuredSet<MappableType, Allocator>::buffer_capacity() const noexcept
+{
+    return buffer_capacity_;
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableLogStructuredSet<MappableType, Allocator>::allocator_type
+MappableLogStructuredSet<MappableType, Allocator>::get_allocator() const noexcept
+{
+    return allocator_type {levels_.get_allocator()};
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableLogStructuredSet<MappableType, Allocator>::size_type
+MappableLogStructuredSet<MappableType, Allocator>::count(const MappableType& mappable) const
+{
+    return std::any_of(std::cbegin(levels_), std::cend(levels_),
+                       [&mappable] (const auto& level) { return level.count(mappable) > 0; }) ? 1 : 0;
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableLogStructuredSet<MappableType, Allocator>::size_type
+MappableLogStructuredSet<MappableType, Allocator>::level_count() const noexcept
+{
+    return levels_.size();
+}
+
+template <typename MappableType, typename Allocator>
+const typename MappableLogStructuredSet<MappableType, Allocator>::level_type&
+MappableLogStructuredSet<MappableType, Allocator>::level(const size_type n) const
+{
+    if (n < levels_.size()) {
+        return levels_[n];
+    } else {
+        throw std::out_of_range {"MappableLogStructuredSet"};
+    }
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+bool MappableLogStructuredSet<MappableType, Allocator>::has_overlapped(const MappableType_& mappable) const
+{
+    return std::any_of(std::cbegin(levels_), std::cend(levels_),
+                       [&mappable] (const auto& level) {
+                           return !level.empty() && level.has_overlapped(mappable);
+                       });
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableLogStructuredSet<MappableType, Allocator>::size_type
+MappableLogStructuredSet<MappableType, Allocator>::count_overlapped(const MappableType_& mappable) const
+{
+    size_type result {0};
+    for (const auto& level : levels_) {
+        if (!level.empty()) result += level.count_overlapped(mappable);
+    }
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+std::vector<OverlapRange<typename MappableLogStructuredSet<MappableType, Allocator>::level_const_iterator>>
+MappableLogStructuredSet<MappableType, Allocator>::overlap_ranges(const MappableType_& mappable) const
+{
+    std::vector<OverlapRange<level_const_iterator>> result {};
+    result.reserve(levels_.size());
+    for (const auto& level : levels_) {
+        if (!level.empty()) {
+            auto overlapped = level.overlap_range(mappable);
+            if (!overlapped.empty()) result.push_back(std::move(overlapped));
+        }
+    }
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+std::vector<MappableType>
+MappableLogStructuredSet<MappableType, Allocator>::copy_overlapped(const MappableType_& mappable) const
+{
+    detail::CallRecorder recorder {Algorithm::copy_overlapped};
+    const auto ranges = overlap_ranges(mappable);
+    detail::record_allocation(recorder, ranges);
+    return detail::merge_copy<OverlapRange<level_const_iterator>, MappableType>(ranges, recorder);
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+void MappableLogStructuredSet<MappableType, Allocator>::erase_overlapped(const MappableType_& mappable)
+{
+    for (auto& level : levels_) {
+        if (!level.empty()) {
+            const auto level_size = level.size();
+            level.erase_overlapped(mappable);
+            size_ -= level_size - level.size();
+        }
+    }
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+bool MappableLogStructuredSet<MappableType, Allocator>::has_contained(const MappableType_& mappable) const
+{
+    return std::any_of(std::cbegin(levels_), std::cend(levels_),
+                       [&mappable] (const auto& level) {
+                           return !level.empty() && !level.contained_range(mappable).empty();
+                       });
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+typename MappableLogStructuredSet<MappableType, Allocator>::size_type
+MappableLogStructuredSet<MappableType, Allocator>::count_contained(const MappableType_& mappable) const
+{
+    size_type result {0};
+    for (const auto& level : levels_) {
+        if (!level.empty()) result += level.count_contained(mappable);
+    }
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+std::vector<ContainedRange<typename MappableLogStructuredSet<MappableType, Allocator>::level_const_iterator>>
+MappableLogStructuredSet<MappableType, Allocator>::contained_ranges(const MappableType_& mappable) const
+{
+    std::vector<ContainedRange<level_const_iterator>> result {};
+    result.reserve(levels_.size());
+    for (const auto& level : levels_) {
+        if (!level.empty()) {
+            auto contained = level.contained_range(mappable);
+            if (!contained.empty()) result.push_back(std::move(contained));
+        }
+    }
+    return result;
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+std::vector<MappableType>
+MappableLogStructuredSet<MappableType, Allocator>::copy_contained(const MappableType_& mappable) const
+{
+    detail::CallRecorder recorder {Algorithm::copy_contained};
+    const auto ranges = contained_ranges(mappable);
+    detail::record_allocation(recorder, ranges);
+    return detail::merge_copy<ContainedRange<level_const_iterator>, MappableType>(ranges, recorder);
+}
+
+template <typename MappableType, typename Allocator>
+template <typename MappableType_>
+void MappableLogStructuredSet<MappableType, Allocator>::erase_contained(const MappableType_& mappable)
+{
+    for (auto& level : levels_) {
+        if (!level.empty()) {
+            const auto level_size = level.size();
+            level.erase_contained(mappable);
+            size_ -= level_size - level.size();
+        }
+    }
+}
+
+// private methods
+
+template <typename MappableType, typename Allocator>
+typename MappableLogStructuredSet<MappableType, Allocator>::size_type
+MappableLogStructuredSet<MappableType, Allocator>::level_capacity(const size_type n) const noexcept
+{
+    return buffer_capacity_ << n;
+}
+
+template <typename MappableType, typename Allocator>
+typename MappableLogStructuredSet<MappableType, Allocator>::level_type&
+MappableLogStructuredSet<MappableType, Allocator>::buffer()
+{
+    // Only a compacted level can be larger than the buffer, and it is not merged into on every insertion
+    if (levels_.empty() || levels_.front().size() > level_capacity(0)) {
+        levels_.emplace(std::begin(levels_), get_allocator());
+    }
+    return levels_.front();
+}
+
+template <typename MappableType, typename Allocator>
+bool MappableLogStructuredSet<MappableType, Allocator>::is_in_deeper_level(const MappableType& mappable) const
+{
+    // Level 0 rejects its own duplicates on insertion, and levels whose elements all sort before or after
+    // mappable cannot contain it, so only the remaining levels are searched
+    return std::any_of(std::next(std::cbegin(levels_)), std::cend(levels_), [&mappable] (const auto& level) {
+        return !level.empty() && !(mappable < level.front()) && !(level.back() < mappable)
+               && level.count(mappable) > 0;
+    });
+}
+
+template <typename MappableType, typename Allocator>
+void MappableLogStructuredSet<MappableType, Allocator>::cascade()
+{
+    for (size_type n {0}; n < levels_.size() && levels_[n].size() > level_capacity(n); ++n) {
+        if (n + 1 == levels_.size()) {
+            levels_.emplace_back(get_allocator());
+        }
+        auto& overflowed = levels_[n];
+        auto& next = levels_[n + 1];
+        if (next.empty()) {
+            using std::swap;
+            swap(overflowed, next);
+        } else {
+            next.insert(std::cbegin(overflowed), std::cend(overflowed));
+            overflowed.clear();
+        }
+    }
+}
+
+} // namespace mappable
+
+#endif
@@ -6,9 +6,11 @@
 
 #include <iterator>
 #include <type_traits>
+#include <utility>
 #include <cstddef>
 
 #include <boost/iterator/filter_iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
 #include <boost/range/iterator_range_core.hpp>
 
 #include "mappable.hpp"
@@ -19,11 +21,14 @@ namespace mappable {
  An ordered collection of MappableType elements, X, is:
  - ForwardSorted         iff i <= j -> mapped_region(X[i]) <= mapped_region(X[j])
  - BidirectionallySorted iff X is ForwardSorted AND i <= j -> end(X[i]) <= end(X[j])
+ - FixedSize             iff X is ForwardSorted AND size(X[i]) == size(X[j]) for all i, j (so X is also
+                         BidirectionallySorted)
  - Unsorted              iff X is not ForwardSorted
  */
 
 struct ForwardSortedTag {};
 struct BidirectionallySortedTag {};
+struct FixedSizeTag {};
 
 namespace detail {
 
@@ -41,6 +46,8 @@ public:
         return overlaps(mappable, region_);
     }
     
+    const RegionType<MappableType>& region() const noexcept { return region_; }
+    
 private:
     RegionType<MappableType> region_;
 };
@@ -80,6 +87,12 @@ auto size(const OverlapRange<Iterator>& range, BidirectionallySortedTag)
     return base_size(range);
 }
 
+template <typename Iterator>
+auto size(const OverlapRange<Iterator>& range, FixedSizeTag)
+{
+    return base_size(range);
+}
+
 template <typename Iterator>
 auto size(const OverlapRange<Iterator>& range)
 {
@@ -103,6 +116,135 @@ OverlapRange<Iterator> make_overlap_range(Iterator first, Iterator last, const M
     );
 }
 
+/*
+ IndexedOverlapIterator visits the elements between two base iterators that overlap a region, like an
+ OverlapIterator, but is also given an overlap index (e.g. the max ends of an ImplicitIntervalTree) over the
+ elements from a first base iterator, and a function to search the index. Whenever it passes an element that is
+ not overlapped it searches the index for the next overlapped element, so the elements between runs of
+ overlapped elements are not tested. The index is not owned, and must outlive the iterator.
+ */
+template <typename Iterator>
+class IndexedOverlapIterator
+    : public boost::iterator_facade<
+        IndexedOverlapIterator<Iterator>,
+        typename std::iterator_traits<Iterator>::value_type,
+        boost::bidirectional_traversal_tag,
+        typename std::iterator_traits<Iterator>::reference,
+        typename std::iterator_traits<Iterator>::difference_type
+    >
+{
+public:
+    using base_type      = Iterator;
+    using value_type     = typename std::iterator_traits<Iterator>::value_type;
+    using reference      = typename std::iterator_traits<Iterator>::reference;
+    using predicate_type = detail::IsOverlapped<value_type>;
+    using region_type    = RegionType<value_type>;
+    
+    // Returns the first overlapped element at or after it if forward, otherwise the last overlapped element
+    // before it
+    using IndexSearch = Iterator (*)(const void* index, std::size_t index_size, Iterator first, Iterator it,
+                                     bool forward, const region_type& region);
+    
+    IndexedOverlapIterator() = default;
+    
+    IndexedOverlapIterator(predicate_type predicate, Iterator it, Iterator last,
+                           Iterator first, const void* index, std::size_t index_size, IndexSearch search);
+    
+    const predicate_type& predicate() const noexcept { return predicate_; }
+    Iterator base() const noexcept { return it_; }
+    Iterator end() const noexcept { return last_; }
+    
+private:
+    friend class boost::iterator_core_access;
+    
+    predicate_type predicate_;
+    Iterator it_, last_, first_;
+    const void* index_ = nullptr;
+    std::size_t index_size_ = 0;
+    IndexSearch search_ = nullptr;
+    
+    reference dereference() const { return *it_; }
+    bool equal(const IndexedOverlapIterator& other) const { return it_ == other.it_; }
+    
+    void increment()
+    {
+        ++it_;
+        if (it_ != last_ && !predicate_(*it_)) {
+            it_ = search_(index_, index_size_, first_, it_, true, predicate_.region());
+        }
+    }
+    
+    void decrement()
+    {
+        --it_;
+        if (!predicate_(*it_)) {
+            it_ = search_(index_, index_size_, first_, it_, false, predicate_.region());
+        }
+    }
+};
+
+template <typename Iterator>
+IndexedOverlapIterator<Iterator>::IndexedOverlapIterator(predicate_type predicate, Iterator it, Iterator last,
+                                                         Iterator first, const void* index,
+                                                         std::size_t index_size, IndexSearch search)
+: predicate_ {std::move(predicate)}
+, it_ {it}
+, last_ {last}
+, first_ {first}
+, index_ {index}
+, index_size_ {index_size}
+, search_ {search}
+{}
+
+template <typename Iterator>
+using IndexedOverlapRange = boost::iterator_range<IndexedOverlapIterator<Iterator>>;
+
+template <typename Iterator>
+boost::iterator_range<Iterator> bases(const IndexedOverlapRange<Iterator>& range)
+{
+    return boost::make_iterator_range(range.begin().base(), range.end().base());
+}
+
+template <typename Iterator>
+auto base_size(const IndexedOverlapRange<Iterator>& range)
+{
+    return static_cast<std::size_t>(std::distance(range.begin().base(), range.end().base()));
+}
+
+template <typename Iterator>
+auto size(const IndexedOverlapRange<Iterator>& range)
+{
+    return static_cast<std::size_t>(std::distance(range.begin(), range.end()));
+}
+
+template <typename Iterator>
+bool empty(const IndexedOverlapRange<Iterator>& range)
+{
+    return range.empty();
+}
+
+/**
+ Makes an IndexedOverlapRange using an overlap index over [first, last), which is searched with search to find
+ the first and last overlapped elements, and to step between runs of overlapped elements when iterating.
+ */
+template <typename Iterator, typename MappableType>
+IndexedOverlapRange<Iterator>
+make_indexed_overlap_range(Iterator first, Iterator last, const MappableType& mappable, const void* index,
+                           std::size_t index_size, typename IndexedOverlapIterator<Iterator>::IndexSearch search)
+{
+    using boost::make_iterator_range; using detail::IsOverlapped;
+    using MappableType2 = typename std::iterator_traits<Iterator>::value_type;
+    const IsOverlapped<MappableType2> predicate {mappable};
+    const auto result_first = search(index, index_size, first, first, true, predicate.region());
+    const auto result_last  = result_first == last ? last
+                                                   : std::next(search(index, index_size, first, last, false,
+                                                                      predicate.region()));
+    return make_iterator_range(
+        IndexedOverlapIterator<Iterator>(predicate, result_first, result_last, first, index, index_size, search),
+        IndexedOverlapIterator<Iterator>(predicate, result_last, result_last, first, index, index_size, search)
+    );
+}
+
 namespace detail {
 
 template <typename MappableType>
@@ -158,6 +300,12 @@ auto size(const ContainedRange<Iterator>& range, BidirectionallySortedTag)
     return base_size(range);
 }
 
+template <typename Iterator>
+auto size(const ContainedRange<Iterator>& range, FixedSizeTag)
+{
+    return base_size(range);
+}
+
 template <typename Iterator>
 auto size(const ContainedRange<Iterator>& range)
 {
@@ -239,6 +387,12 @@ auto size(const SharedRange<Iterator>& range, BidirectionallySortedTag)
     return base_size(range);
 }
 
+template <typename Iterator>
+auto size(const SharedRange<Iterator>& range, FixedSizeTag)
+{
+    return base_size(range);
+}
+
 template <typename Iterator>
 auto size(const SharedRange<Iterator>& range)
 {
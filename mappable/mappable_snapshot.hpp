@@ -0,0 +1,465 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef mappable_snapshot_hpp
+#define mappable_snapshot_hpp
+
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+#include <boost/utility/string_ref.hpp>
+
+#include "mappable.hpp"
+#include "genomic_region.hpp"
+#include "mappable_range.hpp"
+#include "mappable_algorithms.hpp"
+#include "mappable_flat_set.hpp"
+#include "mapped_file.hpp"
+
+namespace mappable {
+
+/*
+ A snapshot is a binary image of a MappableFlatSet of trivially copyable elements that can be memory mapped
+ read-only and queried in place, so large reference sets need not be parsed or sorted when a program starts.
+
+ The file starts with a SnapshotHeader recording the format version, the element size and alignment, and the
+ set's sort information (whether it is bidirectionally sorted or fixed size, and the largest element size),
+ followed by the sorted elements and then an optional string pool. Elements refer to variable length data in
+ the pool with SnapshotStringRef members, which are resolved with MappableSnapshot::string. Snapshots use
+ the native byte order and are not portable between architectures.
+
+ Elements mapped to GenomicRegions cannot be snapshotted: even when GenomicRegion is trivially copyable
+ (MAPPABLE_INTERNED_CONTIGS) its contig is a key into the process's ContigDictionary, which is not stored.
+ Store the contig name in the string pool instead.
+
+ Padding bytes in elements are written as zeros, so writing the same set twice gives identical files, only
+ if the compiler provides __builtin_clear_padding (GCC 11 or later, recent Clang). Otherwise the padding
+ written is unspecified; use element types without padding if snapshots must be byte for byte reproducible.
+ */
+
+struct SnapshotStringRef
+{
+    std::uint64_t offset;
+    std::uint64_t length;
+};
+
+/*
+ SnapshotStringPool collects the variable length data for a snapshot while the elements are being built.
+ */
+class SnapshotStringPool
+{
+public:
+    SnapshotStringPool() = default;
+
+    SnapshotStringPool(const SnapshotStringPool&)            = default;
+    SnapshotStringPool& operator=(const SnapshotStringPool&) = default;
+    SnapshotStringPool(SnapshotStringPool&&)                 = default;
+    SnapshotStringPool& operator=(SnapshotStringPool&&)      = default;
+
+    ~SnapshotStringPool() = default;
+
+    SnapshotStringRef add(const std::string& str);
+
+    const std::string& data() const noexcept;
+    std::size_t size() const noexcept;
+
+private:
+    std::string data_;
+};
+
+inline SnapshotStringRef SnapshotStringPool::add(const std::string& str)
+{
+    const SnapshotStringRef result {data_.size(), str.size()};
+    data_ += str;
+    return result;
+}
+
+inline const std::string& SnapshotStringPool::data() const noexcept
+{
+    return data_;
+}
+
+inline std::size_t SnapshotStringPool::size() const noexcept
+{
+    return data_.size();
+}
+
+namespace detail {
+
+struct SnapshotHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t flags;
+    std::uint64_t element_size;
+    std::uint64_t element_alignment;
+    std::uint64_t num_elements;
+    std::uint64_t max_element_size;
+    std::uint64_t elements_offset;
+    std::uint64_t strings_offset;
+    std::uint64_t strings_size;
+};
+
+static constexpr char snapshot_magic[8] {'M', 'A', 'P', 'P', 'S', 'N', 'A', 'P'};
+static constexpr std::uint32_t snapshot_version {1};
+static constexpr std::uint32_t snapshot_bidirectionally_sorted_flag {1u << 0};
+static constexpr std::uint32_t snapshot_fixed_size_flag {1u << 1};
+
+inline std::uint64_t align_snapshot_offset(const std::uint64_t offset, const std::uint64_t alignment) noexcept
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+template <typename MappableType>
+struct IsSnapshotElement
+    : std::integral_constant<bool, std::is_trivially_copyable<MappableType>::value
+                                   && !std::is_same<RegionType<MappableType>, GenomicRegion>::value>
+{};
+
+// Writes a copy of mappable whose padding bytes are zero where __builtin_clear_padding is available
+template <typename MappableType>
+void write_snapshot_element(std::ostream& os, const MappableType& mappable)
+{
+    std::aligned_storage_t<sizeof(MappableType), alignof(MappableType)> buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    auto copy = ::new (&buffer) MappableType {mappable};
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_clear_padding)
+    // a trivial copy may copy the source's padding
+    __builtin_clear_padding(copy);
+#endif
+#endif
+    os.write(reinterpret_cast<const char*>(copy), sizeof(MappableType));
+}
+
+} // namespace detail
+
+/**
+ Writes a snapshot of mappables, and the string pool its elements refer to, to the file at path.
+ */
+template <typename MappableType, typename Allocator>
+void write_snapshot(const MappableFlatSet<MappableType, Allocator>& mappables, const std::string& path,
+                    const SnapshotStringPool& strings = SnapshotStringPool {})
+{
+    static_assert(std::is_trivially_copyable<MappableType>::value,
+                  "Snapshot elements must be trivially copyable");
+    static_assert(detail::IsSnapshotElement<MappableType>::value,
+                  "Snapshot elements cannot be mapped to GenomicRegions as contig keys are not stored");
+    detail::SnapshotHeader header {};
+    std::copy(std::cbegin(detail::snapshot_magic), std::cend(detail::snapshot_magic), header.magic);
+    header.version = detail::snapshot_version;
+    if (mappables.bidirectionally_sorted()) header.flags |= detail::snapshot_bidirectionally_sorted_flag;
+    if (mappables.fixed_size()) header.flags |= detail::snapshot_fixed_size_flag;
+    header.element_size = sizeof(MappableType);
+    header.element_alignment = alignof(MappableType);
+    header.num_elements = mappables.size();
+    header.max_element_size = mappables.max_element_size();
+    header.elements_offset = detail::align_snapshot_offset(sizeof(header), alignof(MappableType));
+    header.strings_offset = header.elements_offset + header.num_elements * sizeof(MappableType);
+    header.strings_size = strings.size();
+
+    std::ofstream file {path, std::ios::binary | std::ios::trunc};
+    if (!file) throw std::runtime_error {"write_snapshot: could not open " + path};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const std::string padding(header.elements_offset - sizeof(header), '\0');
+    file.write(padding.data(), padding.size());
+    for (const auto& mappable : mappables) {
+        detail::write_snapshot_element(file, mappable);
+    }
+    file.write(strings.data().data(), strings.size());
+    if (!file) throw std::runtime_error {"write_snapshot: could not write " + path};
+}
+
+/*
+ MappableSnapshot memory maps a snapshot written by write_snapshot and provides the same read-only query
+ interface as MappableFlatSet, using the sort information stored in the snapshot. The elements are not copied,
+ so opening a snapshot is O(1) and pages are only read when they are first queried.
+ */
+template <typename MappableType>
+class MappableSnapshot
+{
+public:
+    using value_type      = MappableType;
+    using const_reference = const MappableType&;
+    using const_iterator  = const MappableType*;
+    using iterator        = const_iterator;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    class BadSnapshot;
+
+    static_assert(std::is_trivially_copyable<MappableType>::value,
+                  "Snapshot elements must be trivially copyable");
+    static_assert(detail::IsSnapshotElement<MappableType>::value,
+                  "Snapshot elements cannot be mapped to GenomicRegions as contig keys are not stored");
+
+    MappableSnapshot() = delete;
+
+    explicit MappableSnapshot(const std::string& path);
+
+    MappableSnapshot(const MappableSnapshot&)            = delete;
+    MappableSnapshot& operator=(const MappableSnapshot&) = delete;
+    MappableSnapshot(MappableSnapshot&&)                 = default;
+    MappableSnapshot& operator=(MappableSnapshot&&)      = default;
+
+    ~MappableSnapshot() = default;
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+    const_reference operator[](size_type n) const;
+
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+
+    bool bidirectionally_sorted() const noexcept;
+    bool fixed_size() const noexcept;
+    typename RegionType<MappableType>::Position max_element_size() const noexcept;
+
+    boost::string_ref string(SnapshotStringRef ref) const;
+
+    template <typename MappableType_>
+    bool has_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    size_type count_overlapped(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    OverlapRange<const_iterator> overlap_range(const MappableType_& mappable) const;
+
+    template <typename MappableType_>
+    bool has_contained(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    size_type count_contained(const MappableType_& mappable) const;
+    template <typename MappableType_>
+    ContainedRange<const_iterator> contained_range(const MappableType_& mappable) const;
+
+private:
+    MappedFile file_;
+    detail::SnapshotHeader header_;
+    const MappableType* elements_;
+    const char* strings_;
+
+    static MappedFile open(const std::string& path);
+    void validate(const std::string& path) const;
+};
+
+template <typename MappableType>
+class MappableSnapshot<MappableType>::BadSnapshot : public std::runtime_error
+{
+public:
+    BadSnapshot(const std::string& path, const std::string& reason)
+    : std::runtime_error {"MappableSnapshot: " + path + " " + reason}
+    {}
+
+    virtual ~BadSnapshot() override = default;
+};
+
+template <typename MappableType>
+MappableSnapshot<MappableType>::MappableSnapshot(const std::string& path)
+: file_ {open(path)}
+, header_ {}
+, elements_ {nullptr}
+, strings_ {nullptr}
+{
+    if (file_.size() < sizeof(header_)) throw BadSnapshot {path, "is too small"};
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    validate(path);
+    elements_ = reinterpret_cast<const MappableType*>(file_.data() + header_.elements_offset);
+    strings_  = file_.data() + header_.strings_offset;
+}
+
+template <typename MappableType>
+typename MappableSnapshot<MappableType>::const_iterator MappableSnapshot<MappableType>::begin() const noexcept
+{
+    return elements_;
+}
+
+template <typename MappableType>
+typename MappableSnapshot<MappableType>::const_iterator MappableSnapshot<MappableType>::end() const noexcept
+{
+    return elements_ + header_.num_elements;
+}
+
+template <typename MappableType>
+typename MappableSnapshot<MappableType>::const_iterator MappableSnapshot<MappableType>::cbegin() const noexcept
+{
+    return begin();
+}
+
+template <typename MappableType>
+typename MappableSnapshot<MappableType>::const_iterator MappableSnapshot<MappableType>::cend() const noexcept
+{
+    return end();
+}
+
+template <typename MappableType>
+typename MappableSnapshot<MappableType>::const_reference
+MappableSnapshot<MappableType>::operator[](const size_type n) const
+{
+    return elements_[n];
+}
+
+template <typename MappableType>
+typename MappableSnapshot<MappableType>::size_type MappableSnapshot<MappableType>::size() const noexcept
+{
+    return static_cast<size_type>(header_.num_elements);
+}
+
+template <typename MappableType>
+bool MappableSnapshot<MappableType>::empty() const noexcept
+{
+    return header_.num_elements == 0;
+}
+
+template <typename MappableType>
+bool MappableSnapshot<MappableType>::bidirectionally_sorted() const noexcept
+{
+    return header_.flags & detail::snapshot_bidirectionally_sorted_flag;
+}
+
+template <typename MappableType>
+bool MappableSnapshot<MappableType>::fixed_size() const noexcept
+{
+    return header_.flags & detail::snapshot_fixed_size_flag;
+}
+
+template <typename MappableType>
+typename RegionType<MappableType>::Position MappableSnapshot<MappableType>::max_element_size() const noexcept
+{
+    return static_cast<typename RegionType<MappableType>::Position>(header_.max_element_size);
+}
+
+template <typename MappableType>
+boost::string_ref MappableSnapshot<MappableType>::string(const SnapshotStringRef ref) const
+{
+    if (ref.offset > header_.strings_size || ref.length > header_.strings_size - ref.offset) {
+        throw std::out_of_range {"MappableSnapshot: bad string reference"};
+    }
+    return boost::string_ref {strings_ + ref.offset, static_cast<std::size_t>(ref.length)};
+}
+
+template <typename MappableType>
+template <typename MappableType_>
+bool MappableSnapshot<MappableType>::has_overlapped(const MappableType_& mappable) const
+{
+    using mappable::has_overlapped;
+    if (fixed_size()) {
+        return has_overlapped(begin(), end(), mappable, FixedSizeTag {});
+    }
+    if (bidirectionally_sorted()) {
+        return has_overlapped(begin(), end(), mappable, BidirectionallySortedTag {});
+    }
+    return has_overlapped(begin(), end(), mappable, max_element_size());
+}
+
+template <typename MappableType>
+template <typename MappableType_>
+typename MappableSnapshot<MappableType>::size_type
+MappableSnapshot<MappableType>::count_overlapped(const MappableType_& mappable) const
+{
+    using mappable::count_overlapped;
+    if (fixed_size()) {
+        return count_overlapped(begin(), end(), mappable, FixedSizeTag {});
+    }
+    if (bidirectionally_sorted()) {
+        return count_overlapped(begin(), end(), mappable, BidirectionallySortedTag {});
+    }
+    return count_overlapped(begin(), end(), mappable, max_element_size());
+}
+
+template <typename MappableType>
+template <typename MappableType_>
+OverlapRange<typename MappableSnapshot<MappableType>::const_iterator>
+MappableSnapshot<MappableType>::overlap_range(const MappableType_& mappable) const
+{
+    using mappable::overlap_range;
+    if (fixed_size()) {
+        return overlap_range(begin(), end(), mappable, FixedSizeTag {});
+    }
+    if (bidirectionally_sorted()) {
+        return overlap_range(begin(), end(), mappable, BidirectionallySortedTag {});
+    }
+    return overlap_range(begin(), end(), mappable, max_element_size());
+}
+
+template <typename MappableType>
+template <typename MappableType_>
+bool MappableSnapshot<MappableType>::has_contained(const MappableType_& mappable) const
+{
+    using mappable::has_contained;
+    if (fixed_size()) {
+        return has_contained(begin(), end(), mappable, FixedSizeTag {});
+    }
+    return has_contained(begin(), end(), mappable);
+}
+
+template <typename MappableType>
+template <typename MappableType_>
+typename MappableSnapshot<MappableType>::size_type
+MappableSnapshot<MappableType>::count_contained(const MappableType_& mappable) const
+{
+    using mappable::count_contained;
+    if (fixed_size()) {
+        return count_contained(begin(), end(), mappable, FixedSizeTag {});
+    }
+    return count_contained(begin(), end(), mappable);
+}
+
+template <typename MappableType>
+template <typename MappableType_>
+ContainedRange<typename MappableSnapshot<MappableType>::const_iterator>
+MappableSnapshot<MappableType>::contained_range(const MappableType_& mappable) const
+{
+    using mappable::contained_range;
+    if (fixed_size()) {
+        return contained_range(begin(), end(), mappable, FixedSizeTag {});
+    }
+    return contained_range(begin(), end(), mappable);
+}
+
+// private methods
+
+template <typename MappableType>
+MappedFile MappableSnapshot<MappableType>::open(const std::string& path)
+{
+    try {
+        return MappedFile {path};
+    } catch (const std::runtime_error&) {
+        throw BadSnapshot {path, "could not be mapped"};
+    }
+}
+
+template <typename MappableType>
+void MappableSnapshot<MappableType>::validate(const std::string& path) const
+{
+    if (!std::equal(std::cbegin(detail::snapshot_magic), std::cend(detail::snapshot_magic), header_.magic)) {
+        throw BadSnapshot {path, "is not a snapshot"};
+    }
+    if (header_.version != detail::snapshot_version) {
+        throw BadSnapshot {path, "has unsupported version " + std::to_string(header_.version)};
+    }
+    if (header_.element_size != sizeof(MappableType) || header_.element_alignment != alignof(MappableType)
+        || header_.elements_offset % alignof(MappableType) != 0) {
+        throw BadSnapshot {path, "was not written with this element type"};
+    }
+    if (header_.elements_offset > file_.size()
+        || header_.num_elements > (file_.size() - header_.elements_offset) / sizeof(MappableType)
+        || header_.strings_offset != header_.elements_offset + header_.num_elements * sizeof(MappableType)
+        || header_.strings_size != file_.size() - header_.strings_offset) {
+        throw BadSnapshot {path, "is truncated or corrupt"};
+    }
+}
+
+} // namespace mappable
+
+#endif
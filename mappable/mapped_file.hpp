@@ -0,0 +1,197 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef mapped_file_hpp
+#define mapped_file_hpp
+
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+
+#if !defined(MAPPABLE_NO_MMAP) && (defined(__unix__) || defined(__APPLE__))
+    #define MAPPABLE_HAS_MMAP 1
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#else
+    #define MAPPABLE_HAS_MMAP 0
+    #include <fstream>
+    #include <memory>
+#endif
+
+namespace mappable {
+
+/*
+ MappedFile is a read-only memory mapping of a whole file, which is unmapped when the MappedFile is destroyed.
+ Empty files have a null data pointer.
+
+ On platforms without mmap, or if MAPPABLE_NO_MMAP is defined, the whole file is instead read into a heap
+ buffer, so the interface is unchanged but opening costs a full read of the file.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    ~MappedFile();
+
+    const char* data() const noexcept;
+    std::size_t size() const noexcept;
+
+    const char* begin() const noexcept;
+    const char* end() const noexcept;
+
+private:
+#if MAPPABLE_HAS_MMAP
+    void* data_ = nullptr;
+#else
+    std::unique_ptr<char[]> data_ = nullptr;
+#endif
+    std::size_t size_ = 0;
+
+    void unmap() noexcept;
+};
+
+#if MAPPABLE_HAS_MMAP
+
+inline MappedFile::MappedFile(const std::string& path)
+: data_ {nullptr}
+, size_ {0}
+{
+    const auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) throw std::runtime_error {"MappedFile: could not open " + path};
+    struct stat status;
+    if (::fstat(fd, &status) == -1) {
+        ::close(fd);
+        throw std::runtime_error {"MappedFile: could not stat " + path};
+    }
+    size_ = static_cast<std::size_t>(status.st_size);
+    if (size_ > 0) {
+        data_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (data_ == MAP_FAILED) {
+            data_ = nullptr;
+            size_ = 0;
+            ::close(fd);
+            throw std::runtime_error {"MappedFile: could not map " + path};
+        }
+    }
+    ::close(fd);
+}
+
+inline MappedFile::MappedFile(MappedFile&& other) noexcept
+: data_ {other.data_}
+, size_ {other.size_}
+{
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+inline MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        unmap();
+        data_ = other.data_;
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+inline MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+inline const char* MappedFile::data() const noexcept
+{
+    return static_cast<const char*>(data_);
+}
+
+#else
+
+inline MappedFile::MappedFile(const std::string& path)
+: data_ {nullptr}
+, size_ {0}
+{
+    std::ifstream file {path, std::ios::binary | std::ios::ate};
+    if (!file) throw std::runtime_error {"MappedFile: could not open " + path};
+    const auto size = file.tellg();
+    if (size == std::ifstream::pos_type(-1)) throw std::runtime_error {"MappedFile: could not stat " + path};
+    if (size > 0) {
+        std::unique_ptr<char[]> buffer {new char[static_cast<std::size_t>(size)]};
+        file.seekg(0);
+        if (!file.read(buffer.get(), size)) throw std::runtime_error {"MappedFile: could not read " + path};
+        data_ = std::move(buffer);
+        size_ = static_cast<std::size_t>(size);
+    }
+}
+
+inline MappedFile::MappedFile(MappedFile&& other) noexcept
+: data_ {std::move(other.data_)}
+, size_ {other.size_}
+{
+    other.size_ = 0;
+}
+
+inline MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        data_ = std::move(other.data_);
+        size_ = other.size_;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+inline MappedFile::~MappedFile() = default;
+
+inline const char* MappedFile::data() const noexcept
+{
+    return data_.get();
+}
+
+#endif // MAPPABLE_HAS_MMAP
+
+inline std::size_t MappedFile::size() const noexcept
+{
+    return size_;
+}
+
+inline const char* MappedFile::begin() const noexcept
+{
+    return data();
+}
+
+inline const char* MappedFile::end() const noexcept
+{
+    return data() + size_;
+}
+
+// private methods
+
+inline void MappedFile::unmap() noexcept
+{
+#if MAPPABLE_HAS_MMAP
+    if (data_ != nullptr) {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+#else
+    data_.reset();
+    size_ = 0;
+#endif
+}
+
+} // namespace mappable
+
+#endif
@@ -0,0 +1,303 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef materialised_range_hpp
+#define materialised_range_hpp
+
+#include <vector>
+#include <iterator>
+#include <type_traits>
+#include <cstddef>
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/iterator/filter_iterator.hpp>
+#include <boost/range/iterator_range_core.hpp>
+
+#include "mappable_range.hpp"
+#include "instrumentation.hpp"
+
+namespace mappable {
+
+/*
+ MaterialisedRange is the result of a query with the matching elements already found: it carries the exact
+ bounds of the matching elements [base_begin, base_end) and, if not every element between these bounds matches,
+ the offsets of the matching elements from base_begin. Unlike OverlapRange and ContainedRange, size is O(1)
+ and iteration does not re-test any elements, so the same result can be counted, copied and erased without
+ being recomputed.
+
+ Use materialise to make a MaterialisedRange from an OverlapRange, IndexedOverlapRange, ContainedRange or
+ SharedRange. The underlying iterators must be random access.
+ */
+template <typename Iterator>
+class MaterialisedRange
+{
+public:
+    using base_iterator   = Iterator;
+    using value_type      = typename std::iterator_traits<Iterator>::value_type;
+    using reference       = typename std::iterator_traits<Iterator>::reference;
+    using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+    using size_type       = std::size_t;
+
+    static_assert(std::is_base_of<std::random_access_iterator_tag,
+                                  typename std::iterator_traits<Iterator>::iterator_category>::value,
+                  "MaterialisedRange requires random access iterators");
+
+    class iterator;
+    using const_iterator = iterator;
+
+    MaterialisedRange() = default;
+
+    MaterialisedRange(Iterator first, Iterator last);
+    MaterialisedRange(Iterator first, Iterator last, std::vector<difference_type> offsets);
+
+    MaterialisedRange(const MaterialisedRange&)            = default;
+    MaterialisedRange& operator=(const MaterialisedRange&) = default;
+    MaterialisedRange(MaterialisedRange&&)                 = default;
+    MaterialisedRange& operator=(MaterialisedRange&&)      = default;
+
+    ~MaterialisedRange() = default;
+
+    iterator begin() const noexcept;
+    iterator end() const noexcept;
+
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+
+    bool is_contiguous() const noexcept;
+    Iterator base_begin() const noexcept;
+    Iterator base_end() const noexcept;
+    const std::vector<difference_type>& offsets() const noexcept;
+
+private:
+    Iterator first_, last_;
+    std::vector<difference_type> offsets_;
+    size_type size_ = 0;
+};
+
+template <typename Iterator>
+class MaterialisedRange<Iterator>::iterator
+    : public boost::iterator_facade<
+        typename MaterialisedRange<Iterator>::iterator,
+        typename MaterialisedRange<Iterator>::value_type,
+        boost::random_access_traversal_tag,
+        typename MaterialisedRange<Iterator>::reference,
+        typename MaterialisedRange<Iterator>::difference_type
+    >
+{
+public:
+    iterator() = default;
+
+    iterator(Iterator first, Iterator last, const difference_type* offsets, difference_type size,
+             difference_type index) noexcept
+    : first_ {first}
+    , last_ {last}
+    , offsets_ {offsets}
+    , size_ {size}
+    , index_ {index}
+    {}
+
+    // The end iterator has no offset, so its base is the end of the matching elements' bounds
+    Iterator base() const noexcept
+    {
+        if (index_ == size_) return last_;
+        return first_ + (offsets_ ? offsets_[index_] : index_);
+    }
+
+private:
+    friend class boost::iterator_core_access;
+
+    Iterator first_, last_;
+    const difference_type* offsets_ = nullptr; // nullptr if contiguous
+    difference_type size_ = 0, index_ = 0;
+
+    reference dereference() const { return *base(); }
+    bool equal(const iterator& other) const noexcept { return index_ == other.index_; }
+    void increment() noexcept { ++index_; }
+    void decrement() noexcept { --index_; }
+    void advance(const difference_type n) noexcept { index_ += n; }
+    difference_type distance_to(const iterator& other) const noexcept { return other.index_ - index_; }
+};
+
+template <typename Iterator>
+MaterialisedRange<Iterator>::MaterialisedRange(Iterator first, Iterator last)
+: first_ {first}
+, last_ {last}
+, offsets_ {}
+, size_ {static_cast<size_type>(std::distance(first, last))}
+{}
+
+template <typename Iterator>
+MaterialisedRange<Iterator>::MaterialisedRange(Iterator first, Iterator last, std::vector<difference_type> offsets)
+: first_ {first}
+, last_ {last}
+, offsets_ {std::move(offsets)}
+, size_ {offsets_.size()}
+{
+    if (offsets_.size() == static_cast<size_type>(std::distance(first_, last_))) {
+        offsets_.clear();
+        offsets_.shrink_to_fit();
+    }
+}
+
+template <typename Iterator>
+typename MaterialisedRange<Iterator>::iterator MaterialisedRange<Iterator>::begin() const noexcept
+{
+    return iterator {first_, last_, is_contiguous() ? nullptr : offsets_.data(),
+                     static_cast<difference_type>(size_), 0};
+}
+
+template <typename Iterator>
+typename MaterialisedRange<Iterator>::iterator MaterialisedRange<Iterator>::end() const noexcept
+{
+    const auto size = static_cast<difference_type>(size_);
+    return iterator {first_, last_, is_contiguous() ? nullptr : offsets_.data(), size, size};
+}
+
+template <typename Iterator>
+typename MaterialisedRange<Iterator>::size_type MaterialisedRange<Iterator>::size() const noexcept
+{
+    return size_;
+}
+
+template <typename Iterator>
+bool MaterialisedRange<Iterator>::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+template <typename Iterator>
+bool MaterialisedRange<Iterator>::is_contiguous() const noexcept
+{
+    return offsets_.empty();
+}
+
+template <typename Iterator>
+Iterator MaterialisedRange<Iterator>::base_begin() const noexcept
+{
+    return first_;
+}
+
+template <typename Iterator>
+Iterator MaterialisedRange<Iterator>::base_end() const noexcept
+{
+    return last_;
+}
+
+template <typename Iterator>
+const std::vector<typename MaterialisedRange<Iterator>::difference_type>&
+MaterialisedRange<Iterator>::offsets() const noexcept
+{
+    return offsets_;
+}
+
+// non-member methods
+
+template <typename Iterator>
+boost::iterator_range<Iterator> bases(const MaterialisedRange<Iterator>& range)
+{
+    return boost::make_iterator_range(range.base_begin(), range.base_end());
+}
+
+template <typename Iterator>
+auto base_size(const MaterialisedRange<Iterator>& range)
+{
+    return static_cast<std::size_t>(std::distance(range.base_begin(), range.base_end()));
+}
+
+template <typename Iterator>
+auto size(const MaterialisedRange<Iterator>& range)
+{
+    return range.size();
+}
+
+template <typename Iterator>
+bool empty(const MaterialisedRange<Iterator>& range)
+{
+    return range.empty();
+}
+
+namespace detail {
+
+template <typename Predicate, typename Iterator>
+MaterialisedRange<Iterator>
+materialise(const boost::iterator_range<boost::filter_iterator<Predicate, Iterator>>& range, CallRecorder& recorder)
+{
+    using Difference = typename MaterialisedRange<Iterator>::difference_type;
+    if (range.empty()) return MaterialisedRange<Iterator> {range.end().base(), range.end().base()};
+    const auto first = range.begin().base();
+    const auto is_member = scanning_predicate(range.begin().predicate(), recorder);
+    std::vector<Difference> offsets {};
+    auto offset_inserter = recording_back_inserter(offsets, recorder);
+    *offset_inserter++ = 0;
+    auto last = first;
+    Difference offset {0};
+    for (auto it = std::next(first); it != range.end().base(); ++it) {
+        ++offset;
+        if (is_member(*it)) {
+            last = it;
+            *offset_inserter++ = offset;
+        }
+    }
+    return MaterialisedRange<Iterator> {first, std::next(last), std::move(offsets)};
+}
+
+} // namespace detail
+
+/**
+ Returns a MaterialisedRange of the elements in range, testing each element between the bounds of range once.
+ */
+template <typename Predicate, typename Iterator>
+MaterialisedRange<Iterator>
+materialise(const boost::iterator_range<boost::filter_iterator<Predicate, Iterator>>& range)
+{
+    detail::CallRecorder recorder {Algorithm::materialise};
+    return detail::materialise(range, recorder);
+}
+
+/**
+ Returns a MaterialisedRange of the elements in range without testing any elements.
+
+ Requires the range was computed from a BidirectionallySorted range.
+ */
+template <typename Predicate, typename Iterator>
+MaterialisedRange<Iterator>
+materialise(const boost::iterator_range<boost::filter_iterator<Predicate, Iterator>>& range,
+            BidirectionallySortedTag)
+{
+    return MaterialisedRange<Iterator> {range.begin().base(), range.end().base()};
+}
+
+template <typename Predicate, typename Iterator>
+MaterialisedRange<Iterator>
+materialise(const boost::iterator_range<boost::filter_iterator<Predicate, Iterator>>& range,
+            FixedSizeTag)
+{
+    return materialise(range, BidirectionallySortedTag {});
+}
+
+/**
+ Returns a MaterialisedRange of the elements in range, which only visits the overlapped elements.
+
+ Only the visited elements are counted as scanned; the index searches between them are not instrumented.
+ */
+template <typename Iterator>
+MaterialisedRange<Iterator> materialise(const IndexedOverlapRange<Iterator>& range)
+{
+    using Difference = typename MaterialisedRange<Iterator>::difference_type;
+    detail::CallRecorder recorder {Algorithm::materialise};
+    if (range.empty()) return MaterialisedRange<Iterator> {range.end().base(), range.end().base()};
+    const auto first = range.begin().base();
+    std::vector<Difference> offsets {};
+    auto offset_inserter = detail::recording_back_inserter(offsets, recorder);
+    auto last = first;
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        recorder.scanned();
+        last = it.base();
+        *offset_inserter++ = std::distance(first, last);
+    }
+    return MaterialisedRange<Iterator> {first, std::next(last), std::move(offsets)};
+}
+
+} // namespace mappable
+
+#endif
@@ -0,0 +1,229 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef overlap_cursor_hpp
+#define overlap_cursor_hpp
+
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+#include "mappable.hpp"
+#include "mappable_range.hpp"
+#include "mappable_algorithms.hpp"
+
+namespace mappable {
+
+/*
+ OverlapCursor answers a sequence of overlap and containment queries against the sorted range [first, last),
+ for queries that are given in sorted order, e.g. successive windows along a contig. Each query resumes from
+ where the previous one finished with a galloping search, so a sweep costs O(log d) per query, where d is the
+ distance the query moved, rather than a binary search of the whole range; for densely tiled windows this is
+ O(1) amortised.
+
+ The cursor only moves forwards: a query that is before the previous one gives undefined results unless
+ reset is called first. A cursor is invalidated by any modification of the underlying range.
+ */
+template <typename BidirIt>
+class OverlapCursor
+{
+public:
+    using iterator   = BidirIt;
+    using value_type = typename std::iterator_traits<BidirIt>::value_type;
+    using size_type  = std::size_t;
+    using Position   = typename RegionType<value_type>::Position;
+
+    OverlapCursor(BidirIt first, BidirIt last);
+    OverlapCursor(BidirIt first, BidirIt last, BidirectionallySortedTag);
+    OverlapCursor(BidirIt first, BidirIt last, Position max_mappable_size);
+
+    OverlapCursor(const OverlapCursor&)            = default;
+    OverlapCursor& operator=(const OverlapCursor&) = default;
+    OverlapCursor(OverlapCursor&&)                 = default;
+    OverlapCursor& operator=(OverlapCursor&&)      = default;
+
+    ~OverlapCursor() = default;
+
+    template <typename MappableTp>
+    OverlapRange<BidirIt> overlap_range(const MappableTp& mappable);
+    template <typename MappableTp>
+    bool has_overlapped(const MappableTp& mappable);
+    template <typename MappableTp>
+    size_type count_overlapped(const MappableTp& mappable);
+
+    template <typename MappableTp>
+    ContainedRange<BidirIt> contained_range(const MappableTp& mappable);
+    template <typename MappableTp>
+    bool has_contained(const MappableTp& mappable);
+    template <typename MappableTp>
+    size_type count_contained(const MappableTp& mappable);
+
+    void reset() noexcept;
+
+private:
+    enum class Order { forward, bidirectional, bounded };
+
+    BidirIt first_, last_, overlap_hint_, contained_hint_;
+    Order order_;
+    Position max_mappable_size_;
+};
+
+template <typename BidirIt>
+OverlapCursor<BidirIt>::OverlapCursor(BidirIt first, BidirIt last)
+: first_ {first}
+, last_ {last}
+, overlap_hint_ {first}
+, contained_hint_ {first}
+, order_ {Order::forward}
+, max_mappable_size_ {}
+{}
+
+template <typename BidirIt>
+OverlapCursor<BidirIt>::OverlapCursor(BidirIt first, BidirIt last, BidirectionallySortedTag)
+: OverlapCursor {first, last}
+{
+    order_ = Order::bidirectional;
+}
+
+template <typename BidirIt>
+OverlapCursor<BidirIt>::OverlapCursor(BidirIt first, BidirIt last, const Position max_mappable_size)
+: OverlapCursor {first, last}
+{
+    order_ = Order::bounded;
+    max_mappable_size_ = max_mappable_size;
+}
+
+template <typename BidirIt>
+template <typename MappableTp>
+OverlapRange<BidirIt> OverlapCursor<BidirIt>::overlap_range(const MappableTp& mappable)
+{
+    switch (order_) {
+        case Order::bidirectional:
+            return detail::sweep_overlap_range(first_, overlap_hint_, last_, mappable, BidirectionallySortedTag {});
+        case Order::bounded:
+            return detail::sweep_overlap_range(first_, overlap_hint_, last_, mappable, max_mappable_size_);
+        default:
+            return detail::sweep_overlap_range(first_, overlap_hint_, last_, mappable, ForwardSortedTag {});
+    }
+}
+
+template <typename BidirIt>
+template <typename MappableTp>
+bool OverlapCursor<BidirIt>::has_overlapped(const MappableTp& mappable)
+{
+    return !overlap_range(mappable).empty();
+}
+
+template <typename BidirIt>
+template <typename MappableTp>
+typename OverlapCursor<BidirIt>::size_type OverlapCursor<BidirIt>::count_overlapped(const MappableTp& mappable)
+{
+    const auto overlapped = overlap_range(mappable);
+    if (order_ == Order::bidirectional) {
+        return size(overlapped, BidirectionallySortedTag {});
+    }
+    return size(overlapped, ForwardSortedTag {});
+}
+
+template <typename BidirIt>
+template <typename MappableTp>
+ContainedRange<BidirIt> OverlapCursor<BidirIt>::contained_range(const MappableTp& mappable)
+{
+    static_assert(is_region_or_mappable<MappableTp>, "Mappable required");
+    // Elements beginning before mappable cannot be contained by it or any later mappable
+    contained_hint_ = detail::gallop_lower_bound(contained_hint_, last_, mappable,
+                                                 [] (const auto& lhs, const auto& rhs) {
+                                                     return begins_before(lhs, rhs);
+                                                 });
+    const auto it = detail::gallop_find_first_after(contained_hint_, last_, mappable);
+    if (contained_hint_ == it) return make_contained_range(it, it, mappable);
+    const auto rit = std::find_if(std::make_reverse_iterator(it), std::make_reverse_iterator(std::next(contained_hint_)),
+                                  [&mappable] (const auto& m) { return contains(mappable, m); });
+    return make_contained_range(contained_hint_, rit.base(), mappable);
+}
+
+template <typename BidirIt>
+template <typename MappableTp>
+bool OverlapCursor<BidirIt>::has_contained(const MappableTp& mappable)
+{
+    return !contained_range(mappable).empty();
+}
+
+template <typename BidirIt>
+template <typename MappableTp>
+typename OverlapCursor<BidirIt>::size_type OverlapCursor<BidirIt>::count_contained(const MappableTp& mappable)
+{
+    const auto contained = contained_range(mappable);
+    if (order_ == Order::bidirectional) {
+        return size(contained, BidirectionallySortedTag {});
+    }
+    return size(contained, ForwardSortedTag {});
+}
+
+template <typename BidirIt>
+void OverlapCursor<BidirIt>::reset() noexcept
+{
+    overlap_hint_ = first_;
+    contained_hint_ = first_;
+}
+
+// non-member methods
+
+template <typename BidirIt>
+auto make_overlap_cursor(BidirIt first, BidirIt last)
+{
+    return OverlapCursor<BidirIt> {first, last};
+}
+
+template <typename BidirIt, typename OrderInfo>
+auto make_overlap_cursor(BidirIt first, BidirIt last, OrderInfo order)
+{
+    return OverlapCursor<BidirIt> {first, last, order};
+}
+
+namespace detail {
+
+template <typename C, typename = void>
+struct HasMemberSortInfo : std::false_type {};
+
+template <typename C>
+struct HasMemberSortInfo<C, std::enable_if_t<
+    std::is_same<decltype(std::declval<C>().bidirectionally_sorted()), bool>::value
+    && std::is_convertible<decltype(std::declval<C>().max_element_size()),
+                           typename RegionType<typename C::value_type>::Position>::value>>
+: std::true_type {};
+
+template <typename Container>
+auto make_overlap_cursor(const Container& mappables, std::true_type)
+{
+    using Iterator = typename Container::const_iterator;
+    if (mappables.bidirectionally_sorted()) {
+        return OverlapCursor<Iterator> {std::cbegin(mappables), std::cend(mappables), BidirectionallySortedTag {}};
+    }
+    return OverlapCursor<Iterator> {std::cbegin(mappables), std::cend(mappables), mappables.max_element_size()};
+}
+
+template <typename Range>
+auto make_overlap_cursor(const Range& mappables, std::false_type)
+{
+    return make_overlap_cursor(std::cbegin(mappables), std::cend(mappables));
+}
+
+} // namespace detail
+
+/**
+ Returns an OverlapCursor over mappables. If mappables is a container that knows its sort order (like
+ MappableFlatSet and MappableFlatMultiSet), the cursor uses the same search bounds as the container's own
+ queries; otherwise mappables is assumed to be ForwardSorted.
+ */
+template <typename Range>
+auto make_overlap_cursor(const Range& mappables)
+{
+    return detail::make_overlap_cursor(mappables, detail::HasMemberSortInfo<Range> {});
+}
+
+} // namespace mappable
+
+#endif
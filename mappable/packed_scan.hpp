@@ -0,0 +1,208 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef packed_scan_hpp
+#define packed_scan_hpp
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#if !defined(MAPPABLE_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define MAPPABLE_X86_SIMD 1
+    #include <immintrin.h>
+#else
+    #define MAPPABLE_X86_SIMD 0
+#endif
+
+namespace mappable {
+
+/*
+ Predicate scans over packed begin and end position columns (see MappableColumnSet). Each function tests the
+ n regions [begins[i], ends[i]) against the query [query_begin, query_end) and returns the number of matches.
+
+ These scans are only used by MappableColumnSet. The generic algorithms read interleaved regions whose
+ positions are std::uint_fast32_t (64 bits on LP64 targets), which cannot be loaded as 32-bit columns.
+
+ On x86 the scans are vectorised with AVX2 (8 regions per step) or SSE4.1 (4 regions per step), selected at
+ runtime from the host CPU; otherwise, or if MAPPABLE_NO_SIMD is defined, a scalar loop is used.
+ */
+
+namespace detail {
+
+enum class PackedPredicate { overlaps, contained, spans };
+
+enum class SimdLevel { scalar, sse41, avx2 };
+
+inline SimdLevel host_simd_level() noexcept
+{
+#if MAPPABLE_X86_SIMD
+    static const SimdLevel result = __builtin_cpu_supports("avx2") ? SimdLevel::avx2
+                                    : __builtin_cpu_supports("sse4.1") ? SimdLevel::sse41 : SimdLevel::scalar;
+    return result;
+#else
+    return SimdLevel::scalar;
+#endif
+}
+
+template <PackedPredicate P>
+bool packed_test(const std::uint32_t begin, const std::uint32_t end,
+                 const std::uint32_t query_begin, const std::uint32_t query_end) noexcept
+{
+    switch (P) {
+        case PackedPredicate::overlaps:
+        {
+            // Same as overlaps for ContigRegion: empty regions overlap regions they touch
+            const auto overlap_begin = std::max(begin, query_begin);
+            const auto overlap_end   = std::min(end, query_end);
+            return overlap_begin < overlap_end
+                   || (overlap_begin == overlap_end && (begin == end || query_begin == query_end));
+        }
+        case PackedPredicate::contained:
+            return query_begin <= begin && end <= query_end;
+        case PackedPredicate::spans:
+            return begin <= query_begin && query_end <= end;
+    }
+    return false;
+}
+
+template <PackedPredicate P>
+std::size_t packed_scan_scalar(const std::uint32_t* begins, const std::uint32_t* ends, const std::size_t n,
+                               const std::uint32_t query_begin, const std::uint32_t query_end,
+                               std::size_t i = 0) noexcept
+{
+    std::size_t result {0};
+    for (; i < n; ++i) {
+        if (packed_test<P>(begins[i], ends[i], query_begin, query_end)) ++result;
+    }
+    return result;
+}
+
+#if MAPPABLE_X86_SIMD
+
+template <PackedPredicate P>
+__attribute__((target("avx2")))
+std::size_t packed_scan_avx2(const std::uint32_t* begins, const std::uint32_t* ends, const std::size_t n,
+                             const std::uint32_t query_begin, const std::uint32_t query_end) noexcept
+{
+    const __m256i qbegin = _mm256_set1_epi32(static_cast<int>(query_begin));
+    const __m256i qend   = _mm256_set1_epi32(static_cast<int>(query_end));
+    const bool query_empty {query_begin == query_end};
+    std::size_t result {0}, i {0};
+    for (; i + 8 <= n; i += 8) {
+        const __m256i begin = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begins + i));
+        const __m256i end   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ends + i));
+        __m256i hits;
+        switch (P) {
+            case PackedPredicate::overlaps:
+            {
+                // No unsigned compare, so a <= b is tested as max(a, b) == b
+                const __m256i overlap_begin = _mm256_max_epu32(begin, qbegin);
+                const __m256i overlap_end   = _mm256_min_epu32(end, qend);
+                hits = _mm256_cmpeq_epi32(_mm256_max_epu32(overlap_begin, overlap_end), overlap_end);
+                if (!query_empty) {
+                    // Touching regions only overlap if the element is empty
+                    const __m256i touching = _mm256_andnot_si256(_mm256_cmpeq_epi32(begin, end),
+                                                                 _mm256_cmpeq_epi32(overlap_begin, overlap_end));
+                    hits = _mm256_andnot_si256(touching, hits);
+                }
+                break;
+            }
+            case PackedPredicate::contained:
+                hits = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_max_epu32(begin, qbegin), begin),
+                                        _mm256_cmpeq_epi32(_mm256_min_epu32(end, qend), end));
+                break;
+            case PackedPredicate::spans:
+                hits = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_min_epu32(begin, qbegin), begin),
+                                        _mm256_cmpeq_epi32(_mm256_max_epu32(end, qend), end));
+                break;
+        }
+        const auto bits = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(hits)));
+        result += __builtin_popcount(bits);
+    }
+    return result + packed_scan_scalar<P>(begins, ends, n, query_begin, query_end, i);
+}
+
+template <PackedPredicate P>
+__attribute__((target("sse4.1")))
+std::size_t packed_scan_sse41(const std::uint32_t* begins, const std::uint32_t* ends, const std::size_t n,
+                              const std::uint32_t query_begin, const std::uint32_t query_end) noexcept
+{
+    const __m128i qbegin = _mm_set1_epi32(static_cast<int>(query_begin));
+    const __m128i qend   = _mm_set1_epi32(static_cast<int>(query_end));
+    const bool query_empty {query_begin == query_end};
+    std::size_t result {0}, i {0};
+    for (; i + 4 <= n; i += 4) {
+        const __m128i begin = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begins + i));
+        const __m128i end   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ends + i));
+        __m128i hits;
+        switch (P) {
+            case PackedPredicate::overlaps:
+            {
+                const __m128i overlap_begin = _mm_max_epu32(begin, qbegin);
+                const __m128i overlap_end   = _mm_min_epu32(end, qend);
+                hits = _mm_cmpeq_epi32(_mm_max_epu32(overlap_begin, overlap_end), overlap_end);
+                if (!query_empty) {
+                    const __m128i touching = _mm_andnot_si128(_mm_cmpeq_epi32(begin, end),
+                                                              _mm_cmpeq_epi32(overlap_begin, overlap_end));
+                    hits = _mm_andnot_si128(touching, hits);
+                }
+                break;
+            }
+            case PackedPredicate::contained:
+                hits = _mm_and_si128(_mm_cmpeq_epi32(_mm_max_epu32(begin, qbegin), begin),
+                                     _mm_cmpeq_epi32(_mm_min_epu32(end, qend), end));
+                break;
+            case PackedPredicate::spans:
+                hits = _mm_and_si128(_mm_cmpeq_epi32(_mm_min_epu32(begin, qbegin), begin),
+                                     _mm_cmpeq_epi32(_mm_max_epu32(end, qend), end));
+                break;
+        }
+        const auto bits = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(hits)));
+        result += __builtin_popcount(bits);
+    }
+    return result + packed_scan_scalar<P>(begins, ends, n, query_begin, query_end, i);
+}
+
+#endif // MAPPABLE_X86_SIMD
+
+template <PackedPredicate P>
+std::size_t packed_scan(const std::uint32_t* begins, const std::uint32_t* ends, const std::size_t n,
+                        const std::uint32_t query_begin, const std::uint32_t query_end,
+                        const SimdLevel level = host_simd_level()) noexcept
+{
+    switch (level) {
+#if MAPPABLE_X86_SIMD
+        case SimdLevel::avx2:
+            return packed_scan_avx2<P>(begins, ends, n, query_begin, query_end);
+        case SimdLevel::sse41:
+            return packed_scan_sse41<P>(begins, ends, n, query_begin, query_end);
+#endif
+        default:
+            return packed_scan_scalar<P>(begins, ends, n, query_begin, query_end);
+    }
+}
+
+} // namespace detail
+
+inline std::size_t count_overlapped_packed(const std::uint32_t* begins, const std::uint32_t* ends, std::size_t n,
+                                           std::uint32_t query_begin, std::uint32_t query_end) noexcept
+{
+    return detail::packed_scan<detail::PackedPredicate::overlaps>(begins, ends, n, query_begin, query_end);
+}
+
+inline std::size_t count_contained_packed(const std::uint32_t* begins, const std::uint32_t* ends, std::size_t n,
+                                          std::uint32_t query_begin, std::uint32_t query_end) noexcept
+{
+    return detail::packed_scan<detail::PackedPredicate::contained>(begins, ends, n, query_begin, query_end);
+}
+
+inline std::size_t count_spanning_packed(const std::uint32_t* begins, const std::uint32_t* ends, std::size_t n,
+                                         std::uint32_t query_begin, std::uint32_t query_end) noexcept
+{
+    return detail::packed_scan<detail::PackedPredicate::spans>(begins, ends, n, query_begin, query_end);
+}
+
+} // namespace mappable
+
+#endif
@@ -0,0 +1,121 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef parallel_sort_hpp
+#define parallel_sort_hpp
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <future>
+#include <thread>
+#include <cstddef>
+
+#include "mappable.hpp"
+#include "sorted_element_stats.hpp"
+
+namespace mappable { namespace detail {
+
+// Ranges smaller than this are not worth splitting between threads
+static constexpr std::size_t min_parallel_chunk_size {1u << 14};
+
+inline unsigned resolve_num_threads(const unsigned num_threads) noexcept
+{
+    if (num_threads > 0) return num_threads;
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+template <typename RandomIt>
+std::vector<RandomIt> make_chunk_bounds(RandomIt first, RandomIt last, unsigned num_threads)
+{
+    const auto n = static_cast<std::size_t>(std::distance(first, last));
+    const auto num_chunks = std::max(std::min<std::size_t>(resolve_num_threads(num_threads), n / min_parallel_chunk_size),
+                                     std::size_t {1});
+    std::vector<RandomIt> result {};
+    result.reserve(num_chunks + 1);
+    for (std::size_t i {0}; i < num_chunks; ++i) {
+        result.push_back(std::next(first, i * n / num_chunks));
+    }
+    result.push_back(last);
+    return result;
+}
+
+/**
+ Sorts [first, last) by sorting up to num_threads chunks concurrently and then merging adjacent chunks
+ pairwise, again concurrently. num_threads == 0 means use all hardware threads. Small ranges, or a
+ num_threads of 1, are just sorted with std::sort. Presorted ranges (e.g. from sorted input files) are
+ detected with a linear scan and left as they are.
+ */
+template <typename RandomIt, typename Compare = std::less<>>
+void parallel_sort(RandomIt first, RandomIt last, unsigned num_threads = 0, Compare comp = Compare {})
+{
+    if (std::is_sorted(first, last, comp)) return;
+    auto bounds = make_chunk_bounds(first, last, num_threads);
+    if (bounds.size() <= 2) {
+        std::sort(first, last, comp);
+        return;
+    }
+    std::vector<std::future<void>> tasks {};
+    tasks.reserve(bounds.size() - 1);
+    for (std::size_t i {0}; i + 1 < bounds.size(); ++i) {
+        tasks.push_back(std::async(std::launch::async, [&bounds, &comp, i] () {
+            std::sort(bounds[i], bounds[i + 1], comp);
+        }));
+    }
+    for (auto& task : tasks) task.get();
+    while (bounds.size() > 2) {
+        tasks.clear();
+        std::vector<RandomIt> merged_bounds {};
+        merged_bounds.reserve(bounds.size() / 2 + 1);
+        std::size_t i {0};
+        for (; i + 2 < bounds.size(); i += 2) {
+            merged_bounds.push_back(bounds[i]);
+            tasks.push_back(std::async(std::launch::async, [&bounds, &comp, i] () {
+                std::inplace_merge(bounds[i], bounds[i + 1], bounds[i + 2], comp);
+            }));
+        }
+        for (; i < bounds.size(); ++i) {
+            merged_bounds.push_back(bounds[i]);
+        }
+        for (auto& task : tasks) task.get();
+        bounds = std::move(merged_bounds);
+    }
+}
+
+/**
+ Computes the SortedElementStats of the sorted range [first, last) in a single pass, split between up to
+ num_threads threads whose statistics are then merged.
+ */
+template <typename RandomIt>
+auto summarise_sorted(RandomIt first, RandomIt last, unsigned num_threads = 0)
+{
+    using Position = typename RegionType<typename std::iterator_traits<RandomIt>::value_type>::Position;
+    const auto bounds = make_chunk_bounds(first, last, num_threads);
+    const auto num_chunks = bounds.size() - 1;
+    std::vector<SortedElementStats<Position>> summaries(num_chunks);
+    if (num_chunks == 1) {
+        summaries.front().add_range(first, last);
+    } else {
+        std::vector<std::future<void>> tasks {};
+        tasks.reserve(num_chunks);
+        for (std::size_t i {0}; i < num_chunks; ++i) {
+            tasks.push_back(std::async(std::launch::async, [&bounds, &summaries, i] () {
+                summaries[i].add_range(bounds[i], bounds[i + 1]);
+            }));
+        }
+        for (auto& task : tasks) task.get();
+    }
+    auto& result = summaries.front();
+    for (std::size_t i {1}; i < num_chunks; ++i) {
+        // The pairs that straddle the chunk boundaries
+        result.add_adjacent(*std::prev(bounds[i]), *bounds[i]);
+        result.merge(summaries[i]);
+    }
+    return result;
+}
+
+} // namespace detail
+} // namespace mappable
+
+#endif
@@ -0,0 +1,295 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef region_reader_hpp
+#define region_reader_hpp
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <cstring>
+#include <cstddef>
+
+#include <boost/utility/string_ref.hpp>
+
+#include "contig_region.hpp"
+#include "genomic_region.hpp"
+#include "contig_dictionary.hpp"
+#include "mappable_flat_multi_set.hpp"
+#include "mappable_map.hpp"
+#include "mapped_file.hpp"
+
+namespace mappable {
+
+/*
+ BedRecord is one record of a BED file. The contig and the unparsed remaining columns (name, score, etc) refer
+ directly into the buffer being parsed, so no memory is allocated per record.
+ */
+struct BedRecord
+{
+    boost::string_ref contig;
+    ContigRegion region;
+    boost::string_ref rest;
+};
+
+namespace detail {
+
+inline bool is_bed_delimiter(const char c) noexcept
+{
+    return c == '\t' || c == ' ';
+}
+
+inline bool parse_position(const char*& first, const char* last, ContigRegion::Position& result) noexcept
+{
+    using Position = ContigRegion::Position;
+    static constexpr Position max_position {std::numeric_limits<Position>::max()};
+    bool has_digits {false};
+    result = 0;
+    for (; first != last; ++first) {
+        const auto digit = static_cast<unsigned>(*first - '0');
+        if (digit > 9) break;
+        if (result > (max_position - digit) / 10) return false;
+        result = 10 * result + digit;
+        has_digits = true;
+    }
+    return has_digits;
+}
+
+// As parse_position, but also accepts thousands separators between groups of three digits, e.g. 1,000,000.
+// Only region strings accept separators; BED positions are plain integers.
+inline bool parse_separated_position(const char*& first, const char* last, ContigRegion::Position& result) noexcept
+{
+    using Position = ContigRegion::Position;
+    static constexpr Position max_position {std::numeric_limits<Position>::max()};
+    const auto start = first;
+    if (!parse_position(first, last, result)) return false;
+    if (first == last || *first != ',') return true;
+    if (first - start > 3) return false;
+    while (first != last && *first == ',') {
+        const auto group = ++first;
+        Position digits;
+        if (!parse_position(first, last, digits) || first - group != 3) return false;
+        if (result > (max_position - digits) / 1000) return false;
+        result = 1000 * result + digits;
+    }
+    return true;
+}
+
+// Calls f with each line in [first, last), without the line terminator
+template <typename UnaryFunction>
+void for_each_line(const char* first, const char* last, UnaryFunction f)
+{
+    while (first < last) {
+        auto line_end = static_cast<const char*>(std::memchr(first, '\n', static_cast<std::size_t>(last - first)));
+        if (line_end == nullptr) line_end = last;
+        auto content_end = line_end;
+        if (content_end != first && *std::prev(content_end) == '\r') --content_end;
+        f(boost::string_ref {first, static_cast<std::size_t>(content_end - first)});
+        first = (line_end == last) ? last : std::next(line_end);
+    }
+}
+
+inline boost::string_ref parse_bed_field(const char*& first, const char* last) noexcept
+{
+    const auto start = first;
+    first = std::find_if(first, last, is_bed_delimiter);
+    return boost::string_ref {start, static_cast<std::size_t>(first - start)};
+}
+
+inline bool is_bed_header_line(const boost::string_ref line) noexcept
+{
+    return line.empty() || line.front() == '#' || line.starts_with("track") || line.starts_with("browser");
+}
+
+inline bool parse_bed_line(const boost::string_ref line, BedRecord& record) noexcept
+{
+    auto first = line.data();
+    const auto last = line.data() + line.size();
+    record.contig = parse_bed_field(first, last);
+    if (record.contig.empty() || first == last) return false;
+    ++first;
+    ContigRegion::Position begin, end;
+    if (!parse_position(first, last, begin) || first == last || !is_bed_delimiter(*first)) return false;
+    ++first;
+    if (!parse_position(first, last, end) || end < begin) return false;
+    if (first != last) {
+        if (!is_bed_delimiter(*first)) return false;
+        ++first;
+    }
+    record.region = ContigRegion {begin, end};
+    record.rest = boost::string_ref {first, static_cast<std::size_t>(last - first)};
+    return true;
+}
+
+// Splits a region string contig:begin-end, without allocating; contig refers into str
+inline bool parse_region_string(const boost::string_ref str, boost::string_ref& contig, ContigRegion& region) noexcept
+{
+    const auto colon = str.rfind(':');
+    if (colon == boost::string_ref::npos || colon == 0) return false;
+    auto first = str.data() + colon + 1;
+    const auto last = str.data() + str.size();
+    ContigRegion::Position begin, end;
+    if (!parse_separated_position(first, last, begin) || first == last || *first != '-'
+        || !parse_separated_position(++first, last, end) || first != last || end < begin) {
+        return false;
+    }
+    contig = str.substr(0, colon);
+    region = ContigRegion {begin, end};
+    return true;
+}
+
+// Caches the ContigKey of the last contig seen, as records on the same contig are usually adjacent
+class ContigKeyCache
+{
+public:
+    using ContigKey = GenomicRegion::ContigKey;
+
+    const ContigKey& key(boost::string_ref contig)
+    {
+        if (!has_key_ || contig != name_) {
+            name_.assign(contig.data(), contig.size());
+#ifdef MAPPABLE_INTERNED_CONTIGS
+            key_ = ContigDictionary::global().intern(name_);
+#else
+            key_ = name_;
+#endif
+            has_key_ = true;
+        }
+        return key_;
+    }
+
+    const GenomicRegion::ContigName& name() const noexcept { return name_; }
+
+private:
+    GenomicRegion::ContigName name_;
+    ContigKey key_;
+    bool has_key_ = false;
+};
+
+struct MakeGenomicRegion
+{
+    GenomicRegion operator()(const GenomicRegion::ContigKey& contig, const BedRecord& record) const
+    {
+        return GenomicRegion {contig, record.region};
+    }
+};
+
+template <typename Container, typename Buffers>
+MappableMap<GenomicRegion::ContigName, typename Container::value_type, Container>
+make_contig_map(Buffers& buffers, const unsigned num_threads)
+{
+    MappableMap<GenomicRegion::ContigName, typename Container::value_type, Container> result {buffers.size()};
+    for (auto& p : buffers) {
+        result.emplace(std::piecewise_construct,
+                       std::forward_as_tuple(p.first),
+                       std::forward_as_tuple(std::make_move_iterator(std::begin(p.second)),
+                                             std::make_move_iterator(std::end(p.second)),
+                                             num_threads));
+        p.second.clear();
+        p.second.shrink_to_fit();
+    }
+    return result;
+}
+
+} // namespace detail
+
+/**
+ Parses the region string str, which is in the format written by to_string(GenomicRegion), i.e.
+ contig:begin-end with zero-indexed half open positions. Positions may contain thousands separators between
+ groups of three digits, and the contig name may itself contain ':'.
+ */
+inline GenomicRegion parse_region(const boost::string_ref str)
+{
+    boost::string_ref contig;
+    ContigRegion region;
+    if (!detail::parse_region_string(str, contig, region)) {
+        throw std::invalid_argument {"parse_region: bad region " + str.to_string()};
+    }
+    return GenomicRegion {contig.to_string(), region};
+}
+
+/**
+ Calls f with each BedRecord in the buffer [first, last), skipping blank, comment, track and browser lines,
+ and returns the number of records. Columns may be separated by tabs or spaces.
+
+ Throws std::runtime_error if a line is not a valid BED record.
+ */
+template <typename UnaryFunction>
+std::size_t parse_bed(const char* first, const char* last, UnaryFunction f)
+{
+    std::size_t num_records {0}, line_number {0};
+    BedRecord record {};
+    detail::for_each_line(first, last, [&] (const boost::string_ref line) {
+        ++line_number;
+        if (detail::is_bed_header_line(line)) return;
+        if (!detail::parse_bed_line(line, record)) {
+            throw std::runtime_error {"parse_bed: bad record on line " + std::to_string(line_number)};
+        }
+        f(record);
+        ++num_records;
+    });
+    return num_records;
+}
+
+/**
+ Reads the BED file at path into a MappableMap keyed by contig name. The file is memory mapped and parsed in
+ place, contig names are only looked up when the contig changes, and each contig's elements are bulk loaded
+ into a Container with its range constructor (which skips sorting if the file is already sorted).
+
+ make(contig_key, record) makes the element for each record; by default the element is a GenomicRegion.
+ */
+template <typename Container = MappableFlatMultiSet<GenomicRegion>, typename MakeMappable = detail::MakeGenomicRegion>
+MappableMap<GenomicRegion::ContigName, typename Container::value_type, Container>
+read_bed(const std::string& path, MakeMappable make = MakeMappable {}, const unsigned num_threads = 1)
+{
+    using MappableType = typename Container::value_type;
+    const MappedFile file {path};
+    std::unordered_map<GenomicRegion::ContigName, std::vector<MappableType>> buffers {};
+    detail::ContigKeyCache contigs {};
+    std::vector<MappableType>* buffer {nullptr};
+    parse_bed(file.begin(), file.end(), [&] (const BedRecord& record) {
+        const bool is_new_contig {buffer == nullptr || record.contig != contigs.name()};
+        const auto& contig = contigs.key(record.contig);
+        if (is_new_contig) buffer = &buffers[contigs.name()];
+        buffer->push_back(make(contig, record));
+    });
+    return detail::make_contig_map<Container>(buffers, num_threads);
+}
+
+/**
+ Reads a file of region strings (see parse_region), one per line, into a MappableMap keyed by contig name.
+ Blank lines and lines starting with '#' are skipped. As with read_bed, lines are parsed in place and contig
+ names are only looked up when the contig changes.
+ */
+template <typename Container = MappableFlatMultiSet<GenomicRegion>>
+MappableMap<GenomicRegion::ContigName, typename Container::value_type, Container>
+read_region_list(const std::string& path, const unsigned num_threads = 1)
+{
+    const MappedFile file {path};
+    using MappableType = typename Container::value_type;
+    std::unordered_map<GenomicRegion::ContigName, std::vector<MappableType>> buffers {};
+    detail::ContigKeyCache contigs {};
+    std::vector<MappableType>* buffer {nullptr};
+    boost::string_ref contig_name;
+    ContigRegion region;
+    detail::for_each_line(file.begin(), file.end(), [&] (const boost::string_ref line) {
+        if (line.empty() || line.front() == '#') return;
+        if (!detail::parse_region_string(line, contig_name, region)) {
+            throw std::invalid_argument {"read_region_list: bad region " + line.to_string()};
+        }
+        const bool is_new_contig {buffer == nullptr || contig_name != contigs.name()};
+        const auto& contig = contigs.key(contig_name);
+        if (is_new_contig) buffer = &buffers[contigs.name()];
+        buffer->emplace_back(contig, region);
+    });
+    return detail::make_contig_map<Container>(buffers, num_threads);
+}
+
+} // namespace mappable
+
+#endif
@@ -0,0 +1,240 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef region_writer_hpp
+#define region_writer_hpp
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <ostream>
+#include <cstring>
+#include <cstddef>
+
+#include <boost/utility/string_ref.hpp>
+
+#include "contig_region.hpp"
+#include "genomic_region.hpp"
+#include "mappable.hpp"
+
+namespace mappable {
+
+namespace detail {
+
+static constexpr std::size_t max_position_digits {20};
+
+// Writes the decimal digits of position ending at last, and returns a pointer to the first digit
+inline char* format_position_backwards(char* last, ContigRegion::Position position) noexcept
+{
+    static constexpr char digit_pairs[] {
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899"
+    };
+    while (position >= 100) {
+        const auto pair = static_cast<std::size_t>(position % 100) * 2;
+        position /= 100;
+        *--last = digit_pairs[pair + 1];
+        *--last = digit_pairs[pair];
+    }
+    if (position >= 10) {
+        const auto pair = static_cast<std::size_t>(position) * 2;
+        *--last = digit_pairs[pair + 1];
+        *--last = digit_pairs[pair];
+    } else {
+        *--last = static_cast<char>('0' + position);
+    }
+    return last;
+}
+
+inline char* format_position(char* out, const ContigRegion::Position position) noexcept
+{
+    char digits[max_position_digits];
+    const auto last = digits + max_position_digits;
+    const auto first = format_position_backwards(last, position);
+    const auto num_digits = static_cast<std::size_t>(last - first);
+    std::memcpy(out, first, num_digits);
+    return out + num_digits;
+}
+
+} // namespace detail
+
+enum class RegionFormat { bed, region };
+
+/*
+ RegionWriter formats regions into a reusable buffer which is written to the underlying stream when full, so
+ no strings are allocated per region and no iostream formatting is used.
+
+ RegionFormat::bed writes tab separated contig, begin, end lines, and RegionFormat::region writes
+ contig:begin-end lines (the format of to_string and parse_region). A ContigRegion without a contig is written
+ as begin, end (bed) or begin-end (region).
+
+ The buffer is flushed when the RegionWriter is destroyed, but call flush explicitly to see stream errors.
+ */
+class RegionWriter
+{
+public:
+    static constexpr std::size_t default_buffer_size {1 << 16};
+
+    RegionWriter() = delete;
+
+    RegionWriter(std::ostream& os, RegionFormat format, std::size_t buffer_size = default_buffer_size);
+
+    RegionWriter(const RegionWriter&)            = delete;
+    RegionWriter& operator=(const RegionWriter&) = delete;
+    RegionWriter(RegionWriter&&)                 = delete;
+    RegionWriter& operator=(RegionWriter&&)      = delete;
+
+    ~RegionWriter();
+
+    RegionFormat format() const noexcept;
+
+    RegionWriter& write(const ContigRegion& region);
+    RegionWriter& write(boost::string_ref contig, const ContigRegion& region);
+    RegionWriter& write(const GenomicRegion& region);
+
+    // Writes mapped_region(element) for each element in [first, last), e.g. an OverlapRange or ContainedRange
+    template <typename InputIt>
+    RegionWriter& write(InputIt first, InputIt last);
+    template <typename InputIt>
+    RegionWriter& write(boost::string_ref contig, InputIt first, InputIt last);
+
+    void flush();
+
+private:
+    std::ostream* os_;
+    RegionFormat format_;
+    std::vector<char> buffer_;
+    std::size_t size_;
+
+    char* reserve(std::size_t n);
+    void write_contig(boost::string_ref contig);
+    void write_positions(const ContigRegion& region, bool has_contig);
+};
+
+inline RegionWriter::RegionWriter(std::ostream& os, const RegionFormat format, const std::size_t buffer_size)
+: os_ {&os}
+, format_ {format}
+, buffer_(std::max(buffer_size, 2 * detail::max_position_digits + 3))
+, size_ {0}
+{}
+
+inline RegionWriter::~RegionWriter()
+{
+    try {
+        flush();
+    } catch (...) {}
+}
+
+inline RegionFormat RegionWriter::format() const noexcept
+{
+    return format_;
+}
+
+inline RegionWriter& RegionWriter::write(const ContigRegion& region)
+{
+    write_positions(region, false);
+    return *this;
+}
+
+inline RegionWriter& RegionWriter::write(const boost::string_ref contig, const ContigRegion& region)
+{
+    write_contig(contig);
+    write_positions(region, true);
+    return *this;
+}
+
+inline RegionWriter& RegionWriter::write(const GenomicRegion& region)
+{
+    return write(region.contig_name(), region.contig_region());
+}
+
+template <typename InputIt>
+RegionWriter& RegionWriter::write(InputIt first, InputIt last)
+{
+    std::for_each(first, last, [this] (const auto& mappable) { write(mapped_region(mappable)); });
+    return *this;
+}
+
+template <typename InputIt>
+RegionWriter& RegionWriter::write(const boost::string_ref contig, InputIt first, InputIt last)
+{
+    std::for_each(first, last, [this, contig] (const auto& mappable) { write(contig, contig_region(mappable)); });
+    return *this;
+}
+
+inline void RegionWriter::flush()
+{
+    os_->write(buffer_.data(), static_cast<std::streamsize>(size_));
+    size_ = 0;
+    os_->flush();
+}
+
+// private methods
+
+inline char* RegionWriter::reserve(const std::size_t n)
+{
+    if (size_ + n > buffer_.size()) {
+        os_->write(buffer_.data(), static_cast<std::streamsize>(size_));
+        size_ = 0;
+    }
+    return buffer_.data() + size_;
+}
+
+inline void RegionWriter::write_contig(const boost::string_ref contig)
+{
+    if (contig.size() > buffer_.size()) {
+        reserve(buffer_.size());
+        os_->write(contig.data(), static_cast<std::streamsize>(contig.size()));
+    } else {
+        std::memcpy(reserve(contig.size()), contig.data(), contig.size());
+        size_ += contig.size();
+    }
+}
+
+inline void RegionWriter::write_positions(const ContigRegion& region, const bool has_contig)
+{
+    auto out = reserve(2 * detail::max_position_digits + 3);
+    const auto first = out;
+    if (has_contig) *out++ = format_ == RegionFormat::bed ? '\t' : ':';
+    out = detail::format_position(out, region.begin());
+    *out++ = format_ == RegionFormat::bed ? '\t' : '-';
+    out = detail::format_position(out, region.end());
+    *out++ = '\n';
+    size_ += static_cast<std::size_t>(out - first);
+}
+
+// non-member methods
+
+/**
+ Writes the regions of the elements in range to os in the given format, with one buffered pass over range.
+ */
+template <typename Range>
+std::ostream& write_regions(std::ostream& os, const Range& range, const RegionFormat format = RegionFormat::bed)
+{
+    RegionWriter writer {os, format};
+    writer.write(std::cbegin(range), std::cend(range));
+    writer.flush();
+    return os;
+}
+
+template <typename Range>
+std::ostream& write_regions(std::ostream& os, const boost::string_ref contig, const Range& range,
+                            const RegionFormat format = RegionFormat::bed)
+{
+    RegionWriter writer {os, format};
+    writer.write(contig, std::cbegin(range), std::cend(range));
+    writer.flush();
+    return os;
+}
+
+} // namespace mappable
+
+#endif
@@ -0,0 +1,196 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef segmentation_hpp
+#define segmentation_hpp
+
+#include <vector>
+#include <iterator>
+#include <cstddef>
+#include <cassert>
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/range/iterator_range_core.hpp>
+
+namespace mappable {
+
+/*
+ Segmentation is a partition of a sorted range [base_begin, base_end) into consecutive segments, stored as a
+ single array of boundary offsets from base_begin: segment i is [base_begin + boundaries[i],
+ base_begin + boundaries[i + 1]). No elements are copied, so a Segmentation is only valid while the underlying
+ range is unmodified.
+
+ Segments are returned as boost::iterator_range views. Access is constant time if Iterator is random access,
+ otherwise linear in the offset of the segment.
+ */
+template <typename Iterator>
+class Segmentation
+{
+public:
+    using base_iterator   = Iterator;
+    using value_type      = boost::iterator_range<Iterator>;
+    using reference       = value_type;
+    using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+    using size_type       = std::size_t;
+
+    class iterator;
+    using const_iterator = iterator;
+
+    Segmentation() = default;
+
+    Segmentation(Iterator first, std::vector<difference_type> boundaries);
+
+    Segmentation(const Segmentation&)            = default;
+    Segmentation& operator=(const Segmentation&) = default;
+    Segmentation(Segmentation&&)                 = default;
+    Segmentation& operator=(Segmentation&&)      = default;
+
+    ~Segmentation() = default;
+
+    iterator begin() const noexcept;
+    iterator end() const noexcept;
+
+    value_type operator[](size_type n) const;
+    value_type front() const;
+    value_type back() const;
+
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+
+    Iterator base_begin() const noexcept;
+    Iterator base_end() const;
+    const std::vector<difference_type>& boundaries() const noexcept;
+
+private:
+    Iterator first_;
+    std::vector<difference_type> boundaries_;
+};
+
+template <typename Iterator>
+class Segmentation<Iterator>::iterator
+    : public boost::iterator_facade<
+        typename Segmentation<Iterator>::iterator,
+        typename Segmentation<Iterator>::value_type,
+        boost::random_access_traversal_tag,
+        typename Segmentation<Iterator>::reference,
+        typename Segmentation<Iterator>::difference_type
+    >
+{
+public:
+    iterator() = default;
+
+    iterator(const Segmentation* segmentation, size_type index) noexcept
+    : segmentation_ {segmentation}
+    , index_ {index}
+    {}
+
+private:
+    friend class boost::iterator_core_access;
+
+    const Segmentation* segmentation_ = nullptr;
+    size_type index_ = 0;
+
+    value_type dereference() const { return (*segmentation_)[index_]; }
+    bool equal(const iterator& other) const noexcept { return index_ == other.index_; }
+    void increment() noexcept { ++index_; }
+    void decrement() noexcept { --index_; }
+    void advance(const difference_type n) noexcept { index_ += n; }
+    difference_type distance_to(const iterator& other) const noexcept
+    {
+        return static_cast<difference_type>(other.index_) - static_cast<difference_type>(index_);
+    }
+};
+
+template <typename Iterator>
+Segmentation<Iterator>::Segmentation(Iterator first, std::vector<difference_type> boundaries)
+: first_ {first}
+, boundaries_ {std::move(boundaries)}
+{
+    assert(boundaries_.empty() || boundaries_.front() == 0);
+}
+
+template <typename Iterator>
+typename Segmentation<Iterator>::iterator Segmentation<Iterator>::begin() const noexcept
+{
+    return iterator {this, 0};
+}
+
+template <typename Iterator>
+typename Segmentation<Iterator>::iterator Segmentation<Iterator>::end() const noexcept
+{
+    return iterator {this, size()};
+}
+
+template <typename Iterator>
+typename Segmentation<Iterator>::value_type Segmentation<Iterator>::operator[](const size_type n) const
+{
+    const auto segment_begin = std::next(first_, boundaries_[n]);
+    return boost::make_iterator_range(segment_begin, std::next(segment_begin, boundaries_[n + 1] - boundaries_[n]));
+}
+
+template <typename Iterator>
+typename Segmentation<Iterator>::value_type Segmentation<Iterator>::front() const
+{
+    return (*this)[0];
+}
+
+template <typename Iterator>
+typename Segmentation<Iterator>::value_type Segmentation<Iterator>::back() const
+{
+    return (*this)[size() - 1];
+}
+
+template <typename Iterator>
+typename Segmentation<Iterator>::size_type Segmentation<Iterator>::size() const noexcept
+{
+    return boundaries_.empty() ? 0 : boundaries_.size() - 1;
+}
+
+template <typename Iterator>
+bool Segmentation<Iterator>::empty() const noexcept
+{
+    return size() == 0;
+}
+
+template <typename Iterator>
+Iterator Segmentation<Iterator>::base_begin() const noexcept
+{
+    return first_;
+}
+
+template <typename Iterator>
+Iterator Segmentation<Iterator>::base_end() const
+{
+    return boundaries_.empty() ? first_ : std::next(first_, boundaries_.back());
+}
+
+template <typename Iterator>
+const std::vector<typename Segmentation<Iterator>::difference_type>&
+Segmentation<Iterator>::boundaries() const noexcept
+{
+    return boundaries_;
+}
+
+// non-member methods
+
+template <typename Iterator>
+boost::iterator_range<Iterator> bases(const Segmentation<Iterator>& segmentation)
+{
+    return boost::make_iterator_range(segmentation.base_begin(), segmentation.base_end());
+}
+
+template <typename Iterator>
+auto size(const Segmentation<Iterator>& segmentation)
+{
+    return segmentation.size();
+}
+
+template <typename Iterator>
+bool empty(const Segmentation<Iterator>& segmentation)
+{
+    return segmentation.empty();
+}
+
+} // namespace mappable
+
+#endif
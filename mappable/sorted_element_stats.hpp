@@ -0,0 +1,285 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef sorted_element_stats_hpp
+#define sorted_element_stats_hpp
+
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <cstddef>
+
+#include "mappable.hpp"
+
+namespace mappable { namespace detail {
+
+/*
+ SortedElementStats maintains the statistics the flat containers use to bound their overlap searches for a
+ sorted sequence of elements: a histogram of element sizes, so the size of the largest element is known after
+ any erasure (and whether all elements have the same size), and the number of adjacent element pairs whose
+ ends are out of order, which is zero exactly when the sequence is bidirectionally sorted.
+
+ The insert and erase methods take the bounds of the whole sequence and update the statistics for the
+ neighbours of the changed elements, so single element updates are O(log k) for k distinct sizes. insert must
+ be called after the elements are added and erase before the elements are removed.
+
+ Range insertions scatter the new elements through the sequence. insertion_blocks groups the sorted new
+ elements by the position they will be inserted at, split must be called with the blocks before the elements
+ are added and insert_blocks after, so a range insertion of m elements costs O(m log n) comparisons.
+ */
+template <typename Position>
+class SortedElementStats
+{
+public:
+    using size_type = std::size_t;
+    using InsertionBlock = std::pair<size_type, size_type>; // insertion position and number of elements
+
+    SortedElementStats() = default;
+
+    SortedElementStats(const SortedElementStats&)            = default;
+    SortedElementStats& operator=(const SortedElementStats&) = default;
+    SortedElementStats(SortedElementStats&&)                 = default;
+    SortedElementStats& operator=(SortedElementStats&&)      = default;
+
+    ~SortedElementStats() = default;
+
+    template <typename ForwardIt>
+    void assign(ForwardIt first, ForwardIt last);
+    template <typename ForwardIt>
+    void add_range(ForwardIt first, ForwardIt last);
+    template <typename MappableType>
+    void add_adjacent(const MappableType& lhs, const MappableType& rhs);
+    template <typename BidirIt>
+    void insert(BidirIt first, BidirIt last, BidirIt inserted);
+    template <typename BidirIt>
+    void insert(BidirIt first, BidirIt last, BidirIt inserted_first, BidirIt inserted_last);
+    template <typename RandomIt, typename ForwardIt>
+    static std::vector<InsertionBlock> insertion_blocks(RandomIt first, RandomIt last,
+                                                        ForwardIt values_first, ForwardIt values_last);
+    template <typename RandomIt>
+    void split(RandomIt first, RandomIt last, const std::vector<InsertionBlock>& blocks);
+    template <typename RandomIt>
+    void insert_blocks(RandomIt first, RandomIt last, const std::vector<InsertionBlock>& blocks);
+    template <typename BidirIt>
+    void erase(BidirIt first, BidirIt last, BidirIt erase_first, BidirIt erase_last);
+    void merge(const SortedElementStats& other);
+    void clear() noexcept;
+
+    bool is_bidirectionally_sorted() const noexcept;
+    bool is_fixed_size() const noexcept;
+    Position max_element_size() const noexcept;
+    size_type num_unsorted_ends() const noexcept;
+
+    template <typename P>
+    friend void swap(SortedElementStats<P>& lhs, SortedElementStats<P>& rhs) noexcept;
+
+private:
+    std::map<Position, size_type> sizes_;
+    size_type num_unsorted_ends_ = 0;
+
+    void add_size(Position size);
+    void remove_size(Position size);
+    template <typename MappableType>
+    static bool are_unsorted(const MappableType& lhs, const MappableType& rhs);
+};
+
+template <typename Position>
+template <typename ForwardIt>
+void SortedElementStats<Position>::assign(ForwardIt first, ForwardIt last)
+{
+    clear();
+    add_range(first, last);
+}
+
+template <typename Position>
+template <typename ForwardIt>
+void SortedElementStats<Position>::add_range(ForwardIt first, ForwardIt last)
+{
+    if (first == last) return;
+    add_size(region_size(*first));
+    for (auto prev = first++; first != last; prev = first++) {
+        add_size(region_size(*first));
+        add_adjacent(*prev, *first);
+    }
+}
+
+template <typename Position>
+template <typename MappableType>
+void SortedElementStats<Position>::add_adjacent(const MappableType& lhs, const MappableType& rhs)
+{
+    if (are_unsorted(lhs, rhs)) ++num_unsorted_ends_;
+}
+
+template <typename Position>
+template <typename BidirIt>
+void SortedElementStats<Position>::insert(BidirIt first, BidirIt last, BidirIt inserted)
+{
+    insert(first, last, inserted, std::next(inserted));
+}
+
+template <typename Position>
+template <typename BidirIt>
+void SortedElementStats<Position>::insert(BidirIt first, BidirIt last,
+                                          BidirIt inserted_first, BidirIt inserted_last)
+{
+    if (inserted_first == inserted_last) return;
+    add_range(inserted_first, inserted_last);
+    if (inserted_first != first) {
+        const auto prev = std::prev(inserted_first);
+        if (inserted_last != last && are_unsorted(*prev, *inserted_last)) --num_unsorted_ends_;
+        add_adjacent(*prev, *inserted_first);
+    }
+    if (inserted_last != last) add_adjacent(*std::prev(inserted_last), *inserted_last);
+}
+
+template <typename Position>
+template <typename RandomIt, typename ForwardIt>
+std::vector<typename SortedElementStats<Position>::InsertionBlock>
+SortedElementStats<Position>::insertion_blocks(const RandomIt first, const RandomIt last,
+                                               ForwardIt values_first, const ForwardIt values_last)
+{
+    // Equivalent elements have the same ends, so where they are placed among each other does not matter
+    std::vector<InsertionBlock> result {};
+    auto position = first;
+    for (; values_first != values_last; ++values_first) {
+        position = std::upper_bound(position, last, *values_first);
+        const auto offset = static_cast<size_type>(std::distance(first, position));
+        if (result.empty() || result.back().first != offset) {
+            result.emplace_back(offset, 1);
+        } else {
+            ++result.back().second;
+        }
+    }
+    return result;
+}
+
+template <typename Position>
+template <typename RandomIt>
+void SortedElementStats<Position>::split(const RandomIt first, const RandomIt last,
+                                         const std::vector<InsertionBlock>& blocks)
+{
+    const auto n = static_cast<size_type>(std::distance(first, last));
+    for (const auto& block : blocks) {
+        if (block.first > 0 && block.first < n && are_unsorted(first[block.first - 1], first[block.first])) {
+            --num_unsorted_ends_;
+        }
+    }
+}
+
+template <typename Position>
+template <typename RandomIt>
+void SortedElementStats<Position>::insert_blocks(const RandomIt first, const RandomIt last,
+                                                 const std::vector<InsertionBlock>& blocks)
+{
+    const auto n = static_cast<size_type>(std::distance(first, last));
+    size_type num_inserted {0};
+    for (const auto& block : blocks) {
+        const auto block_first = block.first + num_inserted, block_last = block_first + block.second;
+        for (auto i = block_first; i < block_last; ++i) {
+            add_size(region_size(first[i]));
+            if (i > 0) add_adjacent(first[i - 1], first[i]);
+        }
+        if (block_last < n) add_adjacent(first[block_last - 1], first[block_last]);
+        num_inserted += block.second;
+    }
+}
+
+template <typename Position>
+template <typename BidirIt>
+void SortedElementStats<Position>::erase(BidirIt first, BidirIt last, BidirIt erase_first, BidirIt erase_last)
+{
+    if (erase_first == erase_last) return;
+    auto prev = erase_first;
+    if (erase_first != first) {
+        prev = std::prev(erase_first);
+    }
+    for (auto it = erase_first; it != erase_last; prev = it++) {
+        remove_size(region_size(*it));
+        if (it != prev && are_unsorted(*prev, *it)) --num_unsorted_ends_;
+    }
+    if (erase_last != last) {
+        if (are_unsorted(*prev, *erase_last)) --num_unsorted_ends_;
+        if (erase_first != first) add_adjacent(*std::prev(erase_first), *erase_last);
+    }
+}
+
+template <typename Position>
+void SortedElementStats<Position>::merge(const SortedElementStats& other)
+{
+    for (const auto& p : other.sizes_) sizes_[p.first] += p.second;
+    num_unsorted_ends_ += other.num_unsorted_ends_;
+}
+
+template <typename Position>
+void SortedElementStats<Position>::clear() noexcept
+{
+    sizes_.clear();
+    num_unsorted_ends_ = 0;
+}
+
+template <typename Position>
+bool SortedElementStats<Position>::is_bidirectionally_sorted() const noexcept
+{
+    return num_unsorted_ends_ == 0;
+}
+
+template <typename Position>
+bool SortedElementStats<Position>::is_fixed_size() const noexcept
+{
+    return sizes_.size() <= 1;
+}
+
+template <typename Position>
+Position SortedElementStats<Position>::max_element_size() const noexcept
+{
+    return sizes_.empty() ? 0 : std::prev(std::cend(sizes_))->first;
+}
+
+template <typename Position>
+typename SortedElementStats<Position>::size_type
+SortedElementStats<Position>::num_unsorted_ends() const noexcept
+{
+    return num_unsorted_ends_;
+}
+
+// private methods
+
+template <typename Position>
+void SortedElementStats<Position>::add_size(const Position size)
+{
+    ++sizes_[size];
+}
+
+template <typename Position>
+void SortedElementStats<Position>::remove_size(const Position size)
+{
+    const auto it = sizes_.find(size);
+    if (it != std::end(sizes_) && --it->second == 0) {
+        sizes_.erase(it);
+    }
+}
+
+template <typename Position>
+template <typename MappableType>
+bool SortedElementStats<Position>::are_unsorted(const MappableType& lhs, const MappableType& rhs)
+{
+    // lhs and rhs are adjacent in sorted order, so only the ends can be out of order
+    return ends_before(rhs, lhs);
+}
+
+// non-member methods
+
+template <typename Position>
+void swap(SortedElementStats<Position>& lhs, SortedElementStats<Position>& rhs) noexcept
+{
+    using std::swap;
+    swap(lhs.sizes_, rhs.sizes_);
+    swap(lhs.num_unsorted_ends_, rhs.num_unsorted_ends_);
+}
+
+} // namespace detail
+} // namespace mappable
+
+#endif
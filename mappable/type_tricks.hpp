@@ -6,6 +6,7 @@
 
 #include <type_traits>
 #include <utility>
+#include <memory>
 
 namespace mappable {
 
@@ -112,6 +113,15 @@ using enable_if_map = std::enable_if_t<is_map<T>, V>;
 template <typename T, typename V = void>
 using enable_if_not_map = std::enable_if_t<!is_map<T>, V>;
 
+template <typename Allocator, typename T>
+using RebindAlloc = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+template <typename T, typename Allocator>
+RebindAlloc<Allocator, T> rebind_alloc(const Allocator& alloc)
+{
+    return RebindAlloc<Allocator, T> {alloc};
+}
+
 template <typename Container, typename ConstIterator>
 typename Container::iterator remove_constness(Container& c, ConstIterator it)
 {
@@ -0,0 +1,137 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "mappable/contig_region.hpp"
+#include "mappable/genomic_region.hpp"
+#include "mappable/mappable_algorithms.hpp"
+#include "mappable/coverage_track.hpp"
+#include "mappable/coverage_run_iterator.hpp"
+
+namespace mappable { namespace test {
+
+using mappable::CoverageTrack;
+
+BOOST_AUTO_TEST_SUITE(coverage_track)
+
+BOOST_AUTO_TEST_CASE(track_queries_match_positional_coverage)
+{
+    std::mt19937 gen {17};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 3000}, size_dist {0, 100};
+    std::vector<ContigRegion> regions {};
+    std::generate_n(std::back_inserter(regions), 800, [&] () {
+        const auto begin = begin_dist(gen);
+        return ContigRegion {begin, begin + size_dist(gen)};
+    });
+    std::sort(std::begin(regions), std::end(regions));
+
+    const ContigRegion region {0, 3200};
+    const CoverageTrack<ContigRegion> track {std::cbegin(regions), std::cend(regions), region};
+    const auto coverage = calculate_positional_coverage(std::cbegin(regions), std::cend(regions), region);
+
+    BOOST_CHECK_EQUAL(track.region(), region);
+    BOOST_CHECK(track.num_runs() < coverage.size());
+    for (ContigRegion::Position position {0}; position < coverage.size(); ++position) {
+        BOOST_REQUIRE_EQUAL(track.depth(position), coverage[position]);
+    }
+    BOOST_CHECK_EQUAL(track.depth(5000), 0);
+
+    for (ContigRegion::Position begin {0}; begin < 3200; begin += 101) {
+        const ContigRegion query {begin, std::min(begin + 250, region.end())};
+        const auto first = std::next(std::cbegin(coverage), query.begin());
+        const auto last  = std::next(std::cbegin(coverage), query.end());
+        BOOST_REQUIRE_EQUAL(track.min_depth(query), *std::min_element(first, last));
+        BOOST_REQUIRE_EQUAL(track.max_depth(query), *std::max_element(first, last));
+        const auto mean = static_cast<double>(std::accumulate(first, last, 0u)) / region_size(query);
+        BOOST_REQUIRE_CLOSE(track.mean_depth(query), mean, 1e-6);
+        const auto runs = track.runs(query);
+        BOOST_REQUIRE(!runs.empty());
+        BOOST_REQUIRE_EQUAL(runs.front().first.begin(), query.begin());
+        BOOST_REQUIRE_EQUAL(runs.back().first.end(), query.end());
+    }
+
+    std::vector<bool> covered(coverage.size());
+    std::transform(std::cbegin(coverage), std::cend(coverage), std::begin(covered),
+                   [] (unsigned depth) { return depth >= 3; });
+    BOOST_CHECK(track.threshold(3) == select_regions(region, std::cbegin(covered), std::cend(covered)));
+}
+
+BOOST_AUTO_TEST_CASE(tracks_can_be_added)
+{
+    const std::vector<GenomicRegion> sample1 {GenomicRegion {"1", 0, 10}, GenomicRegion {"1", 5, 15}};
+    const std::vector<GenomicRegion> sample2 {GenomicRegion {"1", 10, 20}, GenomicRegion {"1", 30, 40}};
+    const CoverageTrack<GenomicRegion> track1 {std::cbegin(sample1), std::cend(sample1)};
+    const CoverageTrack<GenomicRegion> track2 {std::cbegin(sample2), std::cend(sample2)};
+
+    const auto total = track1 + track2;
+    BOOST_CHECK_EQUAL(total.region(), GenomicRegion("1", 0, 40));
+    BOOST_REQUIRE_EQUAL(total.num_runs(), 5);
+    BOOST_CHECK_EQUAL(total.run(0).second, 1);
+    BOOST_CHECK_EQUAL(total.run(1).first, GenomicRegion("1", 5, 15));
+    BOOST_CHECK_EQUAL(total.run(1).second, 2);
+    BOOST_CHECK_EQUAL(total.run(2).second, 1);
+    BOOST_CHECK_EQUAL(total.run(3).first, GenomicRegion("1", 20, 30));
+    BOOST_CHECK_EQUAL(total.run(3).second, 0);
+    BOOST_CHECK_EQUAL(total.max_depth(GenomicRegion {"1", 0, 100}), 2);
+    BOOST_CHECK_EQUAL(total.min_depth(GenomicRegion {"1", 0, 100}), 0);
+    BOOST_CHECK_EQUAL(total.max_depth(GenomicRegion {"2", 0, 100}), 0);
+    BOOST_CHECK_THROW(total.run(5), std::out_of_range);
+
+    const CoverageTrack<GenomicRegion> other_contig {GenomicRegion {"2", 0, 10}};
+    auto copy = total;
+    BOOST_CHECK_THROW(copy += other_contig, BadRegionCompare);
+
+    const auto selected = total.select_regions([] (unsigned depth) { return depth > 0; });
+    BOOST_REQUIRE_EQUAL(selected.size(), 2);
+    BOOST_CHECK_EQUAL(selected[0], GenomicRegion("1", 0, 20));
+    BOOST_CHECK_EQUAL(selected[1], GenomicRegion("1", 30, 40));
+}
+
+BOOST_AUTO_TEST_CASE(streamed_coverage_runs_match_coverage_runs)
+{
+    std::mt19937 gen {19};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 5000}, size_dist {0, 60};
+    std::vector<ContigRegion> regions {};
+    std::generate_n(std::back_inserter(regions), 300, [&] () {
+        const auto begin = begin_dist(gen);
+        return ContigRegion {begin, begin + size_dist(gen)};
+    });
+    std::sort(std::begin(regions), std::end(regions));
+
+    const auto expected = calculate_coverage_runs(regions);
+    const auto streamed = make_coverage_run_range(regions);
+    const std::vector<std::pair<ContigRegion, unsigned>> actual {std::cbegin(streamed), std::cend(streamed)};
+    BOOST_CHECK(actual == expected);
+
+    const std::vector<GenomicRegion> reads {
+        GenomicRegion {"1", 0, 10}, GenomicRegion {"1", 5, 10}, GenomicRegion {"1", 20, 20},
+        GenomicRegion {"2", 3, 3}, GenomicRegion {"3", 4, 6}
+    };
+    std::vector<std::pair<GenomicRegion, unsigned>> runs {};
+    for (const auto& run : make_coverage_run_range(std::cbegin(reads), std::cend(reads))) {
+        runs.push_back(run);
+    }
+    BOOST_REQUIRE_EQUAL(runs.size(), 4);
+    BOOST_CHECK_EQUAL(runs[0].first, GenomicRegion("1", 0, 5));
+    BOOST_CHECK_EQUAL(runs[1].first, GenomicRegion("1", 5, 10));
+    BOOST_CHECK_EQUAL(runs[1].second, 2);
+    BOOST_CHECK_EQUAL(runs[2].first, GenomicRegion("1", 10, 20));
+    BOOST_CHECK_EQUAL(runs[2].second, 0);
+    BOOST_CHECK_EQUAL(runs[3].first, GenomicRegion("3", 4, 6));
+    BOOST_CHECK_EQUAL(runs[3].second, 1);
+
+    const std::vector<ContigRegion> none {};
+    BOOST_CHECK(make_coverage_run_range(none).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace mappable
@@ -0,0 +1,119 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef MAPPABLE_INSTRUMENTATION
+#define MAPPABLE_INSTRUMENTATION
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <iterator>
+#include <sstream>
+
+#include "mappable/contig_region.hpp"
+#include "mappable/mappable_algorithms.hpp"
+#include "mappable/mappable_flat_multi_set.hpp"
+#include "mappable/instrumentation.hpp"
+
+namespace mappable { namespace test {
+
+BOOST_AUTO_TEST_SUITE(instrumentation)
+
+BOOST_AUTO_TEST_CASE(queries_count_calls_scans_and_comparisons)
+{
+    BOOST_REQUIRE(is_instrumentation_enabled());
+    reset_algorithm_stats();
+    // A long element at the front forces a ForwardSorted overlap_range to scan from the front
+    std::vector<ContigRegion> regions {ContigRegion {0, 1000}};
+    for (ContigRegion::Position begin {1}; begin < 100; ++begin) regions.emplace_back(begin * 10, begin * 10 + 5);
+    const ContigRegion query {900, 910};
+    const auto num_overlapped = count_overlapped(std::cbegin(regions), std::cend(regions), query);
+    BOOST_CHECK_EQUAL(num_overlapped, 2);
+
+    const auto overlap_stats = algorithm_stats(Algorithm::overlap_range);
+    BOOST_CHECK_EQUAL(overlap_stats.calls, 1);
+    BOOST_CHECK_EQUAL(overlap_stats.elements_scanned, 2); // {910, 915} after the search, then {0, 1000}
+    BOOST_CHECK_GT(overlap_stats.comparisons, overlap_stats.elements_scanned); // and the binary search
+    BOOST_CHECK_LE(overlap_stats.comparisons, overlap_stats.elements_scanned + 8);
+    BOOST_CHECK_EQUAL(overlap_stats.allocations, 0);
+    const auto count_stats = algorithm_stats(Algorithm::count_overlapped);
+    BOOST_CHECK_EQUAL(count_stats.calls, 1);
+    BOOST_CHECK_EQUAL(count_stats.elements_scanned, 90); // everything after {0, 1000} before {910, 915}
+    BOOST_CHECK_EQUAL(count_stats.comparisons, 90);
+
+    std::vector<ContigRegion> fixed_size {ContigRegion {0, 5}, ContigRegion {3, 8}, ContigRegion {10, 15}};
+    count_overlapped(std::cbegin(fixed_size), std::cend(fixed_size), query, FixedSizeTag {});
+    BOOST_CHECK_EQUAL(algorithm_stats(Algorithm::count_overlapped).calls, 2);
+    BOOST_CHECK_EQUAL(algorithm_stats(Algorithm::count_overlapped).elements_scanned, 90);
+    BOOST_CHECK_GT(algorithm_stats(Algorithm::count_overlapped).comparisons, 90);
+
+    reset_algorithm_stats();
+    BOOST_CHECK_EQUAL(algorithm_stats(Algorithm::overlap_range).calls, 0);
+    BOOST_CHECK_EQUAL(algorithm_stats(Algorithm::count_overlapped).comparisons, 0);
+}
+
+BOOST_AUTO_TEST_CASE(result_allocations_are_counted)
+{
+    reset_algorithm_stats();
+    const auto positions = decompose(ContigRegion {0, 10});
+    const auto decompose_stats = algorithm_stats(Algorithm::decompose);
+    BOOST_CHECK_EQUAL(decompose_stats.calls, 1);
+    BOOST_CHECK_EQUAL(decompose_stats.allocations, 1);
+    BOOST_CHECK_EQUAL(decompose_stats.bytes_allocated, positions.capacity() * sizeof(ContigRegion));
+
+    const std::vector<ContigRegion> regions {ContigRegion {0, 5}, ContigRegion {3, 8}, ContigRegion {10, 15}};
+    const auto segments = segment_overlapped_copy(regions);
+    BOOST_REQUIRE_EQUAL(segments.size(), 2);
+    // the outer vector, the two segments, and the outer vector again when it is shrunk to fit
+    BOOST_CHECK_EQUAL(algorithm_stats(Algorithm::segment).allocations, 4);
+
+    MappableFlatMultiSet<ContigRegion> set {std::cbegin(regions), std::cend(regions)};
+    set.erase_overlapped(ContigRegion {4, 5});
+    BOOST_CHECK_EQUAL(set.size(), 1);
+    BOOST_CHECK_EQUAL(algorithm_stats(Algorithm::erase_overlapped).calls, 1);
+    BOOST_CHECK_EQUAL(algorithm_stats(Algorithm::erase_overlapped).elements_scanned, 2);
+
+    const auto runs = calculate_coverage_runs(regions);
+    BOOST_REQUIRE_EQUAL(runs.size(), 5);
+    const auto runs_stats = algorithm_stats(Algorithm::calculate_coverage_runs);
+    BOOST_CHECK_EQUAL(runs_stats.elements_scanned, 3);
+    // the begins, ends, breakpoints and depths temporaries, and the result
+    BOOST_CHECK_GE(runs_stats.allocations, 5);
+    BOOST_CHECK_GE(runs_stats.bytes_allocated, runs.capacity() * sizeof(runs.front()));
+
+    std::ostringstream ss {};
+    print_algorithm_stats(ss);
+    BOOST_CHECK(ss.str().find("decompose calls=1 allocations=1") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_overloads_only_count_buffer_growth)
+{
+    reset_algorithm_stats();
+    const std::vector<ContigRegion> regions {ContigRegion {0, 5}, ContigRegion {3, 8}, ContigRegion {10, 15},
+                                             ContigRegion {20, 25}};
+    std::vector<ContigRegion> buffer {}, covered {};
+    for (int i {0}; i < 2; ++i) {
+        copy_nonoverlapped(regions, ContigRegion {4, 12}, buffer);
+        BOOST_CHECK_EQUAL(buffer.size(), 1);
+        extract_covered_regions(regions, covered);
+        BOOST_CHECK_EQUAL(covered.size(), 3);
+        extract_intervening_regions(covered, buffer);
+        BOOST_CHECK_EQUAL(buffer.size(), 2);
+    }
+    for (const auto algorithm : {Algorithm::copy_nonoverlapped, Algorithm::extract_covered_regions,
+                                 Algorithm::extract_intervening_regions}) {
+        BOOST_CHECK_EQUAL(algorithm_stats(algorithm).calls, 2);
+        BOOST_CHECK_GT(algorithm_stats(algorithm).elements_scanned, 0);
+    }
+    BOOST_CHECK_EQUAL(algorithm_stats(Algorithm::extract_covered_regions).elements_scanned, 2 * regions.size());
+    // Only the first calls grow the buffers: buffer to 1 and then 2 elements, and covered to 1, 2 and 4
+    BOOST_CHECK_EQUAL(algorithm_stats(Algorithm::copy_nonoverlapped).allocations, 1);
+    BOOST_CHECK_EQUAL(algorithm_stats(Algorithm::extract_intervening_regions).allocations, 1);
+    BOOST_CHECK_EQUAL(algorithm_stats(Algorithm::extract_covered_regions).allocations, 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace mappable
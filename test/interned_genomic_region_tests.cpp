@@ -0,0 +1,66 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef MAPPABLE_INTERNED_CONTIGS
+#define MAPPABLE_INTERNED_CONTIGS
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include <type_traits>
+#include <string>
+#include <vector>
+
+#include "mappable/contig_dictionary.hpp"
+#include "mappable/genomic_region.hpp"
+
+namespace mappable { namespace test {
+
+BOOST_AUTO_TEST_SUITE(interned_genomic_region)
+
+BOOST_AUTO_TEST_CASE(contig_names_are_interned)
+{
+    ContigDictionary dictionary {};
+    BOOST_CHECK_EQUAL(dictionary.size(), 1);
+    BOOST_CHECK_EQUAL(dictionary.intern(""), 0);
+    const auto id = dictionary.intern("chr1");
+    BOOST_CHECK_EQUAL(dictionary.intern("chr1"), id);
+    BOOST_CHECK_NE(dictionary.intern("chr2"), id);
+    BOOST_CHECK_EQUAL(dictionary.name(id), "chr1");
+    BOOST_CHECK(dictionary.find("chr1") && *dictionary.find("chr1") == id);
+    BOOST_CHECK(!dictionary.find("chr3"));
+    BOOST_CHECK_THROW(dictionary.name(10), std::out_of_range);
+    
+    std::vector<ContigDictionary::ContigId> ids {};
+    for (int i {0}; i < 1000; ++i) ids.push_back(dictionary.intern("contig" + std::to_string(i)));
+    const auto& first_name = dictionary.name(ids.front());
+    for (int i {0}; i < 1000; ++i) BOOST_REQUIRE_EQUAL(dictionary.name(ids[i]), "contig" + std::to_string(i));
+    BOOST_CHECK_EQUAL(&dictionary.name(ids.front()), &first_name);
+    BOOST_CHECK_EQUAL(dictionary.size(), 1003);
+}
+
+BOOST_AUTO_TEST_CASE(interned_regions_behave_like_named_regions)
+{
+    static_assert(std::is_trivially_copyable<GenomicRegion>::value, "interned regions should be trivially copyable");
+    static_assert(!noexcept(GenomicRegion {}.contig_name()), "interned contig_name can throw for unknown keys");
+
+    const GenomicRegion r1 {"1", 0, 10}, r2 {std::string {"1"}, 5, 15}, r3 {"2", 0, 10};
+    BOOST_CHECK_EQUAL(r1.contig_name(), "1");
+    BOOST_CHECK_EQUAL(r1.contig_key(), r2.contig_key());
+    BOOST_CHECK_EQUAL(r1.contig_key(), *ContigDictionary::global().find("1"));
+    BOOST_CHECK(is_same_contig(r1, r2));
+    BOOST_CHECK(!is_same_contig(r1, r3));
+    BOOST_CHECK(overlaps(r1, r2));
+    BOOST_CHECK(!overlaps(r1, r3));
+    BOOST_CHECK(r1 < r2);
+    BOOST_CHECK_THROW(r1 < r3, BadRegionCompare);
+    BOOST_CHECK_EQUAL(encompassing_region(r1, r2), GenomicRegion("1", 0, 15));
+    BOOST_CHECK_EQUAL(to_string(shift(r3, 5)), "2:5-15");
+    BOOST_CHECK_EQUAL(GenomicRegion {}.contig_name(), "");
+    BOOST_CHECK_EQUAL(GenomicRegion(r3.contig_key(), 1, 2), GenomicRegion("2", 1, 2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace mappable
@@ -6,16 +6,453 @@
 #include <boost/test/unit_test.hpp>
 
 #include <vector>
+#include <algorithm>
+#include <iterator>
+#include <random>
 
 #include "mappable/contig_region.hpp"
+#include "mappable/genomic_region.hpp"
 #include "mappable/mappable.hpp"
 #include "mappable/mappable_algorithms.hpp"
+#include "mappable/mappable_flat_multi_set.hpp"
 
 namespace mappable { namespace test {
 
 BOOST_AUTO_TEST_SUITE(mappable_algorithms)
 
+namespace {
 
+std::vector<ContigRegion> make_random_regions(std::size_t n, ContigRegion::Position max_begin,
+                                              ContigRegion::Position max_size, unsigned seed)
+{
+    std::mt19937 gen {seed};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, max_begin}, size_dist {0, max_size};
+    std::vector<ContigRegion> result {};
+    result.reserve(n);
+    std::generate_n(std::back_inserter(result), n, [&] () {
+        const auto begin = begin_dist(gen);
+        return ContigRegion {begin, begin + size_dist(gen)};
+    });
+    std::sort(std::begin(result), std::end(result));
+    return result;
+}
+
+template <typename Range1, typename Range2>
+bool equal_ranges(const Range1& lhs, const Range2& rhs)
+{
+    return std::equal(std::cbegin(lhs), std::cend(lhs), std::cbegin(rhs), std::cend(rhs));
+}
+
+// A monotonic arena that never frees, counting the bytes handed out
+struct Arena
+{
+    std::vector<char> buffer;
+    std::size_t used = 0;
+    explicit Arena(std::size_t bytes) : buffer(bytes) {}
+};
+
+template <typename T>
+struct ArenaAllocator
+{
+    using value_type = T;
+    Arena* arena;
+    explicit ArenaAllocator(Arena& arena) noexcept : arena {&arena} {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena {other.arena} {}
+    T* allocate(std::size_t n)
+    {
+        arena->used += (alignof(std::max_align_t) - arena->used % alignof(std::max_align_t)) % alignof(std::max_align_t);
+        if (arena->used + n * sizeof(T) > arena->buffer.size()) throw std::bad_alloc {};
+        auto result = reinterpret_cast<T*>(arena->buffer.data() + arena->used);
+        arena->used += n * sizeof(T);
+        return result;
+    }
+    void deallocate(T*, std::size_t) noexcept {}
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept { return lhs.arena == rhs.arena; }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept { return !(lhs == rhs); }
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(overlap_ranges_matches_independent_queries)
+{
+    const auto regions = make_random_regions(1000, 5000, 100, 1);
+    const auto queries = make_random_regions(300, 5200, 50, 2);
+    const auto max_size = region_size(*largest_mappable(regions));
+    
+    const auto forward = overlap_ranges(std::cbegin(regions), std::cend(regions),
+                                        std::cbegin(queries), std::cend(queries));
+    const auto bounded = overlap_ranges(std::cbegin(regions), std::cend(regions),
+                                        std::cbegin(queries), std::cend(queries), max_size);
+    const auto counts = count_overlapped_each(regions, queries);
+    const auto has = has_overlapped_each(regions, queries);
+    
+    BOOST_REQUIRE_EQUAL(forward.size(), queries.size());
+    BOOST_REQUIRE_EQUAL(bounded.size(), queries.size());
+    BOOST_REQUIRE_EQUAL(counts.size(), queries.size());
+    BOOST_REQUIRE_EQUAL(has.size(), queries.size());
+    
+    for (std::size_t i {0}; i < queries.size(); ++i) {
+        const auto expected = overlap_range(regions, queries[i]);
+        BOOST_CHECK(equal_ranges(forward[i], expected));
+        BOOST_CHECK(equal_ranges(bounded[i], expected));
+        BOOST_CHECK_EQUAL(counts[i], size(expected));
+        BOOST_CHECK_EQUAL(has[i], !expected.empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(overlap_ranges_handles_bidirectionally_sorted_ranges)
+{
+    // fixed size regions are bidirectionally sorted
+    std::vector<ContigRegion> regions {};
+    for (ContigRegion::Position begin {0}; begin < 1000; begin += 3) {
+        regions.emplace_back(begin, begin + 10);
+        if (begin % 30 == 0) regions.emplace_back(begin, begin + 10);
+    }
+    BOOST_REQUIRE(is_bidirectionally_sorted(regions));
+    
+    const auto queries = make_random_regions(200, 1100, 20, 3);
+    const auto overlapped = overlap_ranges(std::cbegin(regions), std::cend(regions),
+                                           std::cbegin(queries), std::cend(queries), BidirectionallySortedTag {});
+    const auto counts = count_overlapped_each(std::cbegin(regions), std::cend(regions),
+                                              std::cbegin(queries), std::cend(queries), BidirectionallySortedTag {});
+    
+    for (std::size_t i {0}; i < queries.size(); ++i) {
+        const auto expected = overlap_range(regions, queries[i]);
+        BOOST_CHECK(equal_ranges(overlapped[i], expected));
+        BOOST_CHECK_EQUAL(counts[i], size(expected));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fixed_size_queries_are_exact)
+{
+    const auto queries = make_random_regions(300, 1100, 20, 6);
+    for (const ContigRegion::Position element_size : {0, 1, 10}) {
+        std::vector<ContigRegion> regions {};
+        for (ContigRegion::Position begin {0}; begin < 1000; begin += 3) {
+            regions.emplace_back(begin, begin + element_size);
+            if (begin % 30 == 0) regions.emplace_back(begin, begin + element_size);
+        }
+        for (const auto& query : queries) {
+            const auto overlapped = overlap_range(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {});
+            const auto expected_overlapped = overlap_range(regions, query);
+            BOOST_CHECK(equal_ranges(overlapped, expected_overlapped));
+            BOOST_CHECK_EQUAL(size(overlapped, FixedSizeTag {}), size(expected_overlapped));
+            BOOST_CHECK_EQUAL(count_overlapped(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {}),
+                              size(expected_overlapped));
+            BOOST_CHECK_EQUAL(has_overlapped(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {}),
+                              !expected_overlapped.empty());
+            const auto contained = contained_range(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {});
+            const auto expected_contained = contained_range(regions, query);
+            BOOST_CHECK(equal_ranges(contained, expected_contained));
+            BOOST_CHECK_EQUAL(size(contained, FixedSizeTag {}), size(expected_contained));
+            BOOST_CHECK_EQUAL(count_contained(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {}),
+                              size(expected_contained));
+            BOOST_CHECK_EQUAL(has_contained(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {}),
+                              !expected_contained.empty());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fixed_size_queries_on_other_contigs_are_an_error)
+{
+    const std::vector<GenomicRegion> regions {GenomicRegion {"1", 0, 10}, GenomicRegion {"1", 20, 30}};
+    const MappableFlatMultiSet<GenomicRegion> set {std::cbegin(regions), std::cend(regions)};
+    BOOST_REQUIRE(set.fixed_size());
+    const GenomicRegion query {"2", 5, 25};
+    BOOST_CHECK_THROW(has_overlapped(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {}), BadRegionCompare);
+    BOOST_CHECK_THROW(count_overlapped(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {}), BadRegionCompare);
+    BOOST_CHECK_THROW(overlap_range(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {}), BadRegionCompare);
+    BOOST_CHECK_THROW(set.has_overlapped(query), BadRegionCompare);
+    BOOST_CHECK_THROW(set.count_overlapped(query), BadRegionCompare);
+    BOOST_CHECK_THROW(set.overlap_range(query), BadRegionCompare);
+    BOOST_CHECK_THROW(set.count_contained(query), BadRegionCompare);
+    BOOST_CHECK_EQUAL(set.count_overlapped(GenomicRegion {"1", 5, 25}), 2);
+}
+
+BOOST_AUTO_TEST_CASE(fixed_size_queries_on_ranges_spanning_contigs_are_an_error)
+{
+    // The first element is on the query contig, so only the searched elements reveal the other contig
+    const std::vector<GenomicRegion> regions {
+        GenomicRegion {"1", 0, 10}, GenomicRegion {"1", 20, 30}, GenomicRegion {"2", 0, 10}, GenomicRegion {"2", 20, 30}
+    };
+    const GenomicRegion query {"1", 5, 25};
+    BOOST_CHECK_THROW(count_overlapped(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {}), BadRegionCompare);
+    BOOST_CHECK_THROW(overlap_range(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {}), BadRegionCompare);
+    BOOST_CHECK_THROW(count_contained(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {}), BadRegionCompare);
+    BOOST_CHECK_THROW(contained_range(std::cbegin(regions), std::cend(regions), query, FixedSizeTag {}), BadRegionCompare);
+    BOOST_CHECK_EQUAL(count_overlapped(std::cbegin(regions), std::next(std::cbegin(regions), 2), query, FixedSizeTag {}), 2);
+}
+
+BOOST_AUTO_TEST_CASE(overlap_ranges_uses_container_sort_information)
+{
+    const auto regions = make_random_regions(1000, 5000, 300, 4);
+    const auto queries = make_random_regions(300, 5200, 50, 5);
+    const MappableFlatMultiSet<ContigRegion> set {std::cbegin(regions), std::cend(regions)};
+    
+    const auto overlapped = overlap_ranges(set, queries);
+    const auto has = has_overlapped_each(set, std::cbegin(queries), std::cend(queries));
+    
+    BOOST_REQUIRE_EQUAL(overlapped.size(), queries.size());
+    for (std::size_t i {0}; i < queries.size(); ++i) {
+        const auto expected = set.overlap_range(queries[i]);
+        BOOST_CHECK(equal_ranges(overlapped[i], expected));
+        BOOST_CHECK_EQUAL(has[i], !expected.empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(overlap_join_finds_all_overlapping_pairs)
+{
+    const auto regions1 = make_random_regions(500, 3000, 200, 6);
+    auto regions2 = make_random_regions(400, 3000, 20, 7);
+    regions2.emplace_back(100, 100);
+    regions2.emplace_back(0, 3000);
+    std::sort(std::begin(regions2), std::end(regions2));
+    
+    using RegionPair = std::pair<ContigRegion, ContigRegion>;
+    std::vector<RegionPair> expected {}, actual {};
+    for (const auto& lhs : regions1) {
+        for (const auto& rhs : regions2) {
+            if (overlaps(lhs, rhs)) expected.emplace_back(lhs, rhs);
+        }
+    }
+    overlap_join(regions1, regions2, [&actual] (const auto& lhs, const auto& rhs) { actual.emplace_back(lhs, rhs); });
+    
+    std::sort(std::begin(expected), std::end(expected));
+    std::sort(std::begin(actual), std::end(actual));
+    BOOST_CHECK(expected == actual);
+    
+    std::size_t num_pairs {0};
+    overlap_join(std::cbegin(regions1), std::cend(regions1), std::cend(regions2), std::cend(regions2),
+                 [&num_pairs] (const auto&, const auto&) { ++num_pairs; });
+    BOOST_CHECK_EQUAL(num_pairs, 0);
+}
+
+BOOST_AUTO_TEST_CASE(overlap_join_handles_adjacent_and_empty_regions)
+{
+    // Small regions on a short contig give many shared begins, adjacent regions and empty regions
+    const auto regions1 = make_random_regions(300, 20, 2, 8);
+    const auto regions2 = make_random_regions(300, 20, 2, 9);
+    std::size_t expected {0}, actual {0};
+    for (const auto& lhs : regions1) {
+        expected += std::count_if(std::cbegin(regions2), std::cend(regions2),
+                                  [&lhs] (const auto& rhs) { return overlaps(lhs, rhs); });
+    }
+    overlap_join(regions1, regions2, [&actual] (const auto&, const auto&) { ++actual; });
+    BOOST_CHECK_EQUAL(actual, expected);
+}
+
+BOOST_AUTO_TEST_CASE(overlap_join_handles_long_outliers_in_both_ranges)
+{
+    // Each long region stays active while the short regions it covers are swept and evicted
+    auto regions1 = make_random_regions(400, 5000, 10, 10);
+    auto regions2 = make_random_regions(40, 5000, 10, 11);
+    regions1.emplace_back(0, 5000);
+    regions1.emplace_back(2500, 2500);
+    regions2.emplace_back(10, 4000);
+    regions2.emplace_back(2500, 2500);
+    std::sort(std::begin(regions1), std::end(regions1));
+    std::sort(std::begin(regions2), std::end(regions2));
+    std::size_t expected {0}, actual {0};
+    for (const auto& lhs : regions1) {
+        expected += std::count_if(std::cbegin(regions2), std::cend(regions2),
+                                  [&lhs] (const auto& rhs) { return overlaps(lhs, rhs); });
+    }
+    overlap_join(regions1, regions2, [&actual] (const auto&, const auto&) { ++actual; });
+    BOOST_CHECK_EQUAL(actual, expected);
+    actual = 0;
+    overlap_join(regions2, regions1, [&actual] (const auto&, const auto&) { ++actual; });
+    BOOST_CHECK_EQUAL(actual, expected);
+}
+
+BOOST_AUTO_TEST_CASE(positional_coverage_matches_naive_counts)
+{
+    const auto regions = make_random_regions(500, 2000, 150, 8);
+    const ContigRegion region {100, 1900};
+    
+    const auto coverage = calculate_positional_coverage(regions, region);
+    BOOST_REQUIRE_EQUAL(coverage.size(), region_size(region));
+    for (auto position = region.begin(); position < region.end(); ++position) {
+        const auto expected = std::count_if(std::cbegin(regions), std::cend(regions), [position] (const auto& r) {
+            return r.begin() <= position && position < r.end();
+        });
+        BOOST_REQUIRE_EQUAL(coverage[position - region.begin()], expected);
+    }
+    
+    const auto runs = calculate_coverage_runs(regions, region);
+    BOOST_REQUIRE(!runs.empty());
+    BOOST_CHECK_EQUAL(runs.front().first.begin(), region.begin());
+    BOOST_CHECK_EQUAL(runs.back().first.end(), region.end());
+    for (std::size_t i {0}; i < runs.size(); ++i) {
+        if (i > 0) {
+            BOOST_REQUIRE_EQUAL(runs[i - 1].first.end(), runs[i].first.begin());
+            BOOST_REQUIRE_NE(runs[i - 1].second, runs[i].second);
+        }
+        for (auto position = runs[i].first.begin(); position < runs[i].first.end(); ++position) {
+            BOOST_REQUIRE_EQUAL(coverage[position - region.begin()], runs[i].second);
+        }
+    }
+    
+    BOOST_CHECK_EQUAL(min_coverage(regions, region), *std::min_element(std::cbegin(coverage), std::cend(coverage)));
+    BOOST_CHECK_EQUAL(max_coverage(regions, region), *std::max_element(std::cbegin(coverage), std::cend(coverage)));
+    BOOST_CHECK_EQUAL(min_coverage(regions, ContigRegion {5000, 5010}), 0);
+    
+    const std::vector<GenomicRegion> reads {GenomicRegion {"1", 0, 10}, GenomicRegion {"1", 5, 10}, GenomicRegion {"1", 20, 30}};
+    const auto read_runs = calculate_coverage_runs(reads);
+    BOOST_REQUIRE_EQUAL(read_runs.size(), 4);
+    BOOST_CHECK_EQUAL(read_runs[1].first, GenomicRegion("1", 5, 10));
+    BOOST_CHECK_EQUAL(read_runs[1].second, 2);
+    BOOST_CHECK_EQUAL(read_runs[2].second, 0);
+    BOOST_CHECK_EQUAL(max_coverage(reads), 2);
+    BOOST_CHECK_EQUAL(min_coverage(reads), 0);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_overloads_match_copying_algorithms)
+{
+    const auto regions = make_random_regions(500, 3000, 100, 9);
+    const std::vector<ContigRegion> disjoint {ContigRegion {0, 5}, ContigRegion {10, 20}, ContigRegion {30, 40}};
+    const std::vector<GenomicRegion> reads {GenomicRegion {"1", 0, 10}, GenomicRegion {"1", 12, 20}, GenomicRegion {"1", 40, 50}};
+
+    std::vector<ContigRegion> buffer {}, output {};
+    buffer.reserve(regions.size());
+    const auto capacity = buffer.capacity();
+    for (const ContigRegion query : {ContigRegion {100, 400}, ContigRegion {2500, 2600}, ContigRegion {5000, 5100}}) {
+        copy_overlapped(regions, query, buffer);
+        BOOST_CHECK(buffer == copy_overlapped(regions, query));
+        output.clear();
+        copy_overlapped(std::cbegin(regions), std::cend(regions), query, std::back_inserter(output));
+        BOOST_CHECK(output == buffer);
+
+        copy_contained(regions, query, buffer);
+        BOOST_CHECK(buffer == copy_contained(regions, query));
+        output.clear();
+        copy_contained(std::cbegin(regions), std::cend(regions), query, std::back_inserter(output));
+        BOOST_CHECK(output == buffer);
+
+        copy_nonoverlapped(regions, query, buffer);
+        std::vector<ContigRegion> expected {};
+        std::remove_copy_if(std::cbegin(regions), std::cend(regions), std::back_inserter(expected),
+                            [&query] (const auto& region) { return overlaps(region, query); });
+        BOOST_CHECK(buffer == expected);
+        BOOST_CHECK_EQUAL(buffer.capacity(), capacity);
+    }
+
+    extract_regions(regions, buffer);
+    BOOST_CHECK(buffer == regions);
+    extract_covered_regions(regions, buffer);
+    BOOST_CHECK(buffer == extract_covered_regions(regions));
+    output.clear();
+    extract_covered_regions(std::cbegin(regions), std::cend(regions), std::back_inserter(output));
+    BOOST_CHECK(output == buffer);
+    BOOST_CHECK_EQUAL(buffer.capacity(), capacity);
+
+    extract_intervening_regions(disjoint, buffer);
+    BOOST_CHECK(buffer == extract_intervening_regions(disjoint));
+    extract_intervening_regions(disjoint, ContigRegion {0, 50}, buffer);
+    BOOST_CHECK(buffer == extract_intervening_regions(disjoint, ContigRegion {0, 50}));
+    BOOST_CHECK_EQUAL(buffer.size(), 3);
+
+    std::vector<GenomicRegion> joined {};
+    join_if(reads, [] (const auto& lhs, const auto& rhs) { return inner_distance(lhs, rhs) <= 5; }, joined);
+    BOOST_CHECK(joined == join(reads, 5));
+    BOOST_REQUIRE_EQUAL(joined.size(), 2);
+    BOOST_CHECK_EQUAL(joined.front(), GenomicRegion("1", 0, 20));
+}
+
+template <typename Iterator, typename Segments>
+void check_segmentation(const Segmentation<Iterator>& segmentation, const Segments& expected, const Iterator first)
+{
+    BOOST_REQUIRE_EQUAL(segmentation.size(), expected.size());
+    BOOST_CHECK(segmentation.base_begin() == first);
+    std::size_t i {0};
+    for (const auto& segment : segmentation) {
+        BOOST_REQUIRE(equal_ranges(segment, expected[i]));
+        BOOST_CHECK(equal_ranges(segmentation[i], expected[i]));
+        ++i;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(segmentation_views_match_copied_segments)
+{
+    auto regions = make_random_regions(1000, 5000, 30, 11);
+    const auto duplicates = make_random_regions(200, 5000, 30, 11);
+    regions.insert(std::cend(regions), std::cbegin(duplicates), std::cend(duplicates));
+    std::sort(std::begin(regions), std::end(regions));
+    
+    const auto first = std::cbegin(regions);
+    check_segmentation(segment_overlapped(regions), segment_overlapped_copy(regions), first);
+    check_segmentation(segment_by_begin(regions), segment_by_begin_copy(regions), first);
+    check_segmentation(segment_by_end(regions), segment_by_end_copy(regions), first);
+    check_segmentation(segment_by_region(regions), segment_by_region_copy(regions), first);
+    
+    const auto segments = segment_overlapped(regions);
+    BOOST_CHECK_EQUAL(segments.boundaries().front(), 0);
+    BOOST_CHECK_EQUAL(segments.boundaries().back(), regions.size());
+    BOOST_CHECK(segments.base_end() == std::cend(regions));
+    BOOST_CHECK(all_segment_regions(segments) == all_segment_regions(segment_overlapped_copy(regions)));
+    for (std::size_t i {1}; i < segments.size(); ++i) {
+        BOOST_CHECK(!overlaps(encompassing_region(segments[i - 1]), segments[i].front()));
+    }
+    
+    const std::vector<ContigRegion> empty {};
+    BOOST_CHECK(segment_overlapped(empty).empty());
+    BOOST_CHECK(segment_overlapped(empty).begin() == segment_overlapped(empty).end());
+}
+
+BOOST_AUTO_TEST_CASE(allocator_extended_overloads_allocate_from_the_given_allocator)
+{
+    const auto regions = make_random_regions(300, 2000, 50, 10);
+    const ContigRegion region {100, 1900};
+    Arena arena {1 << 22};
+    const ArenaAllocator<char> alloc {arena};
+
+    const auto segments = segment_overlapped_copy(std::allocator_arg, alloc, regions);
+    const auto expected_segments = segment_overlapped_copy(regions);
+    BOOST_REQUIRE_EQUAL(segments.size(), expected_segments.size());
+    for (std::size_t i {0}; i < segments.size(); ++i) {
+        BOOST_CHECK(equal_ranges(segments[i], expected_segments[i]));
+        BOOST_CHECK(segments[i].get_allocator() == alloc);
+    }
+    BOOST_CHECK_EQUAL(segment_by_begin_copy(std::allocator_arg, alloc, regions).size(), segment_by_begin_copy(regions).size());
+    BOOST_CHECK_EQUAL(segment_by_region_copy(std::allocator_arg, alloc, regions).size(), segment_by_region_copy(regions).size());
+    
+    const auto used = arena.used;
+    BOOST_CHECK(used > 0);
+    BOOST_CHECK(equal_ranges(calculate_positional_coverage(std::allocator_arg, alloc, regions, region),
+                             calculate_positional_coverage(regions, region)));
+    BOOST_CHECK(equal_ranges(calculate_coverage_runs(std::allocator_arg, alloc, regions, region),
+                             calculate_coverage_runs(regions, region)));
+    BOOST_CHECK(equal_ranges(extract_covered_regions(std::allocator_arg, alloc, regions), extract_covered_regions(regions)));
+    BOOST_CHECK(equal_ranges(extract_regions(std::allocator_arg, alloc, regions), regions));
+    const GenomicRegion genomic_region {"1", 100, 1900};
+    BOOST_CHECK(equal_ranges(decompose(std::allocator_arg, alloc, genomic_region, 10), decompose(genomic_region, 10)));
+    std::vector<bool> selections(size(region));
+    for (std::size_t i {0}; i < selections.size(); ++i) selections[i] = (i / 7) % 3 == 0;
+    const auto selected = select_regions(std::allocator_arg, alloc, region, selections);
+    BOOST_CHECK(selected.get_allocator() == alloc);
+    BOOST_CHECK(equal_ranges(selected, select_regions(region, selections)));
+    const auto coverage = calculate_positional_coverage(regions, region);
+    const auto is_covered = [] (const unsigned depth) { return depth > 0; };
+    BOOST_CHECK(equal_ranges(select_regions(std::allocator_arg, alloc, region, coverage, is_covered),
+                             select_regions(region, coverage, is_covered)));
+    BOOST_CHECK(equal_ranges(select_regions(std::allocator_arg, alloc, region, std::cbegin(coverage), std::cend(coverage), is_covered),
+                             select_regions(region, std::cbegin(coverage), std::cend(coverage), is_covered)));
+    const auto covered = extract_covered_regions(regions);
+    const auto intervening = extract_intervening_regions(std::allocator_arg, alloc, covered, ContigRegion {0, 2100});
+    BOOST_CHECK(intervening.get_allocator() == alloc);
+    BOOST_CHECK(equal_ranges(intervening, extract_intervening_regions(covered, ContigRegion {0, 2100})));
+    BOOST_CHECK(equal_ranges(extract_intervening_regions(std::allocator_arg, alloc, std::cbegin(covered), std::cend(covered), region),
+                             extract_intervening_regions(std::cbegin(covered), std::cend(covered), region)));
+    BOOST_CHECK(arena.used > used);
+    
+    using ArenaFlatSet = MappableFlatMultiSet<ContigRegion, ArenaAllocator<ContigRegion>>;
+    const ArenaFlatSet set {std::cbegin(regions), std::cend(regions), ArenaAllocator<ContigRegion> {arena}};
+    BOOST_CHECK(set.get_allocator() == alloc);
+    BOOST_CHECK(equal_ranges(set, regions));
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 
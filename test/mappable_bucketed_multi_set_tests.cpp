@@ -0,0 +1,128 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <random>
+#include <memory>
+#include <cstddef>
+
+#include "mappable/contig_region.hpp"
+#include "mappable/mappable_algorithms.hpp"
+#include "mappable/mappable_bucketed_multi_set.hpp"
+
+#include "test_allocators.hpp"
+
+namespace mappable { namespace test {
+
+using mappable::MappableBucketedMultiSet;
+
+BOOST_AUTO_TEST_SUITE(mappable_bucketed_multi_set)
+
+BOOST_AUTO_TEST_CASE(elements_are_bucketed_by_power_of_two_size)
+{
+    using Set = MappableBucketedMultiSet<ContigRegion>;
+    
+    BOOST_CHECK_EQUAL(Set::bucket_index(0), 0);
+    BOOST_CHECK_EQUAL(Set::bucket_index(1), 1);
+    BOOST_CHECK_EQUAL(Set::bucket_index(2), 2);
+    BOOST_CHECK_EQUAL(Set::bucket_index(3), 2);
+    BOOST_CHECK_EQUAL(Set::bucket_index(150), 8);
+    BOOST_CHECK_EQUAL(Set::bucket_index(1000000), 20);
+    
+    Set set {ContigRegion {0, 0}, ContigRegion {10, 160}, ContigRegion {20, 170}, ContigRegion {0, 1000000}};
+    
+    BOOST_CHECK_EQUAL(set.size(), 4);
+    BOOST_REQUIRE_EQUAL(set.bucket_count(), 21);
+    BOOST_CHECK_EQUAL(set.bucket(0).size(), 1);
+    BOOST_CHECK_EQUAL(set.bucket(8).size(), 2);
+    BOOST_CHECK_EQUAL(set.bucket(20).size(), 1);
+    BOOST_CHECK_THROW(set.bucket(21), std::out_of_range);
+    
+    BOOST_CHECK_EQUAL(set.erase(ContigRegion {10, 160}), 1);
+    BOOST_CHECK_EQUAL(set.erase(ContigRegion {10, 160}), 0);
+    BOOST_CHECK_EQUAL(set.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(queries_match_the_unbucketed_algorithms)
+{
+    std::mt19937 gen {7};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 10000}, size_dist {100, 150};
+    
+    std::vector<ContigRegion> regions {};
+    for (int i {0}; i < 2000; ++i) {
+        const auto begin = begin_dist(gen);
+        regions.emplace_back(begin, begin + (i % 500 == 0 ? 5000 : size_dist(gen)));
+    }
+    
+    MappableBucketedMultiSet<ContigRegion> set {std::cbegin(regions), std::cend(regions)};
+    std::sort(std::begin(regions), std::end(regions));
+    
+    BOOST_REQUIRE_EQUAL(set.size(), regions.size());
+    
+    for (ContigRegion::Position begin {0}; begin < 11000; begin += 97) {
+        for (ContigRegion::Position size : {0, 10, 200, 3000}) {
+            const ContigRegion query {begin, begin + size};
+            const auto overlapped = overlap_range(regions, query);
+            const auto contained = contained_range(regions, query);
+            const std::vector<ContigRegion> expected_overlapped {std::cbegin(overlapped), std::cend(overlapped)};
+            const std::vector<ContigRegion> expected_contained {std::cbegin(contained), std::cend(contained)};
+            BOOST_REQUIRE(set.copy_overlapped(query) == expected_overlapped);
+            BOOST_REQUIRE_EQUAL(set.count_overlapped(query), expected_overlapped.size());
+            BOOST_REQUIRE_EQUAL(set.has_overlapped(query), !expected_overlapped.empty());
+            BOOST_REQUIRE(set.copy_contained(query) == expected_contained);
+            BOOST_REQUIRE_EQUAL(set.count_contained(query), expected_contained.size());
+            BOOST_REQUIRE_EQUAL(set.has_contained(query), !expected_contained.empty());
+        }
+    }
+    
+    const ContigRegion erased {4000, 6000};
+    const auto num_overlapped = set.count_overlapped(erased);
+    set.erase_overlapped(erased);
+    BOOST_CHECK_EQUAL(set.size(), regions.size() - num_overlapped);
+    BOOST_CHECK(!set.has_overlapped(erased));
+}
+
+BOOST_AUTO_TEST_CASE(iteration_visits_buckets_in_order)
+{
+    MappableBucketedMultiSet<ContigRegion> set {};
+    BOOST_CHECK(set.begin() == set.end());
+    set.insert(ContigRegion {0, 1000});
+    set.insert(ContigRegion {50, 51});
+    set.insert(ContigRegion {5, 5});
+    set.insert(ContigRegion {10, 11});
+    set.insert(ContigRegion {20, 300});
+    const std::vector<ContigRegion> expected {
+        ContigRegion {5, 5}, ContigRegion {10, 11}, ContigRegion {50, 51}, ContigRegion {20, 300}, ContigRegion {0, 1000}
+    };
+    const std::vector<ContigRegion> actual {std::cbegin(set), std::cend(set)};
+    BOOST_CHECK(actual == expected);
+    BOOST_CHECK_EQUAL(std::distance(std::cbegin(set), std::cend(set)), set.size());
+    set.erase(ContigRegion {5, 5});
+    BOOST_CHECK_EQUAL(*set.begin(), (ContigRegion {10, 11}));
+}
+
+BOOST_AUTO_TEST_CASE(buckets_use_the_given_allocator)
+{
+    std::size_t num_allocations {0};
+    const AllocationCounter<ContigRegion> alloc {num_allocations};
+    using Set = MappableBucketedMultiSet<ContigRegion, AllocationCounter<ContigRegion>>;
+    const std::vector<ContigRegion> regions {ContigRegion {0, 1}, ContigRegion {0, 100}, ContigRegion {10, 11}};
+    Set set {std::cbegin(regions), std::cend(regions), alloc};
+    BOOST_CHECK(set.get_allocator() == alloc);
+    BOOST_CHECK(set.bucket(1).get_allocator() == alloc);
+    BOOST_CHECK(set.bucket(7).get_allocator() == alloc);
+    BOOST_CHECK_GT(num_allocations, 0);
+    const auto num_range_allocations = num_allocations;
+    set.insert(ContigRegion {0, 10000});
+    BOOST_CHECK_GT(num_allocations, num_range_allocations);
+    BOOST_CHECK_EQUAL(std::distance(std::cbegin(set), std::cend(set)), 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace mappable
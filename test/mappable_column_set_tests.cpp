@@ -0,0 +1,164 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <random>
+#include <limits>
+
+#include "mappable/contig_region.hpp"
+#include "mappable/genomic_region.hpp"
+#include "mappable/mappable_algorithms.hpp"
+#include "mappable/mappable_column_set.hpp"
+#include "mappable/packed_scan.hpp"
+
+namespace mappable { namespace test {
+
+using mappable::MappableColumnSet;
+
+BOOST_AUTO_TEST_SUITE(mappable_column_set)
+
+BOOST_AUTO_TEST_CASE(columns_track_the_elements)
+{
+    MappableColumnSet<ContigRegion> set {ContigRegion {5, 10}, ContigRegion {0, 3}, ContigRegion {5, 10}};
+
+    BOOST_REQUIRE_EQUAL(set.size(), 2);
+    BOOST_CHECK(set.bidirectionally_sorted());
+    BOOST_CHECK(set.insert(ContigRegion {1, 20}).second);
+    BOOST_CHECK(!set.insert(ContigRegion {1, 20}).second);
+    BOOST_CHECK(!set.bidirectionally_sorted());
+    BOOST_CHECK_EQUAL(set.max_element_size(), 19);
+    BOOST_CHECK(set.begin_column() == std::vector<std::uint32_t>({0, 1, 5}));
+    BOOST_CHECK(set.end_column() == std::vector<std::uint32_t>({3, 20, 10}));
+    BOOST_CHECK_EQUAL(set.rightmost(), ContigRegion(1, 20));
+
+    BOOST_CHECK_EQUAL(set.erase(ContigRegion {1, 20}), 1);
+    BOOST_CHECK(set.bidirectionally_sorted());
+    BOOST_CHECK_EQUAL(set.max_element_size(), 5);
+    BOOST_CHECK(set.begin_column() == std::vector<std::uint32_t>({0, 5}));
+
+    const auto too_large = static_cast<ContigRegion::Position>(std::numeric_limits<std::uint32_t>::max()) + 1;
+    BOOST_CHECK_THROW(set.insert(ContigRegion {0, too_large}), std::out_of_range);
+    BOOST_CHECK_EQUAL(set.size(), 2);
+    const std::vector<ContigRegion> batch {ContigRegion {2, 4}, ContigRegion {0, too_large}};
+    BOOST_CHECK_THROW(set.insert(std::cbegin(batch), std::cend(batch)), std::out_of_range);
+    BOOST_CHECK_EQUAL(set.size(), 2);
+    BOOST_CHECK(set.begin_column() == std::vector<std::uint32_t>({0, 5}));
+    set.insert(std::cbegin(batch), std::prev(std::cend(batch)));
+    BOOST_CHECK(set.begin_column() == std::vector<std::uint32_t>({0, 2, 5}));
+    BOOST_CHECK(set.end_column() == std::vector<std::uint32_t>({3, 4, 10}));
+}
+
+BOOST_AUTO_TEST_CASE(queries_match_the_row_algorithms)
+{
+    std::mt19937 gen {11};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 10000}, size_dist {0, 150};
+
+    std::vector<ContigRegion> regions {};
+    for (int i {0}; i < 2000; ++i) {
+        const auto begin = begin_dist(gen);
+        regions.emplace_back(begin, begin + (i % 500 == 0 ? 3000 : size_dist(gen)));
+    }
+
+    MappableColumnSet<ContigRegion> set {std::cbegin(regions), std::cend(regions)};
+    std::sort(std::begin(regions), std::end(regions));
+    regions.erase(std::unique(std::begin(regions), std::end(regions)), std::end(regions));
+
+    BOOST_REQUIRE(std::equal(std::cbegin(set), std::cend(set), std::cbegin(regions), std::cend(regions)));
+
+    for (ContigRegion::Position begin {0}; begin < 11000; begin += 89) {
+        for (ContigRegion::Position query_size : {0, 1, 50, 2000}) {
+            const ContigRegion query {begin, begin + query_size};
+            const auto overlapped = overlap_range(regions, query);
+            const auto contained = contained_range(regions, query);
+            const auto set_overlapped = set.overlap_range(query);
+            const auto set_contained = set.contained_range(query);
+            BOOST_REQUIRE(std::equal(std::cbegin(set_overlapped), std::cend(set_overlapped),
+                                     std::cbegin(overlapped), std::cend(overlapped)));
+            BOOST_REQUIRE(std::equal(std::cbegin(set_contained), std::cend(set_contained),
+                                     std::cbegin(contained), std::cend(contained)));
+            BOOST_REQUIRE_EQUAL(set.count_overlapped(query), size(overlapped));
+            BOOST_REQUIRE_EQUAL(set.has_overlapped(query), !overlapped.empty());
+            BOOST_REQUIRE_EQUAL(set.count_contained(query), size(contained));
+            BOOST_REQUIRE_EQUAL(set.has_contained(query), !contained.empty());
+        }
+    }
+
+    const ContigRegion erased {4000, 6000};
+    const auto num_overlapped = set.count_overlapped(erased);
+    set.erase_overlapped(erased);
+    BOOST_CHECK_EQUAL(set.size(), regions.size() - num_overlapped);
+    BOOST_CHECK(!set.has_overlapped(erased));
+    BOOST_CHECK(set.begin_column().size() == set.size() && set.end_column().size() == set.size());
+}
+
+BOOST_AUTO_TEST_CASE(queries_on_other_contigs_find_nothing)
+{
+    const MappableColumnSet<GenomicRegion> set {GenomicRegion {"1", 0, 10}, GenomicRegion {"1", 5, 20}};
+
+    BOOST_CHECK_EQUAL(set.count_overlapped(GenomicRegion {"1", 8, 9}), 2);
+    BOOST_CHECK_EQUAL(set.count_contained(GenomicRegion {"1", 0, 15}), 1);
+    BOOST_CHECK(!set.has_overlapped(GenomicRegion {"2", 8, 9}));
+    BOOST_CHECK(set.overlap_range(GenomicRegion {"2", 8, 9}).empty());
+    BOOST_CHECK_EQUAL(set.count_contained(GenomicRegion {"2", 0, 100}), 0);
+}
+
+BOOST_AUTO_TEST_CASE(packed_scans_agree_at_every_simd_level)
+{
+    using detail::PackedPredicate;
+    using detail::SimdLevel;
+
+    std::mt19937 gen {13};
+    std::uniform_int_distribution<std::uint32_t> begin_dist {0, 1000}, size_dist {0, 30};
+    std::vector<std::uint32_t> begins(203), ends(203);
+    for (std::size_t i {0}; i < begins.size(); ++i) {
+        begins[i] = begin_dist(gen);
+        ends[i] = begins[i] + size_dist(gen);
+    }
+    // Extreme positions must not be confused by signed comparisons
+    begins[7] = 0x80000000u; ends[7] = 0xffffffffu;
+
+    const auto levels = {SimdLevel::scalar, SimdLevel::sse41, SimdLevel::avx2};
+
+    for (std::uint32_t query_begin {0}; query_begin < 1100; query_begin += 37) {
+        for (std::uint32_t query_size : {0, 1, 20, 300}) {
+            const auto query_end = query_begin + query_size;
+            const ContigRegion query {query_begin, query_end};
+            std::size_t num_overlapped {0}, num_contained {0}, num_spanning {0};
+            for (std::size_t i {0}; i < begins.size(); ++i) {
+                const ContigRegion region {begins[i], ends[i]};
+                num_overlapped += overlaps(region, query);
+                num_contained  += contains(query, region);
+                num_spanning   += contains(region, query);
+            }
+            BOOST_REQUIRE_EQUAL(count_overlapped_packed(begins.data(), ends.data(), begins.size(), query_begin, query_end), num_overlapped);
+            BOOST_REQUIRE_EQUAL(count_contained_packed(begins.data(), ends.data(), begins.size(), query_begin, query_end), num_contained);
+            BOOST_REQUIRE_EQUAL(count_spanning_packed(begins.data(), ends.data(), begins.size(), query_begin, query_end), num_spanning);
+            for (const auto level : levels) {
+                if (level > detail::host_simd_level()) continue;
+                BOOST_REQUIRE_EQUAL((detail::packed_scan<PackedPredicate::overlaps>(begins.data(), ends.data(), begins.size(),
+                                                                                    query_begin, query_end, level)),
+                                    num_overlapped);
+                BOOST_REQUIRE_EQUAL((detail::packed_scan<PackedPredicate::contained>(begins.data(), ends.data(), begins.size(),
+                                                                                     query_begin, query_end, level)),
+                                    num_contained);
+                BOOST_REQUIRE_EQUAL((detail::packed_scan<PackedPredicate::spans>(begins.data(), ends.data(), begins.size(),
+                                                                                 query_begin, query_end, level)),
+                                    num_spanning);
+            }
+        }
+    }
+
+    const MappableColumnSet<ContigRegion> set {ContigRegion {0, 10}, ContigRegion {2, 4}, ContigRegion {3, 30}};
+    BOOST_CHECK_EQUAL(set.count_spanning(ContigRegion {3, 4}), 3);
+    BOOST_CHECK_EQUAL(set.count_spanning(ContigRegion {5, 5}), 2);
+    BOOST_CHECK_EQUAL(set.count_spanning(ContigRegion {9, 11}), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace mappable
@@ -6,14 +6,54 @@
 #include <vector>
 #include <iterator>
 #include <algorithm>
+#include <random>
+#include <memory>
+#include <cstddef>
+#include <thread>
 
 #include "mappable/contig_region.hpp"
 #include "mappable/mappable_flat_set.hpp"
+#include "mappable/mappable_flat_multi_set.hpp"
 
 namespace mappable { namespace test {
 
 using mappable::MappableFlatSet;
 
+namespace {
+
+struct AllocationTracker
+{
+    std::size_t live = 0, peak = 0;
+};
+
+// Records the peak number of bytes live at once
+template <typename T>
+struct TrackingAllocator
+{
+    using value_type = T;
+    AllocationTracker* tracker;
+    explicit TrackingAllocator(AllocationTracker& t) noexcept : tracker {&t} {}
+    template <typename U> TrackingAllocator(const TrackingAllocator<U>& other) noexcept : tracker {other.tracker} {}
+    T* allocate(std::size_t n)
+    {
+        tracker->live += n * sizeof(T);
+        tracker->peak = std::max(tracker->peak, tracker->live);
+        return std::allocator<T> {}.allocate(n);
+    }
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        tracker->live -= n * sizeof(T);
+        std::allocator<T> {}.deallocate(p, n);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const TrackingAllocator<T>& lhs, const TrackingAllocator<U>& rhs) noexcept { return lhs.tracker == rhs.tracker; }
+template <typename T, typename U>
+bool operator!=(const TrackingAllocator<T>& lhs, const TrackingAllocator<U>& rhs) noexcept { return !(lhs == rhs); }
+
+} // namespace
+
 BOOST_AUTO_TEST_SUITE(mappable_flat_set)
 
 BOOST_AUTO_TEST_CASE(emplace_works)
@@ -290,6 +330,283 @@ BOOST_AUTO_TEST_CASE(erase_all_only_erases_given_elements_and_maintains_order)
     BOOST_CHECK(std::is_sorted(std::cbegin(set), std::cend(set)));
 }
 
+BOOST_AUTO_TEST_CASE(overlap_index_gives_same_results_as_unindexed_queries)
+{
+    std::mt19937 gen {42};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 1000}, size_dist {0, 20};
+    
+    MappableFlatSet<ContigRegion> unindexed {}, indexed {};
+    indexed.build_overlap_index();
+    BOOST_REQUIRE(indexed.has_overlap_index());
+    
+    const auto check_queries = [&] () {
+        for (ContigRegion::Position begin {0}; begin < 1100; begin += 7) {
+            for (ContigRegion::Position size : {0, 1, 5, 50, 600}) {
+                const ContigRegion query {begin, begin + size};
+                const auto expected = unindexed.overlap_range(query);
+                const auto actual = indexed.overlap_range(query);
+                BOOST_REQUIRE(std::equal(std::cbegin(expected), std::cend(expected),
+                                         std::cbegin(actual), std::cend(actual)));
+                BOOST_REQUIRE(std::equal(crbegin(expected), crend(expected), crbegin(actual), crend(actual)));
+                if (indexed.has_overlap_index()) {
+                    const auto stepped = indexed.indexed_overlap_range(query);
+                    BOOST_REQUIRE(std::equal(std::cbegin(expected), std::cend(expected),
+                                             std::cbegin(stepped), std::cend(stepped)));
+                }
+                const auto materialised = indexed.materialise_overlapped(query);
+                BOOST_REQUIRE(std::equal(std::cbegin(expected), std::cend(expected),
+                                         std::cbegin(materialised), std::cend(materialised)));
+                BOOST_REQUIRE_EQUAL(materialised.size(), indexed.count_overlapped(query));
+                BOOST_REQUIRE_EQUAL(indexed.count_overlapped(query), unindexed.count_overlapped(query));
+                BOOST_REQUIRE_EQUAL(indexed.has_overlapped(query), unindexed.has_overlapped(query));
+            }
+        }
+    };
+    
+    for (int i {0}; i < 500; ++i) {
+        const auto begin = begin_dist(gen);
+        // a few large elements make the set far from bidirectionally sorted
+        const auto size = i % 50 == 0 ? 10 * size_dist(gen) : size_dist(gen);
+        unindexed.emplace(begin, begin + size);
+        indexed.emplace(begin, begin + size);
+    }
+    check_queries();
+    
+    for (int i {0}; i < 100; ++i) {
+        const auto it = std::next(std::cbegin(unindexed), i);
+        indexed.erase(*it);
+        unindexed.erase(it);
+    }
+    check_queries();
+    
+    indexed.erase_overlapped(ContigRegion {200, 300});
+    unindexed.erase_overlapped(ContigRegion {200, 300});
+    check_queries();
+    
+    indexed.clear_overlap_index();
+    BOOST_CHECK(!indexed.has_overlap_index());
+    check_queries();
+}
+
+BOOST_AUTO_TEST_CASE(indexed_queries_on_a_const_set_can_run_concurrently)
+{
+    std::vector<ContigRegion> regions {};
+    for (ContigRegion::Position begin {0}; begin < 2000; ++begin) {
+        regions.emplace_back(begin, begin + (begin % 100 == 0 ? 500 : begin % 7));
+    }
+    MappableFlatSet<ContigRegion> set {std::cbegin(regions), std::cend(regions)};
+    set.build_overlap_index();
+    // The modifications rebuild the index, so the queries below only read
+    set.erase(ContigRegion {1000, 1500});
+    set.insert(ContigRegion {10, 1900});
+    const auto& shared = set;
+    const auto count_all = [&shared] () {
+        std::size_t result {0};
+        for (ContigRegion::Position begin {0}; begin < 2000; begin += 13) {
+            result += shared.count_overlapped(ContigRegion {begin, begin + 20});
+        }
+        return result;
+    };
+    const auto expected = count_all();
+    std::vector<std::size_t> actual(4);
+    std::vector<std::thread> threads {};
+    for (std::size_t i {0}; i < actual.size(); ++i) {
+        threads.emplace_back([&actual, &count_all, i] () { actual[i] = count_all(); });
+    }
+    for (auto& thread : threads) thread.join();
+    for (const auto count : actual) BOOST_CHECK_EQUAL(count, expected);
+}
+
+BOOST_AUTO_TEST_CASE(indexed_overlap_range_steps_between_overlapped_elements)
+{
+    MappableFlatSet<ContigRegion> set {};
+    set.emplace(0, 100000);
+    for (ContigRegion::Position begin {1}; begin < 10000; ++begin) {
+        set.emplace(begin, begin + 10);
+    }
+    set.build_overlap_index();
+    const auto bounded = set.overlap_range(ContigRegion {9000, 9001});
+    BOOST_CHECK(bounded.begin().base() == std::cbegin(set));
+    BOOST_CHECK(*std::prev(bounded.end().base()) == (ContigRegion {9000, 9010}));
+    const auto overlapped = set.indexed_overlap_range(ContigRegion {9000, 9001});
+    BOOST_CHECK(*overlapped.begin() == (ContigRegion {0, 100000}));
+    BOOST_CHECK(*std::next(overlapped.begin()) == (ContigRegion {8991, 9001}));
+    BOOST_CHECK(*std::prev(std::next(overlapped.begin())) == (ContigRegion {0, 100000}));
+    BOOST_CHECK(*std::prev(overlapped.end()) == (ContigRegion {9000, 9010}));
+    BOOST_CHECK_EQUAL(size(overlapped), 11);
+    const auto materialised = materialise(overlapped);
+    BOOST_CHECK_EQUAL(materialised.size(), 11);
+    BOOST_CHECK(std::equal(std::cbegin(materialised), std::cend(materialised),
+                           std::cbegin(overlapped), std::cend(overlapped)));
+}
+
+BOOST_AUTO_TEST_CASE(parallel_construction_matches_serial_construction)
+{
+    std::mt19937 gen {7};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 100000}, size_dist {0, 100};
+    
+    std::vector<ContigRegion> regions {};
+    for (int i {0}; i < 100000; ++i) {
+        const auto begin = begin_dist(gen);
+        regions.emplace_back(begin, begin + size_dist(gen));
+    }
+    
+    const MappableFlatSet<ContigRegion> serial {std::cbegin(regions), std::cend(regions)};
+    std::vector<ContigRegion> expected {regions};
+    std::sort(std::begin(expected), std::end(expected));
+    const MappableFlatMultiSet<ContigRegion> multi_serial {std::cbegin(expected), std::cend(expected)};
+    expected.erase(std::unique(std::begin(expected), std::end(expected)), std::end(expected));
+    BOOST_REQUIRE(std::equal(std::cbegin(serial), std::cend(serial), std::cbegin(expected), std::cend(expected)));
+    
+    for (unsigned num_threads : {0, 2, 3, 8}) {
+        const MappableFlatSet<ContigRegion> parallel {std::cbegin(regions), std::cend(regions), num_threads};
+        BOOST_REQUIRE(parallel == serial);
+        BOOST_REQUIRE_EQUAL(parallel.bidirectionally_sorted(), serial.bidirectionally_sorted());
+        BOOST_REQUIRE_EQUAL(parallel.max_element_size(), serial.max_element_size());
+        const MappableFlatMultiSet<ContigRegion> multi_parallel {std::cbegin(regions), std::cend(regions), num_threads};
+        BOOST_REQUIRE(multi_parallel == multi_serial);
+        BOOST_REQUIRE_EQUAL(multi_parallel.size(), regions.size());
+    }
+    
+    // Bidirectionally sorted elements are detected across thread chunk boundaries
+    std::vector<ContigRegion> tiled {};
+    for (ContigRegion::Position begin {0}; begin < 100000; ++begin) {
+        tiled.emplace_back(begin, begin + 10);
+    }
+    const MappableFlatSet<ContigRegion> tiled_set {std::cbegin(tiled), std::cend(tiled), 4};
+    BOOST_CHECK(tiled_set.bidirectionally_sorted());
+    BOOST_CHECK_EQUAL(tiled_set.max_element_size(), 10);
+    tiled[49999] = ContigRegion {49999, 50019};
+    const MappableFlatSet<ContigRegion> unsorted_set {std::cbegin(tiled), std::cend(tiled), 4};
+    BOOST_CHECK(!unsorted_set.bidirectionally_sorted());
+    BOOST_CHECK_EQUAL(unsorted_set.max_element_size(), 20);
+}
+
+BOOST_AUTO_TEST_CASE(multi_set_range_construction_sorts_in_place)
+{
+    std::mt19937 gen {11};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 100000}, size_dist {0, 100};
+    std::vector<ContigRegion> regions {};
+    for (int i {0}; i < 10000; ++i) {
+        const auto begin = begin_dist(gen);
+        regions.emplace_back(begin, begin + size_dist(gen));
+    }
+    AllocationTracker tracker {};
+    const TrackingAllocator<ContigRegion> alloc {tracker};
+    const MappableFlatMultiSet<ContigRegion, TrackingAllocator<ContigRegion>> multi {std::cbegin(regions), std::cend(regions), 2, alloc};
+    BOOST_REQUIRE_EQUAL(multi.size(), regions.size());
+    BOOST_CHECK(std::is_sorted(std::cbegin(multi), std::cend(multi)));
+    // the elements are only allocated once
+    BOOST_CHECK_EQUAL(tracker.peak, regions.size() * sizeof(ContigRegion));
+}
+
+BOOST_AUTO_TEST_CASE(materialised_ranges_can_be_erased)
+{
+    std::mt19937 gen {37};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 5000}, size_dist {0, 200};
+    std::vector<ContigRegion> regions {};
+    for (int i {0}; i < 2000; ++i) {
+        const auto begin = begin_dist(gen);
+        regions.emplace_back(begin, begin + size_dist(gen));
+    }
+    MappableFlatSet<ContigRegion> flat {std::cbegin(regions), std::cend(regions)};
+    MappableFlatMultiSet<ContigRegion> multi {std::cbegin(regions), std::cend(regions)};
+    const auto erase_and_check = [] (auto& set, const ContigRegion& query) {
+        const auto overlapped = materialise(set.overlap_range(query));
+        BOOST_REQUIRE_EQUAL(size(overlapped), set.count_overlapped(query));
+        std::vector<ContigRegion> expected {};
+        std::remove_copy_if(std::cbegin(set), std::cend(set), std::back_inserter(expected),
+                            [&] (const auto& region) { return overlaps(region, query); });
+        set.erase(overlapped);
+        BOOST_REQUIRE(std::equal(std::cbegin(set), std::cend(set), std::cbegin(expected), std::cend(expected)));
+        BOOST_REQUIRE_EQUAL(set.bidirectionally_sorted(), is_bidirectionally_sorted(set));
+        BOOST_REQUIRE_EQUAL(set.max_element_size(), region_size(*largest_mappable(set)));
+    };
+    for (ContigRegion::Position begin {0}; begin < 5000; begin += 250) {
+        erase_and_check(flat, ContigRegion {begin, begin + 20});
+        erase_and_check(multi, ContigRegion {begin, begin + 20});
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sort_info_is_maintained_incrementally)
+{
+    MappableFlatSet<ContigRegion> set {ContigRegion {0, 5}, ContigRegion {1, 6}, ContigRegion {2, 7}};
+    BOOST_CHECK(set.bidirectionally_sorted());
+    BOOST_CHECK(set.fixed_size());
+    BOOST_CHECK_EQUAL(set.count_overlapped(ContigRegion {5, 6}), 2);
+    BOOST_CHECK_EQUAL(set.count_contained(ContigRegion {0, 6}), 2);
+    set.insert(ContigRegion {1, 100});
+    BOOST_CHECK(!set.bidirectionally_sorted());
+    BOOST_CHECK(!set.fixed_size());
+    BOOST_CHECK_EQUAL(set.max_element_size(), 99);
+    set.erase(ContigRegion {1, 100});
+    BOOST_CHECK(set.bidirectionally_sorted());
+    BOOST_CHECK(set.fixed_size());
+    BOOST_CHECK_EQUAL(set.max_element_size(), 5);
+    
+    std::mt19937 gen {31};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 2000}, size_dist {0, 50};
+    std::uniform_int_distribution<int> op_dist {0, 7};
+    MappableFlatSet<ContigRegion> flat {};
+    MappableFlatMultiSet<ContigRegion> multi {};
+    const auto check = [] (const auto& container) {
+        BOOST_REQUIRE_EQUAL(container.bidirectionally_sorted(), is_bidirectionally_sorted(container));
+        const auto expected_max = container.empty() ? 0 : region_size(*largest_mappable(container));
+        BOOST_REQUIRE_EQUAL(container.max_element_size(), expected_max);
+        const auto expected_min = container.empty() ? 0 : region_size(*smallest_mappable(container));
+        BOOST_REQUIRE_EQUAL(container.fixed_size(), expected_min == expected_max);
+    };
+    for (int i {0}; i < 3000; ++i) {
+        const auto begin = begin_dist(gen);
+        const ContigRegion region {begin, begin + (i % 97 == 0 ? 500 : size_dist(gen))};
+        switch (op_dist(gen)) {
+            case 0:
+            case 1:
+                flat.insert(region);
+                multi.insert(region);
+                break;
+            case 2:
+                flat.insert(flat.cbegin(), region);
+                multi.emplace(region);
+                break;
+            case 3:
+                if (!flat.empty()) flat.erase(std::next(flat.cbegin(), begin % flat.size()));
+                if (!multi.empty()) multi.erase(*std::next(multi.cbegin(), begin % multi.size()));
+                break;
+            case 4:
+                flat.erase_overlapped(ContigRegion {begin, begin + 10});
+                multi.erase_overlapped(ContigRegion {begin, begin + 10});
+                break;
+            case 5:
+                flat.erase_contained(ContigRegion {begin, begin + 100});
+                multi.erase(multi.cbegin(), std::next(multi.cbegin(), std::min<std::size_t>(multi.size(), 2)));
+                break;
+            case 6: {
+                // Unsorted ranges that repeat each other and existing elements
+                std::vector<ContigRegion> regions {region, ContigRegion {begin / 2, begin / 2 + size_dist(gen)}, region};
+                if (!flat.empty()) regions.push_back(*std::next(flat.cbegin(), begin % flat.size()));
+                regions.emplace_back(begin_dist(gen), 2500);
+                flat.insert(std::cbegin(regions), std::cend(regions));
+                multi.insert(std::cbegin(regions), std::cend(regions));
+                break;
+            }
+            default: {
+                std::vector<ContigRegion> erased {};
+                for (std::size_t j {begin % 3}; j < flat.size(); j += 3 + begin % 5) {
+                    erased.push_back(*std::next(flat.cbegin(), j));
+                }
+                flat.erase_all(std::cbegin(erased), std::cend(erased));
+                multi.erase_all(std::cbegin(erased), std::cend(erased));
+                break;
+            }
+        }
+        check(flat);
+        check(multi);
+    }
+    flat.clear();
+    check(flat);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace test
@@ -0,0 +1,141 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <random>
+#include <cstddef>
+
+#include "mappable/genomic_region.hpp"
+#include "mappable/mappable_algorithms.hpp"
+#include "mappable/mappable_flat_set.hpp"
+#include "mappable/mappable_genome_set.hpp"
+
+#include "test_allocators.hpp"
+
+namespace mappable { namespace test {
+
+using mappable::MappableGenomeSet;
+
+BOOST_AUTO_TEST_SUITE(mappable_genome_set)
+
+BOOST_AUTO_TEST_CASE(elements_are_partitioned_by_contig)
+{
+    MappableGenomeSet<GenomicRegion> set {GenomicRegion {"2", 0, 10}, GenomicRegion {"1", 5, 10}, GenomicRegion {"2", 0, 10}};
+
+    BOOST_CHECK_EQUAL(set.size(), 2);
+    BOOST_CHECK(set.insert(GenomicRegion {"1", 0, 3}));
+    BOOST_CHECK(!set.insert(GenomicRegion {"1", 0, 3}));
+    BOOST_CHECK(set.emplace("3", 1, 2));
+    BOOST_CHECK_EQUAL(set.size(), 4);
+    BOOST_CHECK(set.contigs() == std::vector<std::string>({"2", "1", "3"}));
+    BOOST_CHECK_EQUAL(set.contig("1").size(), 2);
+    BOOST_CHECK_EQUAL(set.contig("1").front().get(), GenomicRegion("1", 0, 3));
+    BOOST_CHECK(set.contig("4").empty());
+#ifdef MAPPABLE_INTERNED_CONTIGS
+    // Looking up an unknown contig does not intern it
+    const auto num_interned = ContigDictionary::global().size();
+    BOOST_CHECK(set.contig("never_inserted").empty());
+    BOOST_CHECK(!ContigDictionary::global().find("never_inserted"));
+    BOOST_CHECK_EQUAL(ContigDictionary::global().size(), num_interned);
+#endif
+    BOOST_CHECK_EQUAL(set.count(GenomicRegion {"3", 1, 2}), 1);
+    BOOST_CHECK_EQUAL(set.count(GenomicRegion {"4", 1, 2}), 0);
+
+    BOOST_CHECK_EQUAL(set.erase(GenomicRegion {"3", 1, 2}), 1);
+    BOOST_CHECK_EQUAL(set.erase(GenomicRegion {"4", 1, 2}), 0);
+    BOOST_CHECK(set.contigs() == std::vector<std::string>({"2", "1"}));
+    BOOST_CHECK_EQUAL(set.size(), 3);
+    set.clear();
+    BOOST_CHECK(set.empty());
+}
+
+BOOST_AUTO_TEST_CASE(queries_match_flat_set_queries)
+{
+    std::mt19937 gen {23};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 5000}, size_dist {0, 100};
+    std::uniform_int_distribution<int> contig_dist {1, 4};
+
+    std::vector<GenomicRegion> regions {};
+    std::generate_n(std::back_inserter(regions), 2000, [&] () {
+        const auto begin = begin_dist(gen);
+        return GenomicRegion {std::to_string(contig_dist(gen)), begin, begin + size_dist(gen)};
+    });
+
+    MappableGenomeSet<GenomicRegion> set {std::cbegin(regions), std::cend(regions)};
+    std::vector<MappableFlatSet<GenomicRegion>> expected(5);
+    for (const auto& region : regions) {
+        expected[std::stoi(region.contig_name())].insert(region);
+    }
+    BOOST_CHECK_EQUAL(set.size(), expected[1].size() + expected[2].size() + expected[3].size() + expected[4].size());
+
+    for (int contig {1}; contig <= 5; ++contig) {
+        const auto& flat = expected[contig % 5];
+        for (ContigRegion::Position begin {0}; begin < 5000; begin += 97) {
+            const GenomicRegion query {std::to_string(contig), begin, begin + 150};
+            BOOST_REQUIRE_EQUAL(set.has_overlapped(query), flat.has_overlapped(query));
+            BOOST_REQUIRE_EQUAL(set.count_overlapped(query), flat.count_overlapped(query));
+            BOOST_REQUIRE_EQUAL(set.has_contained(query), flat.has_contained(query));
+            BOOST_REQUIRE_EQUAL(set.count_contained(query), flat.count_contained(query));
+            const auto overlapped = set.overlap_range(query);
+            BOOST_REQUIRE(std::equal(std::cbegin(overlapped), std::cend(overlapped),
+                                     std::cbegin(flat.overlap_range(query)), std::cend(flat.overlap_range(query)),
+                                     [] (const auto& lhs, const auto& rhs) { return lhs.get() == rhs; }));
+            const auto contained = set.contained_range(query);
+            BOOST_REQUIRE_EQUAL(size(contained), size(flat.contained_range(query)));
+        }
+    }
+
+    const GenomicRegion query {"2", 1000, 2000};
+    const auto num_overlapped = set.count_overlapped(query);
+    const auto old_size = set.size();
+    set.erase_overlapped(query);
+    BOOST_CHECK_EQUAL(set.size(), old_size - num_overlapped);
+    BOOST_CHECK(!set.has_overlapped(query));
+    BOOST_CHECK_EQUAL(set.count_overlapped(GenomicRegion {"1", 1000, 2000}), expected[1].count_overlapped(GenomicRegion {"1", 1000, 2000}));
+    set.erase_contained(GenomicRegion {"5", 0, 5000});
+    BOOST_CHECK_EQUAL(set.size(), old_size - num_overlapped);
+}
+
+BOOST_AUTO_TEST_CASE(contigs_with_names_of_different_lengths_are_found)
+{
+    const std::vector<std::string> names {"10", "2", "chrX", "1", "X", "chr10", "11", "chr1"};
+    MappableGenomeSet<GenomicRegion> set {};
+    for (GenomicRegion::Position i {0}; i < names.size(); ++i) {
+        set.insert(GenomicRegion {names[i], i, i + 1});
+    }
+    BOOST_CHECK(set.contigs() == names);
+    for (GenomicRegion::Position i {0}; i < names.size(); ++i) {
+        BOOST_CHECK_EQUAL(set.count_overlapped(GenomicRegion {names[i], 0, 100}), 1);
+        BOOST_CHECK(set.has_overlapped(GenomicRegion {names[i], i, i + 1}));
+    }
+    BOOST_CHECK(!set.has_overlapped(GenomicRegion {"3", 0, 100}));
+    BOOST_CHECK(!set.has_overlapped(GenomicRegion {"chr2", 0, 100}));
+    BOOST_CHECK(set.contig("Y").empty());
+}
+
+BOOST_AUTO_TEST_CASE(contig_sets_use_the_given_allocator)
+{
+    std::size_t num_allocations {0};
+    const AllocationCounter<GenomicRegion> alloc {num_allocations};
+    const std::vector<GenomicRegion> regions {GenomicRegion {"1", 0, 10}, GenomicRegion {"2", 5, 10}};
+    MappableGenomeSet<GenomicRegion, AllocationCounter<GenomicRegion>> set {std::cbegin(regions), std::cend(regions), alloc};
+    BOOST_CHECK(set.get_allocator() == alloc);
+    set.emplace("3", 1, 2);
+    BOOST_CHECK_EQUAL(set.size(), 3);
+    for (const auto& contig : set.contigs()) {
+        BOOST_CHECK(set.contig(contig).get_allocator() == alloc);
+    }
+    BOOST_CHECK(set.contig("4").empty());
+    BOOST_CHECK_EQUAL(set.count_overlapped(GenomicRegion {"4", 0, 10}), 0);
+    BOOST_CHECK_GT(num_allocations, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace mappable
@@ -0,0 +1,143 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <random>
+#include <memory>
+#include <cstddef>
+
+#include "mappable/contig_region.hpp"
+#include "mappable/mappable_flat_set.hpp"
+#include "mappable/mappable_log_structured_set.hpp"
+
+#include "test_allocators.hpp"
+
+namespace mappable { namespace test {
+
+using mappable::MappableLogStructuredSet;
+
+BOOST_AUTO_TEST_SUITE(mappable_log_structured_set)
+
+BOOST_AUTO_TEST_CASE(levels_are_merged_when_full)
+{
+    MappableLogStructuredSet<ContigRegion> set {2};
+    BOOST_CHECK(set.empty());
+    BOOST_CHECK(set.insert(ContigRegion {0, 1}));
+    BOOST_CHECK(set.insert(ContigRegion {1, 2}));
+    BOOST_CHECK_EQUAL(set.level_count(), 1);
+    BOOST_CHECK(set.insert(ContigRegion {2, 3}));
+    BOOST_CHECK_EQUAL(set.level_count(), 2);
+    BOOST_CHECK(set.level(0).empty());
+    BOOST_CHECK_EQUAL(set.level(1).size(), 3);
+    BOOST_CHECK(!set.insert(ContigRegion {1, 2}));
+    BOOST_CHECK(set.emplace(0, 5));
+    BOOST_CHECK_EQUAL(set.size(), 4);
+    BOOST_CHECK_EQUAL(set.count(ContigRegion {0, 5}), 1);
+    BOOST_CHECK_THROW(set.level(5), std::out_of_range);
+
+    BOOST_CHECK_EQUAL(set.erase(ContigRegion {1, 2}), 1);
+    BOOST_CHECK_EQUAL(set.erase(ContigRegion {1, 2}), 0);
+    BOOST_CHECK_EQUAL(set.size(), 3);
+
+    set.compact();
+    BOOST_REQUIRE_EQUAL(set.level_count(), 1);
+    BOOST_CHECK_EQUAL(set.level(0).size(), 3);
+    BOOST_CHECK(set.copy_overlapped(ContigRegion {0, 10}) == std::vector<ContigRegion>({ContigRegion {0, 1}, ContigRegion {0, 5}, ContigRegion {2, 3}}));
+    // The compacted level is larger than the buffer, so a new buffer level goes in front of it
+    BOOST_CHECK(!set.insert(ContigRegion {2, 3}));
+    BOOST_CHECK(set.insert(ContigRegion {3, 4}));
+    BOOST_REQUIRE_EQUAL(set.level_count(), 2);
+    BOOST_CHECK_EQUAL(set.level(0).size(), 1);
+    BOOST_CHECK_EQUAL(set.level(1).size(), 3);
+    BOOST_CHECK_EQUAL(set.size(), 4);
+    set.clear();
+    BOOST_CHECK(set.empty());
+    BOOST_CHECK_EQUAL(set.level_count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(interleaved_inserts_and_queries_match_flat_set)
+{
+    std::mt19937 gen {29};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 20000}, size_dist {0, 80};
+
+    MappableLogStructuredSet<ContigRegion> set {16};
+    MappableFlatSet<ContigRegion> expected {};
+
+    const auto check_queries = [&] () {
+        BOOST_REQUIRE_EQUAL(set.size(), expected.size());
+        for (ContigRegion::Position begin {0}; begin < 20000; begin += 397) {
+            const ContigRegion query {begin, begin + 200};
+            BOOST_REQUIRE_EQUAL(set.has_overlapped(query), expected.has_overlapped(query));
+            BOOST_REQUIRE_EQUAL(set.count_overlapped(query), expected.count_overlapped(query));
+            BOOST_REQUIRE_EQUAL(set.has_contained(query), expected.count_contained(query) > 0);
+            BOOST_REQUIRE_EQUAL(set.count_contained(query), expected.count_contained(query));
+            const auto overlapped = expected.overlap_range(query);
+            BOOST_REQUIRE(set.copy_overlapped(query) == std::vector<ContigRegion>(std::cbegin(overlapped), std::cend(overlapped)));
+            const auto contained = expected.contained_range(query);
+            BOOST_REQUIRE(set.copy_contained(query) == std::vector<ContigRegion>(std::cbegin(contained), std::cend(contained)));
+        }
+    };
+
+    for (int batch {0}; batch < 40; ++batch) {
+        std::vector<ContigRegion> regions {};
+        for (int i {0}; i < 1 + batch * 5; ++i) {
+            const auto begin = begin_dist(gen);
+            regions.emplace_back(begin, begin + size_dist(gen));
+        }
+        if (batch % 2 == 0) {
+            for (const auto& region : regions) {
+                BOOST_REQUIRE_EQUAL(set.insert(region), expected.insert(region).second);
+            }
+        } else {
+            set.insert(std::cbegin(regions), std::cend(regions));
+            expected.insert(std::cbegin(regions), std::cend(regions));
+        }
+        check_queries();
+    }
+    BOOST_CHECK(set.level_count() > 2);
+    for (std::size_t n {0}; n < set.level_count(); ++n) {
+        BOOST_CHECK(set.level(n).size() <= (set.buffer_capacity() << n));
+    }
+
+    set.erase_overlapped(ContigRegion {1000, 3000});
+    expected.erase_overlapped(ContigRegion {1000, 3000});
+    set.erase_contained(ContigRegion {5000, 9000});
+    expected.erase_contained(ContigRegion {5000, 9000});
+    check_queries();
+
+    set.compact();
+    BOOST_CHECK_EQUAL(set.level_count(), 1);
+    check_queries();
+    for (int i {0}; i < 100; ++i) {
+        const auto begin = begin_dist(gen);
+        const ContigRegion region {begin, begin + size_dist(gen)};
+        BOOST_REQUIRE_EQUAL(set.insert(region), expected.insert(region).second);
+    }
+    check_queries();
+}
+
+BOOST_AUTO_TEST_CASE(levels_use_the_given_allocator)
+{
+    std::size_t num_allocations {0};
+    const AllocationCounter<ContigRegion> alloc {num_allocations};
+    MappableLogStructuredSet<ContigRegion, AllocationCounter<ContigRegion>> set {2, alloc};
+    BOOST_CHECK(set.get_allocator() == alloc);
+    for (ContigRegion::Position begin {0}; begin < 10; ++begin) {
+        set.emplace(begin, begin + 1);
+    }
+    BOOST_CHECK_EQUAL(set.size(), 10);
+    BOOST_REQUIRE_GT(set.level_count(), 1);
+    for (std::size_t n {0}; n < set.level_count(); ++n) {
+        BOOST_CHECK(set.level(n).get_allocator() == alloc);
+    }
+    BOOST_CHECK_GT(num_allocations, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace mappable
@@ -4,9 +4,11 @@
 #include <boost/test/unit_test.hpp>
 
 #include <vector>
+#include <iterator>
 
 #include "mappable/contig_region.hpp"
 #include "mappable/mappable_range.hpp"
+#include "mappable/materialised_range.hpp"
 
 namespace mappable { namespace test {
 
@@ -52,6 +54,36 @@ BOOST_AUTO_TEST_CASE(overlap_ranges_filters_non_overlapped_elements)
     BOOST_CHECK(overlapped.empty());
 }
 
+BOOST_AUTO_TEST_CASE(materialised_ranges_only_contain_selected_elements)
+{
+    const std::vector<ContigRegion> v {
+        ContigRegion {0, 1}, ContigRegion {0, 5}, ContigRegion {1, 2}, ContigRegion {3, 4}, ContigRegion {3, 6},
+        ContigRegion {6, 7}
+    };
+    const auto overlapped = materialise(make_overlap_range(v.cbegin(), v.cend(), ContigRegion {3, 4}));
+    BOOST_CHECK(!overlapped.is_contiguous());
+    BOOST_CHECK_EQUAL(size(overlapped), 3);
+    BOOST_CHECK_EQUAL(base_size(overlapped), 4);
+    BOOST_CHECK(std::vector<ContigRegion>(overlapped.begin(), overlapped.end())
+                == std::vector<ContigRegion>({v[1], v[3], v[4]}));
+    BOOST_CHECK_EQUAL(std::distance(overlapped.begin(), overlapped.end()), 3);
+    BOOST_CHECK(std::prev(overlapped.end()).base() == std::next(v.cbegin(), 4));
+    BOOST_CHECK(overlapped.end().base() == overlapped.base_end());
+    BOOST_CHECK(std::cend(overlapped).base() == std::next(v.cbegin(), 5));
+    BOOST_CHECK(std::next(overlapped.begin(), 3).base() == overlapped.base_end());
+    
+    const auto contained = materialise(make_contained_range(v.cbegin(), v.cend(), ContigRegion {3, 7}));
+    BOOST_CHECK(contained.is_contiguous());
+    BOOST_CHECK_EQUAL(size(contained), 3);
+    BOOST_CHECK(contained.base_begin() == std::next(v.cbegin(), 3));
+    BOOST_CHECK(contained.base_end() == v.cend());
+    BOOST_CHECK(contained.end().base() == v.cend());
+    
+    const auto none = materialise(make_overlap_range(v.cbegin(), v.cend(), ContigRegion {8, 9}));
+    BOOST_CHECK(none.empty());
+    BOOST_CHECK(none.begin() == none.end());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace test
@@ -0,0 +1,179 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <random>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+#include "mappable/contig_region.hpp"
+#include "mappable/mappable.hpp"
+#include "mappable/mappable_flat_set.hpp"
+#include "mappable/mappable_snapshot.hpp"
+
+namespace mappable { namespace test {
+
+namespace {
+
+struct Annotation : public Mappable<Annotation>
+{
+    Annotation() = default;
+    Annotation(ContigRegion region, SnapshotStringRef name) : region {region}, name {name} {}
+    ContigRegion region;
+    SnapshotStringRef name;
+    const ContigRegion& mapped_region() const noexcept { return region; }
+};
+
+bool operator==(const Annotation& lhs, const Annotation& rhs) noexcept
+{
+    return lhs.region == rhs.region && lhs.name.offset == rhs.name.offset;
+}
+
+bool operator<(const Annotation& lhs, const Annotation& rhs) noexcept
+{
+    return lhs.region < rhs.region || (lhs.region == rhs.region && lhs.name.offset < rhs.name.offset);
+}
+
+template <typename Range>
+std::vector<ContigRegion> to_regions(const Range& range)
+{
+    std::vector<ContigRegion> result {};
+    for (const auto& mappable : range) result.push_back(mapped_region(mappable));
+    return result;
+}
+
+struct ScoredRegion : public Mappable<ScoredRegion>
+{
+    ScoredRegion() = default;
+    ScoredRegion(ContigRegion region, std::uint8_t score) : region {region}, score {score} {}
+    ContigRegion region;
+    std::uint8_t score; // followed by padding
+    const ContigRegion& mapped_region() const noexcept { return region; }
+};
+
+bool operator==(const ScoredRegion& lhs, const ScoredRegion& rhs) noexcept
+{
+    return lhs.region == rhs.region && lhs.score == rhs.score;
+}
+
+bool operator<(const ScoredRegion& lhs, const ScoredRegion& rhs) noexcept
+{
+    return lhs.region < rhs.region || (lhs.region == rhs.region && lhs.score < rhs.score);
+}
+
+std::string read_file(const std::string& path)
+{
+    std::ifstream file {path, std::ios::binary};
+    return std::string {std::istreambuf_iterator<char> {file}, std::istreambuf_iterator<char> {}};
+}
+
+struct TemporaryFile
+{
+    std::string path;
+    explicit TemporaryFile(std::string p) : path {std::move(p)} {}
+    ~TemporaryFile() { std::remove(path.c_str()); }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(mappable_snapshot)
+
+BOOST_AUTO_TEST_CASE(snapshots_can_be_queried_in_place)
+{
+    std::mt19937 gen {41};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 20000}, size_dist {0, 300};
+    SnapshotStringPool names {};
+    std::vector<Annotation> annotations {};
+    for (int i {0}; i < 3000; ++i) {
+        const auto begin = begin_dist(gen);
+        annotations.emplace_back(ContigRegion {begin, begin + size_dist(gen)},
+                                 names.add("gene" + std::to_string(i)));
+    }
+    const MappableFlatSet<Annotation> set {std::cbegin(annotations), std::cend(annotations)};
+    const TemporaryFile file {"mappable_snapshot_test.bin"};
+    write_snapshot(set, file.path, names);
+
+    MappableSnapshot<Annotation> snapshot {file.path};
+    BOOST_REQUIRE_EQUAL(snapshot.size(), set.size());
+    BOOST_CHECK(std::equal(std::cbegin(snapshot), std::cend(snapshot), std::cbegin(set), std::cend(set)));
+    BOOST_CHECK_EQUAL(snapshot.bidirectionally_sorted(), set.bidirectionally_sorted());
+    BOOST_CHECK_EQUAL(snapshot.fixed_size(), set.fixed_size());
+    BOOST_CHECK_EQUAL(snapshot.max_element_size(), set.max_element_size());
+    BOOST_CHECK_EQUAL(snapshot.string(snapshot[0].name), names.data().substr(set[0].name.offset, set[0].name.length));
+
+    for (ContigRegion::Position begin {0}; begin < 20000; begin += 173) {
+        const ContigRegion query {begin, begin + 250};
+        BOOST_REQUIRE_EQUAL(snapshot.has_overlapped(query), set.has_overlapped(query));
+        BOOST_REQUIRE_EQUAL(snapshot.count_overlapped(query), set.count_overlapped(query));
+        BOOST_REQUIRE(to_regions(snapshot.overlap_range(query)) == to_regions(set.overlap_range(query)));
+        BOOST_REQUIRE_EQUAL(snapshot.has_contained(query), set.has_contained(query));
+        BOOST_REQUIRE_EQUAL(snapshot.count_contained(query), set.count_contained(query));
+        BOOST_REQUIRE(to_regions(snapshot.contained_range(query)) == to_regions(set.contained_range(query)));
+    }
+
+    auto moved = std::move(snapshot);
+    BOOST_CHECK_EQUAL(moved.size(), set.size());
+}
+
+BOOST_AUTO_TEST_CASE(bad_snapshots_are_rejected)
+{
+    const MappableFlatSet<ContigRegion> regions {ContigRegion {0, 10}, ContigRegion {5, 15}};
+    const TemporaryFile file {"mappable_snapshot_bad_test.bin"};
+    write_snapshot(regions, file.path);
+    {
+        const MappableSnapshot<ContigRegion> snapshot {file.path};
+        BOOST_CHECK_EQUAL(snapshot.size(), 2);
+        BOOST_CHECK(snapshot.fixed_size());
+        BOOST_CHECK_EQUAL(snapshot.count_overlapped(ContigRegion {9, 10}), 2);
+    }
+    using BadSnapshot = MappableSnapshot<Annotation>::BadSnapshot;
+    BOOST_CHECK_THROW(MappableSnapshot<Annotation> {file.path}, BadSnapshot);
+    BOOST_CHECK_THROW(MappableSnapshot<ContigRegion> {"no_such_snapshot.bin"}, MappableSnapshot<ContigRegion>::BadSnapshot);
+    {
+        std::ofstream corrupted {file.path, std::ios::binary | std::ios::app};
+        corrupted << "x";
+    }
+    BOOST_CHECK_THROW(MappableSnapshot<ContigRegion> {file.path}, MappableSnapshot<ContigRegion>::BadSnapshot);
+}
+
+BOOST_AUTO_TEST_CASE(snapshots_are_reproducible)
+{
+    static_assert(!detail::IsSnapshotElement<GenomicRegion>::value, "GenomicRegion contig keys are not stored");
+    static_assert(detail::IsSnapshotElement<ContigRegion>::value, "");
+    static_assert(sizeof(ScoredRegion) > sizeof(ContigRegion) + sizeof(std::uint8_t), "ScoredRegion should be padded");
+
+    std::vector<ScoredRegion> regions {};
+    for (std::uint8_t i {0}; i < 100; ++i) {
+        ScoredRegion region;
+        std::memset(&region, 0xff, sizeof(region)); // dirty the padding
+        region.region = ContigRegion {i * 10u, i * 10u + i % 7};
+        region.score = i;
+        regions.push_back(region);
+    }
+    const MappableFlatSet<ScoredRegion> set {std::cbegin(regions), std::cend(regions)};
+    const TemporaryFile first {"mappable_snapshot_reproducible_test1.bin"}, second {"mappable_snapshot_reproducible_test2.bin"};
+    write_snapshot(set, first.path);
+    write_snapshot(MappableFlatSet<ScoredRegion> {set}, second.path);
+    const auto bytes = read_file(first.path);
+    BOOST_CHECK(bytes == read_file(second.path));
+    const auto elements = bytes.substr(bytes.size() - set.size() * sizeof(ScoredRegion));
+    for (std::size_t i {0}; i < set.size(); ++i) {
+        const auto padding = elements.substr(i * sizeof(ScoredRegion) + sizeof(ContigRegion) + 1,
+                                             sizeof(ScoredRegion) - sizeof(ContigRegion) - 1);
+        BOOST_REQUIRE(std::all_of(std::cbegin(padding), std::cend(padding), [] (char c) { return c == 0; }));
+    }
+    const MappableSnapshot<ScoredRegion> snapshot {first.path};
+    BOOST_CHECK(std::equal(std::cbegin(snapshot), std::cend(snapshot), std::cbegin(set), std::cend(set)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace mappable
@@ -0,0 +1,107 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <random>
+
+#include "mappable/contig_region.hpp"
+#include "mappable/mappable_algorithms.hpp"
+#include "mappable/mappable_flat_set.hpp"
+#include "mappable/mappable_flat_multi_set.hpp"
+#include "mappable/overlap_cursor.hpp"
+
+namespace mappable { namespace test {
+
+namespace {
+
+template <typename Range>
+std::vector<ContigRegion> to_vector(const Range& range)
+{
+    return {std::cbegin(range), std::cend(range)};
+}
+
+template <typename Container>
+void check_sliding_windows(const Container& mappables, const ContigRegion::Position window,
+                           const ContigRegion::Position step)
+{
+    auto cursor = make_overlap_cursor(mappables);
+    for (ContigRegion::Position begin {0}; begin < 10000; begin += step) {
+        const ContigRegion query {begin, begin + window};
+        BOOST_REQUIRE(to_vector(cursor.overlap_range(query)) == to_vector(mappables.overlap_range(query)));
+        BOOST_REQUIRE_EQUAL(cursor.count_overlapped(query), mappables.count_overlapped(query));
+        BOOST_REQUIRE_EQUAL(cursor.has_overlapped(query), mappables.count_overlapped(query) > 0);
+        BOOST_REQUIRE(to_vector(cursor.contained_range(query)) == to_vector(mappables.contained_range(query)));
+        BOOST_REQUIRE_EQUAL(cursor.count_contained(query), mappables.count_contained(query));
+        BOOST_REQUIRE_EQUAL(cursor.has_contained(query), mappables.count_contained(query) > 0);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(overlap_cursor)
+
+BOOST_AUTO_TEST_CASE(cursor_queries_match_container_queries)
+{
+    std::mt19937 gen {31};
+    std::uniform_int_distribution<ContigRegion::Position> begin_dist {0, 10000}, size_dist {0, 150};
+
+    std::vector<ContigRegion> regions {}, fixed_size_regions {};
+    for (int i {0}; i < 2000; ++i) {
+        const auto begin = begin_dist(gen);
+        regions.emplace_back(begin, begin + size_dist(gen));
+        fixed_size_regions.emplace_back(begin, begin + 50);
+    }
+
+    const MappableFlatSet<ContigRegion> set {std::cbegin(regions), std::cend(regions)};
+    const MappableFlatMultiSet<ContigRegion> multi_set {std::cbegin(regions), std::cend(regions)};
+    const MappableFlatSet<ContigRegion> sorted_set {std::cbegin(fixed_size_regions), std::cend(fixed_size_regions)};
+    BOOST_REQUIRE(!set.bidirectionally_sorted());
+    BOOST_REQUIRE(sorted_set.bidirectionally_sorted());
+
+    for (const auto window : {ContigRegion::Position {0}, ContigRegion::Position {100}, ContigRegion::Position {1000}}) {
+        for (const auto step : {ContigRegion::Position {1}, ContigRegion::Position {37}, ContigRegion::Position {500}}) {
+            check_sliding_windows(set, window, step);
+            check_sliding_windows(multi_set, window, step);
+            check_sliding_windows(sorted_set, window, step);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(cursor_works_on_sorted_ranges)
+{
+    std::vector<ContigRegion> regions {
+        ContigRegion {0, 10}, ContigRegion {2, 4}, ContigRegion {3, 30}, ContigRegion {5, 6},
+        ContigRegion {12, 15}, ContigRegion {20, 22}, ContigRegion {40, 50}
+    };
+    auto cursor = make_overlap_cursor(regions);
+    BOOST_CHECK_EQUAL(cursor.count_overlapped(ContigRegion {1, 2}), 1);
+    BOOST_CHECK_EQUAL(cursor.count_overlapped(ContigRegion {4, 5}), 2);
+    BOOST_CHECK_EQUAL(cursor.count_contained(ContigRegion {4, 16}), 2);
+    BOOST_CHECK_EQUAL(cursor.count_overlapped(ContigRegion {16, 21}), 2);
+    BOOST_CHECK(!cursor.has_overlapped(ContigRegion {32, 38}));
+    BOOST_CHECK(cursor.has_contained(ContigRegion {40, 50}));
+    BOOST_CHECK(!cursor.has_overlapped(ContigRegion {60, 70}));
+
+    cursor.reset();
+    BOOST_CHECK_EQUAL(cursor.count_overlapped(ContigRegion {0, 1}), 1);
+
+    auto bounded_cursor = make_overlap_cursor(std::cbegin(regions), std::cend(regions), region_size(*largest_mappable(regions)));
+    std::vector<ContigRegion> queries {};
+    for (ContigRegion::Position begin {0}; begin < 60; begin += 3) {
+        queries.emplace_back(begin, begin + 3);
+    }
+    const auto expected = overlap_ranges(std::cbegin(regions), std::cend(regions), std::cbegin(queries), std::cend(queries),
+                                         ForwardSortedTag {});
+    for (std::size_t i {0}; i < queries.size(); ++i) {
+        BOOST_CHECK(to_vector(bounded_cursor.overlap_range(queries[i])) == to_vector(expected[i]));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace mappable
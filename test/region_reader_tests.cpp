@@ -0,0 +1,118 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <cstdio>
+
+#include "mappable/contig_region.hpp"
+#include "mappable/genomic_region.hpp"
+#include "mappable/mappable_flat_set.hpp"
+#include "mappable/region_reader.hpp"
+
+namespace mappable { namespace test {
+
+namespace {
+
+struct TemporaryFile
+{
+    std::string path;
+    TemporaryFile(std::string p, const std::string& contents) : path {std::move(p)}
+    {
+        std::ofstream {path, std::ios::binary} << contents;
+    }
+    ~TemporaryFile() { std::remove(path.c_str()); }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(region_reader)
+
+BOOST_AUTO_TEST_CASE(parse_region_is_the_inverse_of_to_string)
+{
+    const GenomicRegion region {"chr1", 100, 2000};
+    BOOST_CHECK_EQUAL(parse_region(to_string(region)), region);
+    BOOST_CHECK_EQUAL(parse_region("chr1:1,000-2,000"), (GenomicRegion {"chr1", 1000, 2000}));
+    BOOST_CHECK_EQUAL(parse_region("chr1:999-12,345,678"), (GenomicRegion {"chr1", 999, 12345678}));
+    BOOST_CHECK_THROW(parse_region("chr1:1,,000-2000"), std::invalid_argument);
+    BOOST_CHECK_THROW(parse_region("chr1:1000,-2000"), std::invalid_argument);
+    BOOST_CHECK_THROW(parse_region("chr1:1,00-2000"), std::invalid_argument);
+    BOOST_CHECK_THROW(parse_region("chr1:1000,000-2000000"), std::invalid_argument);
+    BOOST_CHECK_EQUAL(parse_region("HLA-A*01:01:0-10").contig_name(), "HLA-A*01:01");
+    BOOST_CHECK_THROW(parse_region("chr1"), std::invalid_argument);
+    BOOST_CHECK_THROW(parse_region("chr1:10"), std::invalid_argument);
+    BOOST_CHECK_THROW(parse_region("chr1:10-5"), std::invalid_argument);
+    BOOST_CHECK_THROW(parse_region("chr1:a-5"), std::invalid_argument);
+    BOOST_CHECK_THROW(parse_region(":0-5"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(parse_bed_skips_headers_and_keeps_extra_columns)
+{
+    const std::string bed {
+        "track name=test\n"
+        "# comment\n"
+        "chr1\t10\t20\tgeneA\t0\t+\r\n"
+        "\n"
+        "chr1 5 15\n"
+        "chr2\t0\t1"
+    };
+    std::vector<BedRecord> records {};
+    const auto n = parse_bed(bed.data(), bed.data() + bed.size(), [&] (const BedRecord& record) {
+        records.push_back(record);
+    });
+    BOOST_REQUIRE_EQUAL(n, 3);
+    BOOST_CHECK_EQUAL(records[0].contig, "chr1");
+    BOOST_CHECK_EQUAL(records[0].region, (ContigRegion {10, 20}));
+    BOOST_CHECK_EQUAL(records[0].rest, "geneA\t0\t+");
+    BOOST_CHECK_EQUAL(records[1].region, (ContigRegion {5, 15}));
+    BOOST_CHECK(records[1].rest.empty());
+    BOOST_CHECK_EQUAL(records[2].contig, "chr2");
+    BOOST_CHECK_EQUAL(records[2].region, (ContigRegion {0, 1}));
+
+    const std::string bad {"chr1\t10\t20\nchr1\t20\t10\n"};
+    BOOST_CHECK_THROW(parse_bed(bad.data(), bad.data() + bad.size(), [] (const BedRecord&) {}), std::runtime_error);
+    for (const std::string separated : {"chr1\t1,000\t2000\n", "chr1\t1,,000\t2000\n", "chr1\t10\t1000,\n"}) {
+        BOOST_CHECK_THROW(parse_bed(separated.data(), separated.data() + separated.size(), [] (const BedRecord&) {}),
+                          std::runtime_error);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(read_bed_builds_a_contig_map)
+{
+    const TemporaryFile file {"region_reader_test.bed", "chr1\t10\t20\nchr2\t0\t5\nchr1\t0\t30\nchr1\t10\t20\n"};
+    const auto regions = read_bed(file.path);
+    BOOST_REQUIRE_EQUAL(regions.size(), 2);
+    BOOST_CHECK_EQUAL(regions.at("chr1").size(), 3);
+    BOOST_CHECK_EQUAL(regions.at("chr1").front(), (GenomicRegion {"chr1", 0, 30}));
+    BOOST_CHECK_EQUAL(regions.at("chr1").count_overlapped(GenomicRegion {"chr1", 19, 20}), 3);
+    BOOST_CHECK_EQUAL(regions.at("chr2").front(), (GenomicRegion {"chr2", 0, 5}));
+
+    const auto contig_regions = read_bed<MappableFlatSet<ContigRegion>>(
+        file.path, [] (const auto&, const BedRecord& record) { return record.region; });
+    BOOST_CHECK_EQUAL(contig_regions.at("chr1").size(), 2);
+    BOOST_CHECK_EQUAL(contig_regions.at("chr1").max_element_size(), 30);
+
+    BOOST_CHECK_THROW(read_bed("no_such_file.bed"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(read_region_list_builds_a_contig_map)
+{
+    const TemporaryFile file {"region_reader_test.txt", "# regions\nchr1:10-20\nchr2:0-5\n\nchr1:0-30"};
+    const auto regions = read_region_list<MappableFlatSet<GenomicRegion>>(file.path);
+    BOOST_REQUIRE_EQUAL(regions.size(), 2);
+    BOOST_CHECK_EQUAL(regions.at("chr1").size(), 2);
+    BOOST_CHECK_EQUAL(regions.at("chr1").back(), (GenomicRegion {"chr1", 10, 20}));
+    BOOST_CHECK_EQUAL(regions.at("chr2").size(), 1);
+
+    const TemporaryFile bad {"region_reader_bad_test.txt", "chr1:10-20\nchr1:20\n"};
+    BOOST_CHECK_THROW(read_region_list(bad.path), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace mappable
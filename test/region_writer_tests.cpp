@@ -0,0 +1,64 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <limits>
+
+#include "mappable/contig_region.hpp"
+#include "mappable/genomic_region.hpp"
+#include "mappable/mappable_flat_set.hpp"
+#include "mappable/region_reader.hpp"
+#include "mappable/region_writer.hpp"
+
+namespace mappable { namespace test {
+
+BOOST_AUTO_TEST_SUITE(region_writer)
+
+BOOST_AUTO_TEST_CASE(regions_are_written_like_to_string)
+{
+    using Position = ContigRegion::Position;
+    const std::vector<Position> positions {0, 9, 10, 99, 100, 12345, 1000000, std::numeric_limits<Position>::max()};
+    std::ostringstream expected {}, actual {};
+    {
+        RegionWriter writer {actual, RegionFormat::region, 1}; // minimum buffer, so flushed every region
+        for (auto position : positions) {
+            const GenomicRegion region {"chr1", position, position};
+            expected << to_string(region) << '\n' << to_string(region.contig_region()) << '\n';
+            writer.write(region).write(region.contig_region());
+        }
+    }
+    BOOST_CHECK_EQUAL(actual.str(), expected.str());
+}
+
+BOOST_AUTO_TEST_CASE(query_ranges_can_be_written_as_bed)
+{
+    const MappableFlatSet<GenomicRegion> regions {
+        GenomicRegion {"chr1", 0, 10}, GenomicRegion {"chr1", 5, 20}, GenomicRegion {"chr1", 30, 40}
+    };
+    std::ostringstream bed {};
+    write_regions(bed, regions.overlap_range(GenomicRegion {"chr1", 8, 35}));
+    BOOST_CHECK_EQUAL(bed.str(), "chr1\t0\t10\nchr1\t5\t20\nchr1\t30\t40\n");
+
+    const MappableFlatSet<ContigRegion> contig_regions {ContigRegion {0, 10}, ContigRegion {5, 20}};
+    std::ostringstream contained {};
+    write_regions(contained, "chrX", contig_regions.contained_range(ContigRegion {4, 20}), RegionFormat::region);
+    BOOST_CHECK_EQUAL(contained.str(), "chrX:5-20\n");
+    BOOST_CHECK_EQUAL(parse_region(contained.str().substr(0, contained.str().size() - 1)), (GenomicRegion {"chrX", 5, 20}));
+
+    std::string long_contig(100, 'c');
+    std::ostringstream unbuffered {};
+    {
+        RegionWriter writer {unbuffered, RegionFormat::bed, 1};
+        writer.write(long_contig, ContigRegion {1, 2}).write(long_contig, ContigRegion {3, 4});
+    }
+    BOOST_CHECK_EQUAL(unbuffered.str(), long_contig + "\t1\t2\n" + long_contig + "\t3\t4\n");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace mappable
@@ -0,0 +1,50 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef test_allocators_hpp
+#define test_allocators_hpp
+
+#include <memory>
+#include <cstddef>
+
+namespace mappable { namespace test {
+
+/*
+ AllocationCounter is a stateful test allocator that counts the allocations made through any copy or
+ rebind of it in a shared counter. Copies compare equal only if they share the counter.
+ */
+template <typename T>
+struct AllocationCounter
+{
+    using value_type = T;
+
+    std::size_t* num_allocations;
+
+    explicit AllocationCounter(std::size_t& n) noexcept : num_allocations {&n} {}
+    template <typename U>
+    AllocationCounter(const AllocationCounter<U>& other) noexcept : num_allocations {other.num_allocations} {}
+
+    T* allocate(std::size_t n)
+    {
+        ++*num_allocations;
+        return std::allocator<T> {}.allocate(n);
+    }
+    void deallocate(T* p, std::size_t n) noexcept { std::allocator<T> {}.deallocate(p, n); }
+};
+
+template <typename T, typename U>
+bool operator==(const AllocationCounter<T>& lhs, const AllocationCounter<U>& rhs) noexcept
+{
+    return lhs.num_allocations == rhs.num_allocations;
+}
+
+template <typename T, typename U>
+bool operator!=(const AllocationCounter<T>& lhs, const AllocationCounter<U>& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+} // namespace test
+} // namespace mappable
+
+#endif